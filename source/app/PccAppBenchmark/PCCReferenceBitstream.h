@@ -0,0 +1,139 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PCCReferenceBitstream_h
+#define PCCReferenceBitstream_h
+
+#include "PCCBitstream.h"
+
+namespace pcc {
+namespace reference {
+
+// The bit reader and writer of PCCBitstream as they were before the word-level access: one branch per bit. It is
+// kept as the reference of the bit-exactness checks of PccAppBenchmark.
+class PCCBitstream {
+ public:
+  PCCBitstream() { position_ = {0, 0}; }
+  ~PCCBitstream() = default;
+
+  void initialize( const std::vector<uint8_t>& data ) {
+    data_            = data;
+    position_.bytes_ = 0;
+    position_.bits_  = 0;
+  }
+  void initialize( uint64_t capacity ) { data_.resize( capacity, 0 ); }
+  uint8_t*  buffer() { return data_.data(); }
+  uint64_t& size() { return position_.bytes_; }
+  bool      byteAligned() { return ( position_.bits_ == 0 ); }
+
+  inline uint32_t read( uint8_t bits ) { return read( bits, position_ ); }
+
+  template <typename T>
+  void write( T value, uint8_t bits ) {
+    write( static_cast<uint32_t>( value ), bits, position_ );
+  }
+
+  template <typename T>
+  inline void writeUvlc( T value ) {
+    uint32_t code   = static_cast<uint32_t>( value );
+    uint32_t length = 1, temp = ++code;
+    while ( 1 != temp ) {
+      temp >>= 1;
+      length += 2;
+    }
+    write( 0, length >> 1 );
+    write( code, ( length + 1 ) >> 1 );
+  }
+
+  inline uint32_t readUvlc() {
+    uint32_t value = 0, code = 0, length = 0;
+    code = read( 1 );
+    if ( 0 == code ) {
+      length = 0;
+      while ( !( code & 1 ) ) {
+        code = read( 1 );
+        length++;
+      }
+      value = read( length );
+      value += ( 1 << length ) - 1;
+    }
+    return value;
+  }
+
+  template <typename T>
+  inline void writeSvlc( T value ) {
+    int32_t code = static_cast<int32_t>( value );
+    writeUvlc( ( uint32_t )( code <= 0 ? -code << 1 : ( code << 1 ) - 1 ) );
+  }
+
+  inline int32_t readSvlc() {
+    uint32_t bits = readUvlc();
+    return ( bits & 1 ) ? ( int32_t )( bits >> 1 ) + 1 : -( int32_t )( bits >> 1 );
+  }
+
+ private:
+  inline void realloc( const size_t size = 4096 ) { data_.resize( data_.size() + ( ( ( size / 4096 ) + 1 ) * 4096 ) ); }
+  inline uint32_t read( uint8_t bits, PCCBistreamPosition& pos ) {
+    uint32_t value = 0;
+    for ( size_t i = 0; i < bits; i++ ) {
+      value |= ( ( data_[pos.bytes_] >> ( 7 - pos.bits_ ) ) & 1 ) << ( bits - 1 - i );
+      if ( pos.bits_ == 7 ) {
+        pos.bytes_++;
+        pos.bits_ = 0;
+      } else {
+        pos.bits_++;
+      }
+    }
+    return value;
+  }
+
+  inline void write( uint32_t value, uint8_t bits, PCCBistreamPosition& pos ) {
+    if ( pos.bytes_ + bits + 16 >= data_.size() ) { realloc(); }
+    for ( size_t i = 0; i < bits; i++ ) {
+      data_[pos.bytes_] |= ( ( value >> ( bits - 1 - i ) ) & 1 ) << ( 7 - pos.bits_ );
+      if ( pos.bits_ == 7 ) {
+        pos.bytes_++;
+        pos.bits_ = 0;
+      } else {
+        pos.bits_++;
+      }
+    }
+  }
+
+  std::vector<uint8_t> data_;
+  PCCBistreamPosition  position_;
+};
+
+}  // namespace reference
+}  // namespace pcc
+
+#endif /* PCCReferenceBitstream_h */
@@ -0,0 +1,599 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PCCReferencePadding_h
+#define PCCReferencePadding_h
+
+#include "PCCCommon.h"
+#include "PCCMath.h"
+#include "PCCImage.h"
+
+namespace pcc {
+namespace reference {
+
+// The image padding functions of PCCEncoder as they were before the move to PCCImagePadding: one getValue/setValue
+// call per sample. They are kept as the reference of the bit-exactness checks of PccAppBenchmark.
+
+template <typename T>
+void dilate( PCCImage<T, 3>&              image,
+             const std::vector<uint32_t>& occupancyMap,
+             const size_t                 occupancyResolution,
+             const bool                   enhancedOccupancyMap,
+             const PCCImage<T, 3>*        reference ) {
+  auto          occupancyMapTemp         = occupancyMap;
+  const size_t  pixelBlockCount          = occupancyResolution * occupancyResolution;
+  const size_t  occupancyMapSizeU        = image.getWidth() / occupancyResolution;
+  const size_t  occupancyMapSizeV        = image.getHeight() / occupancyResolution;
+  const int64_t neighbors[4][2]          = {{0, -1}, {-1, 0}, {1, 0}, {0, 1}};
+  const size_t  MAX_OCCUPANCY_RESOLUTION = 64;
+  assert( occupancyResolution <= MAX_OCCUPANCY_RESOLUTION );
+  size_t              count[MAX_OCCUPANCY_RESOLUTION][MAX_OCCUPANCY_RESOLUTION];
+  PCCVector3<int32_t> values[MAX_OCCUPANCY_RESOLUTION][MAX_OCCUPANCY_RESOLUTION];
+  for ( size_t v1 = 0; v1 < occupancyMapSizeV; ++v1 ) {
+    const int64_t v0 = v1 * occupancyResolution;
+    for ( size_t u1 = 0; u1 < occupancyMapSizeU; ++u1 ) {
+      const int64_t u0                = u1 * occupancyResolution;
+      size_t        nonZeroPixelCount = 0;
+      for ( size_t v2 = 0; v2 < occupancyResolution; ++v2 ) {
+        for ( size_t u2 = 0; u2 < occupancyResolution; ++u2 ) {
+          const int64_t x0        = u0 + u2;
+          const int64_t y0        = v0 + v2;
+          const size_t  location0 = y0 * image.getWidth() + x0;
+          if ( enhancedOccupancyMap ) {
+            nonZeroPixelCount += static_cast<size_t>( occupancyMapTemp[location0] > 0 );
+          } else {
+            nonZeroPixelCount += static_cast<size_t>( occupancyMapTemp[location0] == 1 );
+          }
+        }
+      }
+      if ( nonZeroPixelCount == 0 ) {
+        if ( reference != nullptr ) {
+          for ( size_t v2 = 0; v2 < occupancyResolution; ++v2 ) {
+            for ( size_t u2 = 0; u2 < occupancyResolution; ++u2 ) {
+              const size_t x0 = u0 + u2;
+              const size_t y0 = v0 + v2;
+              image.setValue( 0, x0, y0, reference->getValue( 0, x0, y0 ) );
+              image.setValue( 1, x0, y0, reference->getValue( 1, x0, y0 ) );
+              image.setValue( 2, x0, y0, reference->getValue( 2, x0, y0 ) );
+            }
+          }
+        } else if ( u1 > 0 ) {
+          for ( size_t v2 = 0; v2 < occupancyResolution; ++v2 ) {
+            for ( size_t u2 = 0; u2 < occupancyResolution; ++u2 ) {
+              const size_t x0 = u0 + u2;
+              const size_t y0 = v0 + v2;
+              const size_t x1 = x0 - 1;
+              image.setValue( 0, x0, y0, image.getValue( 0, x1, y0 ) );
+              image.setValue( 1, x0, y0, image.getValue( 1, x1, y0 ) );
+              image.setValue( 2, x0, y0, image.getValue( 2, x1, y0 ) );
+            }
+          }
+        } else if ( v1 > 0 ) {
+          for ( size_t v2 = 0; v2 < occupancyResolution; ++v2 ) {
+            for ( size_t u2 = 0; u2 < occupancyResolution; ++u2 ) {
+              const size_t x0 = u0 + u2;
+              const size_t y0 = v0 + v2;
+              const size_t y1 = y0 - 1;
+              image.setValue( 0, x0, y0, image.getValue( 0, x0, y1 ) );
+              image.setValue( 1, x0, y0, image.getValue( 1, x0, y1 ) );
+              image.setValue( 2, x0, y0, image.getValue( 2, x0, y1 ) );
+            }
+          }
+        }
+        continue;
+      }
+      for ( size_t v2 = 0; v2 < occupancyResolution; ++v2 ) {
+        for ( size_t u2 = 0; u2 < occupancyResolution; ++u2 ) {
+          values[v2][u2] = 0;
+          count[v2][u2]  = 0UL;
+        }
+      }
+      uint32_t iteration = 1;
+      while ( nonZeroPixelCount < pixelBlockCount ) {
+        for ( size_t v2 = 0; v2 < occupancyResolution; ++v2 ) {
+          for ( size_t u2 = 0; u2 < occupancyResolution; ++u2 ) {
+            const int64_t x0        = u0 + u2;
+            const int64_t y0        = v0 + v2;
+            const size_t  location0 = y0 * image.getWidth() + x0;
+            if ( occupancyMapTemp[location0] == iteration ) {
+              for ( auto neighbor : neighbors ) {
+                const int64_t x1        = x0 + neighbor[0];
+                const int64_t y1        = y0 + neighbor[1];
+                const size_t  location1 = y1 * image.getWidth() + x1;
+                if ( x1 >= u0 && x1 < int64_t( u0 + occupancyResolution ) && y1 >= v0 &&
+                     y1 < int64_t( v0 + occupancyResolution ) && occupancyMapTemp[location1] == 0 ) {
+                  const int64_t u3 = u2 + neighbor[0];
+                  const int64_t v3 = v2 + neighbor[1];
+                  for ( size_t k = 0; k < 3; ++k ) { values[v3][u3][k] += image.getValue( k, x0, y0 ); }
+                  ++count[v3][u3];
+                }
+              }
+            }
+          }
+        }
+        for ( size_t v2 = 0; v2 < occupancyResolution; ++v2 ) {
+          for ( size_t u2 = 0; u2 < occupancyResolution; ++u2 ) {
+            if ( count[v2][u2] != 0U ) {
+              ++nonZeroPixelCount;
+              const size_t x0             = u0 + u2;
+              const size_t y0             = v0 + v2;
+              const size_t location0      = y0 * image.getWidth() + x0;
+              const size_t c              = count[v2][u2];
+              const size_t c2             = c / 2;
+              occupancyMapTemp[location0] = iteration + 1;
+              for ( size_t k = 0; k < 3; ++k ) { image.setValue( k, x0, y0, T( ( values[v2][u2][k] + c2 ) / c ) ); }
+              values[v2][u2] = 0;
+              count[v2][u2]  = 0UL;
+            }
+          }
+        }
+        ++iteration;
+      }
+    }
+  }
+}
+
+template <typename T>
+void createCoarseLayer( PCCImage<T, 3>&        image,
+                        PCCImage<T, 3>&        mip,
+                        std::vector<uint32_t>& occupancyMap,
+                        std::vector<uint32_t>& mipOccupancyMap ) {
+  int dyadicWidth = 1;
+  while ( dyadicWidth < image.getWidth() ) { dyadicWidth *= 2; }
+  int dyadicHeight = 1;
+  while ( dyadicHeight < image.getHeight() ) { dyadicHeight *= 2; }
+  // allocate the mipmap with half the resolution
+  mip.resize( ( dyadicWidth / 2 ), ( dyadicHeight / 2 ), PCCCOLORFORMAT::YUV444 );
+  mipOccupancyMap.resize( ( dyadicWidth / 2 ) * ( dyadicHeight / 2 ), 0 );
+  int stride    = image.getWidth();
+  int newStride = ( dyadicWidth / 2 );
+  for ( size_t y = 0; y < mip.getHeight(); y++ ) {
+    for ( size_t x = 0; x < mip.getWidth(); x++ ) {
+      double num[3] = {0.0, 0.0, 0.0};
+      double den    = 0;
+      for ( size_t i = 0; i < 2; i++ ) {
+        for ( size_t j = 0; j < 2; j++ ) {
+          int row    = ( 2 * y + i ) >= image.getHeight() ? image.getHeight() - 1 : ( 2 * y + i );
+          int column = ( 2 * x + j ) >= image.getWidth() ? image.getWidth() - 1 : ( 2 * x + j );
+          if ( occupancyMap[column + stride * row] == 1 ) {
+            den++;
+            for ( int cc = 0; cc < 3; cc++ ) { num[cc] += image.getValue( cc, column, row ); }
+          }
+        }
+      }
+      if ( den > 0 ) {
+        mipOccupancyMap[x + newStride * y] = 1;
+        for ( int cc = 0; cc < 3; cc++ ) { mip.setValue( cc, x, y, std::round( num[cc] / den ) ); }
+      }
+    }
+  }
+}
+
+template <typename T>
+void regionFill( PCCImage<T, 3>& image, std::vector<uint32_t>& occupancyMap, PCCImage<T, 3>& imageLowRes ) {
+  int                   stride        = image.getWidth();
+  int                   numElem       = 0;
+  int                   numSparseElem = 0;
+  std::vector<uint32_t> indexing;
+  indexing.resize( occupancyMap.size() );
+  for ( int i = 0; i < occupancyMap.size(); i++ ) {
+    if ( occupancyMap[i] == 0 ) {
+      indexing[i] = numElem;
+      numElem++;
+    }
+  }
+  // create a sparse matrix with the coefficients
+  std::vector<uint32_t> iSparse;
+  std::vector<uint32_t> jSparse;
+  std::vector<double>   valSparse;
+  iSparse.resize( numElem * 5 );
+  jSparse.resize( numElem * 5 );
+  valSparse.resize( numElem * 5 );
+  // create an initial solution using the low-resolution
+  std::vector<double> b[3];
+  b[0].resize( numElem );
+  b[1].resize( numElem );
+  b[2].resize( numElem );
+  // fill in the system
+  int idx       = 0;
+  int idxSparse = 0;
+  for ( int row = 0; row < image.getHeight(); row++ ) {
+    for ( int column = 0; column < image.getWidth(); column++ ) {
+      if ( occupancyMap[column + stride * row] == 0 ) {
+        int count = 0;
+        b[0][idx] = 0;
+        b[1][idx] = 0;
+        b[2][idx] = 0;
+        for ( int i = -1; i < 2; i++ ) {
+          for ( int j = -1; j < 2; j++ ) {
+            if ( ( i == j ) || ( i == -j ) ) { continue; }
+            if ( ( column + j < 0 ) || ( column + j > image.getWidth() - 1 ) ) { continue; }
+            if ( ( row + i < 0 ) || ( row + i > image.getHeight() - 1 ) ) { continue; }
+            count++;
+            if ( occupancyMap[column + j + stride * ( row + i )] == 1 ) {
+              b[0][idx] += image.getValue( 0, column + j, row + i );
+              b[1][idx] += image.getValue( 1, column + j, row + i );
+              b[2][idx] += image.getValue( 2, column + j, row + i );
+            } else {
+              iSparse[idxSparse]   = idx;
+              jSparse[idxSparse]   = indexing[column + j + stride * ( row + i )];
+              valSparse[idxSparse] = -1;
+              idxSparse++;
+            }
+          }
+        }
+        // now insert the weight of the center pixel
+        iSparse[idxSparse]   = idx;
+        jSparse[idxSparse]   = idx;
+        valSparse[idxSparse] = count;
+        idx++;
+        idxSparse++;
+      }
+    }
+  }
+  numSparseElem = idxSparse;
+  // now solve the linear system Ax=b using Gauss-Siedel relaxation, with initial guess coming from the lower resolution
+  std::vector<double> x[3];
+  x[0].resize( numElem );
+  x[1].resize( numElem );
+  x[2].resize( numElem );
+  if ( imageLowRes.getWidth() == image.getWidth() ) {
+    // low resolution image not provided, let's use for the initialization the mean value of the active pixels
+    double mean[3] = {0.0, 0.0, 0.0};
+    idx            = 0;
+    for ( int row = 0; row < image.getHeight(); row++ ) {
+      for ( int column = 0; column < image.getWidth(); column++ ) {
+        if ( occupancyMap[column + stride * row] == 1 ) {
+          mean[0] += double( image.getValue( 0, column, row ) );
+          mean[1] += double( image.getValue( 1, column, row ) );
+          mean[2] += double( image.getValue( 2, column, row ) );
+          idx++;
+        }
+      }
+    }
+    mean[0] /= idx;
+    mean[1] /= idx;
+    mean[2] /= idx;
+    idx = 0;
+    for ( int row = 0; row < image.getHeight(); row++ ) {
+      for ( int column = 0; column < image.getWidth(); column++ ) {
+        if ( occupancyMap[column + stride * row] == 0 ) {
+          x[0][idx] = mean[0];
+          x[1][idx] = mean[1];
+          x[2][idx] = mean[2];
+          idx++;
+        }
+      }
+    }
+  } else {
+    idx = 0;
+    for ( int row = 0; row < image.getHeight(); row++ ) {
+      for ( int column = 0; column < image.getWidth(); column++ ) {
+        if ( occupancyMap[column + stride * row] == 0 ) {
+          x[0][idx] = imageLowRes.getValue( 0, column / 2, row / 2 );
+          x[1][idx] = imageLowRes.getValue( 1, column / 2, row / 2 );
+          x[2][idx] = imageLowRes.getValue( 2, column / 2, row / 2 );
+          idx++;
+        }
+      }
+    }
+  }
+  int    maxIteration = 1024;
+  double maxError     = 0.00001;
+  for ( int cc = 0; cc < 3; cc++ ) {
+    int it = 0;
+    for ( ; it < maxIteration; it++ ) {
+      int    idxSparse = 0;
+      double error     = 0;
+      for ( int centerIdx = 0; centerIdx < numElem; centerIdx++ ) {
+        // add the b result
+        double val = b[cc][centerIdx];
+        while ( ( idxSparse < numSparseElem ) && ( iSparse[idxSparse] == centerIdx ) ) {
+          if ( valSparse[idxSparse] < 0 ) {
+            val += x[cc][jSparse[idxSparse]];
+            idxSparse++;
+          } else {
+            // final value
+            val /= valSparse[idxSparse];
+            // accumulate the error
+            error += ( val - x[cc][centerIdx] ) * ( val - x[cc][centerIdx] );
+            // update the value
+            x[cc][centerIdx] = val;
+            idxSparse++;
+          }
+        }
+      }
+      error = error / numElem;
+      if ( error < maxError ) { break; }
+    }
+  }
+  // put the value back in the image
+  idx = 0;
+  for ( int row = 0; row < image.getHeight(); row++ ) {
+    for ( int column = 0; column < image.getWidth(); column++ ) {
+      if ( occupancyMap[column + stride * row] == 0 ) {
+        image.setValue( 0, column, row, x[0][idx] );
+        image.setValue( 1, column, row, x[1][idx] );
+        image.setValue( 2, column, row, x[2][idx] );
+        idx++;
+      }
+    }
+  }
+}
+
+template <typename T>
+void dilateHarmonicBackgroundFill( PCCImage<T, 3>& image, const std::vector<uint32_t>& occupancyMap ) {
+  auto                               occupancyMapTemp = occupancyMap;
+  int                                i                = 0;
+  std::vector<PCCImage<T, 3>>        mipVec;
+  std::vector<std::vector<uint32_t>> mipOccupancyMapVec;
+  int                                miplev = 0;
+
+  // create coarse image by dyadic sampling
+  while ( true ) {
+    mipVec.resize( mipVec.size() + 1 );
+    mipOccupancyMapVec.resize( mipOccupancyMapVec.size() + 1 );
+    if ( miplev > 0 ) {
+      createCoarseLayer( mipVec[miplev - 1], mipVec[miplev], mipOccupancyMapVec[miplev - 1],
+                         mipOccupancyMapVec[miplev] );
+    } else {
+      createCoarseLayer( image, mipVec[miplev], occupancyMapTemp, mipOccupancyMapVec[miplev] );
+    }
+    if ( mipVec[miplev].getWidth() <= 4 || mipVec[miplev].getHeight() <= 4 ) { break; }
+    ++miplev;
+  }
+  miplev++;
+  // push phase: inpaint laplacian
+  regionFill( mipVec[miplev - 1], mipOccupancyMapVec[miplev - 1], mipVec[miplev - 1] );
+  for ( i = miplev - 1; i >= 0; --i ) {
+    if ( i > 0 ) {
+      regionFill( mipVec[i - 1], mipOccupancyMapVec[i - 1], mipVec[i] );
+    } else {
+      regionFill( image, occupancyMapTemp, mipVec[i] );
+    }
+  }
+}
+
+/* pull push filling algorithm */
+template <typename T>
+int mean4w( T p1, unsigned char w1, T p2, unsigned char w2, T p3, unsigned char w3, T p4, unsigned char w4 ) {
+  int result = ( p1 * int( w1 ) + p2 * int( w2 ) + p3 * int( w3 ) + p4 * int( w4 ) ) /
+               ( int( w1 ) + int( w2 ) + int( w3 ) + int( w4 ) );
+  return result;
+}
+
+// Generates a weighted mipmap
+template <typename T>
+void pushPullMip( const PCCImage<T, 3>&        image,
+                  PCCImage<T, 3>&              mip,
+                  const std::vector<uint32_t>& occupancyMap,
+                  std::vector<uint32_t>&       mipOccupancyMap ) {
+  unsigned char w1;
+  unsigned char w2;
+  unsigned char w3;
+  unsigned char w4;
+  unsigned char val1;
+  unsigned char val2;
+  unsigned char val3;
+  unsigned char val4;
+  const size_t  width     = image.getWidth();
+  const size_t  height    = image.getHeight();
+  const size_t  newWidth  = ( ( width + 1 ) >> 1 );
+  const size_t  newHeight = ( ( height + 1 ) >> 1 );
+  // allocate the mipmap with half the resolution
+  mip.resize( newWidth, newHeight, PCCCOLORFORMAT::YUV444 );
+  mipOccupancyMap.resize( newWidth * newHeight, 0 );
+  for ( size_t y = 0; y < newHeight; ++y ) {
+    const size_t yUp = y << 1;
+    for ( size_t x = 0; x < newWidth; ++x ) {
+      const size_t xUp = x << 1;
+      if ( occupancyMap[xUp + width * yUp] == 0 ) {
+        w1 = 0;
+      } else {
+        w1 = 255;
+      }
+      if ( ( xUp + 1 >= width ) || ( occupancyMap[xUp + 1 + width * yUp] == 0 ) ) {
+        w2 = 0;
+      } else {
+        w2 = 255;
+      }
+      if ( ( yUp + 1 >= height ) || ( occupancyMap[xUp + width * ( yUp + 1 )] == 0 ) ) {
+        w3 = 0;
+      } else {
+        w3 = 255;
+      }
+      if ( ( xUp + 1 >= width ) || ( yUp + 1 >= height ) || ( occupancyMap[xUp + 1 + width * ( yUp + 1 )] == 0 ) ) {
+        w4 = 0;
+      } else {
+        w4 = 255;
+      }
+      if ( w1 + w2 + w3 + w4 > 0 ) {
+        for ( int cc = 0; cc < 3; cc++ ) {
+          val1 = image.getValue( cc, xUp, yUp );
+          if ( xUp + 1 >= width ) {
+            val2 = 0;
+          } else {
+            val2 = image.getValue( cc, xUp + 1, yUp );
+          }
+          if ( yUp + 1 >= height ) {
+            val3 = 0;
+          } else {
+            val3 = image.getValue( cc, xUp, yUp + 1 );
+          }
+          if ( ( xUp + 1 >= width ) || ( yUp + 1 >= height ) ) {
+            val4 = 0;
+          } else {
+            val4 = image.getValue( cc, xUp + 1, yUp + 1 );
+          }
+          T newVal = mean4w( val1, w1, val2, w2, val3, w3, val4, w4 );
+          mip.setValue( cc, x, y, newVal );
+        }
+        mipOccupancyMap[x + newWidth * y] = 1;
+      }
+    }
+  }
+}
+
+// interpolate using mipmap
+template <typename T>
+void pushPullFill( PCCImage<T, 3>&              image,
+                   const PCCImage<T, 3>&        mip,
+                   const std::vector<uint32_t>& occupancyMap,
+                   int                          numIters ) {
+  const size_t width    = mip.getWidth();
+  const size_t height   = mip.getHeight();
+  const size_t widthUp  = image.getWidth();
+  const size_t heightUp = image.getHeight();
+  unsigned char w1;
+  unsigned char w2;
+  unsigned char w3;
+  unsigned char w4;
+  for ( int yUp = 0; yUp < heightUp; ++yUp ) {
+    int y = yUp >> 1;
+    for ( int xUp = 0; xUp < widthUp; ++xUp ) {
+      int x = xUp >> 1;
+      if ( occupancyMap[xUp + widthUp * yUp] == 0 ) {
+        if ( ( xUp % 2 == 0 ) && ( yUp % 2 == 0 ) ) {
+          w1 = 144;
+          w2 = ( x > 0 ? static_cast<unsigned char>( 48 ) : 0 );
+          w3 = ( y > 0 ? static_cast<unsigned char>( 48 ) : 0 );
+          w4 = ( ( ( x > 0 ) && ( y > 0 ) ) ? static_cast<unsigned char>( 16 ) : 0 );
+          for ( int cc = 0; cc < 3; cc++ ) {
+            T val       = mip.getValue( cc, x, y );
+            T valLeft   = ( x > 0 ? mip.getValue( cc, x - 1, y ) : 0 );
+            T valUp     = ( y > 0 ? mip.getValue( cc, x, y - 1 ) : 0 );
+            T valUpLeft = ( ( x > 0 && y > 0 ) ? mip.getValue( cc, x - 1, y - 1 ) : 0 );
+            T newVal    = mean4w( val, w1, valLeft, w2, valUp, w3, valUpLeft, w4 );
+            image.setValue( cc, xUp, yUp, newVal );
+          }
+        } else if ( ( xUp % 2 == 1 ) && ( yUp % 2 == 0 ) ) {
+          w1 = 144;
+          w2 = ( x < width - 1 ? static_cast<unsigned char>( 48 ) : 0 );
+          w3 = ( y > 0 ? static_cast<unsigned char>( 48 ) : 0 );
+          w4 = ( ( ( x < width - 1 ) && ( y > 0 ) ) ? static_cast<unsigned char>( 16 ) : 0 );
+          for ( int cc = 0; cc < 3; cc++ ) {
+            T val        = mip.getValue( cc, x, y );
+            T valRight   = ( x < width - 1 ? mip.getValue( cc, x + 1, y ) : 0 );
+            T valUp      = ( y > 0 ? mip.getValue( cc, x, y - 1 ) : 0 );
+            T valUpRight = ( ( ( x < width - 1 ) && ( y > 0 ) ) ? mip.getValue( cc, x + 1, y - 1 ) : 0 );
+            T newVal     = mean4w( val, w1, valRight, w2, valUp, w3, valUpRight, w4 );
+            image.setValue( cc, xUp, yUp, newVal );
+          }
+        } else if ( ( xUp % 2 == 0 ) && ( yUp % 2 == 1 ) ) {
+          w1 = 144;
+          w2 = ( x > 0 ? static_cast<unsigned char>( 48 ) : 0 );
+          w3 = ( y < height - 1 ? static_cast<unsigned char>( 48 ) : 0 );
+          w4 = ( ( ( x > 0 ) && ( y < height - 1 ) ) ? static_cast<unsigned char>( 16 ) : 0 );
+          for ( int cc = 0; cc < 3; cc++ ) {
+            T val         = mip.getValue( cc, x, y );
+            T valLeft     = ( x > 0 ? mip.getValue( cc, x - 1, y ) : 0 );
+            T valDown     = ( ( y < height - 1 ) ? mip.getValue( cc, x, y + 1 ) : 0 );
+            T valDownLeft = ( ( x > 0 && ( y < height - 1 ) ) ? mip.getValue( cc, x - 1, y + 1 ) : 0 );
+            T newVal      = mean4w( val, w1, valLeft, w2, valDown, w3, valDownLeft, w4 );
+            image.setValue( cc, xUp, yUp, newVal );
+          }
+        } else {
+          w1 = 144;
+          w2 = ( x < width - 1 ? static_cast<unsigned char>( 48 ) : 0 );
+          w3 = ( y < height - 1 ? static_cast<unsigned char>( 48 ) : 0 );
+          w4 = ( ( ( x < width - 1 ) && ( y < height - 1 ) ) ? static_cast<unsigned char>( 16 ) : 0 );
+          for ( int cc = 0; cc < 3; cc++ ) {
+            T val          = mip.getValue( cc, x, y );
+            T valRight     = ( x < width - 1 ? mip.getValue( cc, x + 1, y ) : 0 );
+            T valDown      = ( ( y < height - 1 ) ? mip.getValue( cc, x, y + 1 ) : 0 );
+            T valDownRight = ( ( ( x < width - 1 ) && ( y < height - 1 ) ) ? mip.getValue( cc, x + 1, y + 1 ) : 0 );
+            T newVal       = mean4w( val, w1, valRight, w2, valDown, w3, valDownRight, w4 );
+            image.setValue( cc, xUp, yUp, newVal );
+          }
+        }
+      }
+    }
+  }
+  auto tmpImage( image );
+  for ( size_t n = 0; n < numIters; n++ ) {
+    for ( int y = 0; y < heightUp; y++ ) {
+      for ( int x = 0; x < widthUp; x++ ) {
+        if ( occupancyMap[x + widthUp * y] == 0 ) {
+          int x1 = ( x > 0 ) ? x - 1 : x;
+          int y1 = ( y > 0 ) ? y - 1 : y;
+          int x2 = ( x < widthUp - 1 ) ? x + 1 : x;
+          int y2 = ( y < heightUp - 1 ) ? y + 1 : y;
+          for ( size_t c = 0; c < 3; c++ ) {
+            int val = image.getValue( c, x1, y1 ) + image.getValue( c, x2, y1 ) + image.getValue( c, x1, y2 ) +
+                      image.getValue( c, x2, y2 ) + image.getValue( c, x1, y ) + image.getValue( c, x2, y ) +
+                      image.getValue( c, x, y1 ) + image.getValue( c, x, y2 );
+            tmpImage.setValue( c, x, y, ( val + 4 ) >> 3 );
+          }
+        }
+      }
+    }
+    std::swap( image, tmpImage );
+  }
+}
+
+template <typename T>
+void dilateSmoothedPushPull( PCCImage<T, 3>& image, const std::vector<uint32_t>& occupancyMap ) {
+  auto                               occupancyMapTemp = occupancyMap;
+  int                                i                = 0;
+  std::vector<PCCImage<T, 3>>        mipVec;
+  std::vector<std::vector<uint32_t>> mipOccupancyMapVec;
+  int                                miplev = 0;
+
+  // pull phase create the mipmap
+  while ( true ) {
+    mipVec.resize( mipVec.size() + 1 );
+    mipOccupancyMapVec.resize( mipOccupancyMapVec.size() + 1 );
+    if ( miplev > 0 ) {
+      pushPullMip( mipVec[miplev - 1], mipVec[miplev], mipOccupancyMapVec[miplev - 1], mipOccupancyMapVec[miplev] );
+    } else {
+      pushPullMip( image, mipVec[miplev], occupancyMapTemp, mipOccupancyMapVec[miplev] );
+    }
+    if ( mipVec[miplev].getWidth() <= 4 || mipVec[miplev].getHeight() <= 4 ) { break; }
+    ++miplev;
+  }
+  miplev++;
+  // push phase: refill
+  int numIters = 4;
+  for ( i = miplev - 1; i >= 0; --i ) {
+    if ( i > 0 ) {
+      pushPullFill( mipVec[i - 1], mipVec[i], mipOccupancyMapVec[i - 1], numIters );
+    } else {
+      pushPullFill( image, mipVec[i], occupancyMapTemp, numIters );
+    }
+    numIters = ( std::min )( numIters + 1, 16 );
+  }
+}
+
+}  // namespace reference
+}  // namespace pcc
+
+#endif /* PCCReferencePadding_h */
@@ -0,0 +1,396 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PCCReferencePly_h
+#define PCCReferencePly_h
+
+#include "PCCCommon.h"
+#include "PCCPointSet.h"
+#include <fstream>
+#include <iomanip>
+#include <limits>
+
+namespace pcc {
+namespace reference {
+
+// The PLY writer and reader of PCCPointSet3 as they were before the buffered output and the memory mapped input:
+// stream operations per vertex and per token. They are kept as the references of PccAppBenchmark and only use the
+// public interface of PCCPointSet3.
+inline bool writePly( PCCPointSet3& pointSet, const std::string& fileName, const bool asAscii ) {
+  std::ofstream fout( fileName, std::ofstream::out );
+  if ( !fout.is_open() ) { return false; }
+  const size_t pointCount = pointSet.getPointCount();
+  fout << "ply" << std::endl;
+  if ( asAscii ) {
+    fout << "format ascii 1.0" << std::endl;
+  } else {
+    PCCEndianness endianess = PCCSystemEndianness();
+    if ( endianess == PCC_BIG_ENDIAN ) {
+      fout << "format binary_big_endian 1.0" << std::endl;
+    } else {
+      fout << "format binary_little_endian 1.0" << std::endl;
+    }
+  }
+  fout << "element vertex " << pointCount << std::endl;
+  fout << "property float x" << std::endl;
+  fout << "property float y" << std::endl;
+  fout << "property float z" << std::endl;
+  if ( pointSet.hasNormals() ) {
+    fout << "property float nx" << std::endl;
+    fout << "property float ny" << std::endl;
+    fout << "property float nz" << std::endl;
+  }
+  if ( pointSet.hasColors() ) {
+    fout << "property uchar red" << std::endl;
+    fout << "property uchar green" << std::endl;
+    fout << "property uchar blue" << std::endl;
+  }
+  if ( pointSet.hasReflectances() ) { fout << "property uint16 refc" << std::endl; }
+  if ( PCC_SAVE_POINT_TYPE != 0u ) {
+    fout << "property uchar type" << std::endl;
+    switch ( PCC_SAVE_POINT_TYPE ) {
+      case 1: fout << "comment POINT_TYPE: Unset D0 D1 Filling Smooth InBetween" << std::endl; break;
+      case 2: fout << "comment POINT_TYPE: type0 type1 type2  " << std::endl; break;
+      default: break;
+    }
+  }
+  fout << "element face 0" << std::endl;
+  fout << "property list uint8 int32 vertex_index" << std::endl;
+  fout << "end_header" << std::endl;
+  if ( asAscii ) {
+    fout << std::setprecision( std::numeric_limits<double>::max_digits10 );
+    for ( size_t i = 0; i < pointCount; ++i ) {
+      const PCCPoint3D& position = pointSet[i];
+      fout << position.x() << " " << position.y() << " " << position.z();
+      if ( pointSet.hasNormals() ) {
+        const PCCNormal3F& normal = pointSet.getNormals()[i];
+        fout << " " << static_cast<float>( normal[0] ) << " " << static_cast<float>( normal[1] ) << " "
+             << static_cast<float>( normal[2] );
+      }
+      if ( pointSet.hasColors() ) {
+        const PCCColor3B& color = pointSet.getColor( i );
+        fout << " " << static_cast<int>( color[0] ) << " " << static_cast<int>( color[1] ) << " "
+             << static_cast<int>( color[2] );
+      }
+      if ( pointSet.hasReflectances() ) { fout << " " << static_cast<int>( pointSet.getReflectance( i ) ); }
+      if ( PCC_SAVE_POINT_TYPE != 0u ) { fout << " " << static_cast<int>( pointSet.getType( i ) ); }
+      fout << std::endl;
+    }
+  } else {
+    fout.clear();
+    fout.close();
+    fout.open( fileName, std::ofstream::binary | std::ofstream::out | std::ofstream::app );
+    for ( size_t i = 0; i < pointCount; ++i ) {
+      const PCCPoint3D& position = pointSet[i];
+      float             value[3];
+      value[0] = position[0];
+      value[1] = position[1];
+      value[2] = position[2];
+      fout.write( reinterpret_cast<const char*>( &value ), sizeof( float ) * 3 );
+      if ( pointSet.hasNormals() ) {
+        const PCCNormal3F& normal = pointSet.getNormals()[i];
+        value[0]                  = normal[0];
+        value[1]                  = normal[1];
+        value[2]                  = normal[2];
+        fout.write( reinterpret_cast<const char*>( &value ), sizeof( float ) * 3 );
+      }
+      if ( pointSet.hasColors() ) {
+        const PCCColor3B& color = pointSet.getColor( i );
+        fout.write( reinterpret_cast<const char*>( &color ), sizeof( uint8_t ) * 3 );
+      }
+      if ( pointSet.hasReflectances() ) {
+        const uint16_t& reflectance = pointSet.getReflectance( i );
+        fout.write( reinterpret_cast<const char*>( &reflectance ), sizeof( uint16_t ) );
+      }
+      if ( PCC_SAVE_POINT_TYPE != 0u ) {
+        const uint8_t& type = pointSet.getType( i );
+        fout.write( reinterpret_cast<const char*>( &type ), sizeof( uint8_t ) );
+      }
+    }
+  }
+  fout.close();
+  return true;
+}
+
+inline bool readPly( PCCPointSet3& pointSet, const std::string& fileName, const bool readNormals ) {
+  std::ifstream ifs( fileName, std::ifstream::in );
+  if ( !ifs.is_open() ) { return false; }
+  enum AttributeType {
+    ATTRIBUTE_TYPE_FLOAT64 = 0,
+    ATTRIBUTE_TYPE_FLOAT32 = 1,
+    ATTRIBUTE_TYPE_UINT64  = 2,
+    ATTRIBUTE_TYPE_UINT32  = 3,
+    ATTRIBUTE_TYPE_UINT16  = 4,
+    ATTRIBUTE_TYPE_UINT8   = 5,
+    ATTRIBUTE_TYPE_INT64   = 6,
+    ATTRIBUTE_TYPE_INT32   = 7,
+    ATTRIBUTE_TYPE_INT16   = 8,
+    ATTRIBUTE_TYPE_INT8    = 9,
+  };
+  struct AttributeInfo {
+    std::string   name;
+    AttributeType type;
+    size_t        byteCount;
+  };
+
+  std::vector<AttributeInfo> attributesInfo;
+  attributesInfo.reserve( 16 );
+  const size_t             MAX_BUFFER_SIZE = 4096;
+  char                     tmp[MAX_BUFFER_SIZE];
+  const char*              sep = " \t\r";
+  std::vector<std::string> tokens;
+
+  ifs.getline( tmp, MAX_BUFFER_SIZE );
+  PCCPointSet3::getTokens( tmp, sep, tokens );
+  if ( tokens.empty() || tokens[0] != "ply" ) {
+    std::cout << "Error: corrupted file!" << std::endl;
+    return false;
+  }
+  bool   isAscii          = false;
+  double version          = 1.0;
+  size_t pointCount       = 0;
+  bool   isVertexProperty = true;
+  while ( true ) {
+    if ( ifs.eof() ) {
+      std::cout << "Error: corrupted header!" << std::endl;
+      return false;
+    }
+    ifs.getline( tmp, MAX_BUFFER_SIZE );
+    PCCPointSet3::getTokens( tmp, sep, tokens );
+    if ( tokens.empty() || tokens[0] == "comment" ) { continue; }
+    if ( tokens[0] == "format" ) {
+      if ( tokens.size() != 3 ) {
+        std::cout << "Error: corrupted format info!" << std::endl;
+        return false;
+      }
+      isAscii = tokens[1] == "ascii";
+      version = atof( tokens[2].c_str() );
+    } else if ( tokens[0] == "element" ) {
+      if ( tokens.size() != 3 ) {
+        std::cout << "Error: corrupted element info!" << std::endl;
+        return false;
+      }
+      if ( tokens[1] == "vertex" ) {
+        pointCount = atoi( tokens[2].c_str() );
+      } else {
+        isVertexProperty = false;
+      }
+    } else if ( tokens[0] == "property" && isVertexProperty ) {
+      if ( tokens.size() != 3 ) {
+        std::cout << "Error: corrupted property info!" << std::endl;
+        return false;
+      }
+      const std::string& propertyType   = tokens[1];
+      const std::string& propertyName   = tokens[2];
+      const size_t       attributeIndex = attributesInfo.size();
+      attributesInfo.resize( attributeIndex + 1 );
+      AttributeInfo& attributeInfo = attributesInfo[attributeIndex];
+      attributeInfo.name           = propertyName;
+      if ( propertyType == "float64" ) {
+        attributeInfo.type      = ATTRIBUTE_TYPE_FLOAT64;
+        attributeInfo.byteCount = 8;
+      } else if ( propertyType == "float" || propertyType == "float32" ) {
+        attributeInfo.type      = ATTRIBUTE_TYPE_FLOAT32;
+        attributeInfo.byteCount = 4;
+      } else if ( propertyType == "uint64" ) {
+        attributeInfo.type      = ATTRIBUTE_TYPE_UINT64;
+        attributeInfo.byteCount = 8;
+      } else if ( propertyType == "uint32" ) {
+        attributeInfo.type      = ATTRIBUTE_TYPE_UINT32;
+        attributeInfo.byteCount = 4;
+      } else if ( propertyType == "uint16" ) {
+        attributeInfo.type      = ATTRIBUTE_TYPE_UINT16;
+        attributeInfo.byteCount = 2;
+      } else if ( propertyType == "uchar" || propertyType == "uint8" ) {
+        attributeInfo.type      = ATTRIBUTE_TYPE_UINT8;
+        attributeInfo.byteCount = 1;
+      } else if ( propertyType == "int64" ) {
+        attributeInfo.type      = ATTRIBUTE_TYPE_INT64;
+        attributeInfo.byteCount = 8;
+      } else if ( propertyType == "int32" || propertyType == "int" ) {
+        attributeInfo.type      = ATTRIBUTE_TYPE_INT32;
+        attributeInfo.byteCount = 4;
+      } else if ( propertyType == "int16" ) {
+        attributeInfo.type      = ATTRIBUTE_TYPE_INT16;
+        attributeInfo.byteCount = 2;
+      } else if ( propertyType == "char" || propertyType == "int8" ) {
+        attributeInfo.type      = ATTRIBUTE_TYPE_INT8;
+        attributeInfo.byteCount = 1;
+      }
+    } else if ( tokens[0] == "end_header" ) {
+      break;
+    }
+  }
+  if ( version != 1.0 ) {
+    std::cout << "Error: non-supported version!" << std::endl;
+    return false;
+  }
+
+  size_t       indexX           = g_undefined_index;
+  size_t       indexY           = g_undefined_index;
+  size_t       indexZ           = g_undefined_index;
+  size_t       indexR           = g_undefined_index;
+  size_t       indexG           = g_undefined_index;
+  size_t       indexB           = g_undefined_index;
+  size_t       indexReflectance = g_undefined_index;
+  size_t       indexNX          = g_undefined_index;
+  size_t       indexNY          = g_undefined_index;
+  size_t       indexNZ          = g_undefined_index;
+  const size_t attributeCount   = attributesInfo.size();
+  for ( size_t a = 0; a < attributeCount; ++a ) {
+    const auto& attributeInfo = attributesInfo[a];
+    if ( attributeInfo.name == "x" &&
+         ( attributeInfo.byteCount == 8 || attributeInfo.byteCount == 4 || attributeInfo.byteCount == 2 ) ) {
+      indexX = a;
+    } else if ( attributeInfo.name == "y" &&
+                ( attributeInfo.byteCount == 8 || attributeInfo.byteCount == 4 || attributeInfo.byteCount == 2 ) ) {
+      indexY = a;
+    } else if ( attributeInfo.name == "z" &&
+                ( attributeInfo.byteCount == 8 || attributeInfo.byteCount == 4 || attributeInfo.byteCount == 2 ) ) {
+      indexZ = a;
+    } else if ( attributeInfo.name == "red" && attributeInfo.byteCount == 1 ) {
+      indexR = a;
+    } else if ( attributeInfo.name == "green" && attributeInfo.byteCount == 1 ) {
+      indexG = a;
+    } else if ( attributeInfo.name == "blue" && attributeInfo.byteCount == 1 ) {
+      indexB = a;
+    } else if ( attributeInfo.name == "nx" && attributeInfo.byteCount == 4 && readNormals ) {
+      indexNX = a;
+    } else if ( attributeInfo.name == "ny" && attributeInfo.byteCount == 4 && readNormals ) {
+      indexNY = a;
+    } else if ( attributeInfo.name == "nz" && attributeInfo.byteCount == 4 && readNormals ) {
+      indexNZ = a;
+    } else if ( ( attributeInfo.name == "reflectance" || attributeInfo.name == "refc" ) &&
+                attributeInfo.byteCount <= 2 ) {
+      indexReflectance = a;
+    }
+  }
+  if ( indexX == g_undefined_index || indexY == g_undefined_index || indexZ == g_undefined_index ) {
+    std::cout << "Error: missing coordinates!" << std::endl;
+    return false;
+  }
+  pointSet.clear();
+  pointSet.removeColors();
+  pointSet.removeReflectances();
+  pointSet.removeNormals();
+  pointSet.resize( pointCount );
+  if ( indexR != g_undefined_index && indexG != g_undefined_index && indexB != g_undefined_index ) {
+    pointSet.addColors();
+  }
+  if ( indexReflectance != g_undefined_index ) { pointSet.addReflectances(); }
+  if ( indexNX != g_undefined_index && indexNY != g_undefined_index && indexNZ != g_undefined_index ) {
+    pointSet.addNormals();
+  }
+  if ( isAscii ) {
+    size_t pointCounter = 0;
+    while ( !ifs.eof() && pointCounter < pointCount ) {
+      ifs.getline( tmp, MAX_BUFFER_SIZE );
+      PCCPointSet3::getTokens( tmp, sep, tokens );
+      if ( tokens.empty() ) { continue; }
+      if ( tokens.size() < attributeCount ) { return false; }
+      auto& position = pointSet.getPositions()[pointCounter];
+      position[0]    = atof( tokens[indexX].c_str() );
+      position[1]    = atof( tokens[indexY].c_str() );
+      position[2]    = atof( tokens[indexZ].c_str() );
+      if ( pointSet.hasColors() ) {
+        auto& color = pointSet.getColor( pointCounter );
+        color[0]    = atoi( tokens[indexR].c_str() );
+        color[1]    = atoi( tokens[indexG].c_str() );
+        color[2]    = atoi( tokens[indexB].c_str() );
+      }
+      if ( pointSet.hasReflectances() ) {
+        pointSet.setReflectance( pointCounter, uint16_t( atoi( tokens[indexReflectance].c_str() ) ) );
+      }
+      ++pointCounter;
+    }
+  } else {
+    ifs.close();
+    ifs.open( fileName, std::ifstream::binary | std::ifstream::in );
+    ifs.read( tmp, MAX_BUFFER_SIZE );
+    char* str       = strstr( tmp, "end_header" );
+    str             = strstr( str, "\n" );
+    int headerCount = str - tmp + 1;
+    ifs.close();
+    ifs.open( fileName, std::ifstream::binary | std::ifstream::in );
+    ifs.read( tmp, headerCount );
+    for ( size_t pointCounter = 0; pointCounter < pointCount && !ifs.eof(); ++pointCounter ) {
+      auto&       position = pointSet.getPositions()[pointCounter];
+      PCCNormal3D normal( 0.0 );
+      for ( size_t a = 0; a < attributeCount && !ifs.eof(); ++a ) {
+        const auto& attributeInfo = attributesInfo[a];
+        if ( a == indexX || a == indexY || a == indexZ ) {
+          const size_t c = a == indexX ? 0 : a == indexY ? 1 : 2;
+          if ( attributeInfo.byteCount == 2 ) {
+            uint16_t value;
+            ifs.read( reinterpret_cast<char*>( &value ), sizeof( uint16_t ) );
+            position[c] = value;
+          } else if ( attributeInfo.byteCount == 4 ) {
+            float value;
+            ifs.read( reinterpret_cast<char*>( &value ), sizeof( float ) );
+            position[c] = value;
+          } else {
+            double value;
+            ifs.read( reinterpret_cast<char*>( &value ), sizeof( double ) );
+            position[c] = value;
+          }
+        } else if ( ( a == indexR || a == indexG || a == indexB ) && attributeInfo.byteCount == 1 ) {
+          auto& color = pointSet.getColor( pointCounter );
+          ifs.read( reinterpret_cast<char*>( &color[a == indexR ? 0 : a == indexG ? 1 : 2] ), sizeof( uint8_t ) );
+        } else if ( a == indexNX || a == indexNY || a == indexNZ ) {
+          const size_t c = a == indexNX ? 0 : a == indexNY ? 1 : 2;
+          float        value;
+          ifs.read( reinterpret_cast<char*>( &value ), sizeof( float ) );
+          normal[c] = value;
+        } else if ( a == indexReflectance && attributeInfo.byteCount <= 2 ) {
+          if ( indexReflectance == 1 ) {
+            uint8_t reflectance;
+            ifs.read( reinterpret_cast<char*>( &reflectance ), sizeof( uint8_t ) );
+            pointSet.setReflectance( pointCounter, reflectance );
+          } else {
+            auto& reflectance = pointSet.getReflectance( pointCounter );
+            ifs.read( reinterpret_cast<char*>( &reflectance ), sizeof( uint16_t ) );
+          }
+        } else {
+          char buffer[128];
+          ifs.read( buffer, attributeInfo.byteCount );
+        }
+      }
+      if ( pointSet.hasNormals() ) { pointSet.setNormal( pointCounter, normal ); }
+    }
+  }
+  return true;
+}
+
+}  // namespace reference
+}  // namespace pcc
+
+#endif /* PCCReferencePly_h */
@@ -0,0 +1,515 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef _CRT_SECURE_NO_WARNINGS
+#define _CRT_SECURE_NO_WARNINGS
+#endif
+#include "PCCCommon.h"
+#include "PCCChrono.h"
+#include "PCCBitstream.h"
+#include "PCCImage.h"
+#include "PCCImagePadding.h"
+#include "PCCReferencePadding.h"
+#include "PCCReferenceBitstream.h"
+#include "PCCReferencePly.h"
+#include <program_options_lite.h>
+#include <fstream>
+#include <iterator>
+#include <random>
+#if defined( ENABLE_TBB )
+#include <tbb/tbb.h>
+#endif
+
+using namespace std;
+using namespace pcc;
+
+// Benchmarks of the optimized kernels against the reference implementations they replaced: each benchmark checks
+// that both produce the same results and reports their processing times.
+struct PCCBenchmarkParameters {
+  bool        padding_              = false;
+  size_t      width_                = 1280;
+  size_t      height_               = 1280;
+  size_t      occupancyResolution_  = 16;
+  size_t      imageCount_           = 4;
+  size_t      harmonicSize_         = 320;
+  bool        bitstream_            = false;
+  size_t      symbolCount_          = 2000000;
+  bool        ply_                  = false;
+  std::string uncompressedDataPath_ = {};
+  size_t      startFrameNumber_     = 0;
+  size_t      frameCount_           = 1;
+  std::string plyOutputPath_        = "PccAppBenchmark.ply";
+  size_t      nbThread_             = 0;
+};
+
+//---------------------------------------------------------------------------
+// :: Command line / config parsing
+
+bool parseParameters( int argc, char* argv[], PCCBenchmarkParameters& params ) {
+  namespace po    = df::program_options_lite;
+  bool print_help = false;
+
+  // clang-format off
+  po::Options opts;
+  opts.addOptions()
+    ( "help", print_help, false, "This help text" )
+    ( "padding",
+      params.padding_,
+      params.padding_,
+      "Compare the image padding (dilate, push-pull, harmonic fill) with the reference functions" )
+    ( "width",
+      params.width_,
+      params.width_,
+      "Width of the padded canvases" )
+    ( "height",
+      params.height_,
+      params.height_,
+      "Height of the padded canvases" )
+    ( "occupancyResolution",
+      params.occupancyResolution_,
+      params.occupancyResolution_,
+      "Occupancy map resolution of the padded canvases" )
+    ( "imageCount",
+      params.imageCount_,
+      params.imageCount_,
+      "Number of padded canvases of each sample type" )
+    ( "harmonicSize",
+      params.harmonicSize_,
+      params.harmonicSize_,
+      "Width and height of the canvases of the harmonic fill, whose reference solver is slow on full canvases" )
+    ( "bitstream",
+      params.bitstream_,
+      params.bitstream_,
+      "Compare the PCCBitstream bit reader and writer with the reference bit by bit ones" )
+    ( "symbolCount",
+      params.symbolCount_,
+      params.symbolCount_,
+      "Number of symbols written and read by the bitstream benchmark" )
+    ( "ply",
+      params.ply_,
+      params.ply_,
+      "Compare the PLY reader and writer of PCCPointSet3 with the reference stream based ones" )
+    ( "uncompressedDataPath",
+      params.uncompressedDataPath_,
+      params.uncompressedDataPath_,
+      "Point clouds read and written by the PLY benchmark. Multi-frame sequences may be represented by %04i" )
+    ( "startFrameNumber",
+      params.startFrameNumber_,
+      params.startFrameNumber_,
+      "First frame number of the PLY benchmark" )
+    ( "frameCount",
+      params.frameCount_,
+      params.frameCount_,
+      "Number of frames of the PLY benchmark" )
+    ( "plyOutputPath",
+      params.plyOutputPath_,
+      params.plyOutputPath_,
+      "Temporary files written by the PLY benchmark, removed at the end" )
+    ( "nbThread",
+      params.nbThread_,
+      params.nbThread_,
+      "Number of thread used for parallel processing" )
+    ;
+  // clang-format on
+  po::setDefaults( opts );
+  po::ErrorReporter        err;
+  const list<const char*>& argv_unhandled = po::scanArgv( opts, argc, (const char**)argv, err );
+  for ( const auto arg : argv_unhandled ) { printf( "Unhandled argument ignored: %s \n", arg ); }
+  if ( argc == 1 || print_help ) {
+    po::doHelp( std::cout, opts, 78 );
+    return false;
+  }
+  return !err.is_errored;
+}
+
+//---------------------------------------------------------------------------
+// :: Image padding
+
+// Patch-like occupancy: elliptic patches made of occupancy blocks, with scattered empty pixels, covering about the
+// given ratio of the blocks. With enhancedOccupancyMap, some occupied pixels get codes greater than 1.
+static std::vector<uint32_t> createOccupancyMap( std::mt19937& generator,
+                                                 const size_t  width,
+                                                 const size_t  height,
+                                                 const size_t  occupancyResolution,
+                                                 const double  coverage,
+                                                 const bool    enhancedOccupancyMap ) {
+  std::vector<uint32_t> occupancyMap( width * height, 0 );
+  const size_t          blockCountU = width / occupancyResolution;
+  const size_t          blockCountV = height / occupancyResolution;
+  const size_t          blockCount  = size_t( coverage * blockCountU * blockCountV );
+  for ( size_t count = 0; count < blockCount; ) {
+    const size_t sizeU   = 1 + generator() % 12;
+    const size_t sizeV   = 1 + generator() % 12;
+    const size_t u0      = generator() % blockCountU;
+    const size_t v0      = generator() % blockCountV;
+    const double centerX = ( u0 + sizeU / 2 ) * occupancyResolution;
+    const double centerY = ( v0 + sizeV / 2 ) * occupancyResolution;
+    const double radiusX = sizeU * occupancyResolution / 2.0;
+    const double radiusY = sizeV * occupancyResolution / 2.0;
+    for ( size_t y = v0 * occupancyResolution; y < ( std::min )( height, ( v0 + sizeV ) * occupancyResolution ); y++ ) {
+      for ( size_t x = u0 * occupancyResolution; x < ( std::min )( width, ( u0 + sizeU ) * occupancyResolution );
+            x++ ) {
+        const double dx = ( x - centerX ) / radiusX;
+        const double dy = ( y - centerY ) / radiusY;
+        if ( dx * dx + dy * dy < 1.0 && generator() % 16 != 0 ) {
+          occupancyMap[y * width + x] = enhancedOccupancyMap && generator() % 50 == 0 ? 2 : 1;
+        }
+      }
+    }
+    count += sizeU * sizeV;
+  }
+  return occupancyMap;
+}
+
+template <typename T>
+static void createImage( std::mt19937&   generator,
+                         PCCImage<T, 3>& image,
+                         const size_t    width,
+                         const size_t    height,
+                         const size_t    maxValue ) {
+  image.resize( width, height, PCCCOLORFORMAT::YUV444 );
+  for ( size_t c = 0; c < 3; c++ ) {
+    for ( size_t y = 0; y < height; y++ ) {
+      for ( size_t x = 0; x < width; x++ ) {
+        image.setValue( c, x, y, T( ( x * 3 + y * 5 + c * 77 + generator() % 9 ) % maxValue ) );
+      }
+    }
+  }
+}
+
+template <typename T>
+static bool isSameImage( const PCCImage<T, 3>& image0, const PCCImage<T, 3>& image1 ) {
+  for ( size_t c = 0; c < 3; c++ ) {
+    if ( image0.getChannel( c ) != image1.getChannel( c ) ) { return false; }
+  }
+  return true;
+}
+
+// Accumulates the processing times of a kernel and of its reference.
+struct PCCBenchmarkTimes {
+  pcc::chrono::Stopwatch<std::chrono::steady_clock> reference_;
+  pcc::chrono::Stopwatch<std::chrono::steady_clock> optimized_;
+  size_t                                            count_ = 0;
+  void print( const char* name ) const {
+    using ms                = std::chrono::duration<double, std::milli>;
+    const double reference = std::chrono::duration_cast<ms>( reference_.count() ).count() / count_;
+    const double optimized = std::chrono::duration_cast<ms>( optimized_.count() ).count() / count_;
+    printf( "    %-11s reference %9.2f ms  optimized %9.2f ms  speedup %6.2f \n", name, reference, optimized,
+            reference / optimized );
+  }
+};
+
+template <typename T>
+static bool benchmarkPadding( const PCCBenchmarkParameters& params, const char* name, const size_t maxValue ) {
+  const PCCImagePadding<T> padding( params.nbThread_ );
+  PCCBenchmarkTimes        dilateTimes;
+  PCCBenchmarkTimes        pushPullTimes;
+  PCCBenchmarkTimes        harmonicTimes;
+  printf( "  %s images: %zu x %zu ( harmonic fill: %zu x %zu ) \n", name, params.width_, params.height_,
+          params.harmonicSize_, params.harmonicSize_ );
+  for ( size_t index = 0; index < params.imageCount_; index++ ) {
+    std::mt19937   generator( uint32_t( 100 + index ) );
+    const bool     enhancedOccupancyMap = index % 2 == 1;
+    const double   coverage             = 0.2 + 0.1 * ( index % 5 );
+    auto           occupancyMap         = createOccupancyMap( generator, params.width_, params.height_,
+                                                params.occupancyResolution_, coverage, enhancedOccupancyMap );
+    PCCImage<T, 3> source;
+    PCCImage<T, 3> reference;
+    createImage( generator, source, params.width_, params.height_, maxValue );
+    createImage( generator, reference, params.width_, params.height_, maxValue );
+    for ( size_t useReference = 0; useReference < 2; useReference++ ) {
+      auto image0 = source;
+      auto image1 = source;
+      dilateTimes.reference_.start();
+      reference::dilate( image0, occupancyMap, params.occupancyResolution_, enhancedOccupancyMap,
+                         useReference != 0U ? &reference : nullptr );
+      dilateTimes.reference_.stop();
+      dilateTimes.optimized_.start();
+      padding.dilate( image1, occupancyMap, params.occupancyResolution_, enhancedOccupancyMap,
+                      useReference != 0U ? &reference : nullptr );
+      dilateTimes.optimized_.stop();
+      dilateTimes.count_++;
+      if ( !isSameImage( image0, image1 ) ) {
+        printf( "  %s image %zu: dilate results differ from the reference \n", name, index );
+        return false;
+      }
+    }
+    {
+      auto image0 = source;
+      auto image1 = source;
+      pushPullTimes.reference_.start();
+      reference::dilateSmoothedPushPull( image0, occupancyMap );
+      pushPullTimes.reference_.stop();
+      pushPullTimes.optimized_.start();
+      padding.pushPull( image1, occupancyMap );
+      pushPullTimes.optimized_.stop();
+      pushPullTimes.count_++;
+      if ( !isSameImage( image0, image1 ) ) {
+        printf( "  %s image %zu: push-pull results differ from the reference \n", name, index );
+        return false;
+      }
+    }
+    if ( params.harmonicSize_ > 0 ) {
+      const size_t size = params.harmonicSize_;
+      auto         smallOccupancyMap =
+          createOccupancyMap( generator, size, size, params.occupancyResolution_, coverage, false );
+      PCCImage<T, 3> image0;
+      createImage( generator, image0, size, size, maxValue );
+      auto image1 = image0;
+      harmonicTimes.reference_.start();
+      reference::dilateHarmonicBackgroundFill( image0, smallOccupancyMap );
+      harmonicTimes.reference_.stop();
+      harmonicTimes.optimized_.start();
+      padding.harmonicBackgroundFill( image1, smallOccupancyMap );
+      harmonicTimes.optimized_.stop();
+      harmonicTimes.count_++;
+      if ( !isSameImage( image0, image1 ) ) {
+        printf( "  %s image %zu: harmonic fill results differ from the reference \n", name, index );
+        return false;
+      }
+    }
+  }
+  dilateTimes.print( "dilate" );
+  pushPullTimes.print( "push-pull" );
+  if ( harmonicTimes.count_ > 0 ) { harmonicTimes.print( "harmonic" ); }
+  return true;
+}
+
+static bool benchmarkPadding( const PCCBenchmarkParameters& params ) {
+  printf( "Image padding: %zu images of each type, times per image and bit-exactness against the reference \n",
+          params.imageCount_ );
+  return benchmarkPadding<uint8_t>( params, "8-bit", 256 ) && benchmarkPadding<uint16_t>( params, "10-bit", 1024 );
+}
+
+//---------------------------------------------------------------------------
+// :: Bitstream
+
+// A symbol of the bitstream benchmark: a fixed length code, an unsigned or a signed Exp-Golomb code.
+struct PCCBenchmarkSymbol {
+  uint8_t  type_;
+  uint8_t  bits_;
+  uint32_t value_;
+};
+
+template <typename Bitstream>
+static void writeSymbols( Bitstream& bitstream, const std::vector<PCCBenchmarkSymbol>& symbols ) {
+  bitstream.initialize( uint64_t( 4096 ) );
+  for ( const auto& symbol : symbols ) {
+    switch ( symbol.type_ ) {
+      case 0: bitstream.write( symbol.value_, symbol.bits_ ); break;
+      case 1: bitstream.writeUvlc( symbol.value_ ); break;
+      default: bitstream.writeSvlc( static_cast<int32_t>( symbol.value_ ) ); break;
+    }
+  }
+}
+
+template <typename Bitstream>
+static bool readSymbols( Bitstream& bitstream, const std::vector<PCCBenchmarkSymbol>& symbols ) {
+  bool ret = true;
+  for ( const auto& symbol : symbols ) {
+    switch ( symbol.type_ ) {
+      case 0: ret &= bitstream.read( symbol.bits_ ) == symbol.value_; break;
+      case 1: ret &= bitstream.readUvlc() == symbol.value_; break;
+      default: ret &= bitstream.readSvlc() == static_cast<int32_t>( symbol.value_ ); break;
+    }
+  }
+  return ret;
+}
+
+template <typename Bitstream>
+static std::vector<uint8_t> getBytes( Bitstream& bitstream ) {
+  const size_t size = bitstream.size() + ( bitstream.byteAligned() ? 0 : 1 );
+  return std::vector<uint8_t>( bitstream.buffer(), bitstream.buffer() + size );
+}
+
+static bool benchmarkBitstream( const PCCBenchmarkParameters& params ) {
+  printf( "Bitstream: %zu symbols, times and bit-exactness against the reference \n", params.symbolCount_ );
+  // the symbols of the atlas syntax: fixed length codes of up to 32 bits and Exp-Golomb codes of small values
+  std::mt19937                    generator( 1 );
+  std::vector<PCCBenchmarkSymbol> symbols( params.symbolCount_ );
+  for ( auto& symbol : symbols ) {
+    symbol.type_ = uint8_t( generator() % 3 );
+    if ( symbol.type_ == 0 ) {
+      symbol.bits_  = uint8_t( generator() % 33 );
+      symbol.value_ = symbol.bits_ > 0 ? uint32_t( generator() & ( ( uint64_t( 1 ) << symbol.bits_ ) - 1 ) ) : 0;
+    } else {
+      symbol.bits_        = 0;
+      const int32_t value = int32_t( generator() >> ( 1 + generator() % 31 ) );
+      symbol.value_       = symbol.type_ == 2 && generator() % 2 == 0 ? uint32_t( -value ) : uint32_t( value );
+    }
+  }
+  PCCBenchmarkTimes       writeTimes;
+  PCCBenchmarkTimes       readTimes;
+  reference::PCCBitstream bitstream0;
+  PCCBitstream            bitstream1;
+  writeTimes.reference_.start();
+  writeSymbols( bitstream0, symbols );
+  writeTimes.reference_.stop();
+  writeTimes.optimized_.start();
+  writeSymbols( bitstream1, symbols );
+  writeTimes.optimized_.stop();
+  writeTimes.count_++;
+  auto bytes = getBytes( bitstream0 );
+  if ( bytes != getBytes( bitstream1 ) ) {
+    printf( "  the written bytes differ from the reference \n" );
+    return false;
+  }
+  bitstream0.initialize( bytes );
+  bitstream1.initialize( bytes );
+  readTimes.reference_.start();
+  bool ret = readSymbols( bitstream0, symbols );
+  readTimes.reference_.stop();
+  readTimes.optimized_.start();
+  ret &= readSymbols( bitstream1, symbols );
+  readTimes.optimized_.stop();
+  readTimes.count_++;
+  if ( !ret ) {
+    printf( "  the read symbols differ from the written ones \n" );
+    return false;
+  }
+  printf( "  %zu bytes \n", bytes.size() );
+  writeTimes.print( "write" );
+  readTimes.print( "read" );
+  return true;
+}
+
+//---------------------------------------------------------------------------
+// :: PLY
+
+static bool isSamePointSet( const PCCPointSet3& pointSet0, const PCCPointSet3& pointSet1 ) {
+  if ( pointSet0.getPointCount() != pointSet1.getPointCount() || pointSet0.hasColors() != pointSet1.hasColors() ||
+       pointSet0.hasReflectances() != pointSet1.hasReflectances() ||
+       pointSet0.getPositions() != pointSet1.getPositions() ) {
+    return false;
+  }
+  for ( size_t i = 0; i < pointSet0.getPointCount(); i++ ) {
+    if ( pointSet0.hasColors() && pointSet0.getColor( i ) != pointSet1.getColor( i ) ) { return false; }
+    if ( pointSet0.hasReflectances() && pointSet0.getReflectance( i ) != pointSet1.getReflectance( i ) ) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool isSameFile( const std::string& fileName0, const std::string& fileName1 ) {
+  std::ifstream     file0( fileName0, std::ios::binary );
+  std::ifstream     file1( fileName1, std::ios::binary );
+  std::vector<char> data0( ( std::istreambuf_iterator<char>( file0 ) ), std::istreambuf_iterator<char>() );
+  std::vector<char> data1( ( std::istreambuf_iterator<char>( file1 ) ), std::istreambuf_iterator<char>() );
+  return file0.is_open() && file1.is_open() && data0 == data1;
+}
+
+static bool benchmarkPly( const PCCBenchmarkParameters& params ) {
+  if ( params.uncompressedDataPath_.empty() ) {
+    printf( "  the PLY benchmark needs the uncompressedDataPath parameter \n" );
+    return false;
+  }
+  printf( "PLY: %zu frames, times per frame and bit-exactness against the reference \n", params.frameCount_ );
+  const std::string fileName0 = params.plyOutputPath_ + ".reference.ply";
+  const std::string fileName1 = params.plyOutputPath_;
+  PCCBenchmarkTimes readTimes;
+  PCCBenchmarkTimes writeTimes;
+  PCCBenchmarkTimes writeAsciiTimes;
+  PCCBenchmarkTimes readAsciiTimes;
+  bool              ret = true;
+  for ( size_t frameNumber = params.startFrameNumber_;
+        ret && frameNumber < params.startFrameNumber_ + params.frameCount_; frameNumber++ ) {
+    const std::string fileName = stringFormat( params.uncompressedDataPath_.c_str(), int( frameNumber ) );
+    PCCPointSet3      pointSet0;
+    PCCPointSet3      pointSet1;
+    readTimes.reference_.start();
+    bool read = reference::readPly( pointSet0, fileName, false );
+    readTimes.reference_.stop();
+    readTimes.optimized_.start();
+    read &= pointSet1.read( fileName, false );
+    readTimes.optimized_.stop();
+    readTimes.count_++;
+    if ( !read ) {
+      printf( "  %s can't be read \n", fileName.c_str() );
+      ret = false;
+    } else if ( !isSamePointSet( pointSet0, pointSet1 ) ) {
+      printf( "  %s: the read points differ from the reference \n", fileName.c_str() );
+      ret = false;
+    }
+    for ( size_t asAscii = 0; ret && asAscii < 2; asAscii++ ) {
+      auto& writeAsciiOrBinaryTimes = asAscii != 0U ? writeAsciiTimes : writeTimes;
+      writeAsciiOrBinaryTimes.reference_.start();
+      reference::writePly( pointSet1, fileName0, asAscii != 0U );
+      writeAsciiOrBinaryTimes.reference_.stop();
+      writeAsciiOrBinaryTimes.optimized_.start();
+      pointSet1.write( fileName1, asAscii != 0U );
+      writeAsciiOrBinaryTimes.optimized_.stop();
+      writeAsciiOrBinaryTimes.count_++;
+      if ( !isSameFile( fileName0, fileName1 ) ) {
+        printf( "  %s: the written %s files differ from the reference \n", fileName.c_str(),
+                asAscii != 0U ? "ascii" : "binary" );
+        ret = false;
+      }
+    }
+    if ( ret ) {
+      readAsciiTimes.reference_.start();
+      reference::readPly( pointSet0, fileName0, false );
+      readAsciiTimes.reference_.stop();
+      readAsciiTimes.optimized_.start();
+      pointSet1.read( fileName1, false );
+      readAsciiTimes.optimized_.stop();
+      readAsciiTimes.count_++;
+      if ( !isSamePointSet( pointSet0, pointSet1 ) ) {
+        printf( "  %s: the points read from the ascii files differ from the reference \n", fileName.c_str() );
+        ret = false;
+      }
+    }
+  }
+  std::remove( fileName0.c_str() );
+  std::remove( fileName1.c_str() );
+  if ( ret ) {
+    readTimes.print( "read" );
+    writeTimes.print( "write" );
+    writeAsciiTimes.print( "write ascii" );
+    readAsciiTimes.print( "read ascii" );
+  }
+  return ret;
+}
+
+int main( int argc, char* argv[] ) {
+  std::cout << "PccAppBenchmark v" << TMC2_VERSION_MAJOR << "." << TMC2_VERSION_MINOR << std::endl << std::endl;
+  PCCBenchmarkParameters params;
+  if ( !parseParameters( argc, argv, params ) ) { return -1; }
+#if defined( ENABLE_TBB )
+  if ( params.nbThread_ > 0 ) { tbb::task_scheduler_init init( static_cast<int>( params.nbThread_ ) ); }
+#endif
+  bool ret = true;
+  if ( params.padding_ ) { ret &= benchmarkPadding( params ); }
+  if ( params.bitstream_ ) { ret &= benchmarkBitstream( params ); }
+  if ( params.ply_ ) { ret &= benchmarkPly( params ); }
+  return ret ? 0 : 1;
+}
@@ -159,6 +159,10 @@ bool parseParameters( int                       argc,
       decoderParams.keepIntermediateFiles_,
       decoderParams.keepIntermediateFiles_,
       "Keep intermediate files: RGB, YUV and bin")
+    ( "useNamedPipes",
+      decoderParams.useNamedPipes_,
+      decoderParams.useNamedPipes_,
+      "Read decoded videos from the HM and SHM applications through named pipes instead of YUV files")
 	  ( "shvcLayerIndex",
 	    decoderParams.shvcLayerIndex_,
 	    decoderParams.shvcLayerIndex_,
@@ -275,10 +279,12 @@ bool parseParameters( int                       argc,
   return !err.is_errored;
 }
 
-int decompressVideo( PCCDecoderParameters&       decoderParams,
-                     const PCCMetricsParameters& metricsParams,
-                     PCCConformanceParameters&   conformanceParams,
-                     StopwatchUserTime&          clock ) {
+int decompressVideo( PCCDecoderParameters&                                   decoderParams,
+                     const PCCMetricsParameters&                             metricsParams,
+                     PCCConformanceParameters&                               conformanceParams,
+                     StopwatchUserTime&                                      clock,
+                     pcc::chrono::Stopwatch<std::chrono::steady_clock>&      clockOutput,
+                     pcc::chrono::Stopwatch<pcc::chrono::utime_thread_clock>& clockOutputUser ) {
   PCCBitstream     bitstream;
   PCCBitstreamStat bitstreamStat;
   PCCLogger        logger;
@@ -287,7 +293,7 @@ int decompressVideo( PCCDecoderParameters&       decoderParams,
   bitstream.setLogger( logger );
   bitstream.setTrace( true );
 #endif
-  if ( !bitstream.initialize( decoderParams.compressedStreamPath_ ) ) { return -1; }
+  if ( !bitstream.initialize( decoderParams.compressedStreamPath_, true ) ) { return -1; }
   bitstream.computeMD5();
   bitstreamStat.setHeader( bitstream.size() );
   size_t         frameNumber = decoderParams.startFrameNumber_;
@@ -301,6 +307,23 @@ int decompressVideo( PCCDecoderParameters&       decoderParams,
   decoder.setLogger( logger );
   decoder.setParameters( decoderParams );
 
+  // stream the reconstructed frames out as soon as they are decoded; they are only kept for the metrics. The output
+  // runs within the decoding time span, on one thread at a time while the next frames are reconstructed: its user
+  // time is measured on that thread by clockOutputUser and taken out of the decoding user time.
+  decoder.setFrameCallback( [&]( size_t frameIndex, PCCPointSet3& reconstruct ) {
+    clockOutput.start();
+    clockOutputUser.start();
+    if ( metricsParams.computeChecksum_ ) { checksum.computeDecoded( reconstruct ); }
+    if ( !decoderParams.reconstructedDataPath_.empty() ) {
+      char fileName[4096];
+      sprintf( fileName, decoderParams.reconstructedDataPath_.c_str(), frameNumber + frameIndex );
+      reconstruct.write( fileName, false );
+    }
+    if ( !metricsParams.computeMetrics_ ) { reconstruct = PCCPointSet3(); }
+    clockOutputUser.stop();
+    clockOutput.stop();
+  } );
+
   SampleStreamV3CUnit ssvu;
   size_t              headerSize = pcc::PCCBitstreamReader::read( bitstream, ssvu );
   bitstreamStat.incrHeader( headerSize );
@@ -334,7 +357,6 @@ int decompressVideo( PCCDecoderParameters&       decoderParams,
       int retDecoding = decoder.decode( context, reconstructs, atlId );
       clock.stop();
       if ( retDecoding != 0 ) { return retDecoding; }
-      if ( metricsParams.computeChecksum_ ) { checksum.computeDecoded( reconstructs ); }
       if ( metricsParams.computeMetrics_ ) {
         PCCGroupOfFrames sources;
         PCCGroupOfFrames normals;
@@ -360,11 +382,7 @@ int decompressVideo( PCCDecoderParameters&       decoderParams,
       }
 #endif
 
-      if ( !decoderParams.reconstructedDataPath_.empty() ) {
-        reconstructs.write( decoderParams.reconstructedDataPath_, frameNumber, decoderParams.nbThread_, false );
-      } else {
-        frameNumber += reconstructs.getFrameCount();
-      }
+      frameNumber += reconstructs.getFrameCount();
       bMoreData = ( ssvu.getV3CUnitCount() > 0 );
     }
   }
@@ -386,21 +404,27 @@ int main( int argc, char* argv[] ) {
   if ( decoderParams.nbThread_ > 0 ) { tbb::task_scheduler_init init( static_cast<int>( decoderParams.nbThread_ ) ); }
 #endif
   // Timers to count elapsed wall/user time
-  pcc::chrono::Stopwatch<std::chrono::steady_clock> clockWall;
-  pcc::chrono::StopwatchUserTime                    clockUser;
+  pcc::chrono::Stopwatch<std::chrono::steady_clock>       clockWall;
+  pcc::chrono::StopwatchUserTime                          clockUser;
+  pcc::chrono::Stopwatch<std::chrono::steady_clock>       clockOutput;
+  pcc::chrono::Stopwatch<pcc::chrono::utime_thread_clock> clockOutputUser;
 
   clockWall.start();
-  int ret = decompressVideo( decoderParams, metricsParams, conformanceParams, clockUser );
+  int ret = decompressVideo( decoderParams, metricsParams, conformanceParams, clockUser, clockOutput, clockOutputUser );
   clockWall.stop();
 
   using namespace std::chrono;
-  using ms            = milliseconds;
-  auto totalWall      = duration_cast<ms>( clockWall.count() ).count();
-  auto totalUserSelf  = duration_cast<ms>( clockUser.self.count() ).count();
-  auto totalUserChild = duration_cast<ms>( clockUser.children.count() ).count();
+  using ms             = milliseconds;
+  auto totalWall       = duration_cast<ms>( clockWall.count() ).count();
+  auto totalUserSelf   = duration_cast<ms>( clockUser.self.count() - clockOutputUser.count() ).count();
+  auto totalUserChild  = duration_cast<ms>( clockUser.children.count() ).count();
+  auto totalOutput     = duration_cast<ms>( clockOutput.count() ).count();
+  auto totalOutputUser = duration_cast<ms>( clockOutputUser.count() ).count();
   std::cout << "Processing time (wall): " << ( ret == 0 ? totalWall / 1000.0 : -1 ) << " s\n";
   std::cout << "Processing time (user.self): " << ( ret == 0 ? totalUserSelf / 1000.0 : -1 ) << " s\n";
   std::cout << "Processing time (user.children): " << ( ret == 0 ? totalUserChild / 1000.0 : -1 ) << " s\n";
+  std::cout << "Output time (wall): " << ( ret == 0 ? totalOutput / 1000.0 : -1 ) << " s\n";
+  std::cout << "Output time (user.self): " << ( ret == 0 ? totalOutputUser / 1000.0 : -1 ) << " s\n";
   std::cout << "Peak memory: " << getPeakMemory() << " KB\n";
   return ret;
 }
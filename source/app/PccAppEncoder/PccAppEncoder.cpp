@@ -49,6 +49,7 @@
 #include <program_options_lite.h>
 #if defined( ENABLE_TBB )
 #include <tbb/tbb.h>
+#include <atomic>
 #endif
 
 using namespace std;
@@ -65,6 +66,12 @@ static std::istream& operator>>( std::istream& in, PCCColorTransform& val ) {
   val = PCCColorTransform( tmp );
   return in;
 }
+static std::istream& operator>>( std::istream& in, PCCNNEngine& val ) {
+  unsigned int tmp;
+  in >> tmp;
+  val = PCCNNEngine( tmp );
+  return in;
+}
 static std::istream& operator>>( std::istream& in, PCCCodecId& val ) {
   val = UNKNOWN_CODEC;
   std::string tmp;
@@ -147,6 +154,11 @@ bool parseParameters( int                   argc,
       encoderParams.uncompressedDataPath_,
       encoderParams.uncompressedDataPath_,
       "Input pointcloud to encode. Multi-frame sequences may be represented by %04i" )
+    ( "uncompressedDataCachePath",
+      encoderParams.uncompressedDataCachePath_,
+      encoderParams.uncompressedDataCachePath_,
+      "Binary cache of the input pointcloud, read instead of the PLY file when valid and written otherwise. "
+      "Multi-frame sequences may be represented by %04i" )
     ( "compressedStreamPath",
       encoderParams.compressedStreamPath_,
       encoderParams.compressedStreamPath_,
@@ -208,7 +220,8 @@ bool parseParameters( int                   argc,
     ( "normalOrientation",
       encoderParams.normalOrientation_,
       encoderParams.normalOrientation_,
-      "Normal orientation: 0: None 1: spanning tree, 2:view point, 3:cubemap projection" )     
+      "Normal orientation: 0: None 1: spanning tree, 2:view point, 3:cubemap projection, 4: spanning forest "
+      "(parallel spanning tree)" )     
     ( "gridBasedRefineSegmentation",
       encoderParams.gridBasedRefineSegmentation_,
       encoderParams.gridBasedRefineSegmentation_,
@@ -595,6 +608,30 @@ bool parseParameters( int                   argc,
       encoderParams.keepIntermediateFiles_,
       encoderParams.keepIntermediateFiles_,
       "Keep intermediate files: RGB, YUV and bin" )
+    ( "useNamedPipes",
+      encoderParams.useNamedPipes_,
+      encoderParams.useNamedPipes_,
+      "Stream raw videos to and from the HM and SHM applications through named pipes instead of YUV files" )
+    ( "maxGroupOfFramesInFlight",
+      encoderParams.maxGroupOfFramesInFlight_,
+      encoderParams.maxGroupOfFramesInFlight_,
+      "Maximum number of groups of frames in flight: if greater than 1, the loading, the encoding and the metrics\n"
+      "of successive groups of frames are pipelined" )
+    ( "parallelGroupOfFrames",
+      encoderParams.parallelGroupOfFrames_,
+      encoderParams.parallelGroupOfFrames_,
+      "Encode up to maxGroupOfFramesInFlight groups of frames concurrently" )
+    ( "memoryBudget",
+      encoderParams.memoryBudget_,
+      encoderParams.memoryBudget_,
+      "Resident memory budget of the encoder in MB, 0 for none: the memory is reported after each encoding stage\n"
+      "and the cached KD-trees and the freed heap are released when it exceeds the budget" )
+    ( "nnSearchEngine",
+      encoderParams.nnSearchEngine_,
+      encoderParams.nnSearchEngine_,
+      "Nearest neighbour search engine of the encoder:\n"
+      "  0: KD-tree\n"
+      "  1: integer voxel grid" )
     ( "absoluteD1",
       encoderParams.absoluteD1_,
       encoderParams.absoluteD1_,
@@ -1009,9 +1046,27 @@ bool parseParameters( int                   argc,
   return true;
 }
 
-int compressVideo( const PCCEncoderParameters& encoderParams,
-                   const PCCMetricsParameters& metricsParams,
-                   StopwatchUserTime&          clock ) {
+// One group of frames travelling through the encoding pipeline
+struct PCCGroupOfFramesJob {
+  size_t           startFrameNumber_ = 0;
+  size_t           endFrameNumber_   = 0;
+  size_t           contextIndex_     = 0;
+  bool             runMetrics_       = false;
+  int              ret_              = 0;
+  PCCGroupOfFrames sources_;
+  PCCGroupOfFrames normals_;
+  PCCGroupOfFrames reconstructs_;
+
+  // encoding outputs kept until they are merged in order when the groups of frames are encoded concurrently
+  PCCLogger           logger_;
+  PCCBitstreamStat    bitstreamStat_;
+  SampleStreamV3CUnit ssvu_;
+};
+
+int compressVideo( const PCCEncoderParameters&                              encoderParams,
+                   const PCCMetricsParameters&                              metricsParams,
+                   StopwatchUserTime&                                       clock,
+                   pcc::chrono::Stopwatch<pcc::chrono::utime_thread_clock>& clockFinalize ) {
   const size_t startFrameNumber0        = encoderParams.startFrameNumber_;
   size_t       endFrameNumber0          = encoderParams.startFrameNumber_ + encoderParams.frameCount_;
   const size_t groupOfFramesSize0       = ( std::max )( size_t( 1 ), encoderParams.groupOfFramesSize_ );
@@ -1032,60 +1087,138 @@ int compressVideo( const PCCEncoderParameters& encoderParams,
   metrics.setParameters( metricsParams );
   checksum.setParameters( metricsParams );
 
-  // Place to get/set default values for gof metadata enabled flags (in sequence level).
-  while ( startFrameNumber < endFrameNumber0 ) {
-    size_t     endFrameNumber = min( startFrameNumber + groupOfFramesSize0, endFrameNumber0 );
-    PCCContext context;
-    context.setBitstreamStat( bitstreamStat );
-    context.addV3CParameterSet( contextIndex );
-    context.setActiveVpsId( contextIndex );
-    PCCGroupOfFrames sources;
-    PCCGroupOfFrames reconstructs;
-    clock.start();
-    if ( !sources.load( encoderParams.uncompressedDataPath_, startFrameNumber, endFrameNumber,
-                        encoderParams.colorTransform_, false, encoderParams.nbThread_ ) ) {
-      return -1;
+  // load the point clouds of the next group of frames
+  auto load = [&]( PCCGroupOfFramesJob& job ) {
+    job.startFrameNumber_ = startFrameNumber;
+    job.endFrameNumber_   = min( startFrameNumber + groupOfFramesSize0, endFrameNumber0 );
+    job.contextIndex_     = contextIndex;
+    if ( !job.sources_.load( encoderParams.uncompressedDataPath_, job.startFrameNumber_, job.endFrameNumber_,
+                             encoderParams.colorTransform_, false, encoderParams.nbThread_,
+                             encoderParams.uncompressedDataCachePath_ ) ) {
+      return false;
     }
-    if ( sources.getFrameCount() < endFrameNumber - startFrameNumber ) {
-      endFrameNumber  = startFrameNumber + sources.getFrameCount();
-      endFrameNumber0 = endFrameNumber;
+    if ( job.sources_.getFrameCount() < job.endFrameNumber_ - job.startFrameNumber_ ) {
+      job.endFrameNumber_ = job.startFrameNumber_ + job.sources_.getFrameCount();
+      endFrameNumber0     = job.endFrameNumber_;
     }
-    std::cout << "Compressing " << contextIndex << " frames " << startFrameNumber << " -> " << endFrameNumber << "..."
-              << std::endl;
-    int                ret = encoder.encode( sources, context, reconstructs );
+    startFrameNumber = job.endFrameNumber_;
+    contextIndex++;
+    return true;
+  };
+
+  // encode the group of frames and append its V3C units to the sample stream
+  auto encode = [&]( PCCGroupOfFramesJob& job, PCCEncoder& gofEncoder, PCCLogger& gofLogger,
+                     PCCBitstreamStat& gofBitstreamStat, SampleStreamV3CUnit& gofSsvu ) {
+    PCCContext context;
+    context.setBitstreamStat( gofBitstreamStat );
+    context.addV3CParameterSet( job.contextIndex_ );
+    context.setActiveVpsId( job.contextIndex_ );
+    std::cout << "Compressing " << job.contextIndex_ << " frames " << job.startFrameNumber_ << " -> "
+              << job.endFrameNumber_ << "..." << std::endl;
+    job.ret_ = gofEncoder.encode( job.sources_, context, job.reconstructs_ );
     PCCBitstreamWriter bitstreamWriter;
 #ifdef BITSTREAM_TRACE
-    bitstreamWriter.setLogger( logger );
+    bitstreamWriter.setLogger( gofLogger );
 #endif
-    ret |= bitstreamWriter.encode( context, ssvu );
-    clock.stop();
-    PCCGroupOfFrames normals;
+    job.ret_ |= bitstreamWriter.encode( context, gofSsvu );
+  };
+
+  // compute the metrics and write the reconstructed point clouds: not part of the encoding time
+  auto finalize = [&]( PCCGroupOfFramesJob& job ) {
     if ( metricsParams.computeMetrics_ ) {
-      bool bRunMetric = true;
-      if ( !metricsParams.normalDataPath_.empty() ) {
-        if ( !normals.load( metricsParams.normalDataPath_, startFrameNumber, endFrameNumber, COLOR_TRANSFORM_NONE,
-                            true ) ) {
-          bRunMetric = false;
-        }
-      }
-      if ( bRunMetric ) { metrics.compute( sources, reconstructs, normals ); }
+      job.runMetrics_ = metricsParams.normalDataPath_.empty() ||
+                         job.normals_.load( metricsParams.normalDataPath_, job.startFrameNumber_,
+                                            job.endFrameNumber_, COLOR_TRANSFORM_NONE, true );
     }
+    if ( job.runMetrics_ ) { metrics.compute( job.sources_, job.reconstructs_, job.normals_ ); }
+    auto& kdtreeCache = job.sources_.getKdTreeCache();
+    if ( g_printDetailedInfo ) {
+      std::cout << "KD-tree cache " << job.contextIndex_ << ": " << kdtreeCache.getBuildCount() << " builds, "
+                << kdtreeCache.getHitCount() << " hits" << std::endl;
+    }
+    kdtreeCache.clear();
     if ( metricsParams.computeChecksum_ ) {
       if ( encoderParams.rawPointsPatch_ && encoderParams.reconstructRawType_ != 0 ) {
-        checksum.computeSource( sources );
-        checksum.computeReordered( reconstructs );
+        checksum.computeSource( job.sources_ );
+        checksum.computeReordered( job.reconstructs_ );
       }
-      checksum.computeReconstructed( reconstructs );
+      checksum.computeReconstructed( job.reconstructs_ );
     }
-    if ( ret != 0 ) { return ret; }
+    if ( job.ret_ != 0 ) { return job.ret_; }
     if ( !encoderParams.reconstructedDataPath_.empty() ) {
-      reconstructs.write( encoderParams.reconstructedDataPath_, reconstructedFrameNumber );
+      job.reconstructs_.write( encoderParams.reconstructedDataPath_, reconstructedFrameNumber );
+    }
+    return 0;
+  };
+
+  // Place to get/set default values for gof metadata enabled flags (in sequence level).
+#if defined( ENABLE_TBB )
+  if ( encoderParams.maxGroupOfFramesInFlight_ > 1 ) {
+    // the loading of the next groups of frames and the metrics of the previous ones are overlapped with the
+    // encoding, each stage processes the groups of frames in order. With parallelGroupOfFrames, the groups of
+    // frames are encoded concurrently by their own encoders and their outputs are merged in order. The pipeline runs
+    // within the clock span: the user time of the finalize stage, one group of frames at a time on one thread, is
+    // measured by clockFinalize and taken out of the encoding user time.
+    const bool parallel = encoderParams.parallelGroupOfFrames_;
+    typedef PCCGroupOfFramesJob* Job;
+    std::atomic<int>             ret( 0 );
+    auto loadFilter = tbb::make_filter<void, Job>( tbb::filter::serial_in_order, [&]( tbb::flow_control& fc ) -> Job {
+      if ( ret != 0 || startFrameNumber >= endFrameNumber0 ) {
+        fc.stop();
+        return nullptr;
+      }
+      auto job = new PCCGroupOfFramesJob;
+      if ( !load( *job ) ) {
+        ret = -1;
+        delete job;
+        fc.stop();
+        return nullptr;
+      }
+      return job;
+    } );
+    auto encodeFilter = tbb::make_filter<Job, Job>(
+        parallel ? tbb::filter::parallel : tbb::filter::serial_in_order, [&]( Job job ) {
+          if ( ret != 0 ) { return job; }
+          if ( parallel ) {
+            PCCEncoder gofEncoder;
+            job->logger_.setBuffered( true );
+            gofEncoder.setLogger( job->logger_ );
+            gofEncoder.setParameters( encoderParams );
+            encode( *job, gofEncoder, job->logger_, job->bitstreamStat_, job->ssvu_ );
+          } else {
+            encode( *job, encoder, logger, bitstreamStat, ssvu );
+          }
+          return job;
+        } );
+    auto finalizeFilter = tbb::make_filter<Job, void>( tbb::filter::serial_in_order, [&]( Job job ) {
+      if ( parallel ) {
+        logger.append( job->logger_ );
+        bitstreamStat.append( job->bitstreamStat_ );
+        for ( auto& v3cUnit : job->ssvu_.getV3CUnit() ) { ssvu.getV3CUnit().push_back( std::move( v3cUnit ) ); }
+      }
+      if ( ret == 0 ) {
+        clockFinalize.start();
+        ret = finalize( *job );
+        clockFinalize.stop();
+      }
+      delete job;
+    } );
+    clock.start();
+    tbb::parallel_pipeline( encoderParams.maxGroupOfFramesInFlight_, loadFilter & encodeFilter & finalizeFilter );
+    clock.stop();
+    if ( ret != 0 ) { return ret; }
+  } else
+#endif
+  {
+    while ( startFrameNumber < endFrameNumber0 ) {
+      PCCGroupOfFramesJob job;
+      clock.start();
+      if ( !load( job ) ) { return -1; }
+      encode( job, encoder, logger, bitstreamStat, ssvu );
+      clock.stop();
+      int ret = finalize( job );
+      if ( ret != 0 ) { return ret; }
     }
-    normals.clear();
-    sources.clear();
-    reconstructs.clear();
-    startFrameNumber = endFrameNumber;
-    contextIndex++;
   }
 
   PCCBitstream bitstream;
@@ -1124,17 +1257,18 @@ int main( int argc, char* argv[] ) {
   if ( encoderParams.nbThread_ > 0 ) { tbb::task_scheduler_init init( static_cast<int>( encoderParams.nbThread_ ) ); }
 #endif
   // Timers to count elapsed wall/user time
-  pcc::chrono::Stopwatch<std::chrono::steady_clock> clockWall;
-  pcc::chrono::StopwatchUserTime                    clockUser;
+  pcc::chrono::Stopwatch<std::chrono::steady_clock>       clockWall;
+  pcc::chrono::StopwatchUserTime                          clockUser;
+  pcc::chrono::Stopwatch<pcc::chrono::utime_thread_clock> clockFinalize;
 
   clockWall.start();
-  int ret = compressVideo( encoderParams, metricsParams, clockUser );
+  int ret = compressVideo( encoderParams, metricsParams, clockUser, clockFinalize );
   clockWall.stop();
 
   using namespace std::chrono;
   using ms            = milliseconds;
   auto totalWall      = duration_cast<ms>( clockWall.count() ).count();
-  auto totalUserSelf  = duration_cast<ms>( clockUser.self.count() ).count();
+  auto totalUserSelf  = duration_cast<ms>( clockUser.self.count() - clockFinalize.count() ).count();
   auto totalUserChild = duration_cast<ms>( clockUser.children.count() ).count();
   std::cout << "Processing time (wall): " << ( ret == 0 ? totalWall / 1000.0 : -1 ) << " s\n";
   std::cout << "Processing time (user.self): " << ( ret == 0 ? totalUserSelf / 1000.0 : -1 ) << " s\n";
@@ -195,7 +195,7 @@ bool parseParameters( int                             argc,
     ( "orientationStrategy",
       normalParams.orientationStrategy_,
       normalParams.orientationStrategy_,
-      "(0)NONE, (1)SPANNING TREE, (2)VIEWPOINT, (3)CUBEMAP PROJECTION" )
+      "(0)NONE, (1)SPANNING TREE, (2)VIEWPOINT, (3)CUBEMAP PROJECTION, (4)SPANNING FOREST" )
     ( "storeEigenvalues",normalParams.storeEigenvalues_,
       normalParams.storeEigenvalues_,
       "Store Eigenvalues (0)false/(1)true" )
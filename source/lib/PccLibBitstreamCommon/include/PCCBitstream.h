@@ -112,6 +112,9 @@ class PCCBitstreamStat {
     PCCBitstreamGofStat element;
     bitstreamGofStat_.push_back( element );
   }
+  void append( const PCCBitstreamStat& stat ) {
+    bitstreamGofStat_.insert( bitstreamGofStat_.end(), stat.bitstreamGofStat_.begin(), stat.bitstreamGofStat_.end() );
+  }
   void setHeader( size_t size ) { header_ = size; }
   void incrHeader( size_t size ) { header_ += size; }
   void overwriteV3CUnitSize( V3CUnitType type, size_t size ) {
@@ -160,9 +163,16 @@ class PCCBitstream {
 
   bool initialize( std::vector<uint8_t>& data );
   bool initialize( const PCCBitstream& bitstream );
-  bool initialize( const std::string& compressedStreamPath );
-  void initialize( uint64_t capacity ) { data_.resize( capacity, 0 ); }
+  // A memory mapped bitstream is read-only: the V3C units and the video bitstreams extracted from it are views of
+  // the mapping instead of copies.
+  bool initialize( const std::string& compressedStreamPath, bool memoryMapped = false );
+  void initialize( uint64_t capacity ) {
+    materialize();
+    data_.resize( capacity, 0 );
+  }
   void clear() {
+    view_.reset();
+    viewSize_ = 0;
     data_.clear();
     position_.bits_  = 0;
     position_.bytes_ = 0;
@@ -172,10 +182,16 @@ class PCCBitstream {
     position_.bytes_ = 0;
   }
   bool                  write( const std::string& compressedStreamPath );
-  uint8_t*              buffer() { return data_.data(); }
-  std::vector<uint8_t>& vector() { return data_; }
+  uint8_t*              buffer() {
+    materialize();
+    return data_.data();
+  }
+  std::vector<uint8_t>& vector() {
+    materialize();
+    return data_;
+  }
   uint64_t&             size() { return position_.bytes_; }
-  uint64_t              capacity() { return data_.size(); }
+  uint64_t              capacity() { return dataSize(); }
   PCCBistreamPosition   getPosition() { return position_; }
   void                  setPosition( PCCBistreamPosition& val ) { position_ = val; }
   PCCBitstream&         operator+=( const uint64_t size ) {
@@ -187,7 +203,7 @@ class PCCBitstream {
   void writeVideoStream( PCCVideoBitstream& videoBitstream );
   void readVideoStream( PCCVideoBitstream& videoBitstream, size_t videoStreamSize );
   bool byteAligned() { return ( position_.bits_ == 0 ); }
-  bool moreData() { return position_.bytes_ < data_.size(); }
+  bool moreData() { return position_.bytes_ < dataSize(); }
   void computeMD5();
 
   inline std::string readString() {
@@ -207,7 +223,7 @@ class PCCBitstream {
     write( 0, 8 );
   }
 
-  inline uint32_t peekByteAt( uint64_t peekPos ) { return data_[peekPos]; }
+  inline uint32_t peekByteAt( uint64_t peekPos ) { return data()[peekPos]; }
   inline uint32_t read( uint8_t bits, bool bFullStream = false ) {
     uint32_t code = read( bits, position_ );
 #ifdef BITSTREAM_TRACE
@@ -264,41 +280,35 @@ class PCCBitstream {
   inline void writeUvlc( T value ) {
     uint32_t code = static_cast<uint32_t>( value );
 #ifdef BITSTREAM_TRACE
-    uint32_t orgCode            = code;
-    bool     traceStartingValue = trace_;
-    trace_                      = false;
+    uint32_t orgCode = code;
 #endif
-    uint32_t length = 1, temp = ++code;
-    while ( 1 != temp ) {
-      temp >>= 1;
-      length += 2;
-    }
-    write( 0, length >> 1 );
-    write( code, ( length + 1 ) >> 1 );
+    uint32_t prefix = static_cast<uint32_t>( floorLog2( ++code ) );
+    write( 0, prefix, position_ );
+    write( code, prefix + 1, position_ );
 #ifdef BITSTREAM_TRACE
-    trace_ = traceStartingValue;
     trace( "  CodeUvlc: %4zu \n", orgCode );
 #endif
   }
 
   inline uint32_t readUvlc() {
-#ifdef BITSTREAM_TRACE
-    bool traceStartingValue = trace_;
-    trace_                  = false;
-#endif
-    uint32_t value = 0, code = 0, length = 0;
-    code = read( 1 );
-    if ( 0 == code ) {
-      length = 0;
-      while ( !( code & 1 ) ) {
-        code = read( 1 );
-        length++;
-      }
-      value = read( length );
+    uint32_t       value = 0, length = 0;
+    const uint8_t* bytes = data();
+    // count the leading zeros byte by byte
+    uint8_t byte = static_cast<uint8_t>( bytes[position_.bytes_] << position_.bits_ );
+    while ( byte == 0 ) {
+      length += 8 - position_.bits_;
+      position_.bytes_++;
+      position_.bits_ = 0;
+      byte            = bytes[position_.bytes_];
+    }
+    uint32_t zeros = 7 - floorLog2( byte );
+    length += zeros;
+    skip( zeros + 1, position_ );
+    if ( length > 0 ) {
+      value = read( length, position_ );
       value += ( 1 << length ) - 1;
     }
 #ifdef BITSTREAM_TRACE
-    trace_ = traceStartingValue;
     trace( "  CodeUvlc: %4zu \n", value );
 #endif
     return value;
@@ -348,36 +358,49 @@ class PCCBitstream {
   void setLogger( PCCLogger& logger ) { logger_ = &logger; }
 #endif
  private:
+  inline const uint8_t* data() const { return view_ ? view_.get() : data_.data(); }
+  inline uint64_t       dataSize() const { return view_ ? viewSize_ : data_.size(); }
+  inline void           materialize() {
+    if ( view_ ) {
+      data_.assign( view_.get(), view_.get() + viewSize_ );
+      view_.reset();
+      viewSize_ = 0;
+    }
+  }
   inline void realloc( const size_t size = 4096 ) { data_.resize( data_.size() + ( ( ( size / 4096 ) + 1 ) * 4096 ) ); }
+  inline void skip( uint32_t bits, PCCBistreamPosition& pos ) {
+    const uint32_t total = pos.bits_ + bits;
+    pos.bytes_ += total >> 3;
+    pos.bits_ = total & 7;
+  }
+
+  // The bits are read and written with one 64-bit word covering the (up to 5) bytes they span.
   inline uint32_t read( uint8_t bits, PCCBistreamPosition& pos ) {
-    uint32_t value = 0;
-    for ( size_t i = 0; i < bits; i++ ) {
-      value |= ( ( data_[pos.bytes_] >> ( 7 - pos.bits_ ) ) & 1 ) << ( bits - 1 - i );
-      if ( pos.bits_ == 7 ) {
-        pos.bytes_++;
-        pos.bits_ = 0;
-      } else {
-        pos.bits_++;
-      }
-    }
-    return value;
+    if ( bits == 0 ) { return 0; }
+    const uint32_t total = pos.bits_ + bits;
+    const uint32_t count = ( total + 7 ) >> 3;
+    const uint8_t* bytes = data() + pos.bytes_;
+    uint64_t       word  = 0;
+    for ( uint32_t i = 0; i < count; i++ ) { word = ( word << 8 ) | bytes[i]; }
+    skip( bits, pos );
+    return static_cast<uint32_t>( ( word >> ( ( count << 3 ) - total ) ) & ( ( uint64_t( 1 ) << bits ) - 1 ) );
   }
 
   inline void write( uint32_t value, uint8_t bits, PCCBistreamPosition& pos ) {
     if ( pos.bytes_ + bits + 16 >= data_.size() ) { realloc(); }
-    for ( size_t i = 0; i < bits; i++ ) {
-      data_[pos.bytes_] |= ( ( value >> ( bits - 1 - i ) ) & 1 ) << ( 7 - pos.bits_ );
-      if ( pos.bits_ == 7 ) {
-        pos.bytes_++;
-        pos.bits_ = 0;
-      } else {
-        pos.bits_++;
-      }
-    }
+    if ( bits == 0 ) { return; }
+    const uint32_t total = pos.bits_ + bits;
+    const uint32_t count = ( total + 7 ) >> 3;
+    const uint64_t word  = ( value & ( ( uint64_t( 1 ) << bits ) - 1 ) ) << ( ( count << 3 ) - total );
+    uint8_t*       data  = data_.data() + pos.bytes_;
+    for ( uint32_t i = 0; i < count; i++ ) { data[i] |= static_cast<uint8_t>( word >> ( ( count - 1 - i ) << 3 ) ); }
+    skip( bits, pos );
   }
 
-  std::vector<uint8_t> data_;
-  PCCBistreamPosition  position_;
+  std::vector<uint8_t>           data_;
+  PCCBistreamPosition            position_;
+  std::shared_ptr<const uint8_t> view_;
+  uint64_t                       viewSize_ = 0;
 
 #if defined(CONFORMANCE_TRACE) || defined(BITSTREAM_TRACE)
   bool       trace_;
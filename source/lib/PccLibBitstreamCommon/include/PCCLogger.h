@@ -124,7 +124,7 @@ class PCCVirtualLogger {
 
 class PCCLogger {
  public:
-  PCCLogger() : filename_( "" ), encoder_( true ) { logger_.resize( LOG_ERROR ); }
+  PCCLogger() : filename_( "" ), encoder_( true ), buffered_( false ) { logger_.resize( LOG_ERROR ); }
   ~PCCLogger() { logger_.clear(); }
   void initilalize( std::string filename, bool encoder ) {
     filename_ = filename;
@@ -134,8 +134,34 @@ class PCCLogger {
   void         disable( PCCLoggerType type ) { logger_[type].disable(); }
   std::string& getLoggerBaseFileName() { return filename_; }
 
+  // A buffered logger keeps its traces in memory until they are appended to another logger: used to write the
+  // traces of concurrent encodings in order.
+  void setBuffered( bool value ) {
+    buffered_ = value;
+    buffers_.resize( LOG_ERROR );
+  }
+  void append( PCCLogger& logger ) {
+    for ( size_t type = 0; type < logger.buffers_.size(); type++ ) {
+      if ( !logger.buffers_[type].empty() ) {
+        trace( static_cast<PCCLoggerType>( type ), "%s", logger.buffers_[type].c_str() );
+        logger.buffers_[type].clear();
+      }
+    }
+  }
+
   template <typename... Args>
   inline void trace( PCCLoggerType type, const char* format, Args... args ) {
+    if ( buffered_ ) {
+      int size = snprintf( nullptr, 0, format, args... );
+      if ( size > 0 ) {
+        auto&  buffer   = buffers_[type];
+        size_t position = buffer.size();
+        buffer.resize( position + size + 1 );
+        snprintf( &buffer[position], size + 1, format, args... );
+        buffer.resize( position + size );
+      }
+      return;
+    }
     if ( !logger_[type].isInitialized() ) { logger_[type].initialize( type, filename_, encoder_ ); }
     if ( logger_[type].isInitialized() ) {
       logger_[type].trace( format, args... );
@@ -220,6 +246,8 @@ class PCCLogger {
   std::vector<PCCVirtualLogger> logger_;
   std::string                   filename_;
   bool                          encoder_;
+  bool                          buffered_;
+  std::vector<std::string>      buffers_;
 };
 
 #ifdef BITSTREAM_TRACE
@@ -39,15 +39,31 @@ namespace pcc {
 
 class PCCVideoBitstream {
  public:
-  PCCVideoBitstream( PCCVideoType type ) : type_( type ) { data_.clear(); }
+  PCCVideoBitstream( PCCVideoType type ) : type_( type ), viewSize_( 0 ) { data_.clear(); }
   ~PCCVideoBitstream() { data_.clear(); }
 
-  PCCVideoBitstream&    operator=( const PCCVideoBitstream& ) = default;
-  void                  resize( size_t size ) { data_.resize( size ); }
-  std::vector<uint8_t>& vector() { return data_; }
-  uint8_t*              buffer() { return data_.data(); }
-  size_t                size() { return data_.size(); }
-  PCCVideoType          type() { return type_; }
+  PCCVideoBitstream& operator=( const PCCVideoBitstream& ) = default;
+  void               resize( size_t size ) {
+    materialize();
+    data_.resize( size );
+  }
+  std::vector<uint8_t>& vector() {
+    materialize();
+    return data_;
+  }
+  uint8_t* buffer() {
+    materialize();
+    return data_.data();
+  }
+  size_t       size() { return view_ ? viewSize_ : data_.size(); }
+  PCCVideoType type() { return type_; }
+
+  // read-only view of a memory mapped bitstream, copied on the first mutable access
+  void setView( const std::shared_ptr<const uint8_t>& data, size_t size ) {
+    data_.clear();
+    view_     = data;
+    viewSize_ = size;
+  }
 
   void trace() { std::cout << "      " << toString( type_ ) << " ->" << size() << " B " << std::endl; }
 
@@ -68,9 +84,18 @@ class PCCVideoBitstream {
                                  bool   changeStartCodeSize      = true );
 
  private:
-  size_t               getEndOfNaluPosition( size_t startIndex );
-  std::vector<uint8_t> data_;
-  PCCVideoType         type_;
+  void materialize() {
+    if ( view_ ) {
+      data_.assign( view_.get(), view_.get() + viewSize_ );
+      view_.reset();
+      viewSize_ = 0;
+    }
+  }
+  size_t                         getEndOfNaluPosition( size_t startIndex );
+  std::vector<uint8_t>           data_;
+  PCCVideoType                   type_;
+  std::shared_ptr<const uint8_t> view_;
+  size_t                         viewSize_;
 };
 
 }  // namespace pcc
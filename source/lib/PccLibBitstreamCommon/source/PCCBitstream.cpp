@@ -34,6 +34,11 @@
 #include "PCCBitstream.h"
 #include "PCCVideoBitstream.h"
 #include "MD5.h"
+#if !defined( WIN32 )
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 using namespace pcc;
 
@@ -51,20 +56,46 @@ PCCBitstream::~PCCBitstream() { data_.clear(); }
 bool PCCBitstream::initialize( const PCCBitstream& bitstream ) {
   position_.bytes_ = 0;
   position_.bits_  = 0;
-  data_.resize( bitstream.data_.size(), 0 );
-  memcpy( data_.data(), bitstream.data_.data(), bitstream.data_.size() );
+  view_            = bitstream.view_;
+  viewSize_        = bitstream.viewSize_;
+  data_            = bitstream.data_;
   return true;
 }
 
 bool PCCBitstream::initialize( std::vector<uint8_t>& data ) {
   position_.bytes_ = 0;
   position_.bits_  = 0;
+  view_.reset();
+  viewSize_ = 0;
   data_.resize( data.size(), 0 );
   memcpy( data_.data(), data.data(), data.size() );
   return true;
 }
 
-bool PCCBitstream::initialize( const std::string& compressedStreamPath ) {
+bool PCCBitstream::initialize( const std::string& compressedStreamPath, bool memoryMapped ) {
+#if !defined( WIN32 )
+  if ( memoryMapped ) {
+    int fd = open( compressedStreamPath.c_str(), O_RDONLY );
+    if ( fd < 0 ) { return false; }
+    struct stat status;
+    void*       mapping = MAP_FAILED;
+    if ( fstat( fd, &status ) == 0 && status.st_size > 0 ) {
+      mapping = mmap( nullptr, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+    }
+    close( fd );
+    if ( mapping != MAP_FAILED ) {
+      const size_t size = status.st_size;
+      madvise( mapping, size, MADV_SEQUENTIAL );
+      position_.bytes_ = 0;
+      position_.bits_  = 0;
+      data_.clear();
+      view_.reset( static_cast<const uint8_t*>( mapping ),
+                   [size]( const uint8_t* data ) { munmap( const_cast<uint8_t*>( data ), size ); } );
+      viewSize_ = size;
+      return true;
+    }
+  }
+#endif
   std::ifstream fin( compressedStreamPath, std::ios::binary );
   if ( !fin.is_open() ) { return false; }
   fin.seekg( 0, std::ios::end );
@@ -80,7 +111,7 @@ bool PCCBitstream::initialize( const std::string& compressedStreamPath ) {
 bool PCCBitstream::write( const std::string& compressedStreamPath ) {
   std::ofstream fout( compressedStreamPath, std::ios::binary );
   if ( !fout.is_open() ) { return false; }
-  fout.write( reinterpret_cast<const char*>( data_.data() ), size() );
+  fout.write( reinterpret_cast<const char*>( data() ), size() );
   fout.close();
   return true;
 }
@@ -90,8 +121,12 @@ void PCCBitstream::readVideoStream( PCCVideoBitstream& videoBitstream, size_t vi
   trace( "%s \n", "Code: PCCVideoBitstream" );
   trace( "Code: size = %zu \n", videoStreamSize );
 #endif
-  videoBitstream.resize( videoStreamSize );
-  memcpy( videoBitstream.buffer(), data_.data() + position_.bytes_, videoStreamSize );
+  if ( view_ ) {
+    videoBitstream.setView( std::shared_ptr<const uint8_t>( view_, view_.get() + position_.bytes_ ), videoStreamSize );
+  } else {
+    videoBitstream.resize( videoStreamSize );
+    memcpy( videoBitstream.buffer(), data_.data() + position_.bytes_, videoStreamSize );
+  }
   videoBitstream.trace();
   position_.bytes_ += videoStreamSize;
 }
@@ -111,8 +146,14 @@ void PCCBitstream::writeVideoStream( PCCVideoBitstream& videoBitstream ) {
   videoBitstream.trace();
 }
 void PCCBitstream::copyFrom( PCCBitstream& srcBitstream, const size_t position, const size_t size ) {
-  if ( data_.size() < position_.bytes_ + size ) { data_.resize( position_.bytes_ + size ); }
-  memcpy( data_.data() + position_.bytes_, srcBitstream.buffer() + position, size ); 
+  if ( srcBitstream.view_ && position_.bytes_ == 0 && dataSize() == 0 ) {
+    view_     = std::shared_ptr<const uint8_t>( srcBitstream.view_, srcBitstream.view_.get() + position );
+    viewSize_ = size;
+  } else {
+    materialize();
+    if ( data_.size() < position_.bytes_ + size ) { data_.resize( position_.bytes_ + size ); }
+    memcpy( data_.data() + position_.bytes_, srcBitstream.data() + position, size );
+  }
   position_.bytes_ += size; 
   auto pos = srcBitstream.getPosition();
   pos.bytes_ += size; 
@@ -120,8 +161,14 @@ void PCCBitstream::copyFrom( PCCBitstream& srcBitstream, const size_t position,
 }
 
 void PCCBitstream::copyTo( PCCBitstream& dstBitstream, const size_t size ) {
-  dstBitstream.initialize( dstBitstream.position_.bytes_ + size );
-  memcpy( dstBitstream.buffer() + dstBitstream.position_.bytes_, data_.data() + position_.bytes_, size );
+  if ( view_ && dstBitstream.position_.bytes_ == 0 ) {
+    dstBitstream.data_.clear();
+    dstBitstream.view_     = std::shared_ptr<const uint8_t>( view_, view_.get() + position_.bytes_ );
+    dstBitstream.viewSize_ = size;
+  } else {
+    dstBitstream.initialize( dstBitstream.position_.bytes_ + size );
+    memcpy( dstBitstream.buffer() + dstBitstream.position_.bytes_, data() + position_.bytes_, size );
+  }
   position_.bytes_ += size;
 }
 
@@ -129,9 +176,9 @@ void PCCBitstream::computeMD5() {
   MD5                  md5Hash;
   std::vector<uint8_t> tmp_digest;
   tmp_digest.resize( 16 );
-  size_t dataSize = size() == 0 ? data_.size() : size();
+  size_t dataSize = size() == 0 ? this->dataSize() : size();
   TRACE_BITSTRMD5( "%s", "BITSTRMD5 = " )
-  md5Hash.update( data_.data(), dataSize );
+  md5Hash.update( const_cast<uint8_t*>( data() ), dataSize );
   md5Hash.finalize( tmp_digest.data() );
   for ( auto& bitStr : tmp_digest ) TRACE_BITSTRMD5( "%02x", bitStr );
   std::cout << std::endl;
@@ -60,7 +60,11 @@ std::string PCCVideoBitstream::getExtension() {
 bool PCCVideoBitstream::write( const std::string& filename ) {
   std::ofstream file( filename, std::ios::binary );
   if ( !file.good() ) { return false; }
-  file.write( reinterpret_cast<char*>( data_.data() ), data_.size() );
+  if ( view_ ) {
+    file.write( reinterpret_cast<const char*>( view_.get() ), viewSize_ );
+  } else {
+    file.write( reinterpret_cast<char*>( data_.data() ), data_.size() );
+  }
   file.close();
   return true;
 }
@@ -69,6 +73,8 @@ bool PCCVideoBitstream::read( const std::string& filename ) {
   std::ifstream file( filename, std::ios::binary | std::ios::ate );
   if ( !file.good() ) { return false; }
   const uint64_t fileSize = file.tellg();
+  view_.reset();
+  viewSize_ = 0;
   resize( (size_t)fileSize );
   file.clear();
   file.seekg( 0 );
@@ -83,6 +89,7 @@ bool PCCVideoBitstream::_write( const std::string& filename ) { return write( fi
 #endif
 
 void PCCVideoBitstream::byteStreamToSampleStream( size_t precision, bool emulationPreventionBytes ) {
+  materialize();
   size_t               startIndex = 0, endIndex = 0;
   std::vector<uint8_t> data;
   do {
@@ -116,6 +123,7 @@ void PCCVideoBitstream::sampleStreamToByteStream( bool   isAvc,
                                                   size_t precision,
                                                   bool   emulationPreventionBytes,
                                                   bool   changeStartCodeSize ) {
+  materialize();
   size_t               sizeStartCode = 4, startIndex = 0, endIndex = 0;
   std::vector<uint8_t> data;
   bool                 newFrame = true;
@@ -68,6 +68,23 @@ struct utime_children_clock {
 
   static time_point now() noexcept;
 };
+
+/**
+ * Clock reporting elapsed user time of the calling thread.
+ *
+ * NB: where the time of a thread is not available, the user time of the
+ *     current process is reported.
+ */
+struct utime_thread_clock {
+  typedef std::chrono::nanoseconds                              duration;
+  typedef duration::rep                                         rep;
+  typedef duration::period                                      period;
+  typedef std::chrono::time_point<utime_thread_clock, duration> time_point;
+
+  static constexpr bool is_steady = true;
+
+  static time_point now() noexcept;
+};
 }  // namespace chrono
 }  // namespace pcc
 
@@ -199,7 +199,8 @@ class PCCCodec {
 
   void generateTileBlockToPatchFromOccupancyMapVideo( PCCContext&  context,
                                                       const size_t occupancyResolution,
-                                                      const size_t occupancyPrecision );
+                                                      const size_t occupancyPrecision,
+                                                      const size_t nbThread );
 
   void generateTileBlockToPatchFromOccupancyMapVideo( PCCContext&           context,
                                                       PCCFrameContext&      tile,
@@ -210,7 +211,8 @@ class PCCCodec {
 
   void generateAtlasBlockToPatchFromOccupancyMapVideo( PCCContext&  context,
                                                        const size_t occupancyResolution,
-                                                       const size_t occupancyPrecision );
+                                                       const size_t occupancyPrecision,
+                                                       const size_t nbThread );
 
   void generateAtlasBlockToPatchFromOccupancyMapVideo( PCCContext&           context,
                                                        PCCFrameContext&      tile,
@@ -350,7 +352,7 @@ class PCCCodec {
                              uint16_t                            gridWidth,
                              std::vector<int>&                   cellIndex );
 
-  void addGridCentroid( PCCPoint3D&                     point,
+  void addGridCentroid( const PCCPoint3D&               point,
                         uint32_t                        patchIdx,
                         std::vector<uint16_t>&          count,
                         std::vector<PCCVector3<float>>& center,
@@ -360,7 +362,7 @@ class PCCCodec {
                         uint16_t                        gridWidth,
                         int                             cellId );
 
-  void addGridColorCentroid( PCCPoint3D&                             point,
+  void addGridColorCentroid( const PCCPoint3D&                       point,
                              PCCVector3D&                            color,
                              std::pair<size_t, size_t>               tilePatchIdx,
                              std::vector<uint16_t>&                  colorGridCount,
@@ -91,6 +91,7 @@ class PCCFrameContext {
   std::vector<PCCPointSet3>&      getSrcPointCloudByPatch() { return srcPointCloudByPatch_; }
   PCCPointSet3&              getSrcPointCloudByPatch( size_t patchIndex ) { return srcPointCloudByPatch_[patchIndex]; }
   std::vector<PCCPointSet3>& getSrcPointCloudByBlock() { return srcPointCloudByBlock_; }
+  void                       clearSrcPointCloudByPatch() { std::vector<PCCPointSet3>().swap( srcPointCloudByPatch_ ); }
   uint8_t&                   getPointLocalReconstructionNumber() { return pointLocalReconstructionNumber_; }
   PCCGPAFrameSize&           getPrePCCGPAFrameSize() { return prePCCGPAFrameSize_; }
   PCCGPAFrameSize&           getCurPCCGPAFrameSize() { return curPCCGPAFrameSize_; }
@@ -35,6 +35,7 @@
 #define PCCGroupOfFrames_h
 
 #include "PCCCommon.h"
+#include "PCCKdTreeCache.h"
 
 namespace pcc {
 class PCCPointSet3;
@@ -44,7 +45,10 @@ class PCCGroupOfFrames {
   PCCGroupOfFrames( size_t value );
   ~PCCGroupOfFrames();
 
-  void                clear() { frames_.clear(); }
+  void clear() {
+    frames_.clear();
+    kdtreeCache_.clear();
+  }
   size_t              getFrameCount() const { return frames_.size(); }
   void                setFrameCount( size_t n ) { frames_.resize( n ); }
   const PCCPointSet3& operator[]( const size_t index ) const {
@@ -58,13 +62,15 @@ class PCCGroupOfFrames {
   std::vector<PCCPointSet3>&          getFrames() { return frames_; }
   std::vector<PCCPointSet3>::iterator begin() { return frames_.begin(); }
   std::vector<PCCPointSet3>::iterator end() { return frames_.end(); }
+  PCCKdTreeCache&                     getKdTreeCache() const { return kdtreeCache_; }
 
   bool load( const std::string&      uncompressedDataPath,
              const size_t            startFrameNumber,
              const size_t            endFrameNumber,
              const PCCColorTransform colorTransform,
-             const bool              readNormals = false,
-             const size_t            nbThread    = 1 );
+             const bool              readNormals   = false,
+             const size_t            nbThread      = 1,
+             const std::string&      cacheDataPath = std::string() );
 
   bool write( const std::string& reconstructedDataPath,
               size_t&            frameNumber,
@@ -73,6 +79,7 @@ class PCCGroupOfFrames {
 
  private:
   std::vector<PCCPointSet3> frames_;
+  mutable PCCKdTreeCache    kdtreeCache_;
 };
 }  // namespace pcc
 
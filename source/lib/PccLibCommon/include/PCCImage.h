@@ -65,6 +65,10 @@ class PCCImage {
   void clear() {
     for ( auto& channel : channels_ ) { channel.clear(); }
   }
+  // free the samples of the picture but keep its size and format
+  void release() {
+    for ( auto& channel : channels_ ) { std::vector<T>().swap( channel ); }
+  }
   size_t                getWidth() const { return width_; }
   size_t                getHeight() const { return height_; }
   PCCCOLORFORMAT        getColorFormat() const { return format_; }
@@ -175,11 +179,11 @@ class PCCImage {
     }
   }
 
-  bool write( std::ofstream& outfile, const size_t nbyte );
+  bool write( std::ostream& outfile, const size_t nbyte );
 
   bool write( const std::string fileName, const size_t nbyte );
 
-  bool read( std::ifstream&       infile,
+  bool read( std::istream&        infile,
              const size_t         sizeU0,
              const size_t         sizeV0,
              const PCCCOLORFORMAT format,
@@ -35,6 +35,7 @@
 
 #include "PCCCommon.h"
 #include "PCCPointSet.h"
+#include "PCCVoxelGridIndex.h"
 
 namespace pcc {
 
@@ -44,50 +45,85 @@ struct PCCNNQuery3 {
   size_t     nearestNeighborCount;
 };
 
+// Result of a nearest neighbour query: the indices of the neighbours and their squared distances. Up to
+// inlineCapacity neighbours are stored in the object itself and larger results in a heap buffer that is kept
+// when the object is reused, so the queries of a loop do not allocate memory. The voxel grid searches of more than
+// inlineCapacity neighbours also keep their work buffer in the result.
 class PCCNNResult {
  public:
-  PCCNNResult() = default;
-  ~PCCNNResult() {
-    indices_.clear();
-    dist_.clear();
-  }
-  inline void resize( const size_t size ) {
-    indices_.resize( size );
-    dist_.resize( size );
+  static const size_t inlineCapacity = 64;
+
+  PCCNNResult() : size_( 0 ), capacity_( inlineCapacity ), indices_( inlineIndices_ ), dist_( inlineDist_ ) {}
+  PCCNNResult( const PCCNNResult& result ) : PCCNNResult() { *this = result; }
+  ~PCCNNResult() = default;
+  PCCNNResult& operator=( const PCCNNResult& result ) {
+    if ( this != &result ) {
+      resize( result.size_ );
+      std::copy( result.indices_, result.indices_ + size_, indices_ );
+      std::copy( result.dist_, result.dist_ + size_, dist_ );
+    }
+    return *this;
   }
-  inline void reserve( const size_t size ) {
-    indices_.reserve( size );
-    dist_.reserve( size );
+  inline void reserve( const size_t capacity ) {
+    if ( capacity <= capacity_ ) { return; }
+    capacity_ = ( std::max )( capacity, 2 * capacity_ );
+    std::vector<uint32_t> indices( capacity_ );
+    std::vector<float>    dist( capacity_ );
+    std::copy( indices_, indices_ + size_, indices.begin() );
+    std::copy( dist_, dist_ + size_, dist.begin() );
+    heapIndices_.swap( indices );
+    heapDist_.swap( dist );
+    indices_ = heapIndices_.data();
+    dist_    = heapDist_.data();
   }
-  inline size_t size() const {
-    assert( indices_.size() == dist_.size() );
-    return indices_.size();
+  inline void resize( const size_t size ) {
+    reserve( size );
+    size_ = size;
   }
-  inline size_t  count() const { return size(); }
-  inline size_t& indices( size_t index ) { return indices_[index]; }
-  inline double& dist( size_t index ) { return dist_[index]; }
-  inline size_t* indices() { return indices_.data(); }
-  inline double* dist() { return dist_.data(); }
-  inline void    pushBack( const std::pair<size_t, double>& value ) {
-    indices_.push_back( value.first );
-    dist_.push_back( value.second );
+  inline void      clear() { size_ = 0; }
+  inline size_t    size() const { return size_; }
+  inline size_t    count() const { return size_; }
+  inline size_t    capacity() const { return capacity_; }
+  inline uint32_t& indices( size_t index ) { return indices_[index]; }
+  inline float&    dist( size_t index ) { return dist_[index]; }
+  inline uint32_t  indices( size_t index ) const { return indices_[index]; }
+  inline float     dist( size_t index ) const { return dist_[index]; }
+  inline uint32_t* indices() { return indices_; }
+  inline float*    dist() { return dist_; }
+  inline void      pushBack( const uint32_t index, const float dist ) {
+    reserve( size_ + 1 );
+    indices_[size_] = index;
+    dist_[size_]    = dist;
+    ++size_;
   }
-  inline void popBack() {
-    indices_.pop_back();
-    dist_.pop_back();
+  inline void popBack() { --size_; }
+  inline PCCVoxelGridIndex::Neighbor* neighbors( const size_t capacity ) {
+    if ( neighbors_.size() < capacity ) { neighbors_.resize( capacity ); }
+    return neighbors_.data();
   }
 
  private:
-  std::vector<size_t> indices_;
-  std::vector<double> dist_;
+  size_t                                   size_;
+  size_t                                   capacity_;
+  uint32_t*                                indices_;
+  float*                                   dist_;
+  std::vector<uint32_t>                    heapIndices_;
+  std::vector<float>                       heapDist_;
+  std::vector<PCCVoxelGridIndex::Neighbor> neighbors_;
+  uint32_t                                 inlineIndices_[inlineCapacity];
+  float                                    inlineDist_[inlineCapacity];
 };
 
+// Nearest neighbour search engine of a point cloud: a nanoflann KD-tree or, with NN_ENGINE_VOXEL_GRID, an exact
+// integer voxel grid index.
 class PCCKdTree {
  public:
   PCCKdTree();
-  PCCKdTree( const PCCPointSet3& pointCloud );
+  PCCKdTree( const PCCPointSet3& pointCloud, PCCNNEngine engine = NN_ENGINE_KDTREE );
   ~PCCKdTree();
-  void init( const PCCPointSet3& pointCloud );
+  void init( const PCCPointSet3& pointCloud, PCCNNEngine engine = NN_ENGINE_KDTREE );
+  // Both searches overwrite results with at most num_results neighbours sorted by increasing squared distance;
+  // searchRadius only keeps the neighbours closer than the squared distance radius and orders ties by index.
   void search( const PCCPoint3D& point, const size_t num_results, PCCNNResult& results ) const;
   void searchRadius( const PCCPoint3D& point,
                      const size_t      num_results,
@@ -95,8 +131,9 @@ class PCCKdTree {
                      PCCNNResult&      results ) const;
 
  private:
-  void  clear();
-  void* kdtree_;
+  void               clear();
+  void*              kdtree_;
+  PCCVoxelGridIndex* voxelGrid_;
 };
 
 }  // namespace pcc
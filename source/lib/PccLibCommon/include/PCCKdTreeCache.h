@@ -0,0 +1,79 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PCCKdTreeCache_h
+#define PCCKdTreeCache_h
+
+#include "PCCCommon.h"
+#include <atomic>
+#include <mutex>
+
+namespace pcc {
+class PCCPointSet3;
+class PCCKdTree;
+
+// Cache of the KD-trees of the point clouds, so that the successive stages searching the same cloud share its index.
+// The trees are built with the search engine of the cache, the KD-tree by default.
+// The trees are keyed by the point cloud they index, are rebuilt when its positions were modified since they were
+// built and are evicted when it is destroyed. A point cloud is indexed by one cache at a time: the trees of a point
+// cloud already indexed by another cache are built without being cached. A copied cache starts empty.
+class PCCKdTreeCache {
+ public:
+  PCCKdTreeCache();
+  PCCKdTreeCache( const PCCKdTreeCache& );
+  PCCKdTreeCache& operator=( const PCCKdTreeCache& );
+  ~PCCKdTreeCache();
+
+  std::shared_ptr<const PCCKdTree> get( const PCCPointSet3& pointSet );
+  void                             invalidate( const PCCPointSet3& pointSet );
+  void                             setNNSearchEngine( PCCNNEngine engine );
+  void                             clear();
+  void                             trim();
+  size_t                           getHitCount() const { return hitCount_; }
+  size_t                           getBuildCount() const { return buildCount_; }
+
+ private:
+  struct Entry {
+    std::mutex                       mutex_;
+    std::shared_ptr<const PCCKdTree> kdtree_;
+  };
+  void releaseEntries();
+  std::mutex                                             mutex_;
+  PCCNNEngine                                            nnSearchEngine_;
+  std::map<const PCCPointSet3*, std::shared_ptr<Entry>> entries_;
+  std::atomic<size_t>                                    hitCount_;
+  std::atomic<size_t>                                    buildCount_;
+};
+
+}  // namespace pcc
+
+#endif /* PCCKdTreeCache_h */
@@ -453,6 +453,7 @@ typedef PCCBox3<int16_t>     PCCInt16Box3D;
 typedef PCCVector3<uint8_t>  PCCColor3B;
 typedef PCCVector3<uint16_t> PCCColor16bit;
 typedef PCCVector3<double>   PCCNormal3D;
+typedef PCCVector3<float>    PCCNormal3F;
 typedef PCCMatrix3<double>   PCCMatrix3D;
 
 static inline PCCVector3D operator+( const PCCVector3D& a, const PCCPoint3D& b ) {
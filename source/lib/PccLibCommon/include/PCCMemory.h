@@ -49,6 +49,11 @@ static int getUsedMemory() {
   GetProcessMemoryInfo( GetCurrentProcess(), &pmc, sizeof( pmc ) );
   return pmc.WorkingSetSize / 1024;
 }
+static inline uint64_t getResidentMemory() {
+  PROCESS_MEMORY_COUNTERS pmc;
+  GetProcessMemoryInfo( GetCurrentProcess(), &pmc, sizeof( pmc ) );
+  return (uint64_t)pmc.WorkingSetSize / 1024;
+}
 static uint64_t getPeakMemory() {
   PROCESS_MEMORY_COUNTERS pmc;
   GetProcessMemoryInfo( GetCurrentProcess(), &pmc, sizeof( pmc ) );
@@ -63,6 +68,14 @@ static inline int getUsedMemory() {
   }
   return (size_t)info.resident_size;
 }
+static inline uint64_t getResidentMemory() {
+  struct mach_task_basic_info info;
+  mach_msg_type_number_t      infoCount = MACH_TASK_BASIC_INFO_COUNT;
+  if ( task_info( mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &infoCount ) != KERN_SUCCESS ) {
+    return 0;
+  }
+  return (uint64_t)info.resident_size / 1024;
+}
 static uint64_t getPeakMemory() {
   struct rusage rusage;
   getrusage( RUSAGE_SELF, &rusage );
@@ -96,6 +109,23 @@ static int getUsedMemory() {
   }
   return iResult;
 }
+static inline uint64_t getResidentMemory() {
+  FILE*    pFile   = fopen( "/proc/self/status", "r" );
+  uint64_t iResult = 0;
+  if ( pFile != NULL ) {
+    char pLine[128];
+    while ( fgets( pLine, 128, pFile ) != NULL ) {
+      if ( strncmp( pLine, "VmRSS:", 6 ) == 0 ) {
+        const char* pTmp = pLine;
+        while ( *pTmp < '0' || *pTmp > '9' ) { pTmp++; }
+        iResult = strtoull( pTmp, NULL, 10 );
+        break;
+      }
+    }
+    fclose( pFile );
+  }
+  return iResult;
+}
 static uint64_t getPeakMemory() {
   FILE*    pFile   = fopen( "/proc/self/status", "r" );
   uint64_t iResult = 0;
@@ -0,0 +1,114 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PCCPackingCanvas_h
+#define PCCPackingCanvas_h
+
+#include "PCCCommon.h"
+
+namespace pcc {
+
+// Occupied blocks of the canvas used to pack the patches, stored as a bitset in raster order. It is accessed like the
+// std::vector<bool> it replaces, and the rows of a canvas of a given stride are read 64 blocks at a time to test the
+// placements of the patches. A summed-area table of the occupied blocks, rebuilt when the canvas has been modified,
+// counts the occupied blocks of a rectangle in constant time.
+class PCCPackingCanvas {
+ public:
+  class reference {
+   public:
+    reference( PCCPackingCanvas& canvas, const size_t pos ) : canvas_( canvas ), pos_( pos ) {}
+    operator bool() const { return canvas_.get( pos_ ); }
+    reference& operator=( const bool value ) {
+      canvas_.set( pos_, value );
+      return *this;
+    }
+    reference& operator=( const reference& rhs ) { return *this = bool( rhs ); }
+
+   private:
+    PCCPackingCanvas& canvas_;
+    size_t            pos_;
+  };
+
+  PCCPackingCanvas() : size_( 0 ), sumStride_( 0 ), sumValid_( false ) {}
+  ~PCCPackingCanvas() {}
+
+  size_t    size() const { return size_; }
+  void      resize( const size_t size, const bool value = false );
+  void      clear() { resize( 0 ); }
+  bool      operator[]( const size_t pos ) const { return get( pos ); }
+  reference operator[]( const size_t pos ) { return reference( *this, pos ); }
+  bool      get( const size_t pos ) const { return ( ( words_[pos >> 6] >> ( pos & 63 ) ) & 1 ) != 0; }
+  void      set( const size_t pos, const bool value ) {
+    if ( value ) {
+      words_[pos >> 6] |= uint64_t( 1 ) << ( pos & 63 );
+    } else {
+      words_[pos >> 6] &= ~( uint64_t( 1 ) << ( pos & 63 ) );
+    }
+    sumValid_ = false;
+  }
+
+  // builds the summed-area table of a canvas of the given stride, count() calls it when the table is out of date and
+  // it must be called before counting from several threads
+  void updateSummedArea( const size_t stride ) const;
+
+  // number of occupied blocks in [x, x + width) x [y, y + height)
+  size_t count( const size_t x, const size_t y, const size_t width, const size_t height, const size_t stride ) const;
+
+  // true if an occupied block of [x, x + width) x [y, y + height) is set in mask, which stores the rectangle as
+  // height rows of ( width + 63 ) / 64 words, the first block of a row being the lowest bit of its first word
+  bool intersects( const uint64_t* mask,
+                   const size_t    x,
+                   const size_t    y,
+                   const size_t    width,
+                   const size_t    height,
+                   const size_t    stride ) const;
+
+ private:
+  // the 64 blocks starting at pos, the blocks beyond the end of the canvas are free
+  uint64_t getWord( const size_t pos ) const {
+    const size_t index = pos >> 6, shift = pos & 63;
+    if ( index >= words_.size() ) { return 0; }
+    uint64_t word = words_[index] >> shift;
+    if ( shift != 0 && index + 1 < words_.size() ) { word |= words_[index + 1] << ( 64 - shift ); }
+    return word;
+  }
+
+  std::vector<uint64_t>         words_;
+  size_t                        size_;
+  mutable std::vector<uint32_t> sum_;
+  mutable size_t                sumStride_;
+  mutable bool                  sumValid_;
+};
+
+}  // namespace pcc
+
+#endif /* PCCPackingCanvas_h */
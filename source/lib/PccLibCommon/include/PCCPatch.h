@@ -36,6 +36,7 @@
 
 #include "PCCCommon.h"
 #include "PCCPointSet.h"
+#include "PCCPackingCanvas.h"
 
 namespace pcc {
 
@@ -141,10 +142,16 @@ class PCCPatch {
   void setNormalAxis( size_t value ) { normalAxis_ = value; }
   void setTangentAxis( size_t value ) { tangentAxis_ = value; }
   void setBitangentAxis( size_t value ) { bitangentAxis_ = value; }
-  void setOccupancy( const std::vector<bool>& occupancy ) { occupancy_ = occupancy; }
+  void setOccupancy( const std::vector<bool>& occupancy ) {
+    occupancy_ = occupancy;
+    packingMasks_.clear();
+  }
   void setDepth( size_t i, const std::vector<int16_t>& depth ) { depth_[i] = depth; }
   void setDepth( size_t i, size_t j, int16_t value ) { depth_[i][j] = value; }
-  void setOccupancy( size_t i, bool value ) { occupancy_[i] = value; }
+  void setOccupancy( size_t i, bool value ) {
+    occupancy_[i] = value;
+    packingMasks_.clear();
+  }
   void setDepth0PccIdx( size_t i, int64_t value ) { depth0PCidx_[i] = value; }
   void setDepthEOM( size_t i, int16_t value ) { depthEOM_[i] = value; }
   void setAxisOfAdditionalPlane( size_t value ) { axisOfAdditionalPlane_ = value; }
@@ -168,10 +175,16 @@ class PCCPatch {
   void setPatchSize2DYInPixel( size_t value ) { size2DYInPixel_ = value; }
 
   void allocDepth( size_t i, size_t size, int16_t value ) { depth_[i].resize( size, value ); }
-  void allocOccupancy( size_t size, bool value ) { occupancy_.resize( size, value ); }
+  void allocOccupancy( size_t size, bool value ) {
+    occupancy_.resize( size, value );
+    packingMasks_.clear();
+  }
   void allocDepth0PccIdx( size_t size, int64_t value ) { depth0PCidx_.resize( size, value ); }
   void allocDepthEOM( size_t size, int16_t value ) { depthEOM_.resize( size, value ); }
-  void clearOccupancy() { occupancy_.clear(); }
+  void clearOccupancy() {
+    occupancy_.clear();
+    packingMasks_.clear();
+  }
   void clearDepth( size_t i ) { depth_[i].clear(); }
 
   inline double generateNormalCoordinate( const uint16_t depth ) const {
@@ -216,12 +229,27 @@ class PCCPatch {
                                  size_t       canvasHeightBlk,
                                  const Tile   tile = Tile() ) const;
 
-  bool checkFitPatchCanvas( std::vector<bool> canvas,
-                            size_t            canvasStrideBlk,
-                            size_t            canvasHeightBlk,
-                            bool              bPrecedence,
-                            int               safeguard = 0,
-                            const Tile        tile      = Tile() );
+  bool checkFitPatchCanvas( const PCCPackingCanvas& canvas,
+                            size_t                  canvasStrideBlk,
+                            size_t                  canvasHeightBlk,
+                            bool                    bPrecedence,
+                            int                     safeguard = 0,
+                            const Tile              tile      = Tile() );
+
+  // fit test of the patch placed at ( u0, v0 ) with the given orientation, which does not modify the patch and can be
+  // called concurrently; updatePackingMask() caches beforehand the masks of the orientations tested with bPrecedence
+  bool checkFitPatchCanvas( const PCCPackingCanvas& canvas,
+                            const size_t            orientation,
+                            const size_t            u0,
+                            const size_t            v0,
+                            size_t                  canvasStrideBlk,
+                            size_t                  canvasHeightBlk,
+                            bool                    bPrecedence,
+                            int                     safeguard,
+                            const Tile              tile = Tile() ) const;
+  void updatePackingMask( const size_t orientation, const int safeguard ) {
+    addPackingMask( orientation, sizeU0_, sizeV0_, safeguard );
+  }
 
   bool        smallerRefFirst( const PCCPatch& rhs );
   bool        gt( const PCCPatch& rhs );
@@ -271,11 +299,11 @@ class PCCPatch {
                                     size_t       canvasStrideBlk,
                                     size_t       canvasHeightBlk ) const;
 
-  bool checkFitPatchCanvasForGPA( std::vector<bool> canvas,
-                                  size_t            canvasStrideBlk,
-                                  size_t            canvasHeightBlk,
-                                  bool              bPrecedence,
-                                  int               safeguard = 0 );
+  bool checkFitPatchCanvasForGPA( const PCCPackingCanvas& canvas,
+                                  size_t                  canvasStrideBlk,
+                                  size_t                  canvasHeightBlk,
+                                  bool                    bPrecedence,
+                                  int                     safeguard = 0 );
 
   void     allocOneLayerData();
   uint8_t& getPointLocalReconstructionLevel() { return pointLocalReconstructionLevel_; }
@@ -350,6 +378,41 @@ class PCCPatch {
                   std::vector<PCCPatch>& patches );
 
  private:
+  // blocks of the canvas that must be free to place the patch with a given orientation and safeguard when the
+  // precedence is given to the occupied blocks, see PCCPackingCanvas::intersects()
+  struct PackingMask {
+    size_t                orientation_;
+    size_t                sizeU0_;
+    size_t                sizeV0_;
+    size_t                occupancyStride_;
+    int                   safeguard_;
+    std::vector<uint64_t> bits_;
+  };
+  const PackingMask* findPackingMask( const size_t orientation,
+                                      const size_t sizeU0,
+                                      const size_t sizeV0,
+                                      const int    safeguard ) const;
+  void               createPackingMask( PackingMask& mask,
+                                        const size_t orientation,
+                                        const size_t sizeU0,
+                                        const size_t sizeV0,
+                                        const int    safeguard ) const;
+  void               addPackingMask( const size_t orientation,
+                                     const size_t sizeU0,
+                                     const size_t sizeV0,
+                                     const int    safeguard );
+  bool               checkFitPatchCanvas( const PCCPackingCanvas& canvas,
+                                          const size_t            orientation,
+                                          const size_t            u0,
+                                          const size_t            v0,
+                                          const size_t            sizeU0,
+                                          const size_t            sizeV0,
+                                          size_t                  canvasStrideBlk,
+                                          size_t                  canvasHeightBlk,
+                                          bool                    bPrecedence,
+                                          int                     safeguard,
+                                          const Tile&             tile ) const;
+
   size_t                  index_;          // patch index
   size_t                  originalIndex_;  // patch original index
   size_t                  frameIndex_;     // Frame index
@@ -406,6 +469,8 @@ class PCCPatch {
   std::vector<int16_t>    depthMap_;            // Depth map
   std::vector<uint8_t>    occupancyMap_;        // Occupancy map
   std::vector<PCCPoint3D> borderPoints_;        // 3D points created from borders of the patch
+
+  std::vector<PackingMask> packingMasks_;  // masks of the orientations tried so far
 };
 
 class PatchBlockFiltering {
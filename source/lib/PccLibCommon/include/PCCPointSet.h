@@ -36,60 +36,64 @@
 
 #include "PCCCommon.h"
 #include "PCCMath.h"
+#include <atomic>
 
 namespace pcc {
 
+class PCCKdTreeCache;
+
+// Point cloud stored as one vector per channel. Only the positions are always present: the other channels are
+// allocated by their add*() function and then follow the resizes of the point cloud.
 class PCCPointSet3 {
  public:
-  PCCPointSet3() : withNormals_( false ), withColors_( false ), withReflectances_( false ) {}
+  typedef std::pair<uint16_t, uint32_t> PointPatchIndex;  // tile index, patch index
+
+  PCCPointSet3() :
+      withNormals_( false ),
+      withColors_( false ),
+      withColors16bit_( false ),
+      withReflectances_( false ),
+      withBoundaryPointTypes_( false ),
+      withPointPatchIndexes_( false ),
+      withParentPointIndexes_( false ) {}
   PCCPointSet3( const PCCPointSet3& ) = default;
+  PCCPointSet3( PCCPointSet3&& )      = default;
   PCCPointSet3& operator=( const PCCPointSet3& rhs ) = default;
-  ~PCCPointSet3()                                    = default;
+  PCCPointSet3& operator=( PCCPointSet3&& rhs ) = default;
+  ~PCCPointSet3();
 
-  PCCPoint3D operator[]( const size_t index ) const {
-    assert( index < positions_.size() );
-    return positions_[index];
-  }
-  PCCPoint3D& operator[]( const size_t index ) {
+  // the positions are read through the const accessors and written by setPosition() or the non-const getPositions(),
+  // which mark them as modified for the KD-tree cache
+  const PCCPoint3D& operator[]( const size_t index ) const {
     assert( index < positions_.size() );
     return positions_[index];
   }
   size_t appendPointSet( PCCPointSet3& pointSet ) {
-    std::vector<PCCPoint3D>::iterator                itPositions;
-    std::vector<PCCColor3B>::iterator                itColors;
-    std::vector<PCCColor16bit>::iterator             itColors16bit;
-    std::vector<uint16_t>::iterator                  itReflectances;
-    std::vector<uint16_t>::iterator                  itBoundaryPointTypes;
-    std::vector<std::pair<size_t, size_t>>::iterator itPointPatchIndexes;
-    std::vector<uint8_t>::iterator                   itTypes;
-    std::vector<PCCNormal3D>::iterator               itNormals;
-
-    itPositions          = positions_.end();
-    itColors             = colors_.end();
-    itColors16bit        = colors16bit_.end();
-    itReflectances       = reflectances_.end();
-    itBoundaryPointTypes = boundaryPointTypes_.end();
-    itPointPatchIndexes  = pointPatchIndexes_.end();
-    itTypes              = types_.end();
-    itNormals            = normals_.end();
-
-    positions_.insert( itPositions, pointSet.getPositions().begin(), pointSet.getPositions().end() );
-    colors_.insert( itColors, pointSet.getColor().begin(), pointSet.getColor().end() );
-    colors16bit_.insert( itColors16bit, pointSet.getColor16bit().begin(), pointSet.getColor16bit().end() );
-    reflectances_.insert( itReflectances, pointSet.getReflectances().begin(), pointSet.getReflectances().end() );
-    boundaryPointTypes_.insert( itBoundaryPointTypes, pointSet.getBoundaryPointTypes().begin(),
-                                pointSet.getBoundaryPointTypes().end() );
-    pointPatchIndexes_.insert( itPointPatchIndexes, pointSet.getPointPatchIndexes().begin(),
-                               pointSet.getPointPatchIndexes().end() );
-    types_.insert( itTypes, pointSet.getTypes().begin(), pointSet.getTypes().end() );
-    normals_.insert( itNormals, pointSet.getNormals().begin(), pointSet.getNormals().end() );
-
-    resize( getPointCount() );
+    const size_t count = getPointCount();
+    if ( pointSet.hasColors() && !hasColors() ) { addColors(); }
+    if ( pointSet.hasColors16bit() && !hasColors16bit() ) { addColors16bit(); }
+    if ( pointSet.hasReflectances() && !hasReflectances() ) { addReflectances(); }
+    if ( pointSet.hasNormals() && !hasNormals() ) { addNormals(); }
+    if ( pointSet.hasBoundaryPointTypes() && !hasBoundaryPointTypes() ) { addBoundaryPointTypes(); }
+    if ( pointSet.hasPointPatchIndexes() && !hasPointPatchIndexes() ) { addPointPatchIndexes(); }
+    if ( pointSet.hasParentPointIndexes() && !hasParentPointIndexes() ) { addParentPointIndexes(); }
+    resize( count + pointSet.getPointCount() );
+    auto append = [count]( const auto& src, auto& dst ) { std::copy( src.begin(), src.end(), dst.begin() + count ); };
+    append( pointSet.positions_, positions_ );
+    if ( pointSet.hasColors() ) { append( pointSet.colors_, colors_ ); }
+    if ( pointSet.hasColors16bit() ) { append( pointSet.colors16bit_, colors16bit_ ); }
+    if ( pointSet.hasReflectances() ) { append( pointSet.reflectances_, reflectances_ ); }
+    if ( pointSet.hasNormals() ) { append( pointSet.normals_, normals_ ); }
+    if ( pointSet.hasBoundaryPointTypes() ) { append( pointSet.boundaryPointTypes_, boundaryPointTypes_ ); }
+    if ( pointSet.hasPointPatchIndexes() ) { append( pointSet.pointPatchIndexes_, pointPatchIndexes_ ); }
+    if ( pointSet.hasParentPointIndexes() ) { append( pointSet.parentPointIndexes_, parentPointIndexes_ ); }
+    if ( PCC_SAVE_POINT_TYPE ) { append( pointSet.types_, types_ ); }
     return positions_.size();
   }
   std::vector<uint16_t>& getBoundaryPointTypes() { return boundaryPointTypes_; }
   void                   setPosition( const size_t index, const PCCPoint3D position ) {
     assert( index < positions_.size() );
+    kdtreeCacheState_.setModified();
     positions_[index] = position;
   }
   std::vector<PCCColor3B>& getColor() { return colors_; }
@@ -107,15 +111,15 @@ class PCCPointSet3 {
   }
   std::vector<PCCColor16bit>& getColor16bit() { return colors16bit_; }
   PCCColor16bit               getColor16bit( const size_t index ) const {
-    assert( index < colors16bit_.size() && withColors_ );
+    assert( index < colors16bit_.size() && withColors16bit_ );
     return colors16bit_[index];
   }
   PCCColor16bit& getColor16bit( const size_t index ) {
-    assert( index < colors16bit_.size() && withColors_ );
+    assert( index < colors16bit_.size() && withColors16bit_ );
     return colors16bit_[index];
   }
   void setColor16bit( const size_t index, const PCCColor16bit color16bit ) {
-    assert( index < colors16bit_.size() && withColors_ );
+    assert( index < colors16bit_.size() && withColors16bit_ );
     colors16bit_[index] = color16bit;
   }
   void copyRGB16ToRGB8() {
@@ -165,6 +169,11 @@ class PCCPointSet3 {
     }
   }
 
+  bool hasBoundaryPointTypes() const { return withBoundaryPointTypes_; }
+  void addBoundaryPointTypes() {
+    withBoundaryPointTypes_ = true;
+    resize( getPointCount() );
+  }
   uint16_t getBoundaryPointType( const size_t index ) const {
     assert( index < boundaryPointTypes_.size() );
     return boundaryPointTypes_[index];
@@ -177,25 +186,35 @@ class PCCPointSet3 {
     assert( index < boundaryPointTypes_.size() );
     boundaryPointTypes_[index] = BoundaryPointType;
   }
-  std::vector<std::pair<size_t, size_t>>& getPointPatchIndexes() { return pointPatchIndexes_; }
-  std::pair<size_t, size_t>               getPointPatchIndex( const size_t index ) const {
+  bool hasPointPatchIndexes() const { return withPointPatchIndexes_; }
+  void addPointPatchIndexes() {
+    withPointPatchIndexes_ = true;
+    resize( getPointCount() );
+  }
+  std::vector<PointPatchIndex>& getPointPatchIndexes() { return pointPatchIndexes_; }
+  PointPatchIndex               getPointPatchIndex( const size_t index ) const {
     assert( index < pointPatchIndexes_.size() );
     return pointPatchIndexes_[index];
   }
-  std::pair<size_t, size_t>& getPointPatchIndex( const size_t index ) {
+  PointPatchIndex& getPointPatchIndex( const size_t index ) {
     assert( index < pointPatchIndexes_.size() );
     return pointPatchIndexes_[index];
   }
   void setPointPatchIndex( const size_t index, const uint32_t tileIndex, const uint32_t patchIndex ) {
     assert( index < pointPatchIndexes_.size() );
-    pointPatchIndexes_[index].first  = tileIndex;
+    pointPatchIndexes_[index].first  = static_cast<uint16_t>( tileIndex );
     pointPatchIndexes_[index].second = patchIndex;
   }
-  std::vector<uint64_t>& getParentPointIndex() { return parentPointIndex_; }
-  uint64_t&              getParentPointIndex( const size_t index ) { return parentPointIndex_[index]; }
-  void                   setParentPointIndex( const size_t index, const uint64_t parentIndex ) {
-    assert( index < parentPointIndex_.size() );
-    parentPointIndex_[index] = parentIndex;
+  bool hasParentPointIndexes() const { return withParentPointIndexes_; }
+  void addParentPointIndexes() {
+    withParentPointIndexes_ = true;
+    resize( getPointCount() );
+  }
+  std::vector<uint32_t>& getParentPointIndex() { return parentPointIndexes_; }
+  uint32_t&              getParentPointIndex( const size_t index ) { return parentPointIndexes_[index]; }
+  void                   setParentPointIndex( const size_t index, const size_t parentIndex ) {
+    assert( index < parentPointIndexes_.size() );
+    parentPointIndexes_[index] = static_cast<uint32_t>( parentIndex );
   }
   uint16_t getReflectance( const size_t index ) const {
     assert( index < reflectances_.size() && withReflectances_ );
@@ -209,11 +228,15 @@ class PCCPointSet3 {
     assert( index < reflectances_.size() && withReflectances_ );
     reflectances_[index] = reflectance;
   }
-  std::vector<PCCPoint3D>&    getPositions() { return positions_; }
-  std::vector<PCCColor3B>&    getColors() { return colors_; }
-  std::vector<PCCColor16bit>& getColors16bit() { return colors16bit_; }
-  std::vector<uint16_t>&      getReflectances() { return reflectances_; }
-  std::vector<uint8_t>&       getTypes() { return types_; }
+  std::vector<PCCPoint3D>& getPositions() {
+    kdtreeCacheState_.setModified();
+    return positions_;
+  }
+  const std::vector<PCCPoint3D>& getPositions() const { return positions_; }
+  std::vector<PCCColor3B>&       getColors() { return colors_; }
+  std::vector<PCCColor16bit>&    getColors16bit() { return colors16bit_; }
+  std::vector<uint16_t>&         getReflectances() { return reflectances_; }
+  std::vector<uint8_t>&          getTypes() { return types_; }
 
   bool hasReflectances() const { return withReflectances_; }
   void addReflectances() {
@@ -245,18 +268,25 @@ class PCCPointSet3 {
   void removeColors() {
     withColors_ = false;
     colors_.resize( 0 );
+    removeColors16bit();
   }
+  bool hasColors16bit() const { return withColors16bit_; }
   void addColors16bit() {
-    withColors_ = true;
+    withColors_      = true;
+    withColors16bit_ = true;
     resize( getPointCount() );
   }
   void removeColors16bit() {
-    withColors_ = false;
+    withColors16bit_ = false;
     colors16bit_.resize( 0 );
   }
-  const std::vector<PCCNormal3D>& getNormals() const { return normals_; }
-  bool                            hasNormals() const { return withNormals_; }
-  void                            addNormals() {
+  const std::vector<PCCNormal3F>& getNormals() const { return normals_; }
+  PCCNormal3D                     getNormal( const size_t index ) const {
+    assert( index < normals_.size() );
+    return normals_[index];
+  }
+  bool hasNormals() const { return withNormals_; }
+  void addNormals() {
     withNormals_ = true;
     resize( getPointCount() );
   }
@@ -301,7 +331,9 @@ class PCCPointSet3 {
                        double        maxColorDist2Fwd                        = 10000.0,
                        double        maxColorDist2Bwd                        = 10000.0,
                        const bool    excludeColorOutlier                     = false,
-                       const double  thresholdColorOutlierDist               = 10.0 ) const;
+                       const double  thresholdColorOutlierDist               = 10.0,
+                       PCCKdTreeCache* kdtreeCache                           = nullptr,
+                       const size_t    nbThread                              = 0 ) const;
 
   bool transferColors16bitBP( PCCPointSet3& target,
                               const int     filterType,
@@ -320,7 +352,8 @@ class PCCPointSet3 {
                               double        maxColorDist2Fwd                        = 10000.0,
                               double        maxColorDist2Bwd                        = 10000.0,
                               const bool    excludeColorOutlier                     = false,
-                              const double  thresholdColorOutlierDist               = 10.0 ) const;
+                              const double  thresholdColorOutlierDist               = 10.0,
+                              const size_t  nbThread                                = 0 ) const;
   bool transferColorsBackward16bitBP( PCCPointSet3& target,
                                       const int     filterType,
                                       const int32_t searchRange,
@@ -338,7 +371,8 @@ class PCCPointSet3 {
                                       double        maxColorDist2Fwd,
                                       double        maxColorDist2Bwd,
                                       const bool    excludeColorOutlier       = false,
-                                      const double  thresholdColorOutlierDist = 10.0 ) const;
+                                      const double  thresholdColorOutlierDist = 10.0,
+                                      const size_t  nbThread                  = 0 ) const;
 
   bool transferColors16bit( PCCPointSet3& target,
                             const int32_t searchRange,
@@ -356,7 +390,8 @@ class PCCPointSet3 {
                             double        maxColorDist2Fwd                        = 10000.0,
                             double        maxColorDist2Bwd                        = 10000.0,
                             const bool    excludeColorOutlier                     = false,
-                            const double  thresholdColorOutlierDist               = 10.0 ) const;
+                            const double  thresholdColorOutlierDist               = 10.0,
+                            const size_t  nbThread                                = 0 ) const;
 
   bool transferColorsFilter3( PCCPointSet3& target, const int32_t searchRange, const bool losslessAttribute ) const;
 
@@ -366,31 +401,31 @@ class PCCPointSet3 {
 
   size_t getPointCount() const { return positions_.size(); }
   void   resize( const size_t size ) {
+    // the add*() functions resize the point cloud to its own size to allocate their channel
+    if ( size != positions_.size() ) { kdtreeCacheState_.setModified(); }
     positions_.resize( size );
-    if ( hasColors() ) {
-      colors_.resize( size );
-      colors16bit_.resize( size );
-    }
+    if ( hasColors() ) { colors_.resize( size ); }
+    if ( hasColors16bit() ) { colors16bit_.resize( size ); }
     if ( hasReflectances() ) { reflectances_.resize( size ); }
     if ( PCC_SAVE_POINT_TYPE ) { types_.resize( size ); }
     if ( hasNormals() ) { normals_.resize( size ); }
-    boundaryPointTypes_.resize( size );
-    pointPatchIndexes_.resize( size );
-    parentPointIndex_.resize( size );
+    if ( hasBoundaryPointTypes() ) { boundaryPointTypes_.resize( size ); }
+    if ( hasPointPatchIndexes() ) { pointPatchIndexes_.resize( size ); }
+    if ( hasParentPointIndexes() ) { parentPointIndexes_.resize( size ); }
   }
   void reserve( const size_t size ) {
     positions_.reserve( size );
-    if ( hasColors() ) {
-      colors_.reserve( size );
-      colors16bit_.reserve( size );
-    }
+    if ( hasColors() ) { colors_.reserve( size ); }
+    if ( hasColors16bit() ) { colors16bit_.reserve( size ); }
     if ( hasReflectances() ) { reflectances_.reserve( size ); }
     if ( PCC_SAVE_POINT_TYPE ) { types_.reserve( size ); }
-    boundaryPointTypes_.reserve( size );
-    pointPatchIndexes_.reserve( size );
-    parentPointIndex_.reserve( size );
+    if ( hasNormals() ) { normals_.reserve( size ); }
+    if ( hasBoundaryPointTypes() ) { boundaryPointTypes_.reserve( size ); }
+    if ( hasPointPatchIndexes() ) { pointPatchIndexes_.reserve( size ); }
+    if ( hasParentPointIndexes() ) { parentPointIndexes_.reserve( size ); }
   }
   void clear() {
+    kdtreeCacheState_.setModified();
     positions_.clear();
     colors_.clear();
     colors16bit_.clear();
@@ -398,7 +433,7 @@ class PCCPointSet3 {
     if ( PCC_SAVE_POINT_TYPE ) { types_.clear(); }
     boundaryPointTypes_.clear();
     pointPatchIndexes_.clear();
-    parentPointIndex_.clear();
+    parentPointIndexes_.clear();
     normals_.clear();
   }
   size_t addPoint( const PCCPoint3D& position ) {
@@ -439,7 +474,8 @@ class PCCPointSet3 {
   void swapPoints( const size_t index1, const size_t index2 ) {
     assert( index1 < getPointCount() );
     assert( index2 < getPointCount() );
-    std::swap( ( *this )[index1], ( *this )[index2] );
+    kdtreeCacheState_.setModified();
+    std::swap( positions_[index1], positions_[index2] );
     if ( hasColors() ) { std::swap( getColor( index1 ), getColor( index2 ) ); }
     if ( hasReflectances() ) { std::swap( getReflectance( index1 ), getReflectance( index2 ) ); }
     if ( PCC_SAVE_POINT_TYPE ) { std::swap( getType( index1 ), getType( index2 ) ); }
@@ -477,6 +513,11 @@ class PCCPointSet3 {
   }
   bool write( const std::string& fileName, const bool asAscii = false );
   bool read( const std::string& fileName, const bool readNormals = false );
+
+  // binary dump of the point set decoded from sourceFileName with the given options, valid while the source file is
+  // unchanged
+  bool writeCache( const std::string& fileName, const std::string& sourceFileName, const uint32_t options ) const;
+  bool readCache( const std::string& fileName, const std::string& sourceFileName, const uint32_t options );
   void convertRGBToYUV();
   void convertRGBToYUVClosedLoop();
   void convertYUVToRGB();
@@ -503,6 +544,26 @@ class PCCPointSet3 {
   void                 swap( PCCPointSet3& newPointcloud );
 
  private:
+  friend class PCCKdTreeCache;
+
+  // State of the point cloud in the KD-tree cache that indexes it: the cache evicts its tree when the point cloud is
+  // destroyed and rebuilds it when the positions were modified since it was built. A copy is a new point cloud for the
+  // caches, and an assignment modifies the positions.
+  struct KdTreeCacheState {
+    KdTreeCacheState() : cache_( nullptr ), modified_( true ) {}
+    KdTreeCacheState( const KdTreeCacheState& ) : KdTreeCacheState() {}
+    KdTreeCacheState& operator=( const KdTreeCacheState& ) {
+      setModified();
+      return *this;
+    }
+    // the flag is only written when it changes, so that the concurrent writers of the positions do not contend on it
+    void setModified() {
+      if ( !modified_.load( std::memory_order_relaxed ) ) { modified_.store( true, std::memory_order_relaxed ); }
+    }
+    std::atomic<PCCKdTreeCache*> cache_;
+    std::atomic<bool>            modified_;
+  };
+
   void distance( const PCCPointSet3& pointcloud,
                  float&              distPAB,
                  float&              distPBA,
@@ -517,18 +578,23 @@ class PCCPointSet3 {
   void distance( const PCCPointSet3& pointcloud, float& distP ) const;
   std::vector<uint8_t> computeMd5();
 
-  std::vector<PCCPoint3D>                positions_;
-  std::vector<PCCColor3B>                colors_;
-  std::vector<PCCColor16bit>             colors16bit_;
-  std::vector<uint16_t>                  reflectances_;
-  std::vector<uint16_t>                  boundaryPointTypes_;
-  std::vector<std::pair<size_t, size_t>> pointPatchIndexes_;
-  std::vector<uint64_t>                  parentPointIndex_;
-  std::vector<uint8_t>                   types_;
-  std::vector<PCCNormal3D>               normals_;
-  bool                                   withNormals_;
-  bool                                   withColors_;
-  bool                                   withReflectances_;
+  std::vector<PCCPoint3D>      positions_;
+  std::vector<PCCColor3B>      colors_;
+  std::vector<PCCColor16bit>   colors16bit_;
+  std::vector<uint16_t>        reflectances_;
+  std::vector<uint16_t>        boundaryPointTypes_;
+  std::vector<PointPatchIndex> pointPatchIndexes_;
+  std::vector<uint32_t>        parentPointIndexes_;
+  std::vector<uint8_t>         types_;
+  std::vector<PCCNormal3F>     normals_;
+  bool                         withNormals_;
+  bool                         withColors_;
+  bool                         withColors16bit_;
+  bool                         withReflectances_;
+  bool                         withBoundaryPointTypes_;
+  bool                         withPointPatchIndexes_;
+  bool                         withParentPointIndexes_;
+  mutable KdTreeCacheState     kdtreeCacheState_;
 };
 }  // namespace pcc
 
@@ -33,6 +33,7 @@
 #pragma once
 
 #include "PCCCommon.h"
+#include <functional>
 #ifndef _WIN32
 #include <cstdlib>
 #endif
@@ -48,6 +49,60 @@ int system( const char* command ) noexcept;
 #else
 static inline int system( const char* command ) { return ::system( command ); }
 #endif
+
+/**
+ * named pipes used to stream raw videos between TMC2 and the external video
+ * codec applications instead of intermediate YUV files.
+ */
+bool namedPipesSupported();
+bool createNamedPipe( const std::string& name );
+
+/**
+ * run a system command while the input pipe is filled by source and the
+ * output pipe is drained by sink. An empty pipe name disables that side. The
+ * return value is non-zero if the command failed or a stream was not fully
+ * transferred.
+ */
+int systemWithNamedPipes( const char*                                 command,
+                          const std::string&                          inputPipe,
+                          const std::function<bool( std::ostream& )>& source,
+                          const std::string&                          outputPipe,
+                          const std::function<bool( std::istream& )>& sink );
+
+/**
+ * name of a file next to fileName that is unique to the calling process and
+ * thread, to write a file aside before moving it in place with replaceFile().
+ */
+std::string getTemporaryFileName( const std::string& fileName );
+
+/**
+ * move source in place of target, atomically replacing an existing target
+ * where the platform supports it.
+ */
+bool replaceFile( const std::string& source, const std::string& target );
+
+/**
+ * read-only view of a whole file, memory mapped where the platform supports
+ * it and loaded in a single read otherwise.
+ */
+class PCCMappedFile {
+ public:
+  PCCMappedFile() = default;
+  PCCMappedFile( const PCCMappedFile& ) = delete;
+  PCCMappedFile& operator=( const PCCMappedFile& ) = delete;
+  ~PCCMappedFile() { close(); }
+
+  bool        open( const std::string& fileName );
+  void        close();
+  const char* data() const { return data_; }
+  size_t      size() const { return size_; }
+
+ private:
+  const char*       data_   = nullptr;
+  size_t            size_   = 0;
+  bool              mapped_ = false;
+  std::vector<char> buffer_;
+};
 }  // namespace pcc
 
 //===========================================================================
@@ -50,6 +50,10 @@ class PCCVideo {
     for ( auto& frame : frames_ ) { frame.clear(); }
     frames_.clear();
   }
+  // free the pictures preceding frameCount, once no later frame references them
+  void releaseFrames( const size_t frameCount ) {
+    for ( size_t i = 0; i < ( std::min )( frameCount, frames_.size() ); i++ ) { frames_[i].release(); }
+  }
 
   typename std::vector<PCCImage<T, N> >::iterator begin() { return frames_.begin(); }
   typename std::vector<PCCImage<T, N> >::iterator end() { return frames_.end(); }
@@ -108,14 +112,15 @@ class PCCVideo {
 
   void upsample( size_t rate );
 
- private:
-  bool write( std::ofstream& outfile, const size_t nbyte );
-  bool read( std::ifstream&       infile,
+  // raw frame source and sink used to stream videos through pipes.
+  bool write( std::ostream& outfile, const size_t nbyte );
+  bool read( std::istream&        infile,
              const size_t         sizeU0,
              const size_t         sizeV0,
              const PCCCOLORFORMAT format,
              const size_t         nbyte );
 
+ private:
   std::vector<PCCImage<T, N> > frames_;
 };
 
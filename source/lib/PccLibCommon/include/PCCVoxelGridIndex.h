@@ -0,0 +1,93 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PCCVoxelGridIndex_h
+#define PCCVoxelGridIndex_h
+
+#include "PCCCommon.h"
+#include "PCCMath.h"
+
+namespace pcc {
+class PCCPointSet3;
+
+// Exact nearest neighbour index of a voxelized point cloud. The points are sorted by the Morton code of their
+// coordinates, so that the points of each block of 8x8x8 voxels are contiguous, and the occupied blocks are found
+// through a hash table. The searches visit the blocks by growing shells around the query and fill caller provided
+// buffers with squared integer distances; equidistant neighbours are ordered by increasing index.
+class PCCVoxelGridIndex {
+ public:
+  struct Neighbor {
+    int64_t  dist2_;
+    uint32_t index_;
+    bool     operator<( const Neighbor& rhs ) const {
+      return dist2_ < rhs.dist2_ || ( dist2_ == rhs.dist2_ && index_ < rhs.index_ );
+    }
+  };
+
+  PCCVoxelGridIndex();
+  PCCVoxelGridIndex( const PCCPointSet3& pointCloud );
+  ~PCCVoxelGridIndex();
+  void   init( const PCCPointSet3& pointCloud );
+  void   clear();
+  size_t getPointCount() const { return indices_.size(); }
+
+  // numResults nearest neighbours of point sorted by distance, returns the number of neighbours written
+  size_t search( const PCCPoint3D& point, const size_t numResults, Neighbor* neighbors ) const;
+
+  // at most numResults nearest neighbours of point with a squared distance lower than radius2, sorted by distance
+  size_t searchRadius( const PCCPoint3D& point, const size_t numResults, const double radius2, Neighbor* neighbors ) const;
+
+ private:
+  struct Block {
+    uint64_t key_;
+    uint32_t begin_;
+    uint32_t end_;
+  };
+  const Block* findBlock( int32_t x, int32_t y, int32_t z ) const;
+  void         searchBlock( const Block&      block,
+                            const PCCPoint3D& point,
+                            const size_t      numResults,
+                            const int64_t     maxDist2,
+                            Neighbor*         neighbors,
+                            size_t&           count ) const;
+
+  std::vector<PCCPoint3D> points_;
+  std::vector<uint32_t>   indices_;
+  std::vector<Block>      blocks_;
+  uint64_t                blockMask_;
+  int32_t                 blockMin_[3];
+  int32_t                 blockMax_[3];
+};
+
+}  // namespace pcc
+
+#endif /* PCCVoxelGridIndex_h */
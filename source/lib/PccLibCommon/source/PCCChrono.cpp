@@ -88,6 +88,25 @@ pcc::chrono::utime_self_clock::time_point pcc::chrono::utime_self_clock::now() n
 
 //---------------------------------------------------------------------------
 
+#if _WIN32
+pcc::chrono::utime_thread_clock::time_point pcc::chrono::utime_thread_clock::now() noexcept {
+  HANDLE   hThread = GetCurrentThread();
+  FILETIME dummy;
+  FILETIME userTime;
+
+  GetThreadTimes( hThread, &dummy, &dummy, &dummy, &userTime );
+
+  ULARGE_INTEGER val;
+  val.LowPart  = userTime.dwLowDateTime;
+  val.HighPart = userTime.dwHighDateTime;
+
+  using hundredns = std::chrono::duration<int64_t, std::ratio<1, 10000000>>;
+  return time_point( hundredns( val.QuadPart ) );
+}
+#endif
+
+//---------------------------------------------------------------------------
+
 #if HAVE_GETRUSAGE
 pcc::chrono::utime_self_clock::time_point pcc::chrono::utime_self_clock::now() noexcept {
   struct rusage usage;
@@ -114,4 +133,22 @@ pcc::chrono::utime_children_clock::time_point pcc::chrono::utime_children_clock:
 }
 #endif
 
+//---------------------------------------------------------------------------
+
+#if HAVE_GETRUSAGE
+pcc::chrono::utime_thread_clock::time_point pcc::chrono::utime_thread_clock::now() noexcept {
+  struct rusage usage;
+#if defined( RUSAGE_THREAD )
+  getrusage( RUSAGE_THREAD, &usage );
+#else
+  getrusage( RUSAGE_SELF, &usage );
+#endif
+
+  std::chrono::nanoseconds total;
+  total = std::chrono::seconds( usage.ru_utime.tv_sec ) + std::chrono::microseconds( usage.ru_utime.tv_usec );
+
+  return time_point( total );
+}
+#endif
+
 //===========================================================================
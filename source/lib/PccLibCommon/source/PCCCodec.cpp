@@ -537,6 +537,8 @@ void PCCCodec::generatePointCloud( PCCPointSet3&                       reconstru
   uint32_t     patchIndex            = 0;
   const size_t mapCount              = params.mapCountMinus1_ + 1;
   reconstruct.addColors();
+  reconstruct.addBoundaryPointTypes();
+  reconstruct.addPointPatchIndexes();
   printf( "generatePointCloud pbfEnableFlag_ = %d \n", params.pbfEnableFlag_ );
   fflush( stdout );
   TRACE_CODEC( "generatePointCloud pbfEnableFlag_ = %d \n", params.pbfEnableFlag_ );
@@ -979,7 +981,7 @@ void PCCCodec::generatePointCloud( PCCPointSet3&                       reconstru
 #endif
 }
 
-void PCCCodec::addGridCentroid( PCCPoint3D&                     point,
+void PCCCodec::addGridCentroid( const PCCPoint3D&               point,
                                 uint32_t                        patchIdx,
                                 std::vector<uint16_t>&          count,
                                 std::vector<PCCVector3<float>>& centerGrid,
@@ -1096,7 +1098,7 @@ void PCCCodec::smoothPointCloudGrid( PCCPointSet3&                       reconst
       if ( dist2 >= ( std::max )( static_cast<int>( params.thresholdSmoothing_ ), count ) * 2 ) {
         centroid = centroid / static_cast<double>( count ) + 0.5;
         for ( size_t k = 0; k < 3; ++k ) { centroid[k] = double( int64_t( centroid[k] ) ); }
-        reconstruct[c] = centroid;
+        reconstruct.setPosition( c, centroid );
         if ( PCC_SAVE_POINT_TYPE == 1 ) { reconstruct.setType( c, POINT_SMOOTH ); }
         reconstruct.setBoundaryPointType( c, static_cast<uint16_t>( 3 ) );
       }
@@ -1146,28 +1148,29 @@ void PCCCodec::smoothPointCloud( PCCPointSet3&                      reconstruct,
           centroid[k] = double( int64_t( ( centroid[k] + ( neighborCount / 2 ) ) / neighborCount ) );
         }
         if ( distToCentroid2 >= params.thresholdSmoothing_ ) {
-          temp[i] = centroid;
+          temp.setPosition( i, centroid );
           reconstruct.setColor( i, PCCColor3B( 255, 0, 0 ) );
           if ( PCC_SAVE_POINT_TYPE == 1 ) { reconstruct.setType( i, POINT_SMOOTH ); }
         } else {
-          temp[i] = reconstruct[i];
+          temp.setPosition( i, reconstruct[i] );
         }
       } else {
-        temp[i] = reconstruct[i];
+        temp.setPosition( i, reconstruct[i] );
       }
 #if defined( ENABLE_TBB )
     } );
   } );
-  limited.execute(
-      [&] { tbb::parallel_for( size_t( 0 ), pointCount, [&]( const size_t i ) { reconstruct[i] = temp[i]; } ); } );
+  limited.execute( [&] {
+    tbb::parallel_for( size_t( 0 ), pointCount, [&]( const size_t i ) { reconstruct.setPosition( i, temp[i] ); } );
+  } );
 #else
   }
-  for ( size_t i = 0; i < pointCount; i++ ) { reconstruct[i] = temp[i]; }
+  for ( size_t i = 0; i < pointCount; i++ ) { reconstruct.setPosition( i, temp[i] ); }
 #endif
   TRACE_CODEC( "%s \n", "smoothPointCloud done" );
 }
 
-void PCCCodec::addGridColorCentroid( PCCPoint3D&                             point,
+void PCCCodec::addGridColorCentroid( const PCCPoint3D&                       point,
                                      PCCVector3D&                            color,
                                      std::pair<size_t, size_t>               tilePatchIdx,
                                      std::vector<uint16_t>&                  colorGridCount,
@@ -1618,15 +1621,31 @@ void PCCCodec::generateOccupancyMap( PCCFrameContext&      tile,
 
 void PCCCodec::generateTileBlockToPatchFromOccupancyMapVideo( PCCContext&  context,
                                                               const size_t occupancyResolution,
-                                                              const size_t occupancyPrecision ) {
-  for ( int fi = 0; fi < context.size(); fi++ ) {
+                                                              const size_t occupancyPrecision,
+                                                              const size_t nbThread ) {
+  // each tile only reads its own area of the occupancy map video and writes its own block to patch map
+#if defined( ENABLE_TBB )
+  tbb::task_arena limited( static_cast<int>( nbThread ) );
+  limited.execute( [&] {
+    tbb::parallel_for( size_t( 0 ), context.size(), [&]( const size_t fi ) {
+      PCCImageOccupancyMap& occupancyImage = context.getVideoOccupancyMap().getFrame( fi );
+      tbb::parallel_for( size_t( 0 ), context[fi].getNumTilesInAtlasFrame(), [&]( const size_t tileIdx ) {
+#else
+  for ( size_t fi = 0; fi < context.size(); fi++ ) {
     PCCImageOccupancyMap& occupancyImage = context.getVideoOccupancyMap().getFrame( fi );
     for ( size_t tileIdx = 0; tileIdx < context[fi].getNumTilesInAtlasFrame(); tileIdx++ ) {
-      auto& tile = context[fi].getTile( tileIdx );
-      generateTileBlockToPatchFromOccupancyMapVideo( context, tile, fi, occupancyImage, occupancyResolution,
-                                                     occupancyPrecision );
+#endif
+        auto& tile = context[fi].getTile( tileIdx );
+        generateTileBlockToPatchFromOccupancyMapVideo( context, tile, fi, occupancyImage, occupancyResolution,
+                                                       occupancyPrecision );
+#if defined( ENABLE_TBB )
+      } );
+    } );
+  } );
+#else
     }
   }
+#endif
 }
 
 void PCCCodec::generateTileBlockToPatchFromOccupancyMapVideo( PCCContext&           context,
@@ -1671,8 +1690,9 @@ void PCCCodec::generateTileBlockToPatchFromOccupancyMapVideo( PCCContext&
 
 void PCCCodec::generateAtlasBlockToPatchFromOccupancyMapVideo( PCCContext&  context,
                                                                const size_t occupancyResolution,
-                                                               const size_t occupancyPrecision ) {
-  generateTileBlockToPatchFromOccupancyMapVideo( context, occupancyResolution, occupancyPrecision );
+                                                               const size_t occupancyPrecision,
+                                                               const size_t nbThread ) {
+  generateTileBlockToPatchFromOccupancyMapVideo( context, occupancyResolution, occupancyPrecision, nbThread );
   for ( int fi = 0; fi < context.size(); fi++ ) {
     PCCImageOccupancyMap& occupancyImage = context.getVideoOccupancyMap().getFrame( fi );
     auto&                 atlasFrame     = context.getFrame( fi ).getTitleFrameContext();
@@ -48,9 +48,13 @@ bool PCCGroupOfFrames::load( const std::string&      uncompressedDataPath,
                              const size_t            endFrameNumber,
                              const PCCColorTransform colorTransform,
                              const bool              readNormals,
-                             const size_t            nbThread ) {
+                             const size_t            nbThread,
+                             const std::string&      cacheDataPath ) {
   if ( endFrameNumber < startFrameNumber ) { return false; }
   const size_t frameCount = endFrameNumber - startFrameNumber;
+  // the cached point sets are only valid for the same decoding options
+  const uint32_t cacheOptions = static_cast<uint32_t>( colorTransform ) | ( readNormals ? 0x100U : 0U );
+  kdtreeCache_.clear();
   frames_.resize( frameCount );
  
 #if defined( ENABLE_TBB )
@@ -61,14 +65,21 @@ bool PCCGroupOfFrames::load( const std::string&      uncompressedDataPath,
   for ( size_t frameNumber = startFrameNumber; frameNumber < endFrameNumber; frameNumber++ ) {
 #endif
       char fileName[4096];
+      char cacheFileName[4096];
       sprintf( fileName, uncompressedDataPath.c_str(), frameNumber );
+      if ( !cacheDataPath.empty() ) { sprintf( cacheFileName, cacheDataPath.c_str(), frameNumber ); }
       auto& pointSet = frames_[frameNumber - startFrameNumber];
       pointSet.resize( 0 );
-      if ( !pointSet.read( fileName, readNormals ) ) {
-        std::cout << "Error: can't open " << fileName << std::endl;
-        frames_.resize( frameNumber - startFrameNumber );
-      } else {
-        if ( colorTransform == COLOR_TRANSFORM_RGB_TO_YCBCR ) { pointSet.convertRGBToYUV(); }
+      if ( cacheDataPath.empty() || !pointSet.readCache( cacheFileName, fileName, cacheOptions ) ) {
+        if ( !pointSet.read( fileName, readNormals ) ) {
+          std::cout << "Error: can't open " << fileName << std::endl;
+          frames_.resize( frameNumber - startFrameNumber );
+        } else {
+          if ( colorTransform == COLOR_TRANSFORM_RGB_TO_YCBCR ) { pointSet.convertRGBToYUV(); }
+          if ( !cacheDataPath.empty() && !pointSet.writeCache( cacheFileName, fileName, cacheOptions ) ) {
+            std::cout << "Warning: can't write the cache " << cacheFileName << std::endl;
+          }
+        }
       }
 #if defined( ENABLE_TBB )
     } );
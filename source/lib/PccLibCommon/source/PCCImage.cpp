@@ -135,7 +135,7 @@ void PCCImage<T, N>::convertYUV420ToYUV444( const PCCImage<T, 3>& image ) {
 }
 
 template <typename T, size_t N>
-bool PCCImage<T, N>::write( std::ofstream& outfile, const size_t nbyte ) {
+bool PCCImage<T, N>::write( std::ostream& outfile, const size_t nbyte ) {
   printf( "Image write %zux%zu T = %zu nbyte = %zu color format = %d channel size = %zu %zu %zu \n", width_, height_,
           sizeof( T ), nbyte, format_, channels_[0].size(), channels_[1].size(), channels_[2].size() );
   fflush( stdout );
@@ -164,7 +164,7 @@ bool PCCImage<T, N>::write( const std::string fileName, const size_t nbyte ) {
 }
 
 template <typename T, size_t N>
-bool PCCImage<T, N>::read( std::ifstream&       infile,
+bool PCCImage<T, N>::read( std::istream&        infile,
                            const size_t         sizeU0,
                            const size_t         sizeV0,
                            const PCCCOLORFORMAT format,
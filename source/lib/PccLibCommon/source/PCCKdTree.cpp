@@ -41,9 +41,62 @@ using namespace pcc;
 
 typedef KDTreeVectorOfVectorsAdaptor<PCCPointSet3, PCCType, float, 3, metric_L2_Simple_2, size_t> KdTreeAdaptor;
 
-PCCKdTree::PCCKdTree() : kdtree_( nullptr ) {}
+typedef PCCVoxelGridIndex::Neighbor Neighbor;
 
-PCCKdTree::PCCKdTree( const PCCPointSet3& pointCloud ) : kdtree_( nullptr ) { init( pointCloud ); }
+// nanoflann result set writing the nearest neighbours of a query straight into the buffers of a PCCNNResult. Without
+// a radius, it behaves as nanoflann::KNNResultSet; with a radius, it keeps the neighbours closer than the radius
+// ordered by distance then index, as the sorted and truncated output of nanoflann::RadiusResultSet.
+class PCCNNResultSet {
+ public:
+  PCCNNResultSet( PCCNNResult& result, const size_t capacity, const double radius, const bool sorted ) :
+      capacity_( capacity ), count_( 0 ), radius_( radius ), sorted_( sorted ) {
+    result.resize( capacity_ );
+    indices_ = result.indices();
+    dists_   = result.dist();
+  }
+  inline size_t size() const { return count_; }
+  inline bool   full() const { return count_ == capacity_; }
+  inline void   addPoint( const double dist, const size_t index ) {
+    if ( dist >= radius_ ) { return; }
+    const float distance = static_cast<float>( dist );
+    size_t      i        = count_;
+    for ( ; i > 0; --i ) {
+      if ( dists_[i - 1] > distance || ( sorted_ && dists_[i - 1] == distance && indices_[i - 1] > index ) ) {
+        if ( i < capacity_ ) {
+          dists_[i]   = dists_[i - 1];
+          indices_[i] = indices_[i - 1];
+        }
+      } else {
+        break;
+      }
+    }
+    if ( i < capacity_ ) {
+      dists_[i]   = distance;
+      indices_[i] = static_cast<uint32_t>( index );
+    }
+    if ( count_ < capacity_ ) { ++count_; }
+  }
+  inline double worstDist() const {
+    if ( !full() ) { return radius_; }
+    // a point at the same distance as the farthest neighbour may still replace it if it has a lower index
+    return sorted_ ? std::nextafter( double( dists_[capacity_ - 1] ), radius_ ) : dists_[capacity_ - 1];
+  }
+
+ private:
+  const size_t capacity_;
+  size_t       count_;
+  const double radius_;
+  const bool   sorted_;
+  uint32_t*    indices_;
+  float*       dists_;
+};
+
+PCCKdTree::PCCKdTree() : kdtree_( nullptr ), voxelGrid_( nullptr ) {}
+
+PCCKdTree::PCCKdTree( const PCCPointSet3& pointCloud, PCCNNEngine engine ) :
+    kdtree_( nullptr ), voxelGrid_( nullptr ) {
+  init( pointCloud, engine );
+}
 
 PCCKdTree::~PCCKdTree() { clear(); }
 void PCCKdTree::clear() {
@@ -51,29 +104,56 @@ void PCCKdTree::clear() {
     delete ( static_cast<KdTreeAdaptor*>( kdtree_ ) );
     kdtree_ = nullptr;
   }
+  if ( voxelGrid_ != nullptr ) {
+    delete voxelGrid_;
+    voxelGrid_ = nullptr;
+  }
 }
 
-void PCCKdTree::init( const PCCPointSet3& pointCloud ) {
+void PCCKdTree::init( const PCCPointSet3& pointCloud, PCCNNEngine engine ) {
   clear();
-  kdtree_ = new KdTreeAdaptor( 3, pointCloud, 10 );
+  if ( engine == NN_ENGINE_VOXEL_GRID ) {
+    voxelGrid_ = new PCCVoxelGridIndex( pointCloud );
+  } else {
+    kdtree_ = new KdTreeAdaptor( 3, pointCloud, 10 );
+  }
 }
 
 void PCCKdTree::search( const PCCPoint3D& point, const size_t num_results, PCCNNResult& results ) const {
-  if ( num_results != results.size() ) { results.resize( num_results ); }
-  auto retSize = ( static_cast<KdTreeAdaptor*>( kdtree_ ) )
-                     ->index->knnSearch( &point[0], num_results, results.indices(), results.dist() );
-  assert( retSize == results.size() );
+  if ( voxelGrid_ != nullptr ) {
+    const size_t capacity  = ( std::min )( num_results, voxelGrid_->getPointCount() );
+    Neighbor     buffer[PCCNNResult::inlineCapacity];
+    Neighbor*    neighbors = capacity > PCCNNResult::inlineCapacity ? results.neighbors( capacity ) : buffer;
+    const size_t count     = voxelGrid_->search( point, capacity, neighbors );
+    results.resize( count );
+    for ( size_t i = 0; i < count; ++i ) {
+      results.indices( i ) = neighbors[i].index_;
+      results.dist( i )    = static_cast<float>( neighbors[i].dist2_ );
+    }
+    return;
+  }
+  PCCNNResultSet resultSet( results, num_results, ( std::numeric_limits<double>::max )(), false );
+  ( static_cast<KdTreeAdaptor*>( kdtree_ ) )->index->findNeighbors( resultSet, &point[0], nanoflann::SearchParams() );
+  results.resize( resultSet.size() );
 }
 
 void PCCKdTree::searchRadius( const PCCPoint3D& point,
                               const size_t      num_results,
                               const double      radius,
                               PCCNNResult&      results ) const {
-  std::vector<std::pair<size_t, double> > ret;
-  nanoflann::SearchParams                 params;
-  size_t retSize = ( static_cast<KdTreeAdaptor*>( kdtree_ ) )->index->radiusSearch( &point[0], radius, ret, params );
-  if ( retSize > num_results ) { retSize = num_results; }
-  ret.resize( retSize );
-  results.reserve( retSize );
-  for ( const auto& result : ret ) { results.pushBack( result ); }
+  if ( voxelGrid_ != nullptr ) {
+    const size_t capacity  = ( std::min )( num_results, voxelGrid_->getPointCount() );
+    Neighbor     buffer[PCCNNResult::inlineCapacity];
+    Neighbor*    neighbors = capacity > PCCNNResult::inlineCapacity ? results.neighbors( capacity ) : buffer;
+    const size_t count     = voxelGrid_->searchRadius( point, capacity, radius, neighbors );
+    results.resize( count );
+    for ( size_t i = 0; i < count; ++i ) {
+      results.indices( i ) = neighbors[i].index_;
+      results.dist( i )    = static_cast<float>( neighbors[i].dist2_ );
+    }
+    return;
+  }
+  PCCNNResultSet resultSet( results, num_results, radius, true );
+  ( static_cast<KdTreeAdaptor*>( kdtree_ ) )->index->findNeighbors( resultSet, &point[0], nanoflann::SearchParams() );
+  results.resize( resultSet.size() );
 }
@@ -0,0 +1,107 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "PCCCommon.h"
+#include "PCCPointSet.h"
+#include "PCCKdTree.h"
+#include "PCCKdTreeCache.h"
+
+using namespace pcc;
+
+PCCKdTreeCache::PCCKdTreeCache() : nnSearchEngine_( NN_ENGINE_KDTREE ), hitCount_( 0 ), buildCount_( 0 ) {}
+
+PCCKdTreeCache::PCCKdTreeCache( const PCCKdTreeCache& cache ) :
+    nnSearchEngine_( cache.nnSearchEngine_ ), hitCount_( 0 ), buildCount_( 0 ) {}
+
+PCCKdTreeCache& PCCKdTreeCache::operator=( const PCCKdTreeCache& cache ) {
+  clear();
+  nnSearchEngine_ = cache.nnSearchEngine_;
+  return *this;
+}
+
+PCCKdTreeCache::~PCCKdTreeCache() { clear(); }
+
+std::shared_ptr<const PCCKdTree> PCCKdTreeCache::get( const PCCPointSet3& pointSet ) {
+  auto&                  state = pointSet.kdtreeCacheState_;
+  std::shared_ptr<Entry> entry;
+  {
+    std::lock_guard<std::mutex> lock( mutex_ );
+    PCCKdTreeCache*             cache = nullptr;
+    if ( !state.cache_.compare_exchange_strong( cache, this ) && cache != this ) {
+      buildCount_++;
+      return std::make_shared<const PCCKdTree>( pointSet, nnSearchEngine_ );
+    }
+    auto& value = entries_[&pointSet];
+    if ( !value ) { value = std::make_shared<Entry>(); }
+    entry = value;
+  }
+  std::lock_guard<std::mutex> lock( entry->mutex_ );
+  if ( entry->kdtree_ && !state.modified_.load() ) {
+    hitCount_++;
+  } else {
+    state.modified_ = false;
+    entry->kdtree_  = std::make_shared<const PCCKdTree>( pointSet, nnSearchEngine_ );
+    buildCount_++;
+  }
+  return entry->kdtree_;
+}
+
+void PCCKdTreeCache::invalidate( const PCCPointSet3& pointSet ) {
+  std::lock_guard<std::mutex> lock( mutex_ );
+  if ( entries_.erase( &pointSet ) != 0u ) { pointSet.kdtreeCacheState_.cache_ = nullptr; }
+}
+
+// The trees built with another engine are released.
+void PCCKdTreeCache::setNNSearchEngine( PCCNNEngine engine ) {
+  std::lock_guard<std::mutex> lock( mutex_ );
+  if ( engine != nnSearchEngine_ ) { releaseEntries(); }
+  nnSearchEngine_ = engine;
+}
+
+void PCCKdTreeCache::clear() {
+  std::lock_guard<std::mutex> lock( mutex_ );
+  releaseEntries();
+  hitCount_   = 0;
+  buildCount_ = 0;
+}
+
+// Releases the trees to save memory, they are rebuilt by the next get(), the statistics are kept.
+void PCCKdTreeCache::trim() {
+  std::lock_guard<std::mutex> lock( mutex_ );
+  releaseEntries();
+}
+
+// the indexed point clouds are alive, since they evict themselves when destroyed
+void PCCKdTreeCache::releaseEntries() {
+  for ( auto& entry : entries_ ) { entry.first->kdtreeCacheState_.cache_ = nullptr; }
+  entries_.clear();
+}
@@ -0,0 +1,95 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "PCCCommon.h"
+#include "PCCPackingCanvas.h"
+
+using namespace pcc;
+
+void PCCPackingCanvas::resize( const size_t size, const bool value ) {
+  words_.resize( ( size + 63 ) / 64, 0 );
+  if ( size > size_ && value ) {
+    for ( size_t pos = size_; pos < size; ++pos ) { words_[pos >> 6] |= uint64_t( 1 ) << ( pos & 63 ); }
+  } else if ( size < size_ && ( size & 63 ) != 0 ) {
+    words_[size >> 6] &= ( uint64_t( 1 ) << ( size & 63 ) ) - 1;
+  }
+  size_     = size;
+  sumValid_ = false;
+}
+
+void PCCPackingCanvas::updateSummedArea( const size_t stride ) const {
+  if ( sumValid_ && sumStride_ == stride ) { return; }
+  const size_t rows = stride == 0 ? 0 : ( size_ + stride - 1 ) / stride;
+  sum_.assign( ( stride + 1 ) * ( rows + 1 ), 0 );
+  for ( size_t y = 0; y < rows; ++y ) {
+    const uint32_t* above = sum_.data() + y * ( stride + 1 );
+    uint32_t*       row   = sum_.data() + ( y + 1 ) * ( stride + 1 );
+    uint32_t        count = 0;
+    for ( size_t x = 0; x < stride; ++x ) {
+      const size_t pos = y * stride + x;
+      if ( pos < size_ && get( pos ) ) { count++; }
+      row[x + 1] = above[x + 1] + count;
+    }
+  }
+  sumStride_ = stride;
+  sumValid_  = true;
+}
+
+size_t PCCPackingCanvas::count( const size_t x,
+                                const size_t y,
+                                const size_t width,
+                                const size_t height,
+                                const size_t stride ) const {
+  updateSummedArea( stride );
+  const size_t rows = sum_.size() / ( stride + 1 ) - 1;
+  const size_t x1 = ( std::min )( x + width, stride ), y1 = ( std::min )( y + height, rows );
+  if ( x >= x1 || y >= y1 ) { return 0; }
+  const uint32_t* top    = sum_.data() + y * ( stride + 1 );
+  const uint32_t* bottom = sum_.data() + y1 * ( stride + 1 );
+  return bottom[x1] - bottom[x] - top[x1] + top[x];
+}
+
+bool PCCPackingCanvas::intersects( const uint64_t* mask,
+                                   const size_t    x,
+                                   const size_t    y,
+                                   const size_t    width,
+                                   const size_t    height,
+                                   const size_t    stride ) const {
+  const size_t wordCount = ( width + 63 ) / 64;
+  for ( size_t v = 0; v < height; ++v, mask += wordCount ) {
+    const size_t pos = ( y + v ) * stride + x;
+    for ( size_t i = 0; i < wordCount; ++i ) {
+      if ( mask[i] != 0 && ( getWord( pos + 64 * i ) & mask[i] ) != 0 ) { return true; }
+    }
+  }
+  return false;
+}
@@ -307,31 +307,167 @@ int PCCPatch::patchBlock2CanvasBlock( const size_t uBlk,
   return int( x + canvasStrideBlk * y );
 }
 
-bool PCCPatch::checkFitPatchCanvas( std::vector<bool> canvas,
-                                    size_t            canvasStrideBlk,
-                                    size_t            canvasHeightBlk,
-                                    bool              bPrecedence,
-                                    int               safeguard,
-                                    const Tile        tile ) {
-  for ( size_t v0 = 0; v0 < sizeV0_; ++v0 ) {
-    for ( size_t u0 = 0; u0 < sizeU0_; ++u0 ) {
-      for ( int deltaY = -safeguard; deltaY < safeguard + 1; deltaY++ ) {
-        for ( int deltaX = -safeguard; deltaX < safeguard + 1; deltaX++ ) {
-          int pos = patchBlock2CanvasBlock( u0 + deltaX, v0 + deltaY, canvasStrideBlk, canvasHeightBlk, tile );
-          if ( pos < 0 ) {
-            return false;
-          } else {
-            if ( bPrecedence ) {
-              if ( canvas[pos] && occupancy_[u0 + sizeU0_ * v0] ) { return false; }
-            } else {
-              if ( canvas[pos] ) { return false; }
-            }
-          }
-        }
+// position of the block ( u, v ) of a patch of sizeU0 x sizeV0 blocks relative to the patch location in the canvas
+static inline void orientPatchBlock( const size_t orientation,
+                                     const size_t sizeU0,
+                                     const size_t sizeV0,
+                                     const size_t u,
+                                     const size_t v,
+                                     size_t&      x,
+                                     size_t&      y ) {
+  switch ( orientation ) {
+    case PATCH_ORIENTATION_DEFAULT:
+      x = u;
+      y = v;
+      break;
+    case PATCH_ORIENTATION_ROT90:
+      x = sizeV0 - 1 - v;
+      y = u;
+      break;
+    case PATCH_ORIENTATION_ROT180:
+      x = sizeU0 - 1 - u;
+      y = sizeV0 - 1 - v;
+      break;
+    case PATCH_ORIENTATION_ROT270:
+      x = v;
+      y = sizeU0 - 1 - u;
+      break;
+    case PATCH_ORIENTATION_MIRROR:
+      x = sizeU0 - 1 - u;
+      y = v;
+      break;
+    case PATCH_ORIENTATION_MROT90:
+      x = sizeV0 - 1 - v;
+      y = sizeU0 - 1 - u;
+      break;
+    case PATCH_ORIENTATION_MROT180:
+      x = u;
+      y = sizeV0 - 1 - v;
+      break;
+    default:  // PATCH_ORIENTATION_MROT270 and PATCH_ORIENTATION_SWAP
+      x = v;
+      y = u;
+      break;
+  }
+}
+
+static inline bool isOrientationSwitched( const size_t orientation ) {
+  return !( orientation == PATCH_ORIENTATION_DEFAULT || orientation == PATCH_ORIENTATION_ROT180 ||
+            orientation == PATCH_ORIENTATION_MIRROR || orientation == PATCH_ORIENTATION_MROT180 );
+}
+
+const PCCPatch::PackingMask* PCCPatch::findPackingMask( const size_t orientation,
+                                                        const size_t sizeU0,
+                                                        const size_t sizeV0,
+                                                        const int    safeguard ) const {
+  for ( auto& mask : packingMasks_ ) {
+    if ( mask.orientation_ == orientation && mask.sizeU0_ == sizeU0 && mask.sizeV0_ == sizeV0 &&
+         mask.occupancyStride_ == sizeU0_ && mask.safeguard_ == safeguard ) {
+      return &mask;
+    }
+  }
+  return nullptr;
+}
+
+void PCCPatch::createPackingMask( PackingMask& mask,
+                                  const size_t orientation,
+                                  const size_t sizeU0,
+                                  const size_t sizeV0,
+                                  const int    safeguard ) const {
+  // each occupied block sets the square of side 2 * safeguard + 1 centered on its position in the mask
+  const size_t side      = 2 * size_t( safeguard ) + 1;
+  const size_t width     = ( isOrientationSwitched( orientation ) ? sizeV0 : sizeU0 ) + side - 1;
+  const size_t height    = ( isOrientationSwitched( orientation ) ? sizeU0 : sizeV0 ) + side - 1;
+  const size_t wordCount = ( width + 63 ) / 64;
+  mask.orientation_      = orientation;
+  mask.sizeU0_           = sizeU0;
+  mask.sizeV0_           = sizeV0;
+  mask.occupancyStride_  = sizeU0_;
+  mask.safeguard_        = safeguard;
+  mask.bits_.assign( wordCount * height, 0 );
+  for ( size_t v = 0; v < sizeV0; ++v ) {
+    for ( size_t u = 0; u < sizeU0; ++u ) {
+      const size_t index = u + sizeU0_ * v;
+      if ( index >= occupancy_.size() || !occupancy_[index] ) { continue; }
+      size_t x, y;
+      orientPatchBlock( orientation, sizeU0, sizeV0, u, v, x, y );
+      for ( size_t row = y; row < y + side; ++row ) {
+        uint64_t* bits = mask.bits_.data() + row * wordCount;
+        for ( size_t col = x; col < x + side; ++col ) { bits[col >> 6] |= uint64_t( 1 ) << ( col & 63 ); }
       }
     }
   }
-  return true;
+}
+
+void PCCPatch::addPackingMask( const size_t orientation,
+                               const size_t sizeU0,
+                               const size_t sizeV0,
+                               const int    safeguard ) {
+  if ( sizeU0 == 0 || sizeV0 == 0 || safeguard < 0 || orientation > PATCH_ORIENTATION_MROT270 ) { return; }
+  if ( findPackingMask( orientation, sizeU0, sizeV0, safeguard ) != nullptr ) { return; }
+  packingMasks_.resize( packingMasks_.size() + 1 );
+  createPackingMask( packingMasks_.back(), orientation, sizeU0, sizeV0, safeguard );
+}
+
+// Same result as testing each block of the patch, dilated by safeguard, with patchBlock2CanvasBlock(): the dilated
+// bounding box must be inside the canvas and the tile, and its blocks (or, with bPrecedence, the blocks near the
+// occupied blocks of the patch) must be free.
+bool PCCPatch::checkFitPatchCanvas( const PCCPackingCanvas& canvas,
+                                    const size_t            orientation,
+                                    const size_t            u0,
+                                    const size_t            v0,
+                                    const size_t            sizeU0,
+                                    const size_t            sizeV0,
+                                    size_t                  canvasStrideBlk,
+                                    size_t                  canvasHeightBlk,
+                                    bool                    bPrecedence,
+                                    int                     safeguard,
+                                    const Tile&             tile ) const {
+  if ( sizeU0 == 0 || sizeV0 == 0 || safeguard < 0 ) { return true; }
+  if ( orientation > PATCH_ORIENTATION_MROT270 ) { return false; }
+  const bool   switched = isOrientationSwitched( orientation );
+  const size_t border   = size_t( safeguard );
+  const size_t width    = ( switched ? sizeV0 : sizeU0 ) + 2 * border;
+  const size_t height   = ( switched ? sizeU0 : sizeV0 ) + 2 * border;
+  if ( u0 < border || v0 < border ) { return false; }
+  const size_t x = u0 - border, y = v0 - border;
+  if ( x > canvasStrideBlk || width > canvasStrideBlk - x ) { return false; }
+  if ( y > canvasHeightBlk || height > canvasHeightBlk - y ) { return false; }
+  if ( tile.minU != -1 ) {
+    if ( x < size_t( tile.minU ) || y < size_t( tile.minV ) ) { return false; }
+    if ( x + width - 1 > size_t( tile.maxU ) || y + height - 1 > size_t( tile.maxV ) ) { return false; }
+  }
+  if ( canvas.count( x, y, width, height, canvasStrideBlk ) == 0 ) { return true; }
+  if ( !bPrecedence ) { return false; }
+  const PackingMask* mask = findPackingMask( orientation, sizeU0, sizeV0, safeguard );
+  if ( mask != nullptr ) { return !canvas.intersects( mask->bits_.data(), x, y, width, height, canvasStrideBlk ); }
+  PackingMask localMask;
+  createPackingMask( localMask, orientation, sizeU0, sizeV0, safeguard );
+  return !canvas.intersects( localMask.bits_.data(), x, y, width, height, canvasStrideBlk );
+}
+
+bool PCCPatch::checkFitPatchCanvas( const PCCPackingCanvas& canvas,
+                                    size_t                  canvasStrideBlk,
+                                    size_t                  canvasHeightBlk,
+                                    bool                    bPrecedence,
+                                    int                     safeguard,
+                                    const Tile              tile ) {
+  if ( bPrecedence ) { addPackingMask( patchOrientation_, sizeU0_, sizeV0_, safeguard ); }
+  return checkFitPatchCanvas( canvas, patchOrientation_, u0_, v0_, sizeU0_, sizeV0_, canvasStrideBlk, canvasHeightBlk,
+                              bPrecedence, safeguard, tile );
+}
+
+bool PCCPatch::checkFitPatchCanvas( const PCCPackingCanvas& canvas,
+                                    const size_t            orientation,
+                                    const size_t            u0,
+                                    const size_t            v0,
+                                    size_t                  canvasStrideBlk,
+                                    size_t                  canvasHeightBlk,
+                                    bool                    bPrecedence,
+                                    int                     safeguard,
+                                    const Tile              tile ) const {
+  return checkFitPatchCanvas( canvas, orientation, u0, v0, sizeU0_, sizeV0_, canvasStrideBlk, canvasHeightBlk,
+                              bPrecedence, safeguard, tile );
 }
 
 bool PCCPatch::smallerRefFirst( const PCCPatch& rhs ) {
@@ -664,31 +800,17 @@ int PCCPatch::patchBlock2CanvasBlockForGPA( const size_t uBlk,
   return int( x + canvasStrideBlk * y );
 }
 
-bool PCCPatch::checkFitPatchCanvasForGPA( std::vector<bool> canvas,
-                                          size_t            canvasStrideBlk,
-                                          size_t            canvasHeightBlk,
-                                          bool              bPrecedence,
-                                          int               safeguard ) {
-  for ( size_t v0 = 0; v0 < curGPAPatchData_.sizeV0_; ++v0 ) {
-    for ( size_t u0 = 0; u0 < curGPAPatchData_.sizeU0_; ++u0 ) {
-      for ( int deltaY = -safeguard; deltaY < safeguard + 1; deltaY++ ) {
-        for ( int deltaX = -safeguard; deltaX < safeguard + 1; deltaX++ ) {
-          int pos = patchBlock2CanvasBlockForGPA( u0 + deltaX, v0 + deltaY, canvasStrideBlk, canvasHeightBlk );
-          if ( pos < 0 ) {
-            return false;
-          } else {
-            if ( bPrecedence ) {
-              if ( canvas[pos] && occupancy_[u0 + sizeU0_ * v0] ) { return false; }
-            } else {
-              if ( canvas[pos] ) { return false; }
-            }
-          }
-        }
-      }
-    }
+bool PCCPatch::checkFitPatchCanvasForGPA( const PCCPackingCanvas& canvas,
+                                          size_t                  canvasStrideBlk,
+                                          size_t                  canvasHeightBlk,
+                                          bool                    bPrecedence,
+                                          int                     safeguard ) {
+  if ( bPrecedence ) {
+    addPackingMask( curGPAPatchData_.patchOrientation_, curGPAPatchData_.sizeU0_, curGPAPatchData_.sizeV0_, safeguard );
   }
-
-  return true;
+  return checkFitPatchCanvas( canvas, curGPAPatchData_.patchOrientation_, curGPAPatchData_.u0_, curGPAPatchData_.v0_,
+                              curGPAPatchData_.sizeU0_, curGPAPatchData_.sizeV0_, canvasStrideBlk, canvasHeightBlk,
+                              bPrecedence, safeguard, Tile() );
 }
 
 void PCCPatch::allocOneLayerData() {
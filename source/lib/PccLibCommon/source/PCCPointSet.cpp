@@ -36,10 +36,53 @@
 #include "PCCMath.h"
 #include "KDTreeVectorOfVectorsAdaptor.h"
 #include "PCCKdTree.h"
+#include "PCCKdTreeCache.h"
+#include "PCCSystem.h"
+#include "PCCParallel.h"
 #include <numeric>
 
 using namespace pcc;
 
+// Searches the nearest neighbours of the selected query points concurrently, then hands the neighbours that satisfy
+// keep( query, neighbor, dist ) to push( query, neighbor, dist ) sequentially, in the order of a serial search loop.
+template <typename Select, typename Keep, typename Push>
+static void gatherNeighbors( const PCCKdTree&    kdtree,
+                             const PCCPointSet3& queries,
+                             const size_t        count,
+                             const size_t        numResults,
+                             Select              select,
+                             Keep                keep,
+                             Push                push,
+                             const size_t        nbThread ) {
+  std::vector<uint32_t> neighbors( count * numResults );
+  std::vector<float>    dists( count * numResults );
+  std::vector<uint32_t> neighborCounts( count, 0 );
+  forEachRange( nbThread, count, [&]( const size_t begin, const size_t end ) {
+    PCCNNResult result;
+    for ( size_t index = begin; index < end; ++index ) {
+      if ( !select( index ) ) { continue; }
+      kdtree.search( queries[index], numResults, result );
+      auto& neighborCount = neighborCounts[index];
+      for ( size_t i = 0; i < result.size(); ++i ) {
+        if ( keep( index, result.indices( i ), result.dist( i ) ) ) {
+          neighbors[index * numResults + neighborCount] = result.indices( i );
+          dists[index * numResults + neighborCount]     = result.dist( i );
+          neighborCount++;
+        }
+      }
+    }
+  } );
+  for ( size_t index = 0; index < count; ++index ) {
+    for ( size_t i = index * numResults; i < index * numResults + neighborCounts[index]; ++i ) {
+      push( index, neighbors[i], dists[i] );
+    }
+  }
+}
+
+PCCPointSet3::~PCCPointSet3() {
+  if ( PCCKdTreeCache* kdtreeCache = kdtreeCacheState_.cache_.load() ) { kdtreeCache->invalidate( *this ); }
+}
+
 void PCCPointSet3::removeDuplicate() {
   PCCPointSet3 newPointcloud;
   if ( withColors_ ) { newPointcloud.hasColors(); }
@@ -70,6 +113,7 @@ void PCCPointSet3::removeDuplicate() {
       }
     }
   }
+  kdtreeCacheState_.setModified();
   positions_.swap( newPointcloud.positions_ );
   colors_.swap( newPointcloud.colors_ );
   reflectances_.swap( newPointcloud.reflectances_ );
@@ -312,6 +356,8 @@ void PCCPointSet3::reorder() {
   swap( newPointcloud );
 }
 void PCCPointSet3::swap( PCCPointSet3& newPointcloud ) {
+  kdtreeCacheState_.setModified();
+  newPointcloud.kdtreeCacheState_.setModified();
   positions_.swap( newPointcloud.positions_ );
   colors_.swap( newPointcloud.colors_ );
   reflectances_.swap( newPointcloud.reflectances_ );
@@ -356,6 +402,115 @@ bool PCCPointSet3::isRawPointsBboxEmpty( std::vector<size_t> rawPoints, PCCBox3D
   return true;
 }
 
+enum PlyAttributeType {
+  PLY_ATTRIBUTE_TYPE_FLOAT64 = 0,
+  PLY_ATTRIBUTE_TYPE_FLOAT32 = 1,
+  PLY_ATTRIBUTE_TYPE_UINT64  = 2,
+  PLY_ATTRIBUTE_TYPE_UINT32  = 3,
+  PLY_ATTRIBUTE_TYPE_UINT16  = 4,
+  PLY_ATTRIBUTE_TYPE_UINT8   = 5,
+  PLY_ATTRIBUTE_TYPE_INT64   = 6,
+  PLY_ATTRIBUTE_TYPE_INT32   = 7,
+  PLY_ATTRIBUTE_TYPE_INT16   = 8,
+  PLY_ATTRIBUTE_TYPE_INT8    = 9,
+};
+struct PlyAttributeInfo {
+  std::string      name;
+  PlyAttributeType type;
+  size_t           byteCount;
+  size_t           offset;  // in bytes, from the start of a binary vertex
+};
+
+// Loads a binary PLY value, swapping its bytes when the file and system endianness differ.
+template <typename T>
+static inline T loadPlyValue( const char* data, const bool swapBytes ) {
+  char bytes[sizeof( T )];
+  if ( swapBytes ) {
+    for ( size_t i = 0; i < sizeof( T ); ++i ) { bytes[i] = data[sizeof( T ) - 1 - i]; }
+    data = bytes;
+  }
+  T value;
+  memcpy( &value, data, sizeof( T ) );
+  return value;
+}
+
+// Calls store( i, value ) for the attribute of the count vertices of a binary PLY body: one tight loop per attribute
+// type instead of a type dispatch per value.
+template <typename T, typename Store>
+static void readPlyAttribute( const char*  data,
+                              const size_t stride,
+                              const size_t count,
+                              const bool   swapBytes,
+                              Store        store ) {
+  for ( size_t i = 0; i < count; ++i, data += stride ) { store( i, loadPlyValue<T>( data, swapBytes ) ); }
+}
+template <typename Store>
+static void readPlyAttribute( const PlyAttributeInfo& attributeInfo,
+                              const char*             body,
+                              const size_t            stride,
+                              const size_t            count,
+                              const bool              swapBytes,
+                              Store                   store ) {
+  const char* data = body + attributeInfo.offset;
+  switch ( attributeInfo.type ) {
+    case PLY_ATTRIBUTE_TYPE_FLOAT64: readPlyAttribute<double>( data, stride, count, swapBytes, store ); break;
+    case PLY_ATTRIBUTE_TYPE_FLOAT32: readPlyAttribute<float>( data, stride, count, swapBytes, store ); break;
+    case PLY_ATTRIBUTE_TYPE_UINT64: readPlyAttribute<uint64_t>( data, stride, count, swapBytes, store ); break;
+    case PLY_ATTRIBUTE_TYPE_UINT32: readPlyAttribute<uint32_t>( data, stride, count, swapBytes, store ); break;
+    case PLY_ATTRIBUTE_TYPE_UINT16: readPlyAttribute<uint16_t>( data, stride, count, swapBytes, store ); break;
+    case PLY_ATTRIBUTE_TYPE_UINT8: readPlyAttribute<uint8_t>( data, stride, count, swapBytes, store ); break;
+    case PLY_ATTRIBUTE_TYPE_INT64: readPlyAttribute<int64_t>( data, stride, count, swapBytes, store ); break;
+    case PLY_ATTRIBUTE_TYPE_INT32: readPlyAttribute<int32_t>( data, stride, count, swapBytes, store ); break;
+    case PLY_ATTRIBUTE_TYPE_INT16: readPlyAttribute<int16_t>( data, stride, count, swapBytes, store ); break;
+    case PLY_ATTRIBUTE_TYPE_INT8: readPlyAttribute<int8_t>( data, stride, count, swapBytes, store ); break;
+  }
+}
+
+// Splits an ASCII PLY line into its fields, without copying them.
+static inline void splitPlyLine( const char*                                       begin,
+                                 const char*                                       end,
+                                 std::vector<std::pair<const char*, const char*>>& fields ) {
+  fields.clear();
+  while ( begin < end ) {
+    while ( begin < end && ( *begin == ' ' || *begin == '\t' || *begin == '\r' ) ) { ++begin; }
+    const char* field = begin;
+    while ( begin < end && *begin != ' ' && *begin != '\t' && *begin != '\r' ) { ++begin; }
+    if ( begin > field ) { fields.emplace_back( field, begin ); }
+  }
+}
+
+// Same value as atoi() on the field.
+static inline int parsePlyInteger( const char* begin, const char* end ) {
+  const bool negative = begin < end && *begin == '-';
+  if ( begin < end && ( *begin == '-' || *begin == '+' ) ) { ++begin; }
+  int64_t value = 0;
+  for ( ; begin < end && *begin >= '0' && *begin <= '9'; ++begin ) { value = value * 10 + ( *begin - '0' ); }
+  return static_cast<int>( negative ? -value : value );
+}
+
+// Same value as atof() on the field: integers, possibly written with a zero fraction, are converted directly and
+// the other numbers go through strtod() so that their rounding is unchanged.
+static inline double parsePlyReal( const char* begin, const char* end ) {
+  const char* digit    = begin;
+  const bool  negative = digit < end && *digit == '-';
+  if ( digit < end && ( *digit == '-' || *digit == '+' ) ) { ++digit; }
+  const char* digits = digit;
+  int64_t     value  = 0;
+  for ( ; digit < end && *digit >= '0' && *digit <= '9'; ++digit ) { value = value * 10 + ( *digit - '0' ); }
+  const size_t digitCount = digit - digits;
+  if ( digit < end && *digit == '.' ) {
+    for ( ++digit; digit < end && *digit == '0'; ++digit ) {}
+  }
+  if ( digitCount > 0 && digitCount <= 15 && digit == end ) {
+    return negative ? -static_cast<double>( value ) : static_cast<double>( value );
+  }
+  char         buffer[64];
+  const size_t length = ( std::min )( size_t( end - begin ), sizeof( buffer ) - 1 );
+  memcpy( buffer, begin, length );
+  buffer[length] = '\0';
+  return strtod( buffer, nullptr );
+}
+
 bool PCCPointSet3::write( const std::string& fileName, const bool asAscii ) {
   std::ofstream fout( fileName, std::ofstream::out );
   if ( !fout.is_open() ) { return false; }
@@ -407,104 +562,117 @@ bool PCCPointSet3::write( const std::string& fileName, const bool asAscii ) {
   fout << "element face 0" << std::endl;
   fout << "property list uint8 int32 vertex_index" << std::endl;
   fout << "end_header" << std::endl;
+
+  // the vertices are formatted in a buffer that is written in large blocks
+  const size_t      blockSize = size_t( 1 ) << 20;
+  std::vector<char> buffer;
   if ( asAscii ) {
-    fout << std::setprecision( std::numeric_limits<double>::max_digits10 );
+    buffer.resize( blockSize + 256 );
+    size_t size = 0;
     for ( size_t i = 0; i < pointCount; ++i ) {
+      char*             line     = buffer.data() + size;
       const PCCPoint3D& position = ( *this )[i];
-      fout << position.x() << " " << position.y() << " " << position.z();
+      int length = snprintf( line, 64, "%d %d %d", int( position.x() ), int( position.y() ), int( position.z() ) );
       if ( hasNormals() ) {
-        const PCCNormal3D& normal = getNormals()[i];
-        fout << " " << static_cast<float>( normal[0] ) << " " << static_cast<float>( normal[1] ) << " "
-             << static_cast<float>( normal[2] );
+        const PCCNormal3F& normal = getNormals()[i];
+        length += snprintf( line + length, 96, " %.17g %.17g %.17g", double( normal[0] ), double( normal[1] ),
+                            double( normal[2] ) );
       }
       if ( hasColors() ) {
         const PCCColor3B& color = getColor( i );
-        fout << " " << static_cast<int>( color[0] ) << " " << static_cast<int>( color[1] ) << " "
-             << static_cast<int>( color[2] );
+        length += snprintf( line + length, 16, " %d %d %d", int( color[0] ), int( color[1] ), int( color[2] ) );
+      }
+      if ( hasReflectances() ) { length += snprintf( line + length, 8, " %d", int( getReflectance( i ) ) ); }
+      if ( PCC_SAVE_POINT_TYPE != 0u ) { length += snprintf( line + length, 8, " %d", int( types_[i] ) ); }
+      line[length++] = '\n';
+      size += length;
+      if ( size >= blockSize || i + 1 == pointCount ) {
+        fout.write( buffer.data(), size );
+        size = 0;
       }
-      if ( hasReflectances() ) { fout << " " << static_cast<int>( getReflectance( i ) ); }
-      if ( PCC_SAVE_POINT_TYPE != 0u ) { fout << " " << static_cast<int>( types_[i] ); }
-      fout << std::endl;
     }
   } else {
     fout.clear();
     fout.close();
     fout.open( fileName, std::ofstream::binary | std::ofstream::out | std::ofstream::app );
-    for ( size_t i = 0; i < pointCount; ++i ) {
-      const PCCPoint3D& position = ( *this )[i];
-      // fout.write( reinterpret_cast<const char* const>( &position ), sizeof( PCCType ) * 3 );
-      float value[3];
-      value[0] = position[0];
-      value[1] = position[1];
-      value[2] = position[2];
-      fout.write( reinterpret_cast<const char*>( &value ), sizeof( float ) * 3 );
-      if ( hasNormals() ) {
-        const PCCNormal3D& normal = getNormals()[i];
-        value[0]                  = normal[0];
-        value[1]                  = normal[1];
-        value[2]                  = normal[2];
-        fout.write( reinterpret_cast<const char*>( &value ), sizeof( float ) * 3 );
-      }
-      if ( hasColors() ) {
-        const PCCColor3B& color = getColor( i );
-        fout.write( reinterpret_cast<const char*>( &color ), sizeof( uint8_t ) * 3 );
-      }
-      if ( hasReflectances() ) {
-        const uint16_t& reflectance = getReflectance( i );
-        fout.write( reinterpret_cast<const char*>( &reflectance ), sizeof( uint16_t ) );
-      }
-      if ( PCC_SAVE_POINT_TYPE != 0u ) {
-        fout.write( reinterpret_cast<const char* const>( &types_[i] ), sizeof( uint8_t ) );
+    const size_t stride = sizeof( float ) * 3 + ( hasNormals() ? sizeof( float ) * 3 : 0 ) +
+                          ( hasColors() ? sizeof( uint8_t ) * 3 : 0 ) + ( hasReflectances() ? sizeof( uint16_t ) : 0 ) +
+                          ( PCC_SAVE_POINT_TYPE != 0u ? sizeof( uint8_t ) : 0 );
+    const size_t blockPointCount = ( std::max )( blockSize / stride, size_t( 1 ) );
+    buffer.resize( ( std::min )( blockPointCount, pointCount ) * stride );
+    for ( size_t start = 0; start < pointCount; start += blockPointCount ) {
+      const size_t end  = ( std::min )( start + blockPointCount, pointCount );
+      char*        data = buffer.data();
+      for ( size_t i = start; i < end; ++i ) {
+        const PCCPoint3D& position = ( *this )[i];
+        // fout.write( reinterpret_cast<const char* const>( &position ), sizeof( PCCType ) * 3 );
+        float value[3];
+        value[0] = position[0];
+        value[1] = position[1];
+        value[2] = position[2];
+        memcpy( data, value, sizeof( float ) * 3 );
+        data += sizeof( float ) * 3;
+        if ( hasNormals() ) {
+          memcpy( data, &getNormals()[i][0], sizeof( float ) * 3 );
+          data += sizeof( float ) * 3;
+        }
+        if ( hasColors() ) {
+          memcpy( data, &getColor( i )[0], sizeof( uint8_t ) * 3 );
+          data += sizeof( uint8_t ) * 3;
+        }
+        if ( hasReflectances() ) {
+          memcpy( data, &getReflectance( i ), sizeof( uint16_t ) );
+          data += sizeof( uint16_t );
+        }
+        if ( PCC_SAVE_POINT_TYPE != 0u ) { *data++ = static_cast<char>( types_[i] ); }
       }
+      fout.write( buffer.data(), data - buffer.data() );
     }
   }
   fout.close();
   return true;
 }
 bool PCCPointSet3::read( const std::string& fileName, const bool readNormals ) {
-  std::ifstream ifs( fileName, std::ifstream::in );
-  if ( !ifs.is_open() ) { return false; }
-  enum AttributeType {
-    ATTRIBUTE_TYPE_FLOAT64 = 0,
-    ATTRIBUTE_TYPE_FLOAT32 = 1,
-    ATTRIBUTE_TYPE_UINT64  = 2,
-    ATTRIBUTE_TYPE_UINT32  = 3,
-    ATTRIBUTE_TYPE_UINT16  = 4,
-    ATTRIBUTE_TYPE_UINT8   = 5,
-    ATTRIBUTE_TYPE_INT64   = 6,
-    ATTRIBUTE_TYPE_INT32   = 7,
-    ATTRIBUTE_TYPE_INT16   = 8,
-    ATTRIBUTE_TYPE_INT8    = 9,
-  };
-  struct AttributeInfo {
-    std::string   name;
-    AttributeType type;
-    size_t        byteCount;
-  };
-
-  std::vector<AttributeInfo> attributesInfo;
+  PCCMappedFile file;
+  if ( !file.open( fileName ) ) { return false; }
+  const char*                   current = file.data();
+  const char* const             end     = file.data() + file.size();
+  std::vector<PlyAttributeInfo> attributesInfo;
   attributesInfo.reserve( 16 );
   const size_t             MAX_BUFFER_SIZE = 4096;
   char                     tmp[MAX_BUFFER_SIZE];
   const char*              sep = " \t\r";
   std::vector<std::string> tokens;
 
-  ifs.getline( tmp, MAX_BUFFER_SIZE );
+  // copies the next header line in tmp
+  auto getLine = [&]() {
+    const char* lineEnd =
+        current < end ? static_cast<const char*>( memchr( current, '\n', end - current ) ) : nullptr;
+    if ( lineEnd == nullptr ) { lineEnd = end; }
+    const size_t length = ( std::min )( size_t( lineEnd - current ), MAX_BUFFER_SIZE - 1 );
+    memcpy( tmp, current, length );
+    tmp[length] = '\0';
+    current     = lineEnd < end ? lineEnd + 1 : end;
+  };
+
+  getLine();
   getTokens( tmp, sep, tokens );
   if ( tokens.empty() || tokens[0] != "ply" ) {
     std::cout << "Error: corrupted file!" << std::endl;
     return false;
   }
   bool   isAscii          = false;
+  bool   isBigEndian      = false;
   double version          = 1.0;
   size_t pointCount       = 0;
+  size_t stride           = 0;
   bool   isVertexProperty = true;
   while ( true ) {
-    if ( ifs.eof() ) {
+    if ( current == end ) {
       std::cout << "Error: corrupted header!" << std::endl;
       return false;
     }
-    ifs.getline( tmp, MAX_BUFFER_SIZE );
+    getLine();
     getTokens( tmp, sep, tokens );
     if ( tokens.empty() || tokens[0] == "comment" ) { continue; }
     if ( tokens[0] == "format" ) {
@@ -512,8 +680,9 @@ bool PCCPointSet3::read( const std::string& fileName, const bool readNormals ) {
         std::cout << "Error: corrupted format info!" << std::endl;
         return false;
       }
-      isAscii = tokens[1] == "ascii";
-      version = atof( tokens[2].c_str() );
+      isAscii     = tokens[1] == "ascii";
+      isBigEndian = tokens[1] == "binary_big_endian";
+      version     = atof( tokens[2].c_str() );
     } else if ( tokens[0] == "element" ) {
       if ( tokens.size() != 3 ) {
         std::cout << "Error: corrupted element info!" << std::endl;
@@ -529,43 +698,46 @@ bool PCCPointSet3::read( const std::string& fileName, const bool readNormals ) {
         std::cout << "Error: corrupted property info!" << std::endl;
         return false;
       }
-      const std::string& propertyType   = tokens[1];
-      const std::string& propertyName   = tokens[2];
-      const size_t       attributeIndex = attributesInfo.size();
-      attributesInfo.resize( attributeIndex + 1 );
-      AttributeInfo& attributeInfo = attributesInfo[attributeIndex];
-      attributeInfo.name           = propertyName;
-      if ( propertyType == "float64" ) {
-        attributeInfo.type      = ATTRIBUTE_TYPE_FLOAT64;
+      const std::string& propertyType = tokens[1];
+      PlyAttributeInfo   attributeInfo;
+      attributeInfo.name   = tokens[2];
+      attributeInfo.offset = stride;
+      if ( propertyType == "float64" || propertyType == "double" ) {
+        attributeInfo.type      = PLY_ATTRIBUTE_TYPE_FLOAT64;
         attributeInfo.byteCount = 8;
       } else if ( propertyType == "float" || propertyType == "float32" ) {
-        attributeInfo.type      = ATTRIBUTE_TYPE_FLOAT32;
+        attributeInfo.type      = PLY_ATTRIBUTE_TYPE_FLOAT32;
         attributeInfo.byteCount = 4;
       } else if ( propertyType == "uint64" ) {
-        attributeInfo.type      = ATTRIBUTE_TYPE_UINT64;
+        attributeInfo.type      = PLY_ATTRIBUTE_TYPE_UINT64;
         attributeInfo.byteCount = 8;
-      } else if ( propertyType == "uint32" ) {
-        attributeInfo.type      = ATTRIBUTE_TYPE_UINT32;
+      } else if ( propertyType == "uint32" || propertyType == "uint" ) {
+        attributeInfo.type      = PLY_ATTRIBUTE_TYPE_UINT32;
         attributeInfo.byteCount = 4;
-      } else if ( propertyType == "uint16" ) {
-        attributeInfo.type      = ATTRIBUTE_TYPE_UINT16;
+      } else if ( propertyType == "uint16" || propertyType == "ushort" ) {
+        attributeInfo.type      = PLY_ATTRIBUTE_TYPE_UINT16;
         attributeInfo.byteCount = 2;
       } else if ( propertyType == "uchar" || propertyType == "uint8" ) {
-        attributeInfo.type      = ATTRIBUTE_TYPE_UINT8;
+        attributeInfo.type      = PLY_ATTRIBUTE_TYPE_UINT8;
         attributeInfo.byteCount = 1;
       } else if ( propertyType == "int64" ) {
-        attributeInfo.type      = ATTRIBUTE_TYPE_INT64;
+        attributeInfo.type      = PLY_ATTRIBUTE_TYPE_INT64;
         attributeInfo.byteCount = 8;
       } else if ( propertyType == "int32" || propertyType == "int" ) {
-        attributeInfo.type      = ATTRIBUTE_TYPE_INT32;
+        attributeInfo.type      = PLY_ATTRIBUTE_TYPE_INT32;
         attributeInfo.byteCount = 4;
-      } else if ( propertyType == "int16" ) {
-        attributeInfo.type      = ATTRIBUTE_TYPE_INT16;
+      } else if ( propertyType == "int16" || propertyType == "short" ) {
+        attributeInfo.type      = PLY_ATTRIBUTE_TYPE_INT16;
         attributeInfo.byteCount = 2;
       } else if ( propertyType == "char" || propertyType == "int8" ) {
-        attributeInfo.type      = ATTRIBUTE_TYPE_INT8;
+        attributeInfo.type      = PLY_ATTRIBUTE_TYPE_INT8;
         attributeInfo.byteCount = 1;
+      } else {
+        std::cout << "Error: non-supported property type " << propertyType << "!" << std::endl;
+        return false;
       }
+      stride += attributeInfo.byteCount;
+      attributesInfo.push_back( attributeInfo );
     } else if ( tokens[0] == "end_header" ) {
       break;
     }
@@ -623,136 +795,217 @@ bool PCCPointSet3::read( const std::string& fileName, const bool readNormals ) {
   withNormals_      = indexNX != g_undefined_index && indexNY != g_undefined_index && indexNZ != g_undefined_index;
   resize( pointCount );
   if ( isAscii ) {
+    std::vector<std::pair<const char*, const char*>> fields;
+    fields.reserve( attributeCount );
     size_t pointCounter = 0;
-    while ( !ifs.eof() && pointCounter < pointCount ) {
-      ifs.getline( tmp, MAX_BUFFER_SIZE );
-      getTokens( tmp, sep, tokens );
-      if ( tokens.empty() ) { continue; }
-      if ( tokens.size() < attributeCount ) { return false; }
+    while ( current < end && pointCounter < pointCount ) {
+      const char* lineEnd = static_cast<const char*>( memchr( current, '\n', end - current ) );
+      if ( lineEnd == nullptr ) { lineEnd = end; }
+      splitPlyLine( current, lineEnd, fields );
+      current = lineEnd < end ? lineEnd + 1 : end;
+      if ( fields.empty() ) { continue; }
+      if ( fields.size() < attributeCount ) { return false; }
       auto& position = positions_[pointCounter];
-      position[0]    = atof( tokens[indexX].c_str() );
-      position[1]    = atof( tokens[indexY].c_str() );
-      position[2]    = atof( tokens[indexZ].c_str() );
+      position[0]    = parsePlyReal( fields[indexX].first, fields[indexX].second );
+      position[1]    = parsePlyReal( fields[indexY].first, fields[indexY].second );
+      position[2]    = parsePlyReal( fields[indexZ].first, fields[indexZ].second );
       if ( hasColors() ) {
         auto& color = colors_[pointCounter];
-        color[0]    = atoi( tokens[indexR].c_str() );
-        color[1]    = atoi( tokens[indexG].c_str() );
-        color[2]    = atoi( tokens[indexB].c_str() );
+        color[0]    = parsePlyInteger( fields[indexR].first, fields[indexR].second );
+        color[1]    = parsePlyInteger( fields[indexG].first, fields[indexG].second );
+        color[2]    = parsePlyInteger( fields[indexB].first, fields[indexB].second );
+      }
+      if ( hasNormals() ) {
+        auto& normal = normals_[pointCounter];
+        normal[0]    = parsePlyReal( fields[indexNX].first, fields[indexNX].second );
+        normal[1]    = parsePlyReal( fields[indexNY].first, fields[indexNY].second );
+        normal[2]    = parsePlyReal( fields[indexNZ].first, fields[indexNZ].second );
+      }
+      if ( hasReflectances() ) {
+        reflectances_[pointCounter] =
+            uint16_t( parsePlyInteger( fields[indexReflectance].first, fields[indexReflectance].second ) );
       }
-      if ( hasReflectances() ) { reflectances_[pointCounter] = uint16_t( atoi( tokens[indexReflectance].c_str() ) ); }
       ++pointCounter;
     }
   } else {
-    ifs.close();
-    ifs.open( fileName, std::ifstream::binary | std::ifstream::in );
-    ifs.read( tmp, MAX_BUFFER_SIZE );
-    char* str       = strstr( tmp, "end_header" );
-    str             = strstr( str, "\n" );
-    int headerCount = str - tmp + 1;
-    ifs.close();
-    ifs.open( fileName, std::ifstream::binary | std::ifstream::in );
-    ifs.read( tmp, headerCount );
-    for ( size_t pointCounter = 0; pointCounter < pointCount && !ifs.eof(); ++pointCounter ) {
-      auto& position = positions_[pointCounter];
-      for ( size_t a = 0; a < attributeCount && !ifs.eof(); ++a ) {
-        const auto& attributeInfo = attributesInfo[a];
-        if ( a == indexX ) {
-          if ( attributeInfo.byteCount == 2 ) {
-            uint16_t x;
-            ifs.read( reinterpret_cast<char*>( &x ), sizeof( uint16_t ) );
-            position[0] = x;
-          } else if ( attributeInfo.byteCount == 4 ) {
-            float x;
-            ifs.read( reinterpret_cast<char*>( &x ), sizeof( float ) );
-            position[0] = x;
-          } else {
-            double x;
-            ifs.read( reinterpret_cast<char*>( &x ), sizeof( double ) );
-            position[0] = x;
-          }
-        } else if ( a == indexY ) {
-          if ( attributeInfo.byteCount == 2 ) {
-            uint16_t y;
-            ifs.read( reinterpret_cast<char*>( &y ), sizeof( uint16_t ) );
-            position[1] = y;
-          } else if ( attributeInfo.byteCount == 4 ) {
-            float y;
-            ifs.read( reinterpret_cast<char*>( &y ), sizeof( float ) );
-            position[1] = y;
-          } else {
-            double y;
-            ifs.read( reinterpret_cast<char*>( &y ), sizeof( double ) );
-            position[1] = y;
-          }
-        } else if ( a == indexZ ) {
-          if ( attributeInfo.byteCount == 2 ) {
-            uint16_t z;
-            ifs.read( reinterpret_cast<char*>( &z ), sizeof( uint16_t ) );
-            position[2] = z;
-          } else if ( attributeInfo.byteCount == 4 ) {
-            float z;
-            ifs.read( reinterpret_cast<char*>( &z ), sizeof( float ) );
-            position[2] = z;
-          } else {
-            double z;
-            ifs.read( reinterpret_cast<char*>( &z ), sizeof( double ) );
-            position[2] = z;
-          }
-        } else if ( a == indexR && attributeInfo.byteCount == 1 ) {
-          auto& color = colors_[pointCounter];
-          ifs.read( reinterpret_cast<char*>( &color[0] ), sizeof( uint8_t ) );
-        } else if ( a == indexG && attributeInfo.byteCount == 1 ) {
-          auto& color = colors_[pointCounter];
-          ifs.read( reinterpret_cast<char*>( &color[1] ), sizeof( uint8_t ) );
-        } else if ( a == indexB && attributeInfo.byteCount == 1 ) {
-          auto& color = colors_[pointCounter];
-          ifs.read( reinterpret_cast<char*>( &color[2] ), sizeof( uint8_t ) );
-        } else if ( a == indexNX ) {
-          if ( attributeInfo.byteCount == 4 ) {
-            float nx;
-            ifs.read( reinterpret_cast<char*>( &nx ), sizeof( float ) );
-            normals_[pointCounter][0] = nx;
-          } else {
-            double nx;
-            ifs.read( reinterpret_cast<char*>( &nx ), sizeof( double ) );
-            normals_[pointCounter][0] = nx;
-          }
-        } else if ( a == indexNY ) {
-          if ( attributeInfo.byteCount == 4 ) {
-            float ny;
-            ifs.read( reinterpret_cast<char*>( &ny ), sizeof( float ) );
-            normals_[pointCounter][1] = ny;
-          } else {
-            double ny;
-            ifs.read( reinterpret_cast<char*>( &ny ), sizeof( double ) );
-            normals_[pointCounter][1] = ny;
-          }
-        } else if ( a == indexNZ ) {
-          if ( attributeInfo.byteCount == 4 ) {
-            float nz;
-            ifs.read( reinterpret_cast<char*>( &nz ), sizeof( float ) );
-            normals_[pointCounter][2] = nz;
-          } else {
-            double nz;
-            ifs.read( reinterpret_cast<char*>( &nz ), sizeof( double ) );
-            normals_[pointCounter][2] = nz;
-          }
-        } else if ( a == indexReflectance && attributeInfo.byteCount <= 2 ) {
-          if ( indexReflectance == 1 ) {
-            uint8_t reflectance;
-            ifs.read( reinterpret_cast<char*>( &reflectance ), sizeof( uint8_t ) );
-            reflectances_[pointCounter] = reflectance;
-          } else {
-            auto& reflectance = reflectances_[pointCounter];
-            ifs.read( reinterpret_cast<char*>( reflectance ), sizeof( uint16_t ) );
-          }
-        } else {
-          char buffer[128];
-          ifs.read( buffer, attributeInfo.byteCount );
-        }
+    // the body is decoded in place, one attribute at a time, with a dedicated loop for the common layout of
+    // consecutive float coordinates and consecutive uchar colours
+    const char*  body      = current;
+    const size_t count     = stride > 0 ? ( std::min )( pointCount, size_t( end - body ) / stride ) : 0;
+    const bool   swapBytes = isBigEndian != ( PCCSystemEndianness() == PCC_BIG_ENDIAN );
+    const auto&  x         = attributesInfo[indexX];
+    const auto&  y         = attributesInfo[indexY];
+    const auto&  z         = attributesInfo[indexZ];
+    if ( !swapBytes && x.type == PLY_ATTRIBUTE_TYPE_FLOAT32 && y.type == PLY_ATTRIBUTE_TYPE_FLOAT32 &&
+         z.type == PLY_ATTRIBUTE_TYPE_FLOAT32 && y.offset == x.offset + 4 && z.offset == x.offset + 8 ) {
+      const char* data = body + x.offset;
+      for ( size_t i = 0; i < count; ++i, data += stride ) {
+        float value[3];
+        memcpy( value, data, sizeof( value ) );
+        auto& position = positions_[i];
+        position[0]    = value[0];
+        position[1]    = value[1];
+        position[2]    = value[2];
+      }
+    } else {
+      readPlyAttribute( x, body, stride, count, swapBytes, [&]( size_t i, auto value ) { positions_[i][0] = value; } );
+      readPlyAttribute( y, body, stride, count, swapBytes, [&]( size_t i, auto value ) { positions_[i][1] = value; } );
+      readPlyAttribute( z, body, stride, count, swapBytes, [&]( size_t i, auto value ) { positions_[i][2] = value; } );
+    }
+    if ( hasColors() ) {
+      const auto& r = attributesInfo[indexR];
+      const auto& g = attributesInfo[indexG];
+      const auto& b = attributesInfo[indexB];
+      if ( g.offset == r.offset + 1 && b.offset == r.offset + 2 ) {
+        const char* data = body + r.offset;
+        for ( size_t i = 0; i < count; ++i, data += stride ) { memcpy( &colors_[i][0], data, 3 ); }
+      } else {
+        readPlyAttribute( r, body, stride, count, swapBytes, [&]( size_t i, auto value ) { colors_[i][0] = value; } );
+        readPlyAttribute( g, body, stride, count, swapBytes, [&]( size_t i, auto value ) { colors_[i][1] = value; } );
+        readPlyAttribute( b, body, stride, count, swapBytes, [&]( size_t i, auto value ) { colors_[i][2] = value; } );
+      }
+    }
+    if ( hasNormals() ) {
+      for ( size_t k = 0; k < 3; ++k ) {
+        readPlyAttribute( attributesInfo[k == 0 ? indexNX : k == 1 ? indexNY : indexNZ], body, stride, count,
+                          swapBytes, [&]( size_t i, auto value ) { normals_[i][k] = value; } );
       }
     }
+    if ( hasReflectances() ) {
+      readPlyAttribute( attributesInfo[indexReflectance], body, stride, count, swapBytes,
+                        [&]( size_t i, auto value ) { reflectances_[i] = value; } );
+    }
+  }
+  return true;
+}
+
+// Point set cache: a fixed header followed by the positions, colours, normals and reflectances arrays, in the system
+// endianness. The source stamp and the options identify the decoded content, the checksum covers the arrays.
+static const uint32_t g_pointSetCacheVersion = 1;
+struct PCCPointSetCacheHeader {
+  char     magic_[4];
+  uint32_t version_;
+  uint32_t options_;
+  uint32_t channels_;
+  uint64_t sourceSize_;
+  int64_t  sourceTime_;
+  uint64_t pointCount_;
+  uint64_t checksum_;
+};
+
+static bool getFileStamp( const std::string& fileName, uint64_t& size, int64_t& time ) {
+  struct stat status;
+  if ( stat( fileName.c_str(), &status ) != 0 ) { return false; }
+  size = static_cast<uint64_t>( status.st_size );
+  time = static_cast<int64_t>( status.st_mtime );
+  return true;
+}
+
+// 64-bit FNV-1a over 8-byte words.
+static uint64_t updateCacheChecksum( uint64_t checksum, const void* data, const size_t size ) {
+  const char* bytes = static_cast<const char*>( data );
+  size_t      i     = 0;
+  for ( ; i + 8 <= size; i += 8 ) {
+    uint64_t word;
+    memcpy( &word, bytes + i, 8 );
+    checksum = ( checksum ^ word ) * 0x100000001b3ULL;
+  }
+  for ( ; i < size; ++i ) { checksum = ( checksum ^ static_cast<uint8_t>( bytes[i] ) ) * 0x100000001b3ULL; }
+  return checksum;
+}
+
+bool PCCPointSet3::writeCache( const std::string& fileName,
+                               const std::string& sourceFileName,
+                               const uint32_t     options ) const {
+  PCCPointSetCacheHeader header;
+  memcpy( header.magic_, "PCCC", 4 );
+  header.version_  = g_pointSetCacheVersion;
+  header.options_  = options;
+  header.channels_ = ( withColors_ ? 1 : 0 ) | ( withNormals_ ? 2 : 0 ) | ( withReflectances_ ? 4 : 0 );
+  if ( !getFileStamp( sourceFileName, header.sourceSize_, header.sourceTime_ ) ) { return false; }
+  header.pointCount_ = positions_.size();
+  uint64_t checksum = updateCacheChecksum( 0xcbf29ce484222325ULL, positions_.data(),
+                                           positions_.size() * sizeof( PCCPoint3D ) );
+  if ( withColors_ ) {
+    checksum = updateCacheChecksum( checksum, colors_.data(), colors_.size() * sizeof( PCCColor3B ) );
+  }
+  if ( withNormals_ ) {
+    checksum = updateCacheChecksum( checksum, normals_.data(), normals_.size() * sizeof( PCCNormal3F ) );
+  }
+  if ( withReflectances_ ) {
+    checksum = updateCacheChecksum( checksum, reflectances_.data(), reflectances_.size() * sizeof( uint16_t ) );
+  }
+  header.checksum_ = checksum;
+
+  // the cache is written aside, in a file of its own for each writer, then moved in place: concurrent readers and
+  // writers of the same cache only ever see complete files
+  const std::string temporaryFileName = getTemporaryFileName( fileName );
+  std::ofstream     fout( temporaryFileName, std::ofstream::binary | std::ofstream::out );
+  if ( !fout.is_open() ) { return false; }
+  fout.write( reinterpret_cast<const char*>( &header ), sizeof( header ) );
+  fout.write( reinterpret_cast<const char*>( positions_.data() ), positions_.size() * sizeof( PCCPoint3D ) );
+  if ( withColors_ ) {
+    fout.write( reinterpret_cast<const char*>( colors_.data() ), colors_.size() * sizeof( PCCColor3B ) );
+  }
+  if ( withNormals_ ) {
+    fout.write( reinterpret_cast<const char*>( normals_.data() ), normals_.size() * sizeof( PCCNormal3F ) );
+  }
+  if ( withReflectances_ ) {
+    fout.write( reinterpret_cast<const char*>( reflectances_.data() ), reflectances_.size() * sizeof( uint16_t ) );
+  }
+  fout.close();
+  if ( !fout ) {
+    remove( temporaryFileName.c_str() );
+    return false;
+  }
+  if ( !replaceFile( temporaryFileName, fileName ) ) {
+    remove( temporaryFileName.c_str() );
+    return false;
+  }
+  return true;
+}
+
+bool PCCPointSet3::readCache( const std::string& fileName, const std::string& sourceFileName, const uint32_t options ) {
+  PCCMappedFile file;
+  if ( !file.open( fileName ) || file.size() < sizeof( PCCPointSetCacheHeader ) ) { return false; }
+  PCCPointSetCacheHeader header;
+  memcpy( &header, file.data(), sizeof( header ) );
+  uint64_t sourceSize = 0;
+  int64_t  sourceTime = 0;
+  if ( memcmp( header.magic_, "PCCC", 4 ) != 0 || header.version_ != g_pointSetCacheVersion ||
+       header.options_ != options || !getFileStamp( sourceFileName, sourceSize, sourceTime ) ||
+       header.sourceSize_ != sourceSize || header.sourceTime_ != sourceTime ) {
+    return false;
+  }
+  const bool   withColors       = ( header.channels_ & 1 ) != 0;
+  const bool   withNormals      = ( header.channels_ & 2 ) != 0;
+  const bool   withReflectances = ( header.channels_ & 4 ) != 0;
+  const size_t pointCount       = header.pointCount_;
+  const size_t positionsSize    = pointCount * sizeof( PCCPoint3D );
+  const size_t colorsSize       = withColors ? pointCount * sizeof( PCCColor3B ) : 0;
+  const size_t normalsSize      = withNormals ? pointCount * sizeof( PCCNormal3F ) : 0;
+  const size_t reflectancesSize = withReflectances ? pointCount * sizeof( uint16_t ) : 0;
+  if ( pointCount > file.size() ||
+       file.size() != sizeof( header ) + positionsSize + colorsSize + normalsSize + reflectancesSize ) {
+    return false;
   }
+  const char* positions    = file.data() + sizeof( header );
+  const char* colors       = positions + positionsSize;
+  const char* normals      = colors + colorsSize;
+  const char* reflectances = normals + normalsSize;
+  uint64_t    checksum     = updateCacheChecksum( 0xcbf29ce484222325ULL, positions, positionsSize );
+  checksum                 = updateCacheChecksum( checksum, colors, colorsSize );
+  checksum                 = updateCacheChecksum( checksum, normals, normalsSize );
+  checksum                 = updateCacheChecksum( checksum, reflectances, reflectancesSize );
+  if ( checksum != header.checksum_ ) { return false; }
+  withColors_       = withColors;
+  withNormals_      = withNormals;
+  withReflectances_ = withReflectances;
+  resize( pointCount );
+  memcpy( reinterpret_cast<char*>( positions_.data() ), positions, positionsSize );
+  if ( withColors_ ) { memcpy( reinterpret_cast<char*>( colors_.data() ), colors, colorsSize ); }
+  if ( withNormals_ ) { memcpy( reinterpret_cast<char*>( normals_.data() ), normals, normalsSize ); }
+  if ( withReflectances_ ) { memcpy( reflectances_.data(), reflectances, reflectancesSize ); }
   return true;
 }
 
@@ -820,14 +1073,16 @@ bool PCCPointSet3::transferColors( PCCPointSet3& target,
                                    double        maxColorDist2Fwd,
                                    double        maxColorDist2Bwd,
                                    const bool    excludeColorOutlier,
-                                   const double  thresholdColorOutlierDist ) const {
+                                   const double  thresholdColorOutlierDist,
+                                   PCCKdTreeCache* kdtreeCache,
+                                   const size_t    nbThread ) const {
   printf( "transferColors \n" );
   const auto&  source           = *this;
   const size_t pointCountSource = source.getPointCount();
   const size_t pointCountTarget = target.getPointCount();
   if ( ( pointCountSource == 0u ) || ( pointCountTarget == 0u ) || !source.hasColors() ) { return false; }
-  PCCKdTree kdtreeTarget( target );
-  PCCKdTree kdtreeSource( source );
+  auto kdtreeTarget = kdtreeCache != nullptr ? kdtreeCache->get( target ) : std::make_shared<const PCCKdTree>( target );
+  auto kdtreeSource = kdtreeCache != nullptr ? kdtreeCache->get( source ) : std::make_shared<const PCCKdTree>( source );
   target.addColors();
   std::vector<PCCColor3B> refinedColors1;
   refinedColors1.resize( pointCountTarget );
@@ -841,94 +1096,96 @@ bool PCCPointSet3::transferColors( PCCPointSet3& target,
   // ==========================================================================================
   // for each target point indexed by index, derive the refined color as
   // refinedColors1[index]
-  PCCNNResult result;
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
-    kdtreeSource.search( target[index], numNeighborsColorTransferFwd, result );
-    // keep the points that satisfy geometry dist threshold
-    while ( true ) {
-      if ( result.size() == 1 ) { break; }
-      if ( result.dist( int( result.size() ) - 1 ) <= maxGeometryDist2Fwd ) { break; }
-      result.popBack();
-    }
-    bool isDone = false;
-    if ( skipAvgIfIdenticalSourcePointPresentFwd ) {
-      if ( result.dist( 0 ) < 0.0001 ) {
-        refinedColors1[index] = source.getColor( result.indices( 0 ) );
-        isDone                = true;
+  forEachRange( nbThread, pointCountTarget, [&]( const size_t begin, const size_t end ) {
+    PCCNNResult result;
+    for ( size_t index = begin; index < end; ++index ) {
+      kdtreeSource->search( target[index], numNeighborsColorTransferFwd, result );
+      // keep the points that satisfy geometry dist threshold
+      while ( true ) {
+        if ( result.size() == 1 ) { break; }
+        if ( result.dist( int( result.size() ) - 1 ) <= maxGeometryDist2Fwd ) { break; }
+        result.popBack();
       }
-    }
-    if ( !isDone ) {
-      int nNN = static_cast<int>( result.size() );
-      while ( nNN > 0 && !isDone ) {
-        if ( nNN == 1 ) {
+      bool isDone = false;
+      if ( skipAvgIfIdenticalSourcePointPresentFwd ) {
+        if ( result.dist( 0 ) < 0.0001 ) {
           refinedColors1[index] = source.getColor( result.indices( 0 ) );
           isDone                = true;
         }
-        if ( !isDone ) {
-          std::vector<PCCVector3D> colors;
-          colors.resize( 0 );
-          colors.resize( nNN );
-          for ( int i = 0; i < nNN; ++i ) {
-            for ( int k = 0; k < 3; ++k ) { colors[i][k] = double( source.getColor( result.indices( i ) )[k] ); }
+      }
+      if ( !isDone ) {
+        int nNN = static_cast<int>( result.size() );
+        while ( nNN > 0 && !isDone ) {
+          if ( nNN == 1 ) {
+            refinedColors1[index] = source.getColor( result.indices( 0 ) );
+            isDone                = true;
           }
-          double maxColorDist2 = std::numeric_limits<double>::min();
-          for ( int i = 0; i < nNN; ++i ) {
-            for ( int j = i + 1; j < nNN; ++j ) {
-              const double dist2 = ( colors[i] - colors[j] ).getNorm2();
-              if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
+          if ( !isDone ) {
+            std::vector<PCCVector3D> colors;
+            colors.resize( 0 );
+            colors.resize( nNN );
+            for ( int i = 0; i < nNN; ++i ) {
+              for ( int k = 0; k < 3; ++k ) { colors[i][k] = double( source.getColor( result.indices( i ) )[k] ); }
             }
-          }
-          if ( maxColorDist2 <= maxColorDist2Fwd ) {
-            PCCVector3D refinedColor( 0.0 );
-            if ( useDistWeightedAverageFwd ) {
-              double sumWeights{0.0};
-              for ( int i = 0; i < nNN; ++i ) {
-                const double weight = 1 / ( result.dist( i ) + distOffsetFwd );
-                for ( int k = 0; k < 3; ++k ) { refinedColor[k] += source.getColor( result.indices( i ) )[k] * weight; }
-                sumWeights += weight;
+            double maxColorDist2 = std::numeric_limits<double>::min();
+            for ( int i = 0; i < nNN; ++i ) {
+              for ( int j = i + 1; j < nNN; ++j ) {
+                const double dist2 = ( colors[i] - colors[j] ).getNorm2();
+                if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
               }
-              refinedColor /= sumWeights;
-              if ( excludeColorOutlier ) {
-                PCCVector3D excludeOutlierRefinedColor( 0.0 );
-                size_t      excludeCount = 0;
-                sumWeights               = 0.0;
+            }
+            if ( maxColorDist2 <= maxColorDist2Fwd ) {
+              PCCVector3D refinedColor( 0.0 );
+              if ( useDistWeightedAverageFwd ) {
+                double sumWeights{0.0};
                 for ( int i = 0; i < nNN; ++i ) {
-                  double      dist     = 0.0;
-                  PCCColor3B  tmpColor = source.getColor( result.indices( i ) );
-                  PCCVector3D sourceColor( tmpColor[0], tmpColor[1], tmpColor[2] );
-                  dist = ( sourceColor - refinedColor ).getNorm2();
-                  if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist ) {
-                    excludeCount += 1;
-                    continue;
-                  }
                   const double weight = 1 / ( result.dist( i ) + distOffsetFwd );
-                  for ( int k = 0; k < 3; ++k ) {
-                    excludeOutlierRefinedColor[k] += source.getColor( result.indices( i ) )[k] * weight;
-                  }
+                  for ( int k = 0; k < 3; ++k ) { refinedColor[k] += source.getColor( result.indices( i ) )[k] * weight; }
                   sumWeights += weight;
                 }
+                refinedColor /= sumWeights;
+                if ( excludeColorOutlier ) {
+                  PCCVector3D excludeOutlierRefinedColor( 0.0 );
+                  size_t      excludeCount = 0;
+                  sumWeights               = 0.0;
+                  for ( int i = 0; i < nNN; ++i ) {
+                    double      dist     = 0.0;
+                    PCCColor3B  tmpColor = source.getColor( result.indices( i ) );
+                    PCCVector3D sourceColor( tmpColor[0], tmpColor[1], tmpColor[2] );
+                    dist = ( sourceColor - refinedColor ).getNorm2();
+                    if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist ) {
+                      excludeCount += 1;
+                      continue;
+                    }
+                    const double weight = 1 / ( result.dist( i ) + distOffsetFwd );
+                    for ( int k = 0; k < 3; ++k ) {
+                      excludeOutlierRefinedColor[k] += source.getColor( result.indices( i ) )[k] * weight;
+                    }
+                    sumWeights += weight;
+                  }
 
-                if ( excludeCount != nNN && excludeCount != 0 ) {
-                  refinedColor = excludeOutlierRefinedColor / sumWeights;
+                  if ( excludeCount != nNN && excludeCount != 0 ) {
+                    refinedColor = excludeOutlierRefinedColor / sumWeights;
+                  }
                 }
+              } else {
+                for ( int i = 0; i < nNN; ++i ) {
+                  for ( int k = 0; k < 3; ++k ) { refinedColor[k] += source.getColor( result.indices( i ) )[k]; }
+                }
+                refinedColor /= nNN;
               }
-            } else {
-              for ( int i = 0; i < nNN; ++i ) {
-                for ( int k = 0; k < 3; ++k ) { refinedColor[k] += source.getColor( result.indices( i ) )[k]; }
+              for ( int k = 0; k < 3; ++k ) {
+                refinedColors1[index][k] = uint8_t( PCCClip( round( refinedColor[k] ), 0.0, 255.0 ) );
               }
-              refinedColor /= nNN;
-            }
-            for ( int k = 0; k < 3; ++k ) {
-              refinedColors1[index][k] = uint8_t( PCCClip( round( refinedColor[k] ), 0.0, 255.0 ) );
+              isDone = true;
+            } else {
+              --nNN;
             }
-            isDone = true;
-          } else {
-            --nNN;
           }
         }
       }
     }
-  }
+  } );
   // ==========================================================================================
   //                                  Backward direction
   // ==========================================================================================
@@ -940,186 +1197,188 @@ bool PCCPointSet3::transferColors( PCCPointSet3& target,
   std::vector<std::vector<DistColor8Bit>> refinedColorsDists2;
   refinedColorsDists2.resize( pointCountTarget );
   // populate refinedColorsDists2
-  for ( size_t index = 0; index < pointCountSource; ++index ) {
-    const PCCColor3B color = source.getColor( index );
-    kdtreeTarget.search( source[index], numNeighborsColorTransferBwd, result );
-    // keep the points that satisfy geometry dist threshold
-    for ( int i = 0; i < result.size(); ++i ) {
-      if ( result.dist( i ) <= maxGeometryDist2Bwd ) {
-        refinedColorsDists2[result.indices( i )].push_back( DistColor8Bit{result.dist( i ), color} );
-      }
-    }
-  }
+  gatherNeighbors(
+      *kdtreeTarget, source, pointCountSource, numNeighborsColorTransferBwd, []( size_t ) { return true; },
+      // keep the points that satisfy geometry dist threshold
+      [&]( size_t, size_t, double dist ) { return dist <= maxGeometryDist2Bwd; },
+      [&]( size_t index, size_t neighbor, double dist ) {
+        refinedColorsDists2[neighbor].push_back( DistColor8Bit{dist, source.getColor( index )} );
+      },
+      nbThread );
   // sort refinedColorsDists2 according to distance
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
-    std::sort( refinedColorsDists2[index].begin(), refinedColorsDists2[index].end(),
-               []( DistColor8Bit& dc1, DistColor8Bit& dc2 ) { return dc1.dist < dc2.dist; } );
-  }
+  forEachRange( nbThread, pointCountTarget, [&]( const size_t begin, const size_t end ) {
+    for ( size_t index = begin; index < end; ++index ) {
+      std::sort( refinedColorsDists2[index].begin(), refinedColorsDists2[index].end(),
+                 []( DistColor8Bit& dc1, DistColor8Bit& dc2 ) { return dc1.dist < dc2.dist; } );
+    }
+  } );
   // compute centroid2
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
-    const PCCColor3B color1       = refinedColors1[index];       // refined color derived in forward direction
-    auto&            colorsDists2 = refinedColorsDists2[index];  // set of candidate points
-                                                                 // derived in backward
-                                                                 // direction
-    if ( colorsDists2.empty() || losslessAttribute ) {
-      target.setColor( index, color1 );
-    } else {
-      bool              isDone = false;
-      const PCCVector3D centroid1( color1[0], color1[1], color1[2] );
-      PCCVector3D       centroid2( 0.0 );
-      if ( skipAvgIfIdenticalSourcePointPresentBwd ) {
-        if ( colorsDists2[0].dist < 0.0001 ) {
-          auto temp = colorsDists2[0];
-          colorsDists2.clear();
-          colorsDists2.push_back( temp );
-          for ( int k = 0; k < 3; ++k ) { centroid2[k] = colorsDists2[0].color[k]; }
-          isDone = true;
-        }
-      }
-      if ( !isDone ) {
-        int nNN = static_cast<int>( colorsDists2.size() );
-        while ( nNN > 0 && !isDone ) {
-          nNN = static_cast<int>( colorsDists2.size() );
-          if ( nNN == 1 ) {
+  forEachRange( nbThread, pointCountTarget, [&]( const size_t begin, const size_t end ) {
+    for ( size_t index = begin; index < end; ++index ) {
+      const PCCColor3B color1       = refinedColors1[index];       // refined color derived in forward direction
+      auto&            colorsDists2 = refinedColorsDists2[index];  // set of candidate points
+                                                                   // derived in backward
+                                                                   // direction
+      if ( colorsDists2.empty() || losslessAttribute ) {
+        target.setColor( index, color1 );
+      } else {
+        bool              isDone = false;
+        const PCCVector3D centroid1( color1[0], color1[1], color1[2] );
+        PCCVector3D       centroid2( 0.0 );
+        if ( skipAvgIfIdenticalSourcePointPresentBwd ) {
+          if ( colorsDists2[0].dist < 0.0001 ) {
             auto temp = colorsDists2[0];
             colorsDists2.clear();
             colorsDists2.push_back( temp );
             for ( int k = 0; k < 3; ++k ) { centroid2[k] = colorsDists2[0].color[k]; }
             isDone = true;
           }
-          if ( !isDone ) {
-            std::vector<PCCVector3D> colors;
-            colors.resize( 0 );
-            colors.resize( nNN );
-            for ( int i = 0; i < nNN; ++i ) {
-              for ( int k = 0; k < 3; ++k ) { colors[i][k] = double( colorsDists2[i].color[k] ); }
+        }
+        if ( !isDone ) {
+          int nNN = static_cast<int>( colorsDists2.size() );
+          while ( nNN > 0 && !isDone ) {
+            nNN = static_cast<int>( colorsDists2.size() );
+            if ( nNN == 1 ) {
+              auto temp = colorsDists2[0];
+              colorsDists2.clear();
+              colorsDists2.push_back( temp );
+              for ( int k = 0; k < 3; ++k ) { centroid2[k] = colorsDists2[0].color[k]; }
+              isDone = true;
             }
-            double maxColorDist2 = std::numeric_limits<double>::min();
-            for ( int i = 0; i < nNN; ++i ) {
-              for ( int j = i + 1; j < nNN; ++j ) {
-                const double dist2 = ( colors[i] - colors[j] ).getNorm2();
-                if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
+            if ( !isDone ) {
+              std::vector<PCCVector3D> colors;
+              colors.resize( 0 );
+              colors.resize( nNN );
+              for ( int i = 0; i < nNN; ++i ) {
+                for ( int k = 0; k < 3; ++k ) { colors[i][k] = double( colorsDists2[i].color[k] ); }
               }
-            }
-            if ( maxColorDist2 <= maxColorDist2Bwd ) {
-              for ( size_t k = 0; k < 3; ++k ) { centroid2[k] = 0; }
-              if ( useDistWeightedAverageBwd ) {
-                double sumWeights{0.0};
-                for ( auto& i : colorsDists2 ) {
-                  const double weight = 1 / ( sqrt( i.dist ) + distOffsetBwd );
-                  for ( size_t k = 0; k < 3; ++k ) { centroid2[k] += ( i.color[k] * weight ); }
-                  sumWeights += weight;
+              double maxColorDist2 = std::numeric_limits<double>::min();
+              for ( int i = 0; i < nNN; ++i ) {
+                for ( int j = i + 1; j < nNN; ++j ) {
+                  const double dist2 = ( colors[i] - colors[j] ).getNorm2();
+                  if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
                 }
-                centroid2 /= sumWeights;
-                if ( excludeColorOutlier ) {
-                  PCCVector3D excludeOutlierCentroid2( 0.0 );
-                  size_t      excludeCount = 0;
-                  sumWeights               = 0.0;
+              }
+              if ( maxColorDist2 <= maxColorDist2Bwd ) {
+                for ( size_t k = 0; k < 3; ++k ) { centroid2[k] = 0; }
+                if ( useDistWeightedAverageBwd ) {
+                  double sumWeights{0.0};
                   for ( auto& i : colorsDists2 ) {
-                    PCCVector3D sourceColor( i.color[0], i.color[1], i.color[2] );
-                    double      dist = ( sourceColor - centroid2 ).getNorm2();
-                    if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist ) {
-                      excludeCount += 1;
-                      continue;
-                    }
                     const double weight = 1 / ( sqrt( i.dist ) + distOffsetBwd );
-                    for ( size_t k = 0; k < 3; ++k ) { excludeOutlierCentroid2[k] += ( i.color[k] * weight ); }
+                    for ( size_t k = 0; k < 3; ++k ) { centroid2[k] += ( i.color[k] * weight ); }
                     sumWeights += weight;
                   }
+                  centroid2 /= sumWeights;
+                  if ( excludeColorOutlier ) {
+                    PCCVector3D excludeOutlierCentroid2( 0.0 );
+                    size_t      excludeCount = 0;
+                    sumWeights               = 0.0;
+                    for ( auto& i : colorsDists2 ) {
+                      PCCVector3D sourceColor( i.color[0], i.color[1], i.color[2] );
+                      double      dist = ( sourceColor - centroid2 ).getNorm2();
+                      if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist ) {
+                        excludeCount += 1;
+                        continue;
+                      }
+                      const double weight = 1 / ( sqrt( i.dist ) + distOffsetBwd );
+                      for ( size_t k = 0; k < 3; ++k ) { excludeOutlierCentroid2[k] += ( i.color[k] * weight ); }
+                      sumWeights += weight;
+                    }
 
-                  if ( excludeCount != nNN && excludeCount != 0 ) { centroid2 = excludeOutlierCentroid2 / sumWeights; }
+                    if ( excludeCount != nNN && excludeCount != 0 ) { centroid2 = excludeOutlierCentroid2 / sumWeights; }
+                  }
+                } else {
+                  for ( auto& coldist : colorsDists2 ) {
+                    for ( int k = 0; k < 3; ++k ) { centroid2[k] += coldist.color[k]; }
+                  }
+                  centroid2 /= colorsDists2.size();
                 }
+                isDone = true;
               } else {
-                for ( auto& coldist : colorsDists2 ) {
-                  for ( int k = 0; k < 3; ++k ) { centroid2[k] += coldist.color[k]; }
-                }
-                centroid2 /= colorsDists2.size();
+                colorsDists2.pop_back();
               }
-              isDone = true;
-            } else {
-              colorsDists2.pop_back();
             }
           }
         }
-      }
-      auto   H  = double( colorsDists2.size() );
-      double D2 = 0.0;
-      for ( const auto& color2dist : colorsDists2 ) {
-        auto color2 = color2dist.color;
-        for ( size_t k = 0; k < 3; ++k ) {
-          const double d2 = centroid2[k] - color2[k];
-          D2 += d2 * d2;
-        }
-      }
-      const double r      = double( pointCountTarget ) / double( pointCountSource );
-      const double delta2 = ( centroid2 - centroid1 ).getNorm2();
-      const double eps    = 0.000001;
-
-      const bool fixWeight = true;        // m42538
-      if ( fixWeight || delta2 > eps ) {  // centroid2 != centroid1
-        double w = 0.0;
-
-        if ( !fixWeight ) {
-          const double alpha = D2 / delta2;
-          const double a     = H * r - 1.0;
-          const double c     = alpha * r - 1.0;
-          if ( fabs( a ) < eps ) {
-            w = -0.5 * c;
-          } else {
-            const double delta = 1.0 - a * c;
-            if ( delta >= 0.0 ) { w = ( -1.0 + sqrt( delta ) ) / a; }
+        auto   H  = double( colorsDists2.size() );
+        double D2 = 0.0;
+        for ( const auto& color2dist : colorsDists2 ) {
+          auto color2 = color2dist.color;
+          for ( size_t k = 0; k < 3; ++k ) {
+            const double d2 = centroid2[k] - color2[k];
+            D2 += d2 * d2;
           }
         }
-        const double oneMinusW = 1.0 - w;
-        PCCVector3D  color0;
-        for ( size_t k = 0; k < 3; ++k ) {
-          color0[k] = PCCClip( round( w * centroid1[k] + oneMinusW * centroid2[k] ), 0.0, 255.0 );
-        }
-        const double rSource  = 1.0 / double( pointCountSource );
-        const double rTarget  = 1.0 / double( pointCountTarget );
-        const double maxValue = std::numeric_limits<uint8_t>::max();
-        double       minError = std::numeric_limits<double>::max();
-        PCCVector3D  bestColor( color0 );
-        PCCVector3D  color;
-        for ( int32_t s1 = -searchRange; s1 <= searchRange; ++s1 ) {
-          color[0] = PCCClip( color0[0] + s1, 0.0, maxValue );
-          for ( int32_t s2 = -searchRange; s2 <= searchRange; ++s2 ) {
-            color[1] = PCCClip( color0[1] + s2, 0.0, maxValue );
-            for ( int32_t s3 = -searchRange; s3 <= searchRange; ++s3 ) {
-              color[2] = PCCClip( color0[2] + s3, 0.0, maxValue );
-
-              double e1 = 0.0;
-              for ( size_t k = 0; k < 3; ++k ) {
-                const double d = color[k] - color1[k];
-                e1 += d * d;
-              }
-              e1 *= rTarget;
-
-              double e2 = 0.0;
-              for ( const auto& color2dist : colorsDists2 ) {
-                auto color2 = color2dist.color;
+        const double r      = double( pointCountTarget ) / double( pointCountSource );
+        const double delta2 = ( centroid2 - centroid1 ).getNorm2();
+        const double eps    = 0.000001;
+
+        const bool fixWeight = true;        // m42538
+        if ( fixWeight || delta2 > eps ) {  // centroid2 != centroid1
+          double w = 0.0;
+
+          if ( !fixWeight ) {
+            const double alpha = D2 / delta2;
+            const double a     = H * r - 1.0;
+            const double c     = alpha * r - 1.0;
+            if ( fabs( a ) < eps ) {
+              w = -0.5 * c;
+            } else {
+              const double delta = 1.0 - a * c;
+              if ( delta >= 0.0 ) { w = ( -1.0 + sqrt( delta ) ) / a; }
+            }
+          }
+          const double oneMinusW = 1.0 - w;
+          PCCVector3D  color0;
+          for ( size_t k = 0; k < 3; ++k ) {
+            color0[k] = PCCClip( round( w * centroid1[k] + oneMinusW * centroid2[k] ), 0.0, 255.0 );
+          }
+          const double rSource  = 1.0 / double( pointCountSource );
+          const double rTarget  = 1.0 / double( pointCountTarget );
+          const double maxValue = std::numeric_limits<uint8_t>::max();
+          double       minError = std::numeric_limits<double>::max();
+          PCCVector3D  bestColor( color0 );
+          PCCVector3D  color;
+          for ( int32_t s1 = -searchRange; s1 <= searchRange; ++s1 ) {
+            color[0] = PCCClip( color0[0] + s1, 0.0, maxValue );
+            for ( int32_t s2 = -searchRange; s2 <= searchRange; ++s2 ) {
+              color[1] = PCCClip( color0[1] + s2, 0.0, maxValue );
+              for ( int32_t s3 = -searchRange; s3 <= searchRange; ++s3 ) {
+                color[2] = PCCClip( color0[2] + s3, 0.0, maxValue );
+
+                double e1 = 0.0;
                 for ( size_t k = 0; k < 3; ++k ) {
-                  const double d = color[k] - color2[k];
-                  e2 += d * d;
+                  const double d = color[k] - color1[k];
+                  e1 += d * d;
                 }
-              }
-              e2 *= rSource;
+                e1 *= rTarget;
+
+                double e2 = 0.0;
+                for ( const auto& color2dist : colorsDists2 ) {
+                  auto color2 = color2dist.color;
+                  for ( size_t k = 0; k < 3; ++k ) {
+                    const double d = color[k] - color2[k];
+                    e2 += d * d;
+                  }
+                }
+                e2 *= rSource;
 
-              const double error = std::max( e1, e2 );
-              if ( error < minError ) {
-                minError  = error;
-                bestColor = color;
+                const double error = std::max( e1, e2 );
+                if ( error < minError ) {
+                  minError  = error;
+                  bestColor = color;
+                }
               }
             }
           }
+          target.setColor( index,
+                           PCCColor3B( uint8_t( bestColor[0] ), uint8_t( bestColor[1] ), uint8_t( bestColor[2] ) ) );
+        } else {  // centroid2 == centroid1
+          target.setColor( index, color1 );
         }
-        target.setColor( index,
-                         PCCColor3B( uint8_t( bestColor[0] ), uint8_t( bestColor[1] ), uint8_t( bestColor[2] ) ) );
-      } else {  // centroid2 == centroid1
-        target.setColor( index, color1 );
       }
     }
-  }
+  } );
   return true;
 }
 
@@ -1140,7 +1399,8 @@ bool PCCPointSet3::transferColors16bitBP( PCCPointSet3& target,
                                           double        maxColorDist2Fwd,
                                           double        maxColorDist2Bwd,
                                           const bool    excludeColorOutlier,
-                                          const double  thresholdColorOutlierDist ) const {
+                                          const double  thresholdColorOutlierDist,
+                                          const size_t  nbThread ) const {
   const auto&  source           = *this;
   const size_t pointCountSource = source.getPointCount();
   const size_t pointCountTarget = target.getPointCount();
@@ -1155,114 +1415,122 @@ bool PCCPointSet3::transferColors16bitBP( PCCPointSet3& target,
   maxColorDist2Fwd    = ( maxColorDist2Fwd < 131072 ) ? maxColorDist2Fwd : std::numeric_limits<double>::max();
   maxColorDist2Bwd    = ( maxColorDist2Bwd < 131072 ) ? maxColorDist2Bwd : std::numeric_limits<double>::max();
   PCCPointSet3 partSource;
-  partSource.addColors();
+  partSource.addColors16bit();
+  partSource.addParentPointIndexes();
   // ==========================================================================================
   //                                     Forward direction
   // ==========================================================================================
   // for each target point indexed by index, derive the refined color as
   // refinedColors1[index]
-  PCCNNResult result;
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
-    PCCColor16bit colorT16bit = target.getColor16bit( index );
-    for ( int k = 0; k < 3; ++k ) { refinedColors1[index][k] = colorT16bit[k]; }
-    if ( target.getBoundaryPointType( index ) == 3 ) {
-      kdtreeSource.search( target[index], numNeighborsColorTransferFwd, result );
-      if ( filterType == 1 ) {
-        for ( size_t rI = 0; rI < result.size(); ++rI ) {
-          auto indexInSource = result.indices( rI );
-          auto partIndex2    = partSource.addPoint( source[indexInSource] );
+  if ( filterType == 1 ) {
+    // the source neighbours of the boundary points, in target order
+    gatherNeighbors(
+        kdtreeSource, target, pointCountTarget, numNeighborsColorTransferFwd,
+        [&]( size_t index ) { return target.getBoundaryPointType( index ) == 3; },
+        []( size_t, size_t, double ) { return true; },
+        [&]( size_t, size_t indexInSource, double ) {
+          auto partIndex2 = partSource.addPoint( source[indexInSource] );
           partSource.setColor( partIndex2, source.getColor( indexInSource ) );
           partSource.setColor16bit( partIndex2, source.getColor16bit( indexInSource ) );
           partSource.setParentPointIndex( partIndex2, indexInSource );
+        },
+        nbThread );
+  }
+  forEachRange( nbThread, pointCountTarget, [&]( const size_t begin, const size_t end ) {
+    PCCNNResult result;
+    for ( size_t index = begin; index < end; ++index ) {
+      PCCColor16bit colorT16bit = target.getColor16bit( index );
+      for ( int k = 0; k < 3; ++k ) { refinedColors1[index][k] = colorT16bit[k]; }
+      if ( target.getBoundaryPointType( index ) == 3 ) {
+        kdtreeSource.search( target[index], numNeighborsColorTransferFwd, result );
+        // keep the points that satisfy geometry dist threshold
+        while ( true ) {
+          if ( result.size() == 1 ) { break; }
+          if ( result.dist( int( result.size() ) - 1 ) <= maxGeometryDist2Fwd ) { break; }
+          result.popBack();
         }
-      }
-      // keep the points that satisfy geometry dist threshold
-      while ( true ) {
-        if ( result.size() == 1 ) { break; }
-        if ( result.dist( int( result.size() ) - 1 ) <= maxGeometryDist2Fwd ) { break; }
-        result.popBack();
-      }
-      bool isDone = false;
-      if ( skipAvgIfIdenticalSourcePointPresentFwd ) {
-        if ( result.dist( 0 ) < 0.0001 ) {
-          refinedColors1[index] = source.getColor16bit( result.indices( 0 ) );
-          isDone                = true;
-        }
-      }
-      if ( !isDone ) {
-        int nNN = static_cast<int>( result.count() );
-        while ( nNN > 0 && !isDone ) {
-          if ( nNN == 1 ) {
+        bool isDone = false;
+        if ( skipAvgIfIdenticalSourcePointPresentFwd ) {
+          if ( result.dist( 0 ) < 0.0001 ) {
             refinedColors1[index] = source.getColor16bit( result.indices( 0 ) );
             isDone                = true;
           }
-          if ( !isDone ) {
-            std::vector<PCCVector3D> colors;
-            colors.resize( 0 );
-            colors.resize( nNN );
-            for ( int i = 0; i < nNN; ++i ) {
-              for ( int k = 0; k < 3; ++k ) { colors[i][k] = double( source.getColor16bit( result.indices( i ) )[k] ); }
+        }
+        if ( !isDone ) {
+          int nNN = static_cast<int>( result.count() );
+          while ( nNN > 0 && !isDone ) {
+            if ( nNN == 1 ) {
+              refinedColors1[index] = source.getColor16bit( result.indices( 0 ) );
+              isDone                = true;
             }
-            double maxColorDist2 = std::numeric_limits<double>::min();
-            for ( int i = 0; i < nNN; ++i ) {
-              for ( int j = i + 1; j < nNN; ++j ) {
-                const double dist2 = ( colors[i] - colors[j] ).getNorm2();
-                if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
+            if ( !isDone ) {
+              std::vector<PCCVector3D> colors;
+              colors.resize( 0 );
+              colors.resize( nNN );
+              for ( int i = 0; i < nNN; ++i ) {
+                for ( int k = 0; k < 3; ++k ) { colors[i][k] = double( source.getColor16bit( result.indices( i ) )[k] ); }
               }
-            }
-            if ( maxColorDist2 <= maxColorDist2Fwd ) {
-              PCCVector3D refinedColor( 0.0 );
-              if ( useDistWeightedAverageFwd ) {
-                double sumWeights{0.0};
-                for ( int i = 0; i < nNN; ++i ) {
-                  const double weight = 1 / ( result.dist( i ) + distOffsetFwd );
-                  for ( int k = 0; k < 3; ++k ) {
-                    refinedColor[k] += source.getColor16bit( result.indices( i ) )[k] * weight;
-                  }
-                  sumWeights += weight;
+              double maxColorDist2 = std::numeric_limits<double>::min();
+              for ( int i = 0; i < nNN; ++i ) {
+                for ( int j = i + 1; j < nNN; ++j ) {
+                  const double dist2 = ( colors[i] - colors[j] ).getNorm2();
+                  if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
                 }
-                refinedColor /= sumWeights;
-                if ( excludeColorOutlier ) {
-                  PCCVector3D excludeOutlierRefinedColor( 0.0 );
-                  size_t      excludeCount = 0;
-                  sumWeights               = 0.0;
+              }
+              if ( maxColorDist2 <= maxColorDist2Fwd ) {
+                PCCVector3D refinedColor( 0.0 );
+                if ( useDistWeightedAverageFwd ) {
+                  double sumWeights{0.0};
                   for ( int i = 0; i < nNN; ++i ) {
-                    PCCColor16bit tmpColor = source.getColor16bit( result.indices( i ) );
-                    PCCVector3D   sourceColor( tmpColor[0], tmpColor[1], tmpColor[2] );
-                    double        dist = ( sourceColor - refinedColor ).getNorm2();
-                    if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist * 256.0 * 256.0 ) {
-                      excludeCount += 1;
-                      continue;
-                    }
                     const double weight = 1 / ( result.dist( i ) + distOffsetFwd );
                     for ( int k = 0; k < 3; ++k ) {
-                      excludeOutlierRefinedColor[k] += source.getColor16bit( result.indices( i ) )[k] * weight;
+                      refinedColor[k] += source.getColor16bit( result.indices( i ) )[k] * weight;
                     }
                     sumWeights += weight;
                   }
+                  refinedColor /= sumWeights;
+                  if ( excludeColorOutlier ) {
+                    PCCVector3D excludeOutlierRefinedColor( 0.0 );
+                    size_t      excludeCount = 0;
+                    sumWeights               = 0.0;
+                    for ( int i = 0; i < nNN; ++i ) {
+                      PCCColor16bit tmpColor = source.getColor16bit( result.indices( i ) );
+                      PCCVector3D   sourceColor( tmpColor[0], tmpColor[1], tmpColor[2] );
+                      double        dist = ( sourceColor - refinedColor ).getNorm2();
+                      if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist * 256.0 * 256.0 ) {
+                        excludeCount += 1;
+                        continue;
+                      }
+                      const double weight = 1 / ( result.dist( i ) + distOffsetFwd );
+                      for ( int k = 0; k < 3; ++k ) {
+                        excludeOutlierRefinedColor[k] += source.getColor16bit( result.indices( i ) )[k] * weight;
+                      }
+                      sumWeights += weight;
+                    }
 
-                  if ( excludeCount != nNN && excludeCount != 0 ) {
-                    refinedColor = excludeOutlierRefinedColor / sumWeights;
+                    if ( excludeCount != nNN && excludeCount != 0 ) {
+                      refinedColor = excludeOutlierRefinedColor / sumWeights;
+                    }
+                  }
+                } else {
+                  for ( int i = 0; i < nNN; ++i ) {
+                    for ( int k = 0; k < 3; ++k ) { refinedColor[k] += source.getColor16bit( result.indices( i ) )[k]; }
                   }
+                  refinedColor /= nNN;
                 }
-              } else {
-                for ( int i = 0; i < nNN; ++i ) {
-                  for ( int k = 0; k < 3; ++k ) { refinedColor[k] += source.getColor16bit( result.indices( i ) )[k]; }
+                for ( int k = 0; k < 3; ++k ) {
+                  refinedColors1[index][k] = uint16_t( PCCClip( round( refinedColor[k] ), 0.0, 65535.0 ) );
                 }
-                refinedColor /= nNN;
-              }
-              for ( int k = 0; k < 3; ++k ) {
-                refinedColors1[index][k] = uint16_t( PCCClip( round( refinedColor[k] ), 0.0, 65535.0 ) );
+                isDone = true;
+              } else {
+                --nNN;
               }
-              isDone = true;
-            } else {
-              --nNN;
             }
           }
         }
       }
     }
-  }
+  } );
   // ==========================================================================================
   //                                  Backward direction
   // ==========================================================================================
@@ -1276,211 +1544,215 @@ bool PCCPointSet3::transferColors16bitBP( PCCPointSet3& target,
     refinedColorsDists2.resize( pointCountTarget );
     // populate refinedColorsDists2
     auto sampleSetPointCount = partSource.getPointCount();
-    for ( size_t index = 0; index < sampleSetPointCount; ++index ) {
-      const PCCColor16bit color = partSource.getColor16bit( index );
-      kdtreeTarget.search( partSource[index], numNeighborsColorTransferBwd, result );
-      // keep the points that satisfy geometry dist threshold
-      for ( int i = 0; i < result.size(); ++i ) {
-        if ( result.dist( i ) <= maxGeometryDist2Bwd ) {
-          if ( std::abs( color[0] - target.getColor16bit()[result.indices( i )][0] ) < 40 &&
-               std::abs( color[1] - target.getColor16bit()[result.indices( i )][1] ) < 40 &&
-               std::abs( color[2] - target.getColor16bit()[result.indices( i )][2] ) < 40 )
-            refinedColorsDists2[result.indices( i )].push_back( DistColor{
-                result.dist( i ), color, target[result.indices( i )], partSource.getParentPointIndex( index ), index} );
-        }
-      }
-    }
+    gatherNeighbors(
+        kdtreeTarget, partSource, sampleSetPointCount, numNeighborsColorTransferBwd, []( size_t ) { return true; },
+        // keep the points that satisfy geometry dist threshold
+        [&]( size_t index, size_t neighbor, double dist ) {
+          const PCCColor16bit color = partSource.getColor16bit( index );
+          return dist <= maxGeometryDist2Bwd && std::abs( color[0] - target.getColor16bit()[neighbor][0] ) < 40 &&
+                 std::abs( color[1] - target.getColor16bit()[neighbor][1] ) < 40 &&
+                 std::abs( color[2] - target.getColor16bit()[neighbor][2] ) < 40;
+        },
+        [&]( size_t index, size_t neighbor, double dist ) {
+          refinedColorsDists2[neighbor].push_back( DistColor{dist, partSource.getColor16bit( index ), target[neighbor],
+                                                             partSource.getParentPointIndex( index ), index} );
+        },
+        nbThread );
 
     // sort refinedColorsDists2 according to distance
-    for ( size_t index = 0; index < pointCountTarget; ++index ) {
-      std::sort( refinedColorsDists2[index].begin(), refinedColorsDists2[index].end(),
-                 []( DistColor& dc1, DistColor& dc2 ) { return dc1.dist < dc2.dist; } );
-    }
+    forEachRange( nbThread, pointCountTarget, [&]( const size_t begin, const size_t end ) {
+      for ( size_t index = begin; index < end; ++index ) {
+        std::sort( refinedColorsDists2[index].begin(), refinedColorsDists2[index].end(),
+                   []( DistColor& dc1, DistColor& dc2 ) { return dc1.dist < dc2.dist; } );
+      }
+    } );
   } else {
     // populate refinedColorsDists2
     refinedColorsDists2.resize( pointCountTarget );
-    for ( size_t index = 0; index < pointCountSource; ++index ) {
-      const PCCColor16bit color = source.getColor16bit( index );
-      kdtreeTarget.search( source[index], numNeighborsColorTransferBwd, result );
-      // keep the points that satisfy geometry dist threshold
-      for ( int i = 0; i < result.size(); ++i ) {
-        if ( result.dist( i ) <= maxGeometryDist2Bwd ) {
-          refinedColorsDists2[result.indices( i )].push_back( DistColor{result.dist( i ), color} );
-        }
-      }
-    }
+    gatherNeighbors(
+        kdtreeTarget, source, pointCountSource, numNeighborsColorTransferBwd, []( size_t ) { return true; },
+        // keep the points that satisfy geometry dist threshold
+        [&]( size_t, size_t, double dist ) { return dist <= maxGeometryDist2Bwd; },
+        [&]( size_t index, size_t neighbor, double dist ) {
+          refinedColorsDists2[neighbor].push_back( DistColor{dist, source.getColor16bit( index )} );
+        },
+        nbThread );
     // sort refinedColorsDists2 according to distance
-    for ( size_t index = 0; index < pointCountTarget; ++index ) {
-      std::sort( refinedColorsDists2[index].begin(), refinedColorsDists2[index].end(),
-                 []( DistColor& dc1, DistColor& dc2 ) { return dc1.dist < dc2.dist; } );
-    }
+    forEachRange( nbThread, pointCountTarget, [&]( const size_t begin, const size_t end ) {
+      for ( size_t index = begin; index < end; ++index ) {
+        std::sort( refinedColorsDists2[index].begin(), refinedColorsDists2[index].end(),
+                   []( DistColor& dc1, DistColor& dc2 ) { return dc1.dist < dc2.dist; } );
+      }
+    } );
   }
   // compute centroid2
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
-    if ( filterType == 1 && target.getBoundaryPointType( index ) != 3 ) continue;
-    const PCCColor16bit color1       = refinedColors1[index];       // refined color derived in forward direction
-    auto&               colorsDists2 = refinedColorsDists2[index];  // set of candidate points
-                                                                    // derived in backward
-                                                                    // direction
-    if ( colorsDists2.empty() || losslessAttribute ) {
-      target.setColor16bit( index, color1 );
-    } else {
-      bool              isDone = false;
-      const PCCVector3D centroid1( color1[0], color1[1], color1[2] );
-      PCCVector3D       centroid2( 0.0 );
-      if ( skipAvgIfIdenticalSourcePointPresentBwd ) {
-        if ( colorsDists2[0].dist < 0.0001 ) {
-          auto temp = colorsDists2[0];
-          colorsDists2.clear();
-          colorsDists2.push_back( temp );
-          for ( int k = 0; k < 3; ++k ) { centroid2[k] = colorsDists2[0].color[k]; }
-          isDone = true;
-        }
-      }
-      if ( !isDone ) {
-        int nNN = static_cast<int>( colorsDists2.size() );
-        while ( nNN > 0 && !isDone ) {
-          nNN = static_cast<int>( colorsDists2.size() );
-          if ( nNN == 1 ) {
+  forEachRange( nbThread, pointCountTarget, [&]( const size_t begin, const size_t end ) {
+    for ( size_t index = begin; index < end; ++index ) {
+      if ( filterType == 1 && target.getBoundaryPointType( index ) != 3 ) continue;
+      const PCCColor16bit color1       = refinedColors1[index];       // refined color derived in forward direction
+      auto&               colorsDists2 = refinedColorsDists2[index];  // set of candidate points
+                                                                      // derived in backward
+                                                                      // direction
+      if ( colorsDists2.empty() || losslessAttribute ) {
+        target.setColor16bit( index, color1 );
+      } else {
+        bool              isDone = false;
+        const PCCVector3D centroid1( color1[0], color1[1], color1[2] );
+        PCCVector3D       centroid2( 0.0 );
+        if ( skipAvgIfIdenticalSourcePointPresentBwd ) {
+          if ( colorsDists2[0].dist < 0.0001 ) {
             auto temp = colorsDists2[0];
             colorsDists2.clear();
             colorsDists2.push_back( temp );
             for ( int k = 0; k < 3; ++k ) { centroid2[k] = colorsDists2[0].color[k]; }
             isDone = true;
           }
-          if ( !isDone ) {
-            std::vector<PCCVector3D> colors;
-            colors.resize( 0 );
-            colors.resize( nNN );
-            for ( int i = 0; i < nNN; ++i ) {
-              for ( int k = 0; k < 3; ++k ) { colors[i][k] = double( colorsDists2[i].color[k] ); }
+        }
+        if ( !isDone ) {
+          int nNN = static_cast<int>( colorsDists2.size() );
+          while ( nNN > 0 && !isDone ) {
+            nNN = static_cast<int>( colorsDists2.size() );
+            if ( nNN == 1 ) {
+              auto temp = colorsDists2[0];
+              colorsDists2.clear();
+              colorsDists2.push_back( temp );
+              for ( int k = 0; k < 3; ++k ) { centroid2[k] = colorsDists2[0].color[k]; }
+              isDone = true;
             }
-            double maxColorDist2 = std::numeric_limits<double>::min();
-            for ( int i = 0; i < nNN; ++i ) {
-              for ( int j = i + 1; j < nNN; ++j ) {
-                const double dist2 = ( colors[i] - colors[j] ).getNorm2();
-                if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
+            if ( !isDone ) {
+              std::vector<PCCVector3D> colors;
+              colors.resize( 0 );
+              colors.resize( nNN );
+              for ( int i = 0; i < nNN; ++i ) {
+                for ( int k = 0; k < 3; ++k ) { colors[i][k] = double( colorsDists2[i].color[k] ); }
               }
-            }
-            if ( maxColorDist2 <= maxColorDist2Bwd ) {
-              for ( size_t k = 0; k < 3; ++k ) { centroid2[k] = 0; }
-              if ( useDistWeightedAverageBwd ) {
-                double sumWeights{0.0};
-                for ( auto& i : colorsDists2 ) {
-                  const double weight = 1 / ( sqrt( i.dist ) + distOffsetBwd );
-                  for ( size_t k = 0; k < 3; ++k ) { centroid2[k] += ( i.color[k] * weight ); }
-                  sumWeights += weight;
+              double maxColorDist2 = std::numeric_limits<double>::min();
+              for ( int i = 0; i < nNN; ++i ) {
+                for ( int j = i + 1; j < nNN; ++j ) {
+                  const double dist2 = ( colors[i] - colors[j] ).getNorm2();
+                  if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
                 }
-                centroid2 /= sumWeights;
-                if ( excludeColorOutlier ) {
-                  PCCVector3D excludeOutlierCentroid2( 0.0 );
-                  size_t      excludeCount = 0;
-                  sumWeights               = 0.0;
+              }
+              if ( maxColorDist2 <= maxColorDist2Bwd ) {
+                for ( size_t k = 0; k < 3; ++k ) { centroid2[k] = 0; }
+                if ( useDistWeightedAverageBwd ) {
+                  double sumWeights{0.0};
                   for ( auto& i : colorsDists2 ) {
-                    PCCVector3D sourceColor( i.color[0], i.color[1], i.color[2] );
-                    double      dist = ( sourceColor - centroid2 ).getNorm2();
-                    if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist * 256.0 * 256.0 ) {
-                      excludeCount += 1;
-                      continue;
-                    }
                     const double weight = 1 / ( sqrt( i.dist ) + distOffsetBwd );
-                    for ( size_t k = 0; k < 3; ++k ) { excludeOutlierCentroid2[k] += ( i.color[k] * weight ); }
+                    for ( size_t k = 0; k < 3; ++k ) { centroid2[k] += ( i.color[k] * weight ); }
                     sumWeights += weight;
                   }
+                  centroid2 /= sumWeights;
+                  if ( excludeColorOutlier ) {
+                    PCCVector3D excludeOutlierCentroid2( 0.0 );
+                    size_t      excludeCount = 0;
+                    sumWeights               = 0.0;
+                    for ( auto& i : colorsDists2 ) {
+                      PCCVector3D sourceColor( i.color[0], i.color[1], i.color[2] );
+                      double      dist = ( sourceColor - centroid2 ).getNorm2();
+                      if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist * 256.0 * 256.0 ) {
+                        excludeCount += 1;
+                        continue;
+                      }
+                      const double weight = 1 / ( sqrt( i.dist ) + distOffsetBwd );
+                      for ( size_t k = 0; k < 3; ++k ) { excludeOutlierCentroid2[k] += ( i.color[k] * weight ); }
+                      sumWeights += weight;
+                    }
 
-                  if ( excludeCount != nNN && excludeCount != 0 ) { centroid2 = excludeOutlierCentroid2 / sumWeights; }
+                    if ( excludeCount != nNN && excludeCount != 0 ) { centroid2 = excludeOutlierCentroid2 / sumWeights; }
+                  }
+                } else {
+                  for ( auto& coldist : colorsDists2 ) {
+                    for ( int k = 0; k < 3; ++k ) { centroid2[k] += coldist.color[k]; }
+                  }
+                  centroid2 /= colorsDists2.size();
                 }
+                isDone = true;
               } else {
-                for ( auto& coldist : colorsDists2 ) {
-                  for ( int k = 0; k < 3; ++k ) { centroid2[k] += coldist.color[k]; }
-                }
-                centroid2 /= colorsDists2.size();
+                colorsDists2.pop_back();
               }
-              isDone = true;
-            } else {
-              colorsDists2.pop_back();
             }
           }
         }
-      }
-      auto   H  = double( colorsDists2.size() );
-      double D2 = 0.0;
-      for ( const auto& color2dist : colorsDists2 ) {
-        auto color2 = color2dist.color;
-        for ( size_t k = 0; k < 3; ++k ) {
-          const double d2 = centroid2[k] - color2[k];
-          D2 += d2 * d2;
-        }
-      }
-      const double r      = double( pointCountTarget ) / double( pointCountSource );
-      const double delta2 = ( centroid2 - centroid1 ).getNorm2();
-      const double eps    = 0.000001;
-
-      const bool fixWeight = true;        // m42538
-      if ( fixWeight || delta2 > eps ) {  // centroid2 != centroid1
-        double w = 0.0;
-
-        if ( !fixWeight ) {
-          const double alpha = D2 / delta2;
-          const double a     = H * r - 1.0;
-          const double c     = alpha * r - 1.0;
-          if ( fabs( a ) < eps ) {
-            w = -0.5 * c;
-          } else {
-            const double delta = 1.0 - a * c;
-            if ( delta >= 0.0 ) { w = ( -1.0 + sqrt( delta ) ) / a; }
+        auto   H  = double( colorsDists2.size() );
+        double D2 = 0.0;
+        for ( const auto& color2dist : colorsDists2 ) {
+          auto color2 = color2dist.color;
+          for ( size_t k = 0; k < 3; ++k ) {
+            const double d2 = centroid2[k] - color2[k];
+            D2 += d2 * d2;
           }
         }
-        const double oneMinusW = 1.0 - w;
-        PCCVector3D  color0;
-        for ( size_t k = 0; k < 3; ++k ) {
-          color0[k] = PCCClip( round( w * centroid1[k] + oneMinusW * centroid2[k] ), 0.0, 65535.0 );
-        }
-        const double rSource  = 1.0 / double( pointCountSource );
-        const double rTarget  = 1.0 / double( pointCountTarget );
-        const double maxValue = std::numeric_limits<uint16_t>::max();
-        double       minError = std::numeric_limits<double>::max();
-        PCCVector3D  bestColor( color0 );
-        PCCVector3D  color;
-        for ( int32_t s1 = -searchRange; s1 <= searchRange; ++s1 ) {
-          color[0] = PCCClip( color0[0] + s1, 0.0, maxValue );
-          for ( int32_t s2 = -searchRange; s2 <= searchRange; ++s2 ) {
-            color[1] = PCCClip( color0[1] + s2, 0.0, maxValue );
-            for ( int32_t s3 = -searchRange; s3 <= searchRange; ++s3 ) {
-              color[2] = PCCClip( color0[2] + s3, 0.0, maxValue );
-
-              double e1 = 0.0;
-              for ( size_t k = 0; k < 3; ++k ) {
-                const double d = color[k] - color1[k];
-                e1 += d * d;
-              }
-              e1 *= rTarget;
-
-              double e2 = 0.0;
-              for ( const auto& color2dist : colorsDists2 ) {
-                auto color2 = color2dist.color;
+        const double r      = double( pointCountTarget ) / double( pointCountSource );
+        const double delta2 = ( centroid2 - centroid1 ).getNorm2();
+        const double eps    = 0.000001;
+
+        const bool fixWeight = true;        // m42538
+        if ( fixWeight || delta2 > eps ) {  // centroid2 != centroid1
+          double w = 0.0;
+
+          if ( !fixWeight ) {
+            const double alpha = D2 / delta2;
+            const double a     = H * r - 1.0;
+            const double c     = alpha * r - 1.0;
+            if ( fabs( a ) < eps ) {
+              w = -0.5 * c;
+            } else {
+              const double delta = 1.0 - a * c;
+              if ( delta >= 0.0 ) { w = ( -1.0 + sqrt( delta ) ) / a; }
+            }
+          }
+          const double oneMinusW = 1.0 - w;
+          PCCVector3D  color0;
+          for ( size_t k = 0; k < 3; ++k ) {
+            color0[k] = PCCClip( round( w * centroid1[k] + oneMinusW * centroid2[k] ), 0.0, 65535.0 );
+          }
+          const double rSource  = 1.0 / double( pointCountSource );
+          const double rTarget  = 1.0 / double( pointCountTarget );
+          const double maxValue = std::numeric_limits<uint16_t>::max();
+          double       minError = std::numeric_limits<double>::max();
+          PCCVector3D  bestColor( color0 );
+          PCCVector3D  color;
+          for ( int32_t s1 = -searchRange; s1 <= searchRange; ++s1 ) {
+            color[0] = PCCClip( color0[0] + s1, 0.0, maxValue );
+            for ( int32_t s2 = -searchRange; s2 <= searchRange; ++s2 ) {
+              color[1] = PCCClip( color0[1] + s2, 0.0, maxValue );
+              for ( int32_t s3 = -searchRange; s3 <= searchRange; ++s3 ) {
+                color[2] = PCCClip( color0[2] + s3, 0.0, maxValue );
+
+                double e1 = 0.0;
                 for ( size_t k = 0; k < 3; ++k ) {
-                  const double d = color[k] - color2[k];
-                  e2 += d * d;
+                  const double d = color[k] - color1[k];
+                  e1 += d * d;
                 }
-              }
-              e2 *= rSource;
+                e1 *= rTarget;
+
+                double e2 = 0.0;
+                for ( const auto& color2dist : colorsDists2 ) {
+                  auto color2 = color2dist.color;
+                  for ( size_t k = 0; k < 3; ++k ) {
+                    const double d = color[k] - color2[k];
+                    e2 += d * d;
+                  }
+                }
+                e2 *= rSource;
 
-              const double error = std::max( e1, e2 );
-              if ( error < minError ) {
-                minError  = error;
-                bestColor = color;
+                const double error = std::max( e1, e2 );
+                if ( error < minError ) {
+                  minError  = error;
+                  bestColor = color;
+                }
               }
             }
           }
+          target.setColor16bit(
+              index, PCCColor16bit( uint16_t( bestColor[0] ), uint16_t( bestColor[1] ), uint16_t( bestColor[2] ) ) );
+        } else {  // centroid2 == centroid1
+          target.setColor16bit( index, color1 );
         }
-        target.setColor16bit(
-            index, PCCColor16bit( uint16_t( bestColor[0] ), uint16_t( bestColor[1] ), uint16_t( bestColor[2] ) ) );
-      } else {  // centroid2 == centroid1
-        target.setColor16bit( index, color1 );
       }
     }
-  }
+  } );
   return true;
 }
 
@@ -1501,7 +1773,8 @@ bool PCCPointSet3::transferColorsBackward16bitBP( PCCPointSet3& target,
                                                   double        maxColorDist2Fwd,
                                                   double        maxColorDist2Bwd,
                                                   const bool    excludeColorOutlier,
-                                                  const double  thresholdColorOutlierDist ) const {
+                                                  const double  thresholdColorOutlierDist,
+                                                  const size_t  nbThread ) const {
   const auto&  source           = *this;
   const size_t pointCountSource = source.getPointCount();
   const size_t pointCountTarget = target.getPointCount();
@@ -1517,14 +1790,14 @@ bool PCCPointSet3::transferColorsBackward16bitBP( PCCPointSet3& target,
   // ==========================================================================================
   // backward search first
   // ==========================================================================================
-  PCCNNResult       result;
-  std::vector<bool> newValueDecided;
+  std::vector<uint8_t> newValueDecided;
   newValueDecided.resize( pointCountTarget, false );
   std::vector<PCCColor16bit> refinedColors1;
   refinedColors1.resize( pointCountTarget );
 
   PCCPointSet3 partTarget;
-  partTarget.addColors();
+  partTarget.addColors16bit();
+  partTarget.addParentPointIndexes();
   if ( filterType == 9 ) {
     for ( size_t index = 0; index < pointCountTarget; ++index ) {
       if ( target.getBoundaryPointType( index ) == 3 ) {
@@ -1542,133 +1815,138 @@ bool PCCPointSet3::transferColorsBackward16bitBP( PCCPointSet3& target,
   std::vector<std::vector<DistColor>> refinedColorsDists2;
   // populate refinedColorsDists2
   refinedColorsDists2.resize( pointCountTarget );
-  for ( size_t index = 0; index < pointCountSource; ++index ) {
-    const PCCColor16bit color = source.getColor16bit( index );
-    if ( target.getBoundaryPointType( index ) != 3 ) continue;
-    if ( filterType == 9 ) {
-      kdtreePartTarget.search( source[index], numNeighborsColorTransferBwd, result );
-      for ( int i = 0; i < result.count(); ++i ) {
-        if ( result.dist( i ) <= maxGeometryDist2Bwd &&
-             ( std::abs( color[0] - partTarget.getColor16bit()[result.indices( i )][0] ) < 40 &&
-               std::abs( color[1] - partTarget.getColor16bit()[result.indices( i )][1] ) < 40 &&
-               std::abs( color[2] - partTarget.getColor16bit()[result.indices( i )][2] ) < 40 ) ) {
-          auto indexInTarget = partTarget.getParentPointIndex( result.indices( i ) );
+  auto isBoundary = [&]( size_t index ) { return target.getBoundaryPointType( index ) == 3; };
+  if ( filterType == 9 ) {
+    gatherNeighbors(
+        kdtreePartTarget, source, pointCountSource, numNeighborsColorTransferBwd, isBoundary,
+        [&]( size_t index, size_t neighbor, double dist ) {
+          const PCCColor16bit color = source.getColor16bit( index );
+          return dist <= maxGeometryDist2Bwd && ( std::abs( color[0] - partTarget.getColor16bit()[neighbor][0] ) < 40 &&
+                                                  std::abs( color[1] - partTarget.getColor16bit()[neighbor][1] ) < 40 &&
+                                                  std::abs( color[2] - partTarget.getColor16bit()[neighbor][2] ) < 40 );
+        },
+        [&]( size_t index, size_t neighbor, double dist ) {
+          auto indexInTarget = partTarget.getParentPointIndex( neighbor );
           if ( target.getBoundaryPointType( indexInTarget ) != 3 ) {
             printf( "something wrong!!\n" );
             assert( 0 );
             exit( 0 );
           }
           refinedColorsDists2[indexInTarget].push_back(
-              DistColor{result.dist( i ), color, partTarget[result.indices( i )], indexInTarget, result.indices( i )} );
-        }
-      }
-    } else {
-      kdtreeTarget.search( source[index], numNeighborsColorTransferBwd, result );
-      // keep the points that satisfy geometry dist threshold
-      for ( int i = 0; i < result.count(); ++i ) {
-        if ( result.dist( i ) <= maxGeometryDist2Bwd ) {
-          refinedColorsDists2[result.indices( i )].push_back( DistColor{result.dist( i ), color} );
-        }
-      }
-    }
+              DistColor{dist, source.getColor16bit( index ), partTarget[neighbor], indexInTarget, neighbor} );
+        },
+        nbThread );
+  } else {
+    gatherNeighbors(
+        kdtreeTarget, source, pointCountSource, numNeighborsColorTransferBwd, isBoundary,
+        // keep the points that satisfy geometry dist threshold
+        [&]( size_t, size_t, double dist ) { return dist <= maxGeometryDist2Bwd; },
+        [&]( size_t index, size_t neighbor, double dist ) {
+          refinedColorsDists2[neighbor].push_back( DistColor{dist, source.getColor16bit( index )} );
+        },
+        nbThread );
   }
 
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
-    std::sort( refinedColorsDists2[index].begin(), refinedColorsDists2[index].end(),
-               []( DistColor& dc1, DistColor& dc2 ) { return dc1.dist < dc2.dist; } );
-  }
+  forEachRange( nbThread, pointCountTarget, [&]( const size_t begin, const size_t end ) {
+    for ( size_t index = begin; index < end; ++index ) {
+      std::sort( refinedColorsDists2[index].begin(), refinedColorsDists2[index].end(),
+                 []( DistColor& dc1, DistColor& dc2 ) { return dc1.dist < dc2.dist; } );
+    }
+  } );
 
   // compute centroid2
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
-    if ( target.getBoundaryPointType( index ) != 3 ) {
-      newValueDecided[index] = true;
-      continue;
-    }
-    if ( refinedColorsDists2[index].empty() ) { continue; }
-    auto&       colorsDists2 = refinedColorsDists2[index];
-    bool        isDone       = false;
-    PCCVector3D centroid2( 0.0 );
-    if ( skipAvgIfIdenticalSourcePointPresentBwd ) {
-      if ( colorsDists2[0].dist < 0.0001 ) {
-        auto temp = colorsDists2[0];
-        colorsDists2.clear();
-        colorsDists2.push_back( temp );
-        for ( int k = 0; k < 3; ++k ) { centroid2[k] = colorsDists2[0].color[k]; }
-        isDone = true;
+  forEachRange( nbThread, pointCountTarget, [&]( const size_t begin, const size_t end ) {
+    for ( size_t index = begin; index < end; ++index ) {
+      if ( target.getBoundaryPointType( index ) != 3 ) {
+        newValueDecided[index] = true;
+        continue;
       }
-    }
-    if ( !isDone ) {
-      int nNN = static_cast<int>( colorsDists2.size() );
-      while ( nNN > 0 && !isDone ) {
-        nNN = static_cast<int>( colorsDists2.size() );
-        if ( nNN == 1 ) {
+      if ( refinedColorsDists2[index].empty() ) { continue; }
+      auto&       colorsDists2 = refinedColorsDists2[index];
+      bool        isDone       = false;
+      PCCVector3D centroid2( 0.0 );
+      if ( skipAvgIfIdenticalSourcePointPresentBwd ) {
+        if ( colorsDists2[0].dist < 0.0001 ) {
           auto temp = colorsDists2[0];
           colorsDists2.clear();
           colorsDists2.push_back( temp );
           for ( int k = 0; k < 3; ++k ) { centroid2[k] = colorsDists2[0].color[k]; }
           isDone = true;
         }
-        if ( !isDone ) {
-          std::vector<PCCVector3D> colors;
-          colors.resize( 0 );
-          colors.resize( nNN );
-          for ( int i = 0; i < nNN; ++i ) {
-            for ( int k = 0; k < 3; ++k ) { colors[i][k] = double( colorsDists2[i].color[k] ); }
+      }
+      if ( !isDone ) {
+        int nNN = static_cast<int>( colorsDists2.size() );
+        while ( nNN > 0 && !isDone ) {
+          nNN = static_cast<int>( colorsDists2.size() );
+          if ( nNN == 1 ) {
+            auto temp = colorsDists2[0];
+            colorsDists2.clear();
+            colorsDists2.push_back( temp );
+            for ( int k = 0; k < 3; ++k ) { centroid2[k] = colorsDists2[0].color[k]; }
+            isDone = true;
           }
-          double maxColorDist2 = std::numeric_limits<double>::min();
-          for ( int i = 0; i < nNN; ++i ) {
-            for ( int j = i + 1; j < nNN; ++j ) {
-              const double dist2 = ( colors[i] - colors[j] ).getNorm2();
-              if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
+          if ( !isDone ) {
+            std::vector<PCCVector3D> colors;
+            colors.resize( 0 );
+            colors.resize( nNN );
+            for ( int i = 0; i < nNN; ++i ) {
+              for ( int k = 0; k < 3; ++k ) { colors[i][k] = double( colorsDists2[i].color[k] ); }
             }
-          }
-          if ( maxColorDist2 <= maxColorDist2Bwd ) {
-            for ( size_t k = 0; k < 3; ++k ) { centroid2[k] = 0; }
-            if ( useDistWeightedAverageBwd ) {
-              double sumWeights{0.0};
-              for ( auto& i : colorsDists2 ) {
-                const double weight = 1 / ( sqrt( i.dist ) + distOffsetBwd );
-                for ( size_t k = 0; k < 3; ++k ) { centroid2[k] += ( i.color[k] * weight ); }
-                sumWeights += weight;
+            double maxColorDist2 = std::numeric_limits<double>::min();
+            for ( int i = 0; i < nNN; ++i ) {
+              for ( int j = i + 1; j < nNN; ++j ) {
+                const double dist2 = ( colors[i] - colors[j] ).getNorm2();
+                if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
               }
-              centroid2 /= sumWeights;
-              if ( excludeColorOutlier ) {
-                PCCVector3D excludeOutlierCentroid2( 0.0 );
-                size_t      excludeCount = 0;
-                sumWeights               = 0.0;
+            }
+            if ( maxColorDist2 <= maxColorDist2Bwd ) {
+              for ( size_t k = 0; k < 3; ++k ) { centroid2[k] = 0; }
+              if ( useDistWeightedAverageBwd ) {
+                double sumWeights{0.0};
                 for ( auto& i : colorsDists2 ) {
-                  PCCVector3D sourceColor( i.color[0], i.color[1], i.color[2] );
-                  double      dist = ( sourceColor - centroid2 ).getNorm2();
-                  if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist * 256.0 * 256.0 ) {
-                    excludeCount += 1;
-                    continue;
-                  }
                   const double weight = 1 / ( sqrt( i.dist ) + distOffsetBwd );
-                  for ( size_t k = 0; k < 3; ++k ) { excludeOutlierCentroid2[k] += ( i.color[k] * weight ); }
+                  for ( size_t k = 0; k < 3; ++k ) { centroid2[k] += ( i.color[k] * weight ); }
                   sumWeights += weight;
                 }
+                centroid2 /= sumWeights;
+                if ( excludeColorOutlier ) {
+                  PCCVector3D excludeOutlierCentroid2( 0.0 );
+                  size_t      excludeCount = 0;
+                  sumWeights               = 0.0;
+                  for ( auto& i : colorsDists2 ) {
+                    PCCVector3D sourceColor( i.color[0], i.color[1], i.color[2] );
+                    double      dist = ( sourceColor - centroid2 ).getNorm2();
+                    if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist * 256.0 * 256.0 ) {
+                      excludeCount += 1;
+                      continue;
+                    }
+                    const double weight = 1 / ( sqrt( i.dist ) + distOffsetBwd );
+                    for ( size_t k = 0; k < 3; ++k ) { excludeOutlierCentroid2[k] += ( i.color[k] * weight ); }
+                    sumWeights += weight;
+                  }
 
-                if ( excludeCount != nNN && excludeCount != 0 ) { centroid2 = excludeOutlierCentroid2 / sumWeights; }
+                  if ( excludeCount != nNN && excludeCount != 0 ) { centroid2 = excludeOutlierCentroid2 / sumWeights; }
+                }
+              } else {
+                for ( auto& coldist : colorsDists2 ) {
+                  for ( int k = 0; k < 3; ++k ) { centroid2[k] += coldist.color[k]; }
+                }
+                centroid2 /= colorsDists2.size();
               }
+              isDone = true;
             } else {
-              for ( auto& coldist : colorsDists2 ) {
-                for ( int k = 0; k < 3; ++k ) { centroid2[k] += coldist.color[k]; }
-              }
-              centroid2 /= colorsDists2.size();
+              colorsDists2.pop_back();
             }
-            isDone = true;
-          } else {
-            colorsDists2.pop_back();
           }
         }
       }
-    }
 
-    PCCVector3D color0;
-    for ( size_t k = 0; k < 3; ++k ) { color0[k] = PCCClip( round( centroid2[k] ), 0.0, 65535.0 ); }
-    target.setColor16bit( index, PCCColor16bit( uint16_t( color0[0] ), uint16_t( color0[1] ), uint16_t( color0[2] ) ) );
-    newValueDecided[index] = true;
-  }
+      PCCVector3D color0;
+      for ( size_t k = 0; k < 3; ++k ) { color0[k] = PCCClip( round( centroid2[k] ), 0.0, 65535.0 ); }
+      target.setColor16bit( index, PCCColor16bit( uint16_t( color0[0] ), uint16_t( color0[1] ), uint16_t( color0[2] ) ) );
+      newValueDecided[index] = true;
+    }
+  } );
 
   // ==========================================================================================
   //                                     Forward direction
@@ -1676,14 +1954,153 @@ bool PCCPointSet3::transferColorsBackward16bitBP( PCCPointSet3& target,
   // for each target point indexed by index, derive the refined color as
   // refinedColors1[index]
 
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
-    PCCColor16bit colorT16bit = target.getColor16bit( index );
-    for ( int k = 0; k < 3; ++k ) { refinedColors1[index][k] = colorT16bit[k]; }
-    if ( target.getBoundaryPointType( index ) == 3 && newValueDecided[index] == false ) {
+  forEachRange( nbThread, pointCountTarget, [&]( const size_t begin, const size_t end ) {
+    PCCNNResult result;
+    for ( size_t index = begin; index < end; ++index ) {
+      PCCColor16bit colorT16bit = target.getColor16bit( index );
+      for ( int k = 0; k < 3; ++k ) { refinedColors1[index][k] = colorT16bit[k]; }
+      if ( target.getBoundaryPointType( index ) == 3 && newValueDecided[index] == false ) {
+        kdtreeSource.search( target[index], numNeighborsColorTransferFwd, result );
+        // keep the points that satisfy geometry dist threshold
+        while ( true ) {
+          if ( result.count() == 1 ) { break; }
+          if ( result.dist( int( result.size() ) - 1 ) <= maxGeometryDist2Fwd ) { break; }
+          result.popBack();
+        }
+        bool isDone = false;
+        if ( skipAvgIfIdenticalSourcePointPresentFwd ) {
+          if ( result.dist( 0 ) < 0.0001 ) {
+            refinedColors1[index] = source.getColor16bit( result.indices( 0 ) );
+            isDone                = true;
+          }
+        }
+        if ( !isDone ) {
+          int nNN = static_cast<int>( result.count() );
+          while ( nNN > 0 && !isDone ) {
+            if ( nNN == 1 ) {
+              refinedColors1[index] = source.getColor16bit( result.indices( 0 ) );
+              isDone                = true;
+            }
+            if ( !isDone ) {
+              std::vector<PCCVector3D> colors;
+              colors.resize( 0 );
+              colors.resize( nNN );
+              for ( int i = 0; i < nNN; ++i ) {
+                for ( int k = 0; k < 3; ++k ) { colors[i][k] = double( source.getColor16bit( result.indices( i ) )[k] ); }
+              }
+              double maxColorDist2 = std::numeric_limits<double>::min();
+              for ( int i = 0; i < nNN; ++i ) {
+                for ( int j = i + 1; j < nNN; ++j ) {
+                  const double dist2 = ( colors[i] - colors[j] ).getNorm2();
+                  if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
+                }
+              }
+              if ( maxColorDist2 <= maxColorDist2Fwd ) {
+                PCCVector3D refinedColor( 0.0 );
+                if ( useDistWeightedAverageFwd ) {
+                  double sumWeights{0.0};
+                  for ( int i = 0; i < nNN; ++i ) {
+                    const double weight = 1 / ( result.dist( i ) + distOffsetFwd );
+                    for ( int k = 0; k < 3; ++k ) {
+                      refinedColor[k] += source.getColor16bit( result.indices( i ) )[k] * weight;
+                    }
+                    sumWeights += weight;
+                  }
+                  refinedColor /= sumWeights;
+                  if ( excludeColorOutlier ) {
+                    PCCVector3D excludeOutlierRefinedColor( 0.0 );
+                    size_t      excludeCount = 0;
+                    sumWeights               = 0.0;
+                    for ( int i = 0; i < nNN; ++i ) {
+                      PCCColor16bit tmpColor = source.getColor16bit( result.indices( i ) );
+                      PCCVector3D   sourceColor( tmpColor[0], tmpColor[1], tmpColor[2] );
+                      double        dist = ( sourceColor - refinedColor ).getNorm2();
+                      if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist * 256.0 * 256.0 ) {
+                        excludeCount += 1;
+                        continue;
+                      }
+                      const double weight = 1 / ( result.dist( i ) + distOffsetFwd );
+                      for ( int k = 0; k < 3; ++k ) {
+                        excludeOutlierRefinedColor[k] += source.getColor16bit( result.indices( i ) )[k] * weight;
+                      }
+                      sumWeights += weight;
+                    }
+
+                    if ( excludeCount != nNN && excludeCount != 0 ) {
+                      refinedColor = excludeOutlierRefinedColor / sumWeights;
+                    }
+                  }
+                } else {
+                  for ( int i = 0; i < nNN; ++i ) {
+                    for ( int k = 0; k < 3; ++k ) { refinedColor[k] += source.getColor16bit( result.indices( i ) )[k]; }
+                  }
+                  refinedColor /= nNN;
+                }
+                for ( int k = 0; k < 3; ++k ) {
+                  refinedColors1[index][k] = uint16_t( PCCClip( round( refinedColor[k] ), 0.0, 65535.0 ) );
+                }
+                isDone = true;
+              } else {
+                --nNN;
+              }
+            }
+          }  // while
+        }    //! isDone
+
+        target.setColor16bit( index,
+                              PCCColor16bit( uint16_t( refinedColors1[index][0] ), uint16_t( refinedColors1[index][1] ),
+                                             uint16_t( refinedColors1[index][2] ) ) );
+      }  // if ( target.getBoundaryPointType( index ) == 3 && newValueDecided[ index ] == false )
+    }    // index
+  } );
+
+  return true;
+}
+bool PCCPointSet3::transferColors16bit( PCCPointSet3& target,
+                                        const int32_t searchRange,
+                                        const bool    losslessAttribute,
+                                        const int     numNeighborsColorTransferFwd,
+                                        const int     numNeighborsColorTransferBwd,
+                                        const bool    useDistWeightedAverageFwd,
+                                        const bool    useDistWeightedAverageBwd,
+                                        const bool    skipAvgIfIdenticalSourcePointPresentFwd,
+                                        const bool    skipAvgIfIdenticalSourcePointPresentBwd,
+                                        const double  distOffsetFwd,
+                                        const double  distOffsetBwd,
+                                        double        maxGeometryDist2Fwd,
+                                        double        maxGeometryDist2Bwd,
+                                        double        maxColorDist2Fwd,
+                                        double        maxColorDist2Bwd,
+                                        const bool    excludeColorOutlier,
+                                        const double  thresholdColorOutlierDist,
+                                        const size_t  nbThread ) const {
+  printf( "transferColors16bit \n" );
+  const auto&  source           = *this;
+  const size_t pointCountSource = source.getPointCount();
+  const size_t pointCountTarget = target.getPointCount();
+  if ( ( pointCountSource == 0u ) || ( pointCountTarget == 0u ) || !source.hasColors() ) { return false; }
+  PCCKdTree kdtreeTarget( target );
+  PCCKdTree kdtreeSource( source );
+  target.addColors16bit();
+  std::vector<PCCColor16bit> refinedColors1;
+  refinedColors1.resize( pointCountTarget );
+  maxGeometryDist2Fwd = ( maxGeometryDist2Fwd < 512 ) ? maxGeometryDist2Fwd : std::numeric_limits<double>::max();
+  maxGeometryDist2Bwd = ( maxGeometryDist2Bwd < 512 ) ? maxGeometryDist2Bwd : std::numeric_limits<double>::max();
+  maxColorDist2Fwd    = ( maxColorDist2Fwd < 131072 ) ? maxColorDist2Fwd : std::numeric_limits<double>::max();
+  maxColorDist2Bwd    = ( maxColorDist2Bwd < 131072 ) ? maxColorDist2Bwd : std::numeric_limits<double>::max();
+
+  // ==========================================================================================
+  //                                     Forward direction
+  // ==========================================================================================
+  // for each target point indexed by index, derive the refined color as
+  // refinedColors1[index]
+  forEachRange( nbThread, pointCountTarget, [&]( const size_t begin, const size_t end ) {
+    PCCNNResult result;
+    for ( size_t index = begin; index < end; ++index ) {
       kdtreeSource.search( target[index], numNeighborsColorTransferFwd, result );
       // keep the points that satisfy geometry dist threshold
       while ( true ) {
-        if ( result.count() == 1 ) { break; }
+        if ( result.size() == 1 ) { break; }
         if ( result.dist( int( result.size() ) - 1 ) <= maxGeometryDist2Fwd ) { break; }
         result.popBack();
       }
@@ -1695,7 +2112,7 @@ bool PCCPointSet3::transferColorsBackward16bitBP( PCCPointSet3& target,
         }
       }
       if ( !isDone ) {
-        int nNN = static_cast<int>( result.count() );
+        int nNN = static_cast<int>( result.size() );
         while ( nNN > 0 && !isDone ) {
           if ( nNN == 1 ) {
             refinedColors1[index] = source.getColor16bit( result.indices( 0 ) );
@@ -1764,143 +2181,10 @@ bool PCCPointSet3::transferColorsBackward16bitBP( PCCPointSet3& target,
               --nNN;
             }
           }
-        }  // while
-      }    //! isDone
-
-      target.setColor16bit( index,
-                            PCCColor16bit( uint16_t( refinedColors1[index][0] ), uint16_t( refinedColors1[index][1] ),
-                                           uint16_t( refinedColors1[index][2] ) ) );
-    }  // if ( target.getBoundaryPointType( index ) == 3 && newValueDecided[ index ] == false )
-  }    // index
-
-  return true;
-}
-bool PCCPointSet3::transferColors16bit( PCCPointSet3& target,
-                                        const int32_t searchRange,
-                                        const bool    losslessAttribute,
-                                        const int     numNeighborsColorTransferFwd,
-                                        const int     numNeighborsColorTransferBwd,
-                                        const bool    useDistWeightedAverageFwd,
-                                        const bool    useDistWeightedAverageBwd,
-                                        const bool    skipAvgIfIdenticalSourcePointPresentFwd,
-                                        const bool    skipAvgIfIdenticalSourcePointPresentBwd,
-                                        const double  distOffsetFwd,
-                                        const double  distOffsetBwd,
-                                        double        maxGeometryDist2Fwd,
-                                        double        maxGeometryDist2Bwd,
-                                        double        maxColorDist2Fwd,
-                                        double        maxColorDist2Bwd,
-                                        const bool    excludeColorOutlier,
-                                        const double  thresholdColorOutlierDist ) const {
-  printf( "transferColors16bit \n" );
-  const auto&  source           = *this;
-  const size_t pointCountSource = source.getPointCount();
-  const size_t pointCountTarget = target.getPointCount();
-  if ( ( pointCountSource == 0u ) || ( pointCountTarget == 0u ) || !source.hasColors() ) { return false; }
-  PCCKdTree kdtreeTarget( target );
-  PCCKdTree kdtreeSource( source );
-  target.addColors16bit();
-  std::vector<PCCColor16bit> refinedColors1;
-  refinedColors1.resize( pointCountTarget );
-  maxGeometryDist2Fwd = ( maxGeometryDist2Fwd < 512 ) ? maxGeometryDist2Fwd : std::numeric_limits<double>::max();
-  maxGeometryDist2Bwd = ( maxGeometryDist2Bwd < 512 ) ? maxGeometryDist2Bwd : std::numeric_limits<double>::max();
-  maxColorDist2Fwd    = ( maxColorDist2Fwd < 131072 ) ? maxColorDist2Fwd : std::numeric_limits<double>::max();
-  maxColorDist2Bwd    = ( maxColorDist2Bwd < 131072 ) ? maxColorDist2Bwd : std::numeric_limits<double>::max();
-
-  // ==========================================================================================
-  //                                     Forward direction
-  // ==========================================================================================
-  // for each target point indexed by index, derive the refined color as
-  // refinedColors1[index]
-  PCCNNResult result;
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
-    kdtreeSource.search( target[index], numNeighborsColorTransferFwd, result );
-    // keep the points that satisfy geometry dist threshold
-    while ( true ) {
-      if ( result.size() == 1 ) { break; }
-      if ( result.dist( int( result.size() ) - 1 ) <= maxGeometryDist2Fwd ) { break; }
-      result.popBack();
-    }
-    bool isDone = false;
-    if ( skipAvgIfIdenticalSourcePointPresentFwd ) {
-      if ( result.dist( 0 ) < 0.0001 ) {
-        refinedColors1[index] = source.getColor16bit( result.indices( 0 ) );
-        isDone                = true;
-      }
-    }
-    if ( !isDone ) {
-      int nNN = static_cast<int>( result.size() );
-      while ( nNN > 0 && !isDone ) {
-        if ( nNN == 1 ) {
-          refinedColors1[index] = source.getColor16bit( result.indices( 0 ) );
-          isDone                = true;
-        }
-        if ( !isDone ) {
-          std::vector<PCCVector3D> colors;
-          colors.resize( 0 );
-          colors.resize( nNN );
-          for ( int i = 0; i < nNN; ++i ) {
-            for ( int k = 0; k < 3; ++k ) { colors[i][k] = double( source.getColor16bit( result.indices( i ) )[k] ); }
-          }
-          double maxColorDist2 = std::numeric_limits<double>::min();
-          for ( int i = 0; i < nNN; ++i ) {
-            for ( int j = i + 1; j < nNN; ++j ) {
-              const double dist2 = ( colors[i] - colors[j] ).getNorm2();
-              if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
-            }
-          }
-          if ( maxColorDist2 <= maxColorDist2Fwd ) {
-            PCCVector3D refinedColor( 0.0 );
-            if ( useDistWeightedAverageFwd ) {
-              double sumWeights{0.0};
-              for ( int i = 0; i < nNN; ++i ) {
-                const double weight = 1 / ( result.dist( i ) + distOffsetFwd );
-                for ( int k = 0; k < 3; ++k ) {
-                  refinedColor[k] += source.getColor16bit( result.indices( i ) )[k] * weight;
-                }
-                sumWeights += weight;
-              }
-              refinedColor /= sumWeights;
-              if ( excludeColorOutlier ) {
-                PCCVector3D excludeOutlierRefinedColor( 0.0 );
-                size_t      excludeCount = 0;
-                sumWeights               = 0.0;
-                for ( int i = 0; i < nNN; ++i ) {
-                  PCCColor16bit tmpColor = source.getColor16bit( result.indices( i ) );
-                  PCCVector3D   sourceColor( tmpColor[0], tmpColor[1], tmpColor[2] );
-                  double        dist = ( sourceColor - refinedColor ).getNorm2();
-                  if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist * 256.0 * 256.0 ) {
-                    excludeCount += 1;
-                    continue;
-                  }
-                  const double weight = 1 / ( result.dist( i ) + distOffsetFwd );
-                  for ( int k = 0; k < 3; ++k ) {
-                    excludeOutlierRefinedColor[k] += source.getColor16bit( result.indices( i ) )[k] * weight;
-                  }
-                  sumWeights += weight;
-                }
-
-                if ( excludeCount != nNN && excludeCount != 0 ) {
-                  refinedColor = excludeOutlierRefinedColor / sumWeights;
-                }
-              }
-            } else {
-              for ( int i = 0; i < nNN; ++i ) {
-                for ( int k = 0; k < 3; ++k ) { refinedColor[k] += source.getColor16bit( result.indices( i ) )[k]; }
-              }
-              refinedColor /= nNN;
-            }
-            for ( int k = 0; k < 3; ++k ) {
-              refinedColors1[index][k] = uint16_t( PCCClip( round( refinedColor[k] ), 0.0, 65535.0 ) );
-            }
-            isDone = true;
-          } else {
-            --nNN;
-          }
         }
       }
     }
-  }
+  } );
   // ==========================================================================================
   //                                  Backward direction
   // ==========================================================================================
@@ -1912,186 +2196,188 @@ bool PCCPointSet3::transferColors16bit( PCCPointSet3& target,
   std::vector<std::vector<DistColor>> refinedColorsDists2;
   refinedColorsDists2.resize( pointCountTarget );
   // populate refinedColorsDists2
-  for ( size_t index = 0; index < pointCountSource; ++index ) {
-    const PCCColor16bit color = source.getColor16bit( index );
-    kdtreeTarget.search( source[index], numNeighborsColorTransferBwd, result );
-    // keep the points that satisfy geometry dist threshold
-    for ( int i = 0; i < result.size(); ++i ) {
-      if ( result.dist( i ) <= maxGeometryDist2Bwd ) {
-        refinedColorsDists2[result.indices( i )].push_back( DistColor{result.dist( i ), color} );
-      }
-    }
-  }
+  gatherNeighbors(
+      kdtreeTarget, source, pointCountSource, numNeighborsColorTransferBwd, []( size_t ) { return true; },
+      // keep the points that satisfy geometry dist threshold
+      [&]( size_t, size_t, double dist ) { return dist <= maxGeometryDist2Bwd; },
+      [&]( size_t index, size_t neighbor, double dist ) {
+        refinedColorsDists2[neighbor].push_back( DistColor{dist, source.getColor16bit( index )} );
+      },
+      nbThread );
   // sort refinedColorsDists2 according to distance
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
-    std::sort( refinedColorsDists2[index].begin(), refinedColorsDists2[index].end(),
-               []( DistColor& dc1, DistColor& dc2 ) { return dc1.dist < dc2.dist; } );
-  }
+  forEachRange( nbThread, pointCountTarget, [&]( const size_t begin, const size_t end ) {
+    for ( size_t index = begin; index < end; ++index ) {
+      std::sort( refinedColorsDists2[index].begin(), refinedColorsDists2[index].end(),
+                 []( DistColor& dc1, DistColor& dc2 ) { return dc1.dist < dc2.dist; } );
+    }
+  } );
   // compute centroid2
-  for ( size_t index = 0; index < pointCountTarget; ++index ) {
-    const PCCColor16bit color1       = refinedColors1[index];       // refined color derived in forward direction
-    auto&               colorsDists2 = refinedColorsDists2[index];  // set of candidate points
-                                                                    // derived in backward
-                                                                    // direction
-    if ( colorsDists2.empty() || losslessAttribute ) {
-      target.setColor16bit( index, color1 );
-    } else {
-      bool              isDone = false;
-      const PCCVector3D centroid1( color1[0], color1[1], color1[2] );
-      PCCVector3D       centroid2( 0.0 );
-      if ( skipAvgIfIdenticalSourcePointPresentBwd ) {
-        if ( colorsDists2[0].dist < 0.0001 ) {
-          auto temp = colorsDists2[0];
-          colorsDists2.clear();
-          colorsDists2.push_back( temp );
-          for ( int k = 0; k < 3; ++k ) { centroid2[k] = colorsDists2[0].color[k]; }
-          isDone = true;
-        }
-      }
-      if ( !isDone ) {
-        int nNN = static_cast<int>( colorsDists2.size() );
-        while ( nNN > 0 && !isDone ) {
-          nNN = static_cast<int>( colorsDists2.size() );
-          if ( nNN == 1 ) {
+  forEachRange( nbThread, pointCountTarget, [&]( const size_t begin, const size_t end ) {
+    for ( size_t index = begin; index < end; ++index ) {
+      const PCCColor16bit color1       = refinedColors1[index];       // refined color derived in forward direction
+      auto&               colorsDists2 = refinedColorsDists2[index];  // set of candidate points
+                                                                      // derived in backward
+                                                                      // direction
+      if ( colorsDists2.empty() || losslessAttribute ) {
+        target.setColor16bit( index, color1 );
+      } else {
+        bool              isDone = false;
+        const PCCVector3D centroid1( color1[0], color1[1], color1[2] );
+        PCCVector3D       centroid2( 0.0 );
+        if ( skipAvgIfIdenticalSourcePointPresentBwd ) {
+          if ( colorsDists2[0].dist < 0.0001 ) {
             auto temp = colorsDists2[0];
             colorsDists2.clear();
             colorsDists2.push_back( temp );
             for ( int k = 0; k < 3; ++k ) { centroid2[k] = colorsDists2[0].color[k]; }
             isDone = true;
           }
-          if ( !isDone ) {
-            std::vector<PCCVector3D> colors;
-            colors.resize( 0 );
-            colors.resize( nNN );
-            for ( int i = 0; i < nNN; ++i ) {
-              for ( int k = 0; k < 3; ++k ) { colors[i][k] = double( colorsDists2[i].color[k] ); }
+        }
+        if ( !isDone ) {
+          int nNN = static_cast<int>( colorsDists2.size() );
+          while ( nNN > 0 && !isDone ) {
+            nNN = static_cast<int>( colorsDists2.size() );
+            if ( nNN == 1 ) {
+              auto temp = colorsDists2[0];
+              colorsDists2.clear();
+              colorsDists2.push_back( temp );
+              for ( int k = 0; k < 3; ++k ) { centroid2[k] = colorsDists2[0].color[k]; }
+              isDone = true;
             }
-            double maxColorDist2 = std::numeric_limits<double>::min();
-            for ( int i = 0; i < nNN; ++i ) {
-              for ( int j = i + 1; j < nNN; ++j ) {
-                const double dist2 = ( colors[i] - colors[j] ).getNorm2();
-                if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
+            if ( !isDone ) {
+              std::vector<PCCVector3D> colors;
+              colors.resize( 0 );
+              colors.resize( nNN );
+              for ( int i = 0; i < nNN; ++i ) {
+                for ( int k = 0; k < 3; ++k ) { colors[i][k] = double( colorsDists2[i].color[k] ); }
               }
-            }
-            if ( maxColorDist2 <= maxColorDist2Bwd ) {
-              for ( size_t k = 0; k < 3; ++k ) { centroid2[k] = 0; }
-              if ( useDistWeightedAverageBwd ) {
-                double sumWeights{0.0};
-                for ( auto& i : colorsDists2 ) {
-                  const double weight = 1 / ( sqrt( i.dist ) + distOffsetBwd );
-                  for ( size_t k = 0; k < 3; ++k ) { centroid2[k] += ( i.color[k] * weight ); }
-                  sumWeights += weight;
+              double maxColorDist2 = std::numeric_limits<double>::min();
+              for ( int i = 0; i < nNN; ++i ) {
+                for ( int j = i + 1; j < nNN; ++j ) {
+                  const double dist2 = ( colors[i] - colors[j] ).getNorm2();
+                  if ( dist2 > maxColorDist2 ) { maxColorDist2 = dist2; }
                 }
-                centroid2 /= sumWeights;
-                if ( excludeColorOutlier ) {
-                  PCCVector3D excludeOutlierCentroid2( 0.0 );
-                  size_t      excludeCount = 0;
-                  sumWeights               = 0.0;
+              }
+              if ( maxColorDist2 <= maxColorDist2Bwd ) {
+                for ( size_t k = 0; k < 3; ++k ) { centroid2[k] = 0; }
+                if ( useDistWeightedAverageBwd ) {
+                  double sumWeights{0.0};
                   for ( auto& i : colorsDists2 ) {
-                    PCCVector3D sourceColor( i.color[0], i.color[1], i.color[2] );
-                    double      dist = ( sourceColor - centroid2 ).getNorm2();
-                    if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist * 256.0 * 256.0 ) {
-                      excludeCount += 1;
-                      continue;
-                    }
                     const double weight = 1 / ( sqrt( i.dist ) + distOffsetBwd );
-                    for ( size_t k = 0; k < 3; ++k ) { excludeOutlierCentroid2[k] += ( i.color[k] * weight ); }
+                    for ( size_t k = 0; k < 3; ++k ) { centroid2[k] += ( i.color[k] * weight ); }
                     sumWeights += weight;
                   }
+                  centroid2 /= sumWeights;
+                  if ( excludeColorOutlier ) {
+                    PCCVector3D excludeOutlierCentroid2( 0.0 );
+                    size_t      excludeCount = 0;
+                    sumWeights               = 0.0;
+                    for ( auto& i : colorsDists2 ) {
+                      PCCVector3D sourceColor( i.color[0], i.color[1], i.color[2] );
+                      double      dist = ( sourceColor - centroid2 ).getNorm2();
+                      if ( dist > thresholdColorOutlierDist * thresholdColorOutlierDist * 256.0 * 256.0 ) {
+                        excludeCount += 1;
+                        continue;
+                      }
+                      const double weight = 1 / ( sqrt( i.dist ) + distOffsetBwd );
+                      for ( size_t k = 0; k < 3; ++k ) { excludeOutlierCentroid2[k] += ( i.color[k] * weight ); }
+                      sumWeights += weight;
+                    }
 
-                  if ( excludeCount != nNN && excludeCount != 0 ) { centroid2 = excludeOutlierCentroid2 / sumWeights; }
+                    if ( excludeCount != nNN && excludeCount != 0 ) { centroid2 = excludeOutlierCentroid2 / sumWeights; }
+                  }
+                } else {
+                  for ( auto& coldist : colorsDists2 ) {
+                    for ( int k = 0; k < 3; ++k ) { centroid2[k] += coldist.color[k]; }
+                  }
+                  centroid2 /= colorsDists2.size();
                 }
+                isDone = true;
               } else {
-                for ( auto& coldist : colorsDists2 ) {
-                  for ( int k = 0; k < 3; ++k ) { centroid2[k] += coldist.color[k]; }
-                }
-                centroid2 /= colorsDists2.size();
+                colorsDists2.pop_back();
               }
-              isDone = true;
-            } else {
-              colorsDists2.pop_back();
             }
           }
         }
-      }
-      auto   H  = double( colorsDists2.size() );
-      double D2 = 0.0;
-      for ( const auto& color2dist : colorsDists2 ) {
-        auto color2 = color2dist.color;
-        for ( size_t k = 0; k < 3; ++k ) {
-          const double d2 = centroid2[k] - color2[k];
-          D2 += d2 * d2;
-        }
-      }
-      const double r      = double( pointCountTarget ) / double( pointCountSource );
-      const double delta2 = ( centroid2 - centroid1 ).getNorm2();
-      const double eps    = 0.000001;
-
-      const bool fixWeight = true;        // m42538
-      if ( fixWeight || delta2 > eps ) {  // centroid2 != centroid1
-        double w = 0.0;
-
-        if ( !fixWeight ) {
-          const double alpha = D2 / delta2;
-          const double a     = H * r - 1.0;
-          const double c     = alpha * r - 1.0;
-          if ( fabs( a ) < eps ) {
-            w = -0.5 * c;
-          } else {
-            const double delta = 1.0 - a * c;
-            if ( delta >= 0.0 ) { w = ( -1.0 + sqrt( delta ) ) / a; }
+        auto   H  = double( colorsDists2.size() );
+        double D2 = 0.0;
+        for ( const auto& color2dist : colorsDists2 ) {
+          auto color2 = color2dist.color;
+          for ( size_t k = 0; k < 3; ++k ) {
+            const double d2 = centroid2[k] - color2[k];
+            D2 += d2 * d2;
           }
         }
-        const double oneMinusW = 1.0 - w;
-        PCCVector3D  color0;
-        for ( size_t k = 0; k < 3; ++k ) {
-          color0[k] = PCCClip( round( w * centroid1[k] + oneMinusW * centroid2[k] ), 0.0, 65535.0 );
-        }
-        const double rSource  = 1.0 / double( pointCountSource );
-        const double rTarget  = 1.0 / double( pointCountTarget );
-        const double maxValue = std::numeric_limits<uint16_t>::max();
-        double       minError = std::numeric_limits<double>::max();
-        PCCVector3D  bestColor( color0 );
-        PCCVector3D  color;
-        for ( int32_t s1 = -searchRange; s1 <= searchRange; ++s1 ) {
-          color[0] = PCCClip( color0[0] + s1, 0.0, maxValue );
-          for ( int32_t s2 = -searchRange; s2 <= searchRange; ++s2 ) {
-            color[1] = PCCClip( color0[1] + s2, 0.0, maxValue );
-            for ( int32_t s3 = -searchRange; s3 <= searchRange; ++s3 ) {
-              color[2] = PCCClip( color0[2] + s3, 0.0, maxValue );
-
-              double e1 = 0.0;
-              for ( size_t k = 0; k < 3; ++k ) {
-                const double d = color[k] - color1[k];
-                e1 += d * d;
-              }
-              e1 *= rTarget;
-
-              double e2 = 0.0;
-              for ( const auto& color2dist : colorsDists2 ) {
-                auto color2 = color2dist.color;
+        const double r      = double( pointCountTarget ) / double( pointCountSource );
+        const double delta2 = ( centroid2 - centroid1 ).getNorm2();
+        const double eps    = 0.000001;
+
+        const bool fixWeight = true;        // m42538
+        if ( fixWeight || delta2 > eps ) {  // centroid2 != centroid1
+          double w = 0.0;
+
+          if ( !fixWeight ) {
+            const double alpha = D2 / delta2;
+            const double a     = H * r - 1.0;
+            const double c     = alpha * r - 1.0;
+            if ( fabs( a ) < eps ) {
+              w = -0.5 * c;
+            } else {
+              const double delta = 1.0 - a * c;
+              if ( delta >= 0.0 ) { w = ( -1.0 + sqrt( delta ) ) / a; }
+            }
+          }
+          const double oneMinusW = 1.0 - w;
+          PCCVector3D  color0;
+          for ( size_t k = 0; k < 3; ++k ) {
+            color0[k] = PCCClip( round( w * centroid1[k] + oneMinusW * centroid2[k] ), 0.0, 65535.0 );
+          }
+          const double rSource  = 1.0 / double( pointCountSource );
+          const double rTarget  = 1.0 / double( pointCountTarget );
+          const double maxValue = std::numeric_limits<uint16_t>::max();
+          double       minError = std::numeric_limits<double>::max();
+          PCCVector3D  bestColor( color0 );
+          PCCVector3D  color;
+          for ( int32_t s1 = -searchRange; s1 <= searchRange; ++s1 ) {
+            color[0] = PCCClip( color0[0] + s1, 0.0, maxValue );
+            for ( int32_t s2 = -searchRange; s2 <= searchRange; ++s2 ) {
+              color[1] = PCCClip( color0[1] + s2, 0.0, maxValue );
+              for ( int32_t s3 = -searchRange; s3 <= searchRange; ++s3 ) {
+                color[2] = PCCClip( color0[2] + s3, 0.0, maxValue );
+
+                double e1 = 0.0;
                 for ( size_t k = 0; k < 3; ++k ) {
-                  const double d = color[k] - color2[k];
-                  e2 += d * d;
+                  const double d = color[k] - color1[k];
+                  e1 += d * d;
                 }
-              }
-              e2 *= rSource;
+                e1 *= rTarget;
+
+                double e2 = 0.0;
+                for ( const auto& color2dist : colorsDists2 ) {
+                  auto color2 = color2dist.color;
+                  for ( size_t k = 0; k < 3; ++k ) {
+                    const double d = color[k] - color2[k];
+                    e2 += d * d;
+                  }
+                }
+                e2 *= rSource;
 
-              const double error = std::max( e1, e2 );
-              if ( error < minError ) {
-                minError  = error;
-                bestColor = color;
+                const double error = std::max( e1, e2 );
+                if ( error < minError ) {
+                  minError  = error;
+                  bestColor = color;
+                }
               }
             }
           }
+          target.setColor16bit(
+              index, PCCColor16bit( uint16_t( bestColor[0] ), uint16_t( bestColor[1] ), uint16_t( bestColor[2] ) ) );
+        } else {  // centroid2 == centroid1
+          target.setColor16bit( index, color1 );
         }
-        target.setColor16bit(
-            index, PCCColor16bit( uint16_t( bestColor[0] ), uint16_t( bestColor[1] ), uint16_t( bestColor[2] ) ) );
-      } else {  // centroid2 == centroid1
-        target.setColor16bit( index, color1 );
       }
     }
-  }
+  } );
   return true;
 }
 bool PCCPointSet3::transferColorsFilter3( PCCPointSet3& target,
@@ -2325,7 +2611,9 @@ void PCCPointSet3::scaleNormals( const PCCPointSet3& sourceWithNormal ) {
     exit( -1 );
   }
   addNormals();
-  std::vector<size_t> count;
+  // the normals are accumulated in double precision
+  std::vector<PCCNormal3D> normals( normals_.begin(), normals_.end() );
+  std::vector<size_t>      count;
   count.resize( getPointCount(), 0 );
   const size_t num_results_max  = 30;
   const size_t num_results_incr = 5;
@@ -2342,9 +2630,9 @@ void PCCPointSet3::scaleNormals( const PCCPointSet3& sourceWithNormal ) {
     for ( size_t j = 0; j < result.size(); ++j ) {
       if ( result.dist( 0 ) == result.dist( j ) ) {
         size_t index = result.indices( j );
-        normals_[index][0] += sourceWithNormal.normals_[i][0];
-        normals_[index][1] += sourceWithNormal.normals_[i][1];
-        normals_[index][2] += sourceWithNormal.normals_[i][2];
+        normals[index][0] += sourceWithNormal.normals_[i][0];
+        normals[index][1] += sourceWithNormal.normals_[i][1];
+        normals[index][2] += sourceWithNormal.normals_[i][2];
         count[index]++;
       }
     }
@@ -2352,9 +2640,9 @@ void PCCPointSet3::scaleNormals( const PCCPointSet3& sourceWithNormal ) {
 
   for ( long i = 0; i < getPointCount(); ++i ) {
     if ( count[i] > 0 ) {
-      normals_[i][0] /= count[i];
-      normals_[i][1] /= count[i];
-      normals_[i][2] /= count[i];
+      normals[i][0] /= count[i];
+      normals[i][1] /= count[i];
+      normals[i][2] /= count[i];
     } else {
       size_t num_results = 0;
       do {
@@ -2366,15 +2654,16 @@ void PCCPointSet3::scaleNormals( const PCCPointSet3& sourceWithNormal ) {
       for ( size_t j = 0; j < num_results; ++j ) {
         if ( result.dist( 0 ) == result.dist( j ) ) {
           size_t index = result.indices( j );
-          normals_[i][0] += sourceWithNormal.normals_[index][0];
-          normals_[i][1] += sourceWithNormal.normals_[index][1];
-          normals_[i][2] += sourceWithNormal.normals_[index][2];
+          normals[i][0] += sourceWithNormal.normals_[index][0];
+          normals[i][1] += sourceWithNormal.normals_[index][1];
+          normals[i][2] += sourceWithNormal.normals_[index][2];
           num++;
         }
       }
-      normals_[i][0] /= num;
-      normals_[i][1] /= num;
-      normals_[i][2] /= num;
+      normals[i][0] /= num;
+      normals[i][1] /= num;
+      normals[i][2] /= num;
     }
   }
+  std::copy( normals.begin(), normals.end(), normals_.begin() );
 }
@@ -36,10 +36,27 @@
 #include <windows.h>
 #endif
 
+#include <atomic>
 #include <chrono>
+#include <functional>
 #include <memory>
+#include <sstream>
+#include <streambuf>
+#include <thread>
 #include "PCCSystem.h"
 
+#ifndef _WIN32
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
 //===========================================================================
 
 #if _WIN32
@@ -105,3 +122,274 @@ int pcc::system( const char* command ) noexcept {
 #endif
 
 //===========================================================================
+
+#ifndef _WIN32
+namespace pcc {
+
+// stream buffer over a pipe file descriptor, used either for reading or for writing.
+class PCCPipeStreamBuffer : public std::streambuf {
+ public:
+  PCCPipeStreamBuffer( int fd ) : fd_( fd ), buffer_( 1 << 20 ) {
+    setg( buffer_.data(), buffer_.data(), buffer_.data() );
+    setp( buffer_.data(), buffer_.data() + buffer_.size() );
+  }
+  ~PCCPipeStreamBuffer() { flush(); }
+
+ protected:
+  int_type overflow( int_type c ) override {
+    if ( !flush() ) { return traits_type::eof(); }
+    if ( !traits_type::eq_int_type( c, traits_type::eof() ) ) {
+      *pptr() = traits_type::to_char_type( c );
+      pbump( 1 );
+    }
+    return traits_type::not_eof( c );
+  }
+  int      sync() override { return flush() ? 0 : -1; }
+  int_type underflow() override {
+    ssize_t size = 0;
+    do { size = ::read( fd_, buffer_.data(), buffer_.size() ); } while ( size < 0 && errno == EINTR );
+    if ( size <= 0 ) { return traits_type::eof(); }
+    setg( buffer_.data(), buffer_.data(), buffer_.data() + size );
+    return traits_type::to_int_type( *gptr() );
+  }
+
+ private:
+  bool flush() {
+    char* data = pbase();
+    while ( data < pptr() ) {
+      ssize_t size = ::write( fd_, data, pptr() - data );
+      if ( size < 0 && errno == EINTR ) { continue; }
+      if ( size <= 0 ) { return false; }
+      data += size;
+    }
+    setp( buffer_.data(), buffer_.data() + buffer_.size() );
+    return true;
+  }
+  int               fd_;
+  std::vector<char> buffer_;
+};
+
+// Blocks SIGPIPE on the calling thread while it writes to a pipe, so that a command that stops reading does not
+// kill TMC2, without changing the handler of the process. A SIGPIPE raised meanwhile is discarded before the previous
+// signal mask is restored.
+class PCCSigpipeBlocker {
+ public:
+  PCCSigpipeBlocker() {
+    sigemptyset( &sigpipe_ );
+    sigaddset( &sigpipe_, SIGPIPE );
+    pthread_sigmask( SIG_BLOCK, &sigpipe_, &previous_ );
+  }
+  ~PCCSigpipeBlocker() {
+    sigset_t pending;
+    int      signal = 0;
+    if ( !sigismember( &previous_, SIGPIPE ) && sigpending( &pending ) == 0 && sigismember( &pending, SIGPIPE ) ) {
+      sigwait( &sigpipe_, &signal );
+    }
+    pthread_sigmask( SIG_SETMASK, &previous_, nullptr );
+  }
+
+ private:
+  sigset_t sigpipe_;
+  sigset_t previous_;
+};
+
+// The pipes are opened in non-blocking mode and polled so that a command that
+// exits before opening its end of a pipe does not block TMC2 forever.
+static int openNamedPipeForWriting( const std::string& name, const std::atomic<bool>& done ) {
+  while ( true ) {
+    int fd = open( name.c_str(), O_WRONLY | O_NONBLOCK );
+    if ( fd >= 0 ) {
+      fcntl( fd, F_SETFL, fcntl( fd, F_GETFL ) & ~O_NONBLOCK );
+      return fd;
+    }
+    if ( errno != ENXIO || done ) { return -1; }
+    std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+  }
+}
+
+static int openNamedPipeForReading( const std::string& name, const std::atomic<bool>& done ) {
+  int fd = open( name.c_str(), O_RDONLY | O_NONBLOCK );
+  if ( fd < 0 ) { return -1; }
+  while ( true ) {
+    bool          last = done;
+    struct pollfd pfd  = {fd, POLLIN, 0};
+    if ( poll( &pfd, 1, last ? 0 : 10 ) > 0 && ( pfd.revents & ( POLLIN | POLLHUP ) ) != 0 ) {
+      fcntl( fd, F_SETFL, fcntl( fd, F_GETFL ) & ~O_NONBLOCK );
+      return fd;
+    }
+    if ( last ) {
+      close( fd );
+      return -1;
+    }
+  }
+}
+
+}  // namespace pcc
+
+bool pcc::namedPipesSupported() { return true; }
+
+bool pcc::createNamedPipe( const std::string& name ) {
+  removeFile( name );
+  if ( mkfifo( name.c_str(), 0600 ) != 0 ) {
+    printf( "Can't create named pipe: %s \n", name.c_str() );
+    return false;
+  }
+  return true;
+}
+
+int pcc::systemWithNamedPipes( const char*                                 command,
+                               const std::string&                          inputPipe,
+                               const std::function<bool( std::ostream& )>& source,
+                               const std::string&                          outputPipe,
+                               const std::function<bool( std::istream& )>& sink ) {
+  std::atomic<bool> done( false );
+  int               ret      = -1;
+  bool              sourceOk = true;
+  bool              sinkOk   = true;
+  std::thread       reader;
+  std::thread       process( [&] {
+    ret  = pcc::system( command );
+    done = true;
+  } );
+  if ( !outputPipe.empty() ) {
+    reader = std::thread( [&] {
+      int fd = openNamedPipeForReading( outputPipe, done );
+      if ( fd < 0 ) {
+        sinkOk = false;
+        return;
+      }
+      PCCPipeStreamBuffer buffer( fd );
+      std::istream        stream( &buffer );
+      sinkOk = sink( stream );
+      close( fd );
+    } );
+  }
+  if ( !inputPipe.empty() ) {
+    int fd = openNamedPipeForWriting( inputPipe, done );
+    if ( fd < 0 ) {
+      sourceOk = false;
+    } else {
+      // the threads above were started first: the command does not inherit the blocked SIGPIPE.
+      PCCSigpipeBlocker sigpipeBlocker;
+      {
+        PCCPipeStreamBuffer buffer( fd );
+        std::ostream        stream( &buffer );
+        sourceOk = source( stream ) && stream.flush().good();
+      }
+      close( fd );
+    }
+  }
+  if ( reader.joinable() ) { reader.join(); }
+  process.join();
+  if ( ret != 0 ) { return ret; }
+  return sourceOk && sinkOk ? 0 : -1;
+}
+
+#else
+
+bool pcc::namedPipesSupported() { return false; }
+
+bool pcc::createNamedPipe( const std::string& name ) { return false; }
+
+int pcc::systemWithNamedPipes( const char*                                 command,
+                               const std::string&                          inputPipe,
+                               const std::function<bool( std::ostream& )>& source,
+                               const std::string&                          outputPipe,
+                               const std::function<bool( std::istream& )>& sink ) {
+  return -1;
+}
+
+#endif
+
+//===========================================================================
+
+//===========================================================================
+
+#ifndef _WIN32
+
+bool pcc::PCCMappedFile::open( const std::string& fileName ) {
+  close();
+  int fd = ::open( fileName.c_str(), O_RDONLY );
+  if ( fd < 0 ) { return false; }
+  struct stat status;
+  if ( fstat( fd, &status ) != 0 ) {
+    ::close( fd );
+    return false;
+  }
+  size_ = static_cast<size_t>( status.st_size );
+  if ( size_ > 0 ) {
+    void* data = mmap( nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0 );
+    if ( data == MAP_FAILED ) {
+      ::close( fd );
+      size_ = 0;
+      return false;
+    }
+    madvise( data, size_, MADV_SEQUENTIAL );
+    data_   = static_cast<const char*>( data );
+    mapped_ = true;
+  }
+  ::close( fd );
+  return true;
+}
+
+void pcc::PCCMappedFile::close() {
+  if ( mapped_ ) { munmap( const_cast<char*>( data_ ), size_ ); }
+  buffer_.clear();
+  buffer_.shrink_to_fit();
+  data_   = nullptr;
+  size_   = 0;
+  mapped_ = false;
+}
+
+#else
+
+bool pcc::PCCMappedFile::open( const std::string& fileName ) {
+  close();
+  std::ifstream file( fileName, std::ifstream::binary | std::ifstream::ate );
+  if ( !file.is_open() ) { return false; }
+  buffer_.resize( static_cast<size_t>( file.tellg() ) );
+  file.seekg( 0 );
+  if ( !file.read( buffer_.data(), buffer_.size() ) ) {
+    buffer_.clear();
+    return false;
+  }
+  data_ = buffer_.data();
+  size_ = buffer_.size();
+  return true;
+}
+
+void pcc::PCCMappedFile::close() {
+  buffer_.clear();
+  buffer_.shrink_to_fit();
+  data_ = nullptr;
+  size_ = 0;
+}
+
+#endif
+
+//===========================================================================
+
+std::string pcc::getTemporaryFileName( const std::string& fileName ) {
+  static std::atomic<uint64_t> counter( 0 );
+#if _WIN32
+  const uint64_t processId = GetCurrentProcessId();
+#else
+  const uint64_t processId = static_cast<uint64_t>( getpid() );
+#endif
+  std::ostringstream name;
+  name << fileName << "." << processId << "." << std::hash<std::thread::id>()( std::this_thread::get_id() ) << "."
+       << counter++ << ".tmp";
+  return name.str();
+}
+
+//---------------------------------------------------------------------------
+
+bool pcc::replaceFile( const std::string& source, const std::string& target ) {
+#if _WIN32
+  return MoveFileExA( source.c_str(), target.c_str(), MOVEFILE_REPLACE_EXISTING ) != 0;
+#else
+  return rename( source.c_str(), target.c_str() ) == 0;
+#endif
+}
+
+//===========================================================================
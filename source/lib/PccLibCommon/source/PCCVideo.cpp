@@ -48,7 +48,7 @@ bool PCCVideo<T, N>::read( const std::string    fileName,
 }
 
 template <typename T, size_t N>
-bool PCCVideo<T, N>::read( std::ifstream&       infile,
+bool PCCVideo<T, N>::read( std::istream&        infile,
                            const size_t         sizeU0,
                            const size_t         sizeV0,
                            const PCCCOLORFORMAT format,
@@ -71,7 +71,7 @@ bool PCCVideo<T, N>::write( const std::string fileName, const size_t nbyte ) {
 }
 
 template <typename T, size_t N>
-bool PCCVideo<T, N>::write( std::ofstream& outfile, const size_t nbyte ) {
+bool PCCVideo<T, N>::write( std::ostream& outfile, const size_t nbyte ) {
   for ( auto& frame : frames_ ) {
     if ( !frame.write( outfile, nbyte ) ) { return false; }
   }
@@ -0,0 +1,262 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "PCCCommon.h"
+#include "PCCPointSet.h"
+#include "PCCVoxelGridIndex.h"
+
+using namespace pcc;
+
+// the coordinates are biased to be positive and the blocks are made of ( 1 << blockShift )^3 voxels
+static const int32_t  coordinateBias = 32768;
+static const int32_t  blockShift     = 3;
+static const uint64_t emptyKey       = ( std::numeric_limits<uint64_t>::max )();
+
+static inline uint64_t spreadBits( uint64_t value ) {
+  value &= 0x1fffff;
+  value = ( value | value << 32 ) & 0x1f00000000ffff;
+  value = ( value | value << 16 ) & 0x1f0000ff0000ff;
+  value = ( value | value << 8 ) & 0x100f00f00f00f00f;
+  value = ( value | value << 4 ) & 0x10c30c30c30c30c3;
+  value = ( value | value << 2 ) & 0x1249249249249249;
+  return value;
+}
+
+static inline uint64_t mortonCode( const PCCPoint3D& point ) {
+  return spreadBits( point[0] + coordinateBias ) | ( spreadBits( point[1] + coordinateBias ) << 1 ) |
+         ( spreadBits( point[2] + coordinateBias ) << 2 );
+}
+
+static inline uint64_t blockKey( const int32_t x, const int32_t y, const int32_t z ) {
+  return uint64_t( x ) | ( uint64_t( y ) << 16 ) | ( uint64_t( z ) << 32 );
+}
+
+static inline uint64_t blockHash( const uint64_t key ) { return ( key * 0x9E3779B97F4A7C15ULL ) >> 24; }
+
+static inline int64_t distance2( const PCCPoint3D& point0, const PCCPoint3D& point1 ) {
+  const int64_t dx = int32_t( point0[0] ) - int32_t( point1[0] );
+  const int64_t dy = int32_t( point0[1] ) - int32_t( point1[1] );
+  const int64_t dz = int32_t( point0[2] ) - int32_t( point1[2] );
+  return dx * dx + dy * dy + dz * dz;
+}
+
+PCCVoxelGridIndex::PCCVoxelGridIndex() : blockMask_( 0 ) {}
+
+PCCVoxelGridIndex::PCCVoxelGridIndex( const PCCPointSet3& pointCloud ) : blockMask_( 0 ) { init( pointCloud ); }
+
+PCCVoxelGridIndex::~PCCVoxelGridIndex() { clear(); }
+
+void PCCVoxelGridIndex::clear() {
+  points_.clear();
+  indices_.clear();
+  blocks_.clear();
+  blockMask_ = 0;
+}
+
+void PCCVoxelGridIndex::init( const PCCPointSet3& pointCloud ) {
+  clear();
+  const size_t pointCount = pointCloud.getPointCount();
+  if ( pointCount == 0 ) { return; }
+  assert( pointCount <= ( std::numeric_limits<uint32_t>::max )() );
+
+  // sort the points by Morton code: the points of a block are contiguous
+  std::vector<std::pair<uint64_t, uint32_t>> codes( pointCount );
+  for ( size_t i = 0; i < pointCount; ++i ) { codes[i] = std::make_pair( mortonCode( pointCloud[i] ), uint32_t( i ) ); }
+  std::sort( codes.begin(), codes.end() );
+  points_.resize( pointCount );
+  indices_.resize( pointCount );
+  size_t blockCount = 0;
+  for ( size_t i = 0; i < pointCount; ++i ) {
+    indices_[i] = codes[i].second;
+    points_[i]  = pointCloud[codes[i].second];
+    if ( i == 0 || ( codes[i].first >> ( 3 * blockShift ) ) != ( codes[i - 1].first >> ( 3 * blockShift ) ) ) {
+      blockCount++;
+    }
+  }
+
+  // hash table of the occupied blocks
+  size_t capacity = 1;
+  while ( capacity < 2 * blockCount ) { capacity <<= 1; }
+  blocks_.assign( capacity, Block{emptyKey, 0, 0} );
+  blockMask_ = capacity - 1;
+  for ( size_t k = 0; k < 3; ++k ) {
+    blockMin_[k] = ( std::numeric_limits<int32_t>::max )();
+    blockMax_[k] = ( std::numeric_limits<int32_t>::min )();
+  }
+  for ( size_t begin = 0, end = 0; begin < pointCount; begin = end ) {
+    const uint64_t code = codes[begin].first >> ( 3 * blockShift );
+    for ( end = begin + 1; end < pointCount && ( codes[end].first >> ( 3 * blockShift ) ) == code; ++end ) {}
+    int32_t block[3];
+    for ( size_t k = 0; k < 3; ++k ) {
+      block[k]     = ( points_[begin][k] + coordinateBias ) >> blockShift;
+      blockMin_[k] = ( std::min )( blockMin_[k], block[k] );
+      blockMax_[k] = ( std::max )( blockMax_[k], block[k] );
+    }
+    const uint64_t key   = blockKey( block[0], block[1], block[2] );
+    size_t         index = blockHash( key ) & blockMask_;
+    while ( blocks_[index].key_ != emptyKey ) { index = ( index + 1 ) & blockMask_; }
+    blocks_[index] = Block{key, uint32_t( begin ), uint32_t( end )};
+  }
+}
+
+const PCCVoxelGridIndex::Block* PCCVoxelGridIndex::findBlock( int32_t x, int32_t y, int32_t z ) const {
+  const uint64_t key   = blockKey( x, y, z );
+  size_t         index = blockHash( key ) & blockMask_;
+  while ( true ) {
+    const auto& block = blocks_[index];
+    if ( block.key_ == key ) { return &block; }
+    if ( block.key_ == emptyKey ) { return nullptr; }
+    index = ( index + 1 ) & blockMask_;
+  }
+}
+
+// inserts the points of a block with a squared distance lower or equal to maxDist2 in the max-heap of the
+// numResults nearest neighbours
+void PCCVoxelGridIndex::searchBlock( const Block&      block,
+                                     const PCCPoint3D& point,
+                                     const size_t      numResults,
+                                     const int64_t     maxDist2,
+                                     Neighbor*         neighbors,
+                                     size_t&           count ) const {
+  for ( uint32_t i = block.begin_; i < block.end_; ++i ) {
+    const int64_t dist2 = distance2( point, points_[i] );
+    if ( dist2 > maxDist2 || ( count == numResults && dist2 > neighbors[0].dist2_ ) ) { continue; }
+    const Neighbor neighbor = {dist2, indices_[i]};
+    if ( count < numResults ) {
+      neighbors[count++] = neighbor;
+      std::push_heap( neighbors, neighbors + count );
+    } else if ( neighbor < neighbors[0] ) {
+      // replaces the farthest neighbour and sifts it down the heap
+      size_t parent = 0;
+      for ( size_t child = 1; child < count; child = 2 * parent + 1 ) {
+        if ( child + 1 < count && neighbors[child] < neighbors[child + 1] ) { ++child; }
+        if ( !( neighbor < neighbors[child] ) ) { break; }
+        neighbors[parent] = neighbors[child];
+        parent            = child;
+      }
+      neighbors[parent] = neighbor;
+    }
+  }
+}
+
+// squared distance between a point and a block, in biased coordinates
+static inline int64_t blockDistance2( const int32_t* point, const int32_t x, const int32_t y, const int32_t z ) {
+  const int32_t block[3] = {x, y, z};
+  int64_t       dist2    = 0;
+  for ( size_t k = 0; k < 3; ++k ) {
+    const int32_t lower = block[k] << blockShift;
+    const int32_t upper = lower + ( 1 << blockShift ) - 1;
+    const int64_t d     = point[k] < lower ? lower - point[k] : point[k] > upper ? point[k] - upper : 0;
+    dist2 += d * d;
+  }
+  return dist2;
+}
+
+size_t PCCVoxelGridIndex::search( const PCCPoint3D& point, const size_t numResults, Neighbor* neighbors ) const {
+  if ( numResults == 0 || points_.empty() ) { return 0; }
+  const int32_t query[3] = {point[0] + coordinateBias, point[1] + coordinateBias, point[2] + coordinateBias};
+  int32_t       center[3];
+  int32_t       minRing = 0;
+  int32_t       maxRing = 0;
+  for ( size_t k = 0; k < 3; ++k ) {
+    center[k] = query[k] >> blockShift;
+    minRing   = ( std::max )( minRing, ( std::max )( blockMin_[k] - center[k], center[k] - blockMax_[k] ) );
+    maxRing   = ( std::max )( maxRing, ( std::max )( center[k] - blockMin_[k], blockMax_[k] - center[k] ) );
+  }
+  const int64_t maxDist2 = ( std::numeric_limits<int64_t>::max )();
+  size_t        count    = 0;
+  auto          visit    = [&]( const int32_t x, const int32_t y, const int32_t z ) {
+    if ( count == numResults && blockDistance2( query, x, y, z ) > neighbors[0].dist2_ ) { return; }
+    const Block* block = findBlock( x, y, z );
+    if ( block != nullptr ) { searchBlock( *block, point, numResults, maxDist2, neighbors, count ); }
+  };
+  // visit the blocks by rings of increasing Chebyshev distance to the block of the query
+  for ( int32_t ring = minRing; ring <= maxRing; ++ring ) {
+    const int32_t x0 = ( std::max )( center[0] - ring, blockMin_[0] );
+    const int32_t x1 = ( std::min )( center[0] + ring, blockMax_[0] );
+    const int32_t y0 = ( std::max )( center[1] - ring, blockMin_[1] );
+    const int32_t y1 = ( std::min )( center[1] + ring, blockMax_[1] );
+    const int32_t z0 = ( std::max )( center[2] - ring, blockMin_[2] );
+    const int32_t z1 = ( std::min )( center[2] + ring, blockMax_[2] );
+    for ( int32_t z = z0; z <= z1; ++z ) {
+      for ( int32_t y = y0; y <= y1; ++y ) {
+        if ( std::abs( z - center[2] ) == ring || std::abs( y - center[1] ) == ring ) {
+          for ( int32_t x = x0; x <= x1; ++x ) { visit( x, y, z ); }
+        } else {
+          if ( center[0] - ring >= blockMin_[0] ) { visit( center[0] - ring, y, z ); }
+          if ( ring > 0 && center[0] + ring <= blockMax_[0] ) { visit( center[0] + ring, y, z ); }
+        }
+      }
+    }
+    if ( count == numResults ) {
+      // the points of the next rings are at least gap away from the query
+      int64_t gap = ( std::numeric_limits<int32_t>::max )();
+      for ( size_t k = 0; k < 3; ++k ) {
+        gap = ( std::min )( gap, int64_t( ( ( center[k] + ring + 1 ) << blockShift ) - query[k] ) );
+        gap = ( std::min )( gap, int64_t( query[k] - ( ( center[k] - ring ) << blockShift ) + 1 ) );
+      }
+      if ( neighbors[0].dist2_ < gap * gap ) { break; }
+    }
+  }
+  std::sort_heap( neighbors, neighbors + count );
+  return count;
+}
+
+size_t PCCVoxelGridIndex::searchRadius( const PCCPoint3D& point,
+                                        const size_t      numResults,
+                                        const double      radius2,
+                                        Neighbor*         neighbors ) const {
+  if ( numResults == 0 || points_.empty() || radius2 <= 0 ) { return 0; }
+  // the squared distances are integers: dist2 < radius2 <=> dist2 <= ceil( radius2 ) - 1
+  const int64_t maxDist2 = static_cast<int64_t>( std::ceil( ( std::min )( radius2, 1e15 ) ) ) - 1;
+  const int32_t radius   = static_cast<int32_t>( std::ceil( std::sqrt( double( maxDist2 ) ) ) );
+  const int32_t query[3] = {point[0] + coordinateBias, point[1] + coordinateBias, point[2] + coordinateBias};
+  int32_t       lower[3];
+  int32_t       upper[3];
+  for ( size_t k = 0; k < 3; ++k ) {
+    lower[k] = ( std::max )( int64_t( query[k] ) - radius, int64_t( blockMin_[k] ) << blockShift ) >> blockShift;
+    upper[k] = ( std::min )( int64_t( query[k] ) + radius, int64_t( blockMax_[k] ) << blockShift ) >> blockShift;
+  }
+  size_t count = 0;
+  for ( int32_t z = lower[2]; z <= upper[2]; ++z ) {
+    for ( int32_t y = lower[1]; y <= upper[1]; ++y ) {
+      for ( int32_t x = lower[0]; x <= upper[0]; ++x ) {
+        const int64_t dist2 = blockDistance2( query, x, y, z );
+        if ( dist2 > maxDist2 || ( count == numResults && dist2 > neighbors[0].dist2_ ) ) { continue; }
+        const Block* block = findBlock( x, y, z );
+        if ( block != nullptr ) { searchBlock( *block, point, numResults, maxDist2, neighbors, count ); }
+      }
+    }
+  }
+  std::sort_heap( neighbors, neighbors + count );
+  return count;
+}
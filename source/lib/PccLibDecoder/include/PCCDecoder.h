@@ -38,6 +38,7 @@
 #include "PCCCodec.h"
 #include "PCCMath.h"
 #include "PCCPatch.h"
+#include <functional>
 
 namespace pcc {
 
@@ -53,6 +54,10 @@ class PLRData;
 template <typename T, size_t N>
 class PCCImage;
 typedef pcc::PCCImage<uint8_t, 3> PCCImageOccupancyMap;
+class PCCPointSet3;
+
+// called with each reconstructed frame as soon as it is available
+typedef std::function<void( size_t frameIndex, PCCPointSet3& reconstruct )> PCCFrameCallback;
 
 class PCCDecoder : public PCCCodec {
  public:
@@ -62,6 +67,7 @@ class PCCDecoder : public PCCCodec {
   int decode( PCCContext& context, PCCGroupOfFrames& reconstruct, int32_t atlasIndex );
 
   void setParameters( const PCCDecoderParameters& params );
+  void setFrameCallback( PCCFrameCallback callback ) { frameCallback_ = std::move( callback ); }
   void setReconstructionParameters( const PCCDecoderParameters& params );
   void setPostProcessingSeiParameters( GeneratePointCloudParameters& gpcParams, PCCContext& context, size_t atglIndex );
   void setGeneratePointCloudParameters( GeneratePointCloudParameters& gpcParams,
@@ -82,9 +88,16 @@ class PCCDecoder : public PCCCodec {
   void       createHlsAtlasTileLogFiles( PCCContext& context, int frameIndex );
   void       setConsitantFourCCCode( PCCContext& context, size_t atglIndex );
   PCCCodecId getCodedCodecId( PCCContext& context, const uint8_t codecCodecId, const std::string& videoDecoderPath );
+  void       reconstructFrame( PCCContext&                           context,
+                               PCCPointSet3&                         reconstruct,
+                               size_t                                frameIdx,
+                               int32_t                               atlasIndex,
+                               const std::vector<std::vector<bool>>& absoluteT1List );
+  void       releaseVideoFrames( PCCContext& context, size_t frameIndex, size_t frameCount, int32_t atlasIndex );
 
   PCCDecoderParameters     params_;
   std::vector<std::string> consitantFourCCCode_;
+  PCCFrameCallback         frameCallback_;
 };
 
 };  // namespace pcc
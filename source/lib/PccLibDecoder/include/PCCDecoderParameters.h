@@ -60,6 +60,7 @@ class PCCDecoderParameters {
   std::string       inverseColorSpaceConversionConfig_;
   size_t            nbThread_;
   bool              keepIntermediateFiles_;
+  bool              useNamedPipes_;
   bool              patchColorSubsampling_;
   size_t            bestColorSearchRange_;
   int               numNeighborsColorTransferFwd_;
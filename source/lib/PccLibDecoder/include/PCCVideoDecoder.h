@@ -66,9 +66,11 @@ class PCCVideoDecoder {
                    const size_t       upsamplingFilter                  = 0 );
 
   void setLogger( PCCLogger& logger ) { logger_ = &logger; }
+  void setUseNamedPipes( bool value ) { useNamedPipes_ = value; }
 
  private:
-  PCCLogger* logger_ = nullptr;
+  PCCLogger* logger_        = nullptr;
+  bool       useNamedPipes_ = false;
 };
 
 };  // namespace pcc
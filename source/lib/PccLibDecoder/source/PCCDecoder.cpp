@@ -74,6 +74,7 @@ int PCCDecoder::decode( PCCContext& context, PCCGroupOfFrames& reconstructs, int
 
   PCCVideoDecoder videoDecoder;
   videoDecoder.setLogger( *logger_ );
+  videoDecoder.setUseNamedPipes( params_.useNamedPipes_ );
   std::stringstream path;
   auto&             sps              = context.getVps();
   auto&             ai               = sps.getAttributeInformation( atlasIndex );
@@ -297,45 +298,107 @@ int PCCDecoder::decode( PCCContext& context, PCCGroupOfFrames& reconstructs, int
       }
     }
   }
+  context.setOccupancyPrecision( sps.getFrameWidth( atlasIndex ) / context.getVideoOccupancyMap().getWidth() );
   printf( "generate point cloud of %zu frames \n", frameCount );
   fflush( stdout );
-  for ( size_t frameIdx = 0; frameIdx < frameCount; frameIdx++ ) {
-    // All video have been decoded, start reconsctruction processes
-    if ( asps.getRawPatchEnabledFlag() && asps.getAuxiliaryVideoEnabledFlag() &&
-         sps.getAuxiliaryVideoPresentFlag( atlasIndex ) ) {
-      for ( int attrIndex = 0; attrIndex < ai.getAttributeCount(); attrIndex++ ) {
-        int attributeDimensionPartitions = ai.getAttributeDimensionPartitionsMinus1( attrIndex ) + 1;
-        for ( int attrPartitionIndex = 0; attrPartitionIndex < attributeDimensionPartitions; attrPartitionIndex++ ) {
-          printf( "generateRawPointsAttributefromVideo attrIndex = %d attrPartitionIndex = %d \n", attrIndex,
-                  attrPartitionIndex );
-          fflush( stdout );
-          generateRawPointsAttributefromVideo( context, frameIdx );
-        }
+#if defined( ENABLE_TBB )
+  if ( params_.nbThread_ != 1 && frameCount > 1 ) {
+    // Once the videos are decoded, the frames are independent: they are reconstructed concurrently, each by its own
+    // copy of the decoder (scratch state) with buffered traces, and are released in order.
+    struct PCCFrameJob {
+      size_t    frameIdx_;
+      PCCLogger logger_;
+    };
+    typedef PCCFrameJob* Job;
+    size_t     nextFrameIdx = 0;
+    const auto tokens = params_.nbThread_ > 0 ? params_.nbThread_ : tbb::task_scheduler_init::default_num_threads();
+    auto readFilter   = tbb::make_filter<void, Job>( tbb::filter::serial_in_order, [&]( tbb::flow_control& fc ) -> Job {
+      if ( nextFrameIdx >= frameCount ) {
+        fc.stop();
+        return nullptr;
       }
-    }  // getAuxiliaryVideoEnabledFlag()
-
-    context.setOccupancyPrecision( sps.getFrameWidth( atlasIndex ) / context.getVideoOccupancyMap().getWidth() );
-    GeneratePointCloudParameters gpcParams;
-    GeneratePointCloudParameters ppSEIParams;
+      auto job       = new PCCFrameJob;
+      job->frameIdx_ = nextFrameIdx++;
+      job->logger_.setBuffered( true );
+      return job;
+    } );
+    auto reconstructFilter = tbb::make_filter<Job, Job>( tbb::filter::parallel, [&]( Job job ) {
+      PCCDecoder frameDecoder( *this );
+      frameDecoder.setLogger( job->logger_ );
+      frameDecoder.reconstructFrame( context, reconstructs[job->frameIdx_], job->frameIdx_, atlasIndex,
+                                     absoluteT1List );
+      return job;
+    } );
+    auto outputFilter = tbb::make_filter<Job, void>( tbb::filter::serial_in_order, [&]( Job job ) {
+      logger_->append( job->logger_ );
+      releaseVideoFrames( context, job->frameIdx_, frameCount, atlasIndex );
+      if ( frameCallback_ ) { frameCallback_( job->frameIdx_, reconstructs[job->frameIdx_] ); }
+      delete job;
+    } );
+    tbb::task_arena limited( static_cast<int>( tokens ) );
+    limited.execute( [&] { tbb::parallel_pipeline( tokens, readFilter & reconstructFilter & outputFilter ); } );
+    return 0;
+  }
+#endif
+  for ( size_t frameIdx = 0; frameIdx < frameCount; frameIdx++ ) {
+    reconstructFrame( context, reconstructs[frameIdx], frameIdx, atlasIndex, absoluteT1List );
+    releaseVideoFrames( context, frameIdx, frameCount, atlasIndex );
+    if ( frameCallback_ ) { frameCallback_( frameIdx, reconstructs[frameIdx] ); }
+  }
+  return 0;
+}
 
-    auto&                 reconstruct = reconstructs[frameIdx];
-    std::vector<uint32_t> partition;
-    // Decode point cloud
-    printf( "call generatePointCloud() \n" );
-    std::vector<size_t> accTilePointCount;
-    accTilePointCount.resize( ai.getAttributeCount(), 0 );
-    for ( size_t tileIdx = 0; tileIdx < context[frameIdx].getNumTilesInAtlasFrame(); tileIdx++ ) {
+void PCCDecoder::reconstructFrame( PCCContext&                           context,
+                                   PCCPointSet3&                         reconstruct,
+                                   size_t                                frameIdx,
+                                   int32_t                               atlasIndex,
+                                   const std::vector<std::vector<bool>>& absoluteT1List ) {
+  auto& sps  = context.getVps();
+  auto& ai   = sps.getAttributeInformation( atlasIndex );
+  auto& oi   = sps.getOccupancyInformation( atlasIndex );
+  auto& asps = context.getAtlasSequenceParameterSet( 0 );
+  // All video have been decoded, start reconsctruction processes
+  if ( asps.getRawPatchEnabledFlag() && asps.getAuxiliaryVideoEnabledFlag() &&
+       sps.getAuxiliaryVideoPresentFlag( atlasIndex ) ) {
+    for ( int attrIndex = 0; attrIndex < ai.getAttributeCount(); attrIndex++ ) {
+      int attributeDimensionPartitions = ai.getAttributeDimensionPartitionsMinus1( attrIndex ) + 1;
+      for ( int attrPartitionIndex = 0; attrPartitionIndex < attributeDimensionPartitions; attrPartitionIndex++ ) {
+        printf( "generateRawPointsAttributefromVideo attrIndex = %d attrPartitionIndex = %d \n", attrIndex,
+                attrPartitionIndex );
+        fflush( stdout );
+        generateRawPointsAttributefromVideo( context, frameIdx );
+      }
+    }
+  }  // getAuxiliaryVideoEnabledFlag()
+
+  GeneratePointCloudParameters gpcParams;
+  GeneratePointCloudParameters ppSEIParams;
+
+  std::vector<uint32_t> partition;
+  // Decode point cloud
+  printf( "call generatePointCloud() \n" );
+  std::vector<size_t> accTilePointCount;
+  accTilePointCount.resize( ai.getAttributeCount(), 0 );
+  // the tiles cover disjoint areas of the occupancy map video: their occupancy and block to patch maps are generated
+  // concurrently, then the tiles are reconstructed in order
+  const size_t tileCount = context[frameIdx].getNumTilesInAtlasFrame();
+#if defined( ENABLE_TBB )
+  tbb::task_arena limited( static_cast<int>( params_.nbThread_ ) );
+  limited.execute( [&] {
+    tbb::parallel_for( size_t( 0 ), tileCount, [&]( const size_t tileIdx ) {
+#else
+  for ( size_t tileIdx = 0; tileIdx < tileCount; tileIdx++ ) {
+#endif
+      GeneratePointCloudParameters tileSEIParams;
       auto atglIndex = context.getAtlasHighLevelSyntax().getAtlasTileLayerIndex( frameIdx, tileIdx );
-      setGeneratePointCloudParameters( gpcParams, context, atglIndex );
-      setPostProcessingSeiParameters( ppSEIParams, context, atglIndex );
-      // std::cout << "Processing frame " << frameIdx << " tile " << tileIdx << std::endl;
+      setPostProcessingSeiParameters( tileSEIParams, context, atglIndex );
       auto& tile = context[frameIdx].getTile( tileIdx );
-      if ( !ppSEIParams.pbfEnableFlag_ ) {
+      if ( !tileSEIParams.pbfEnableFlag_ ) {
         generateOccupancyMap( tile, context.getVideoOccupancyMap().getFrame( tile.getFrameIndex() ),
                               context.getOccupancyPrecision(), oi.getLossyOccupancyCompressionThreshold(),
                               asps.getEomPatchEnabledFlag() );
       }
-      if ( context[frameIdx].getNumTilesInAtlasFrame() > 1 ) {
+      if ( tileCount > 1 ) {
         generateTileBlockToPatchFromOccupancyMapVideo(
             context, tile, frameIdx, context.getVideoOccupancyMap().getFrame( frameIdx ),
             size_t( 1 ) << asps.getLog2PatchPackingBlockSize(), context.getOccupancyPrecision() );
@@ -345,145 +408,181 @@ int PCCDecoder::decode( PCCContext& context, PCCGroupOfFrames& reconstructs, int
             context, tile, frameIdx, context.getVideoOccupancyMap().getFrame( frameIdx ),
             size_t( 1 ) << asps.getLog2PatchPackingBlockSize(), context.getOccupancyPrecision() );
       }
-
-      printf( "call generatePointCloud() \n" );
-      PCCPointSet3 tileReconstrct;
-      generatePointCloud( tileReconstrct, context, frameIdx, tileIdx, gpcParams, partition, true );
-      reconstruct.appendPointSet( tileReconstrct );
-      if ( context[frameIdx].getNumTilesInAtlasFrame() > 1 )
-        context[frameIdx].getTitleFrameContext().appendPointToPixel(
-            context[frameIdx].getTile( tileIdx ).getPointToPixel() );
-      if ( ai.getAttributeCount() > 0 ) {
-        reconstruct.addColors();
-        reconstruct.addColors16bit();
-        for ( size_t attIdx = 0; attIdx < ai.getAttributeCount(); attIdx++ ) {
-          printf( "start colorPointCloud attIdx = %zu / %u ] \n", attIdx, ai.getAttributeCount() );
-          fflush( stdout );
-          size_t updatedPointCount  = colorPointCloud( reconstruct, context, tile, absoluteT1List[attIdx],
-                                                      sps.getMultipleMapStreamsPresentFlag( atlasIndex ),
-                                                      ai.getAttributeCount(), accTilePointCount[attIdx], gpcParams );
-          accTilePointCount[attIdx] = updatedPointCount;
-        }
+#if defined( ENABLE_TBB )
+    } );
+  } );
+#else
+  }
+#endif
+  for ( size_t tileIdx = 0; tileIdx < tileCount; tileIdx++ ) {
+    auto atglIndex = context.getAtlasHighLevelSyntax().getAtlasTileLayerIndex( frameIdx, tileIdx );
+    setGeneratePointCloudParameters( gpcParams, context, atglIndex );
+    setPostProcessingSeiParameters( ppSEIParams, context, atglIndex );
+    // std::cout << "Processing frame " << frameIdx << " tile " << tileIdx << std::endl;
+    auto& tile = context[frameIdx].getTile( tileIdx );
+    printf( "call generatePointCloud() \n" );
+    PCCPointSet3 tileReconstrct;
+    generatePointCloud( tileReconstrct, context, frameIdx, tileIdx, gpcParams, partition, true );
+    reconstruct.appendPointSet( tileReconstrct );
+    if ( context[frameIdx].getNumTilesInAtlasFrame() > 1 )
+      context[frameIdx].getTitleFrameContext().appendPointToPixel(
+          context[frameIdx].getTile( tileIdx ).getPointToPixel() );
+    if ( ai.getAttributeCount() > 0 ) {
+      reconstruct.addColors();
+      reconstruct.addColors16bit();
+      for ( size_t attIdx = 0; attIdx < ai.getAttributeCount(); attIdx++ ) {
+        printf( "start colorPointCloud attIdx = %zu / %u ] \n", attIdx, ai.getAttributeCount() );
+        fflush( stdout );
+        size_t updatedPointCount  = colorPointCloud( reconstruct, context, tile, absoluteT1List[attIdx],
+                                                    sps.getMultipleMapStreamsPresentFlag( atlasIndex ),
+                                                    ai.getAttributeCount(), accTilePointCount[attIdx], gpcParams );
+        accTilePointCount[attIdx] = updatedPointCount;
       }
-    }  // tile
+    }
+  }  // tile
 
 #ifdef CONFORMANCE_TRACE
-    size_t numProjPoints = 0, numRawPoints = 0, numEomPoints = 0;
-    for ( size_t tileIdx = 0; tileIdx < context[frameIdx].getNumTilesInAtlasFrame(); tileIdx++ ) {
-      auto& tile = context[frameIdx].getTile( tileIdx );
-      numProjPoints += tile.getTotalNumberOfRegularPoints();
-      numEomPoints += tile.getTotalNumberOfEOMPoints();
-      numRawPoints += tile.getTotalNumberOfRawPoints();
-    }  // tile
-    if ( ai.getAttributeCount() == 0 ) {
-      reconstructs[frameIdx].removeColors();
-      reconstructs[frameIdx].removeColors16bit();
+  size_t numProjPoints = 0, numRawPoints = 0, numEomPoints = 0;
+  for ( size_t tileIdx = 0; tileIdx < context[frameIdx].getNumTilesInAtlasFrame(); tileIdx++ ) {
+    auto& tile = context[frameIdx].getTile( tileIdx );
+    numProjPoints += tile.getTotalNumberOfRegularPoints();
+    numEomPoints += tile.getTotalNumberOfEOMPoints();
+    numRawPoints += tile.getTotalNumberOfRawPoints();
+  }  // tile
+  if ( ai.getAttributeCount() == 0 ) {
+    reconstruct.removeColors();
+    reconstruct.removeColors16bit();
+  } else {
+    bool isAttributes444 = context.getVideoAttributesMultiple( 0 ).getColorFormat() == PCCCOLORFORMAT::RGB444;
+    if ( !isAttributes444 ) {  // lossy: convert 16-bit yuv444 to 8-bit RGB444
+      reconstruct.convertYUV16ToRGB8();
     } else {
-      bool isAttributes444 = context.getVideoAttributesMultiple( 0 ).getColorFormat() == PCCCOLORFORMAT::RGB444;
-      if ( !isAttributes444 ) {  // lossy: convert 16-bit yuv444 to 8-bit RGB444
-        reconstructs[frameIdx].convertYUV16ToRGB8();
-      } else {
-        reconstructs[frameIdx].copyRGB16ToRGB8();
-      }
+      reconstruct.copyRGB16ToRGB8();
     }
-    TRACE_PCFRAME( "AtlasFrameIndex = %d\n", frameIdx );
-    TRACE_PCFRAME( "PointCloudFrameOrderCntVal = %d, NumProjPoints = %zu, NumRawPoints = %zu, NumEomPoints = %zu,",
-                   frameIdx, numProjPoints, numRawPoints, numEomPoints );
-    auto checksumFrame = reconstructs[frameIdx].computeChecksum( true );
-    TRACE_PCFRAME( " MD5 checksum = " );
-    for ( auto& c : checksumFrame ) { TRACE_PCFRAME( "%02x", c ); }
-    TRACE_PCFRAME( "\n" );
+  }
+  TRACE_PCFRAME( "AtlasFrameIndex = %d\n", frameIdx );
+  TRACE_PCFRAME( "PointCloudFrameOrderCntVal = %d, NumProjPoints = %zu, NumRawPoints = %zu, NumEomPoints = %zu,",
+                 frameIdx, numProjPoints, numRawPoints, numEomPoints );
+  auto checksumFrame = reconstruct.computeChecksum( true );
+  TRACE_PCFRAME( " MD5 checksum = " );
+  for ( auto& c : checksumFrame ) { TRACE_PCFRAME( "%02x", c ); }
+  TRACE_PCFRAME( "\n" );
 #endif
 
-    // Post-Processing
-    TRACE_PATCH( "Post-Processing: postprocessSmoothing = %zu pbfEnableFlag = %d \n", params_.attrTransferFilterType_,
-                 ppSEIParams.pbfEnableFlag_ );
-    if ( params_.applyGeoSmoothingType_ != 0 && ppSEIParams.flagGeometrySmoothing_ ) {
-      PCCPointSet3 tempFrameBuffer = reconstruct;
-      if ( ppSEIParams.gridSmoothing_ ) {
-        smoothPointCloudPostprocess( reconstruct, params_.colorTransform_, ppSEIParams, partition );
-      }
-      if ( ai.getAttributeCount() > 0 ) {
-        bool isAttributes444 = context.getVideoAttributesMultiple( 0 ).getColorFormat() == PCCCOLORFORMAT::RGB444;
-        printf( "isAttributes444 = %d Format = %d \n", isAttributes444,
-                context.getVideoAttributesMultiple( 0 ).getColorFormat() );
-        fflush( stdout );
-
-        if ( !ppSEIParams.pbfEnableFlag_ ) {
-          // These are different attribute transfer functions
-          if ( params_.attrTransferFilterType_ == 1 || params_.attrTransferFilterType_ == 5 ) {
-            TRACE_PATCH( " transferColors16bitBP \n" );
-            tempFrameBuffer.transferColors16bitBP( reconstruct,                      // target
-                                                   params_.attrTransferFilterType_,  // filterType
-                                                   int32_t( 0 ),                     // searchRange
-                                                   isAttributes444,                  // losslessAttribute
-                                                   8,                                // numNeighborsColorTransferFwd
-                                                   1,                                // numNeighborsColorTransferBwd
-                                                   true,                             // useDistWeightedAverageFwd
-                                                   true,                             // useDistWeightedAverageBwd
-                                                   true,        // skipAvgIfIdenticalSourcePointPresentFwd
-                                                   false,       // skipAvgIfIdenticalSourcePointPresentBwd
-                                                   4,           // distOffsetFwd
-                                                   4,           // distOffsetBwd
-                                                   1000,        // maxGeometryDist2Fwd
-                                                   1000,        // maxGeometryDist2Bwd
-                                                   1000 * 256,  // maxColorDist2Fwd
-                                                   1000 * 256   // maxColorDist2Bwd
-            );
-          } else if ( params_.attrTransferFilterType_ == 2 ) {
-            TRACE_PATCH( " transferColorWeight \n" );
-            tempFrameBuffer.transferColorWeight( reconstruct, 0.1 );
-          } else if ( params_.attrTransferFilterType_ == 3 ) {
-            TRACE_PATCH( " transferColorsFilter3 \n" );
-            tempFrameBuffer.transferColorsFilter3( reconstruct, int32_t( 0 ), isAttributes444 );
-          } else if ( params_.attrTransferFilterType_ == 7 || params_.attrTransferFilterType_ == 9 ) {
-            TRACE_PATCH( " transferColorsFilter3 \n" );
-            tempFrameBuffer.transferColorsBackward16bitBP( reconstruct,                      //  target
-                                                           params_.attrTransferFilterType_,  //  filterType
-                                                           int32_t( 0 ),                     //  searchRange
-                                                           isAttributes444,                  //  losslessAttribute
-                                                           8,           //  numNeighborsColorTransferFwd
-                                                           1,           //  numNeighborsColorTransferBwd
-                                                           true,        //  useDistWeightedAverageFwd
-                                                           true,        //  useDistWeightedAverageBwd
-                                                           true,        //  skipAvgIfIdenticalSourcePointPresentFwd
-                                                           false,       //  skipAvgIfIdenticalSourcePointPresentBwd
-                                                           4,           //  distOffsetFwd
-                                                           4,           //  distOffsetBwd
-                                                           1000,        //  maxGeometryDist2Fwd
-                                                           1000,        //  maxGeometryDist2Bwd
-                                                           1000 * 256,  //  maxColorDist2Fwd
-                                                           1000 * 256   //  maxColorDist2Bwd
-            );
-          }
-        }
-      }  // if ( ai.getAttributeCount() > 0 )
+  // Post-Processing
+  TRACE_PATCH( "Post-Processing: postprocessSmoothing = %zu pbfEnableFlag = %d \n", params_.attrTransferFilterType_,
+               ppSEIParams.pbfEnableFlag_ );
+  if ( params_.applyGeoSmoothingType_ != 0 && ppSEIParams.flagGeometrySmoothing_ ) {
+    PCCPointSet3 tempFrameBuffer = reconstruct;
+    if ( ppSEIParams.gridSmoothing_ ) {
+      smoothPointCloudPostprocess( reconstruct, params_.colorTransform_, ppSEIParams, partition );
     }
     if ( ai.getAttributeCount() > 0 ) {
-      if ( params_.applyAttrSmoothingType_ != 0 && ppSEIParams.flagColorSmoothing_ ) {
-        TRACE_PATCH( " colorSmoothing \n" );
-        colorSmoothing( reconstruct, params_.colorTransform_, ppSEIParams );
+      bool isAttributes444 = context.getVideoAttributesMultiple( 0 ).getColorFormat() == PCCCOLORFORMAT::RGB444;
+      printf( "isAttributes444 = %d Format = %d \n", isAttributes444,
+              context.getVideoAttributesMultiple( 0 ).getColorFormat() );
+      fflush( stdout );
+
+      if ( !ppSEIParams.pbfEnableFlag_ ) {
+        // These are different attribute transfer functions
+        if ( params_.attrTransferFilterType_ == 1 || params_.attrTransferFilterType_ == 5 ) {
+          TRACE_PATCH( " transferColors16bitBP \n" );
+          tempFrameBuffer.transferColors16bitBP( reconstruct,                      // target
+                                                 params_.attrTransferFilterType_,  // filterType
+                                                 int32_t( 0 ),                     // searchRange
+                                                 isAttributes444,                  // losslessAttribute
+                                                 8,                                // numNeighborsColorTransferFwd
+                                                 1,                                // numNeighborsColorTransferBwd
+                                                 true,                             // useDistWeightedAverageFwd
+                                                 true,                             // useDistWeightedAverageBwd
+                                                 true,                 // skipAvgIfIdenticalSourcePointPresentFwd
+                                                 false,                // skipAvgIfIdenticalSourcePointPresentBwd
+                                                 4,                    // distOffsetFwd
+                                                 4,                    // distOffsetBwd
+                                                 1000,                 // maxGeometryDist2Fwd
+                                                 1000,                 // maxGeometryDist2Bwd
+                                                 1000 * 256,           // maxColorDist2Fwd
+                                                 1000 * 256,           // maxColorDist2Bwd
+                                                 false,                // excludeColorOutlier
+                                                 10.0,                 // thresholdColorOutlierDist
+                                                 params_.nbThread_ );  // nbThread
+        } else if ( params_.attrTransferFilterType_ == 2 ) {
+          TRACE_PATCH( " transferColorWeight \n" );
+          tempFrameBuffer.transferColorWeight( reconstruct, 0.1 );
+        } else if ( params_.attrTransferFilterType_ == 3 ) {
+          TRACE_PATCH( " transferColorsFilter3 \n" );
+          tempFrameBuffer.transferColorsFilter3( reconstruct, int32_t( 0 ), isAttributes444 );
+        } else if ( params_.attrTransferFilterType_ == 7 || params_.attrTransferFilterType_ == 9 ) {
+          TRACE_PATCH( " transferColorsFilter3 \n" );
+          tempFrameBuffer.transferColorsBackward16bitBP( reconstruct,                      //  target
+                                                         params_.attrTransferFilterType_,  //  filterType
+                                                         int32_t( 0 ),                     //  searchRange
+                                                         isAttributes444,                  //  losslessAttribute
+                                                         8,           //  numNeighborsColorTransferFwd
+                                                         1,           //  numNeighborsColorTransferBwd
+                                                         true,        //  useDistWeightedAverageFwd
+                                                         true,        //  useDistWeightedAverageBwd
+                                                         true,        //  skipAvgIfIdenticalSourcePointPresentFwd
+                                                         false,       //  skipAvgIfIdenticalSourcePointPresentBwd
+                                                         4,           //  distOffsetFwd
+                                                         4,           //  distOffsetBwd
+                                                         1000,        //  maxGeometryDist2Fwd
+                                                         1000,        //  maxGeometryDist2Bwd
+                                                         1000 * 256,  //  maxColorDist2Fwd
+                                                         1000 * 256,  //  maxColorDist2Bwd
+                                                         false,                //  excludeColorOutlier
+                                                         10.0,                 //  thresholdColorOutlierDist
+                                                         params_.nbThread_ );  //  nbThread
+        }
       }
-      if ( context.getVideoAttributesMultiple( 0 ).getColorFormat() !=
-           PCCCOLORFORMAT::RGB444 ) {  // lossy: convert 16-bit yuv444 to 8-bit RGB444
-        TRACE_PATCH( "lossy: convert 16-bit yuv444 to 8-bit RGB444 (convertYUV16ToRGB8) \n" );
-        reconstruct.convertYUV16ToRGB8();
-      } else {  // lossless: copy 16-bit RGB to 8-bit RGB
-        TRACE_PATCH( "lossy: lossless: copy 16-bit RGB to 8-bit RGB (copyRGB16ToRGB8) \n" );
-        reconstruct.copyRGB16ToRGB8();
+    }  // if ( ai.getAttributeCount() > 0 )
+  }
+  if ( ai.getAttributeCount() > 0 ) {
+    if ( params_.applyAttrSmoothingType_ != 0 && ppSEIParams.flagColorSmoothing_ ) {
+      TRACE_PATCH( " colorSmoothing \n" );
+      colorSmoothing( reconstruct, params_.colorTransform_, ppSEIParams );
+    }
+    if ( context.getVideoAttributesMultiple( 0 ).getColorFormat() !=
+         PCCCOLORFORMAT::RGB444 ) {  // lossy: convert 16-bit yuv444 to 8-bit RGB444
+      TRACE_PATCH( "lossy: convert 16-bit yuv444 to 8-bit RGB444 (convertYUV16ToRGB8) \n" );
+      reconstruct.convertYUV16ToRGB8();
+    } else {  // lossless: copy 16-bit RGB to 8-bit RGB
+      TRACE_PATCH( "lossy: lossless: copy 16-bit RGB to 8-bit RGB (copyRGB16ToRGB8) \n" );
+      reconstruct.copyRGB16ToRGB8();
+    }
+  }
+  /*auto tmp = reconstruct.computeChecksum();
+  TRACE_PCFRAME( " MD5 checksum = " );
+  for ( auto& c : tmp ) { TRACE_PCFRAME( "%02x", c ); }
+  TRACE_PCFRAME( "\n" );*/
+  TRACE_RECFRAME( "AtlasFrameIndex = %d\n", frameIdx );
+  auto checksum = reconstruct.computeChecksum( true );
+  TRACE_RECFRAME( " MD5 checksum = " );
+  for ( auto& c : checksum ) { TRACE_RECFRAME( "%02x", c ); }
+  TRACE_RECFRAME( "\n" );
+}
+
+template <typename T, size_t N>
+static void releaseVideo( PCCVideo<T, N>& video, size_t frameIndex, size_t frameCount ) {
+  // the videos may hold several pictures per atlas frame (single stream maps)
+  if ( frameCount > 0 && video.getFrameCount() >= frameCount ) {
+    video.releaseFrames( ( frameIndex + 1 ) * ( video.getFrameCount() / frameCount ) );
+  }
+}
+
+void PCCDecoder::releaseVideoFrames( PCCContext& context, size_t frameIndex, size_t frameCount, int32_t atlasIndex ) {
+  auto& ai = context.getVps().getAttributeInformation( atlasIndex );
+  releaseVideo( context.getVideoOccupancyMap(), frameIndex, frameCount );
+  for ( auto& video : context.getVideoGeometryMultiple() ) { releaseVideo( video, frameIndex, frameCount ); }
+  releaseVideo( context.getVideoRawPointsGeometry(), frameIndex, frameCount );
+  for ( int attrIdx = 0; attrIdx < ai.getAttributeCount(); attrIdx++ ) {
+    for ( int partIdx = 0; partIdx < ai.getAttributeDimensionPartitionsMinus1( attrIdx ) + 1; partIdx++ ) {
+      for ( auto& video : context.getVideoAttributesMultiple( atlasIndex, attrIdx, partIdx ) ) {
+        releaseVideo( video, frameIndex, frameCount );
       }
+      releaseVideo( context.getVideoRawPointsAttribute( atlasIndex, attrIdx, partIdx ), frameIndex, frameCount );
     }
-    /*auto tmp = reconstruct.computeChecksum();
-    TRACE_PCFRAME( " MD5 checksum = " );
-    for ( auto& c : tmp ) { TRACE_PCFRAME( "%02x", c ); }
-    TRACE_PCFRAME( "\n" );*/
-    TRACE_RECFRAME( "AtlasFrameIndex = %d\n", frameIdx );
-    auto checksum = reconstructs[frameIdx].computeChecksum( true );
-    TRACE_RECFRAME( " MD5 checksum = " );
-    for ( auto& c : checksum ) { TRACE_RECFRAME( "%02x", c ); }
-    TRACE_RECFRAME( "\n" );
   }
-  return 0;
 }
 
 void PCCDecoder::setPointLocalReconstruction( PCCContext& context ) {
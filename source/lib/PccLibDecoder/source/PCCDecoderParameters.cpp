@@ -50,6 +50,7 @@ PCCDecoderParameters::PCCDecoderParameters() {
   byteStreamVideoCoderAttribute_     = true;
   nbThread_                          = 1;
   keepIntermediateFiles_             = false;
+  useNamedPipes_                     = false;
   pixelDeinterleavingType_           = -1;
   pointLocalReconstructionType_      = -1;
   reconstructEomType_                = -1;
@@ -73,6 +74,7 @@ void PCCDecoderParameters::print() {
   std::cout << "\t colorTransform                      " << colorTransform_ << std::endl;
   std::cout << "\t nbThread                            " << nbThread_ << std::endl;
   std::cout << "\t keepIntermediateFiles               " << keepIntermediateFiles_ << std::endl;
+  std::cout << "\t useNamedPipes                       " << useNamedPipes_ << std::endl;
   std::cout << "\t video encoding" << std::endl;
   std::cout << "\t   colorSpaceConversionPath          " << colorSpaceConversionPath_ << std::endl;
   std::cout << "\t   videoDecoderOccupancyPath         " << videoDecoderOccupancyPath_ << std::endl;
@@ -107,6 +107,7 @@ bool PCCVideoDecoder::decompress( PCCVideo<T, 3>&    video,
     shmDecoder->setLayerIndex( shvcLayerIndex );
   }
 #endif
+  decoder->setUseNamedPipes( useNamedPipes_ );
   decoder->decode( bitstream, video, outputBitDepth, decoderPath, fileName );
   size_t width      = video.getWidth();
   size_t height     = video.getHeight();
@@ -37,6 +37,7 @@
 #include "PCCEncoderParameters.h"
 #include "PCCCodec.h"
 #include "PCCKdTree.h"
+#include "PCCKdTreeCache.h"
 #include <map>
 
 namespace pcc {
@@ -64,6 +65,7 @@ typedef pcc::PCCImage<uint16_t, 3> PCCImageGeometry;
 typedef pcc::PCCImage<uint16_t, 3> PCCImageAttribute;
 struct PCCPatchSegmenter3Parameters;
 class PCCPatch;
+class PCCPackingCanvas;
 struct PCCBistreamPosition;
 
 struct SparseMatrixCoefficient {
@@ -238,42 +240,36 @@ class PCCEncoder : public PCCCodec {
                                size_t            y,
                                uint16_t          mean_val,
                                PCCImageGeometry& image,
-                               PCCKdTree&        kdtree,
+                               const PCCKdTree&  kdtree,
                                PCCFrameContext&  frame );
 
   // Push-pull background filling
   template <typename T>
-  int mean4w( T p1, unsigned char w1, T p2, unsigned char w2, T p3, unsigned char w3, T p4, unsigned char w4 );
-  template <typename T>
-  void pushPullMip( const PCCImage<T, 3>&        image,
-                    PCCImage<T, 3>&              mip,
-                    const std::vector<uint32_t>& occupancyMap,
-                    std::vector<uint32_t>&       mipOccupancyMap );
-  template <typename T>
-  void pushPullFill( PCCImage<T, 3>&              image,
-                     const PCCImage<T, 3>&        mip,
-                     const std::vector<uint32_t>& occupancyMap,
-                     int                          numIters );
-  template <typename T>
   void dilateSmoothedPushPull( PCCFrameContext& frame, PCCImage<T, 3>& image, int mapIdx = -1 );
   template <typename T>
   void dilateHarmonicBackgroundFill( PCCFrameContext& frame, PCCImage<T, 3>& image );
-  template <typename T>
-  void createCoarseLayer( PCCImage<T, 3>&        image,
-                          PCCImage<T, 3>&        mip,
-                          std::vector<uint32_t>& occupancyMap,
-                          std::vector<uint32_t>& mipOccupancyMap );
-  template <typename T>
-  void regionFill( PCCImage<T, 3>& image, std::vector<uint32_t>& occupancyMap, PCCImage<T, 3>& imageLowRes );
 
   //**placing patches**//
+  bool findPatchLocation( PCCPatch&                  patch,
+                          const PCCPackingCanvas&    occupancyMap,
+                          const std::vector<size_t>& orientations,
+                          size_t                     sizeU,
+                          size_t                     sizeV,
+                          size_t                     occupancySizeU,
+                          size_t                     occupancySizeV,
+                          int                        safeguard );
   void packFlexible( PCCFrameContext& tile,
                      int              packingStrategy,
                      size_t           frameWidth,
                      size_t           frameHeight,
                      int              safeguard                    = 0,
-                     bool             enablePointCloudPartitioning = false );
-  void packTetris( PCCFrameContext& tile, size_t frameWidth, size_t frameHeight, int safeguard = 0 );
+                     bool             enablePointCloudPartitioning = false,
+                     std::ostream&    log                          = std::cout );
+  void packTetris( PCCFrameContext& tile,
+                   size_t           frameWidth,
+                   size_t           frameHeight,
+                   int              safeguard = 0,
+                   std::ostream&    log       = std::cout );
   void packMultipleTiles( PCCAtlasFrameContext& frame, int safeguard );
   void packFlexibleMultipleTiles( PCCAtlasFrameContext& frame, int safeguard );
   void spatialConsistencyPackMultipleTiles( PCCAtlasFrameContext& frame,
@@ -285,20 +281,22 @@ class PCCEncoder : public PCCCodec {
 
   size_t packRawPointsPatchSimple( PCCFrameContext& tile, size_t patchStartOffsetX = 0, size_t patchStartOffsetY = 0 );
 
-  size_t packRawPointsPatch( PCCFrameContext&   frame,
-                             std::vector<bool>& occupancyMap,
-                             size_t             width,
-                             size_t&            height,
-                             size_t             occupancySizeU,
-                             size_t             occupancySizeV,
-                             size_t             maxOccupancyRow );
-  void   packEOMAttributePointsPatch( PCCFrameContext&   frame,
-                                      std::vector<bool>& occupancyMap,
-                                      size_t             width,
-                                      size_t&            height,
-                                      size_t             occupancySizeU,
-                                      size_t             occupancySizeV,
-                                      size_t             maxOccupancyRow );
+  size_t packRawPointsPatch( PCCFrameContext&  frame,
+                             PCCPackingCanvas& occupancyMap,
+                             size_t            width,
+                             size_t&           height,
+                             size_t            occupancySizeU,
+                             size_t            occupancySizeV,
+                             size_t            maxOccupancyRow,
+                             std::ostream&     log = std::cout );
+  void   packEOMAttributePointsPatch( PCCFrameContext&  frame,
+                                      PCCPackingCanvas& occupancyMap,
+                                      size_t            width,
+                                      size_t&           height,
+                                      size_t            occupancySizeU,
+                                      size_t            occupancySizeV,
+                                      size_t            maxOccupancyRow,
+                                      std::ostream&     log = std::cout );
   void   adjustReferenceAtlasFrames( PCCContext& context, size_t tileIndex );
   double adjustReferenceAtlasFrame( PCCContext&            context,
                                     PCCFrameContext&       tile,
@@ -311,15 +309,19 @@ class PCCEncoder : public PCCCodec {
                                          size_t           frameWidth,
                                          size_t           frameHeight,
                                          int              safeguard                    = 0,
-                                         bool             enablePointCloudPartitioning = false );
+                                         bool             enablePointCloudPartitioning = false,
+                                         std::ostream&    log                          = std::cout );
   void   spatialConsistencyPackTetris( PCCFrameContext& tile,
                                        PCCFrameContext& prevFrame,
                                        size_t           frameWidth,
                                        size_t           frameHeight,
-                                       int              safeguard = 0 );
+                                       int              safeguard = 0,
+                                       std::ostream&    log       = std::cout );
 
   //**GTP**//
-  void findMatchesForGlobalTetrisPacking( PCCFrameContext& tile, PCCFrameContext& prevFrame );
+  void findMatchesForGlobalTetrisPacking( PCCFrameContext& tile,
+                                          PCCFrameContext& prevFrame,
+                                          std::ostream&    log = std::cout );
   void doGlobalTetrisPacking( PCCContext& context,
                               size_t      tileIndex,
                               size_t      frameWidth,
@@ -388,16 +390,16 @@ class PCCEncoder : public PCCCodec {
                                  int         safeguard,
                                  bool        hasRefFrame );
   static void updatePatchInformation( PCCContext& context, size_t tileIndex, SubContext& subContext );
-  void        packingWithoutRefForFirstFrameNoglobalPatch( PCCPatch&          patch,
-                                                           size_t             i,
-                                                           size_t             icount,
-                                                           size_t&            occupancySizeU,
-                                                           size_t&            occupancySizeV,
-                                                           const size_t       safeguard,
-                                                           std::vector<bool>& occupancyMap,
-                                                           size_t&            heightGPA,
-                                                           size_t&            widthGPA,
-                                                           size_t&            maxOccupancyRow );
+  void        packingWithoutRefForFirstFrameNoglobalPatch( PCCPatch&         patch,
+                                                           size_t            i,
+                                                           size_t            icount,
+                                                           size_t&           occupancySizeU,
+                                                           size_t&           occupancySizeV,
+                                                           const size_t      safeguard,
+                                                           PCCPackingCanvas& occupancyMap,
+                                                           size_t&           heightGPA,
+                                                           size_t&           widthGPA,
+                                                           size_t&           maxOccupancyRow );
 
   void packingWithRefForFirstFrameNoglobalPatch( PCCPatch&                    patch,
                                                  const std::vector<PCCPatch>& prePatches,
@@ -407,7 +409,7 @@ class PCCEncoder : public PCCCodec {
                                                  size_t&                      occupancySizeU,
                                                  size_t&                      occupancySizeV,
                                                  const size_t                 safeguard,
-                                                 std::vector<bool>&           occupancyMap,
+                                                 PCCPackingCanvas&            occupancyMap,
                                                  size_t&                      heightGPA,
                                                  size_t&                      widthGPA,
                                                  size_t&                      maxOccupancyRow );
@@ -442,11 +444,20 @@ class PCCEncoder : public PCCCodec {
   void                   presmoothPointCloudColor( PCCPointSet3& reconstruct, const PCCEncoderParameters params );
   PCCVector3D            calculateWeightNormal( size_t geometryBitDepth3D, const PCCPointSet3& source );
 
+  //**memory**//
+  void checkMemoryBudget( const std::string& stage );
+
   //**print out**//
-  static void printMap( std::vector<bool> img, const size_t sizeU, const size_t sizeV );
-  static void printMapTetris( std::vector<bool> img, const size_t sizeU, const size_t sizeV, std::vector<int> horizon );
+  template <typename T>
+  static void printMap( const T& img, const size_t sizeU, const size_t sizeV, std::ostream& log = std::cout );
+  static void printMapTetris( const PCCPackingCanvas& img,
+                              const size_t            sizeU,
+                              const size_t            sizeV,
+                              std::vector<int>        horizon,
+                              std::ostream&           log = std::cout );
 
   PCCEncoderParameters params_;
+  PCCKdTreeCache*      kdtreeCache_ = nullptr;
 };
 
 };  // namespace pcc
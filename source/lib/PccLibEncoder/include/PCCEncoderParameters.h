@@ -72,9 +72,14 @@ class PCCEncoderParameters {
   std::string       colorSpaceConversionConfig_;
   std::string       inverseColorSpaceConversionConfig_;
   size_t            nbThread_;
+  size_t            maxGroupOfFramesInFlight_;
+  bool              parallelGroupOfFrames_;
+  size_t            memoryBudget_;
+  PCCNNEngine       nnSearchEngine_;
   size_t            frameCount_;
   size_t            groupOfFramesSize_;
   std::string       uncompressedDataPath_;
+  std::string       uncompressedDataCachePath_;
   uint32_t          forcedSsvhUnitSizePrecisionBytes_;
 
   // packing
@@ -196,6 +201,7 @@ class PCCEncoderParameters {
   size_t levelOfDetailX_;
   size_t levelOfDetailY_;
   bool   keepIntermediateFiles_;
+  bool   useNamedPipes_;
   bool   absoluteD1_;
   bool   absoluteT1_;
   bool   constrainedPack_;
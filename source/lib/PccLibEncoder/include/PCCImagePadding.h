@@ -0,0 +1,84 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PCCImagePadding_h
+#define PCCImagePadding_h
+
+#include "PCCCommon.h"
+#include "PCCImage.h"
+
+namespace pcc {
+
+// Padding of the empty pixels of the geometry and attribute images. The images are 4:4:4 and their occupancy maps
+// have the size of the images. The kernels walk the rows of the planes, and the row bands of an image are processed
+// by up to nbThread threads.
+template <typename T>
+class PCCImagePadding {
+ public:
+  PCCImagePadding( const size_t nbThread = 0 ) : nbThread_( nbThread ) {}
+  ~PCCImagePadding() = default;
+
+  // the empty blocks copy their left (or upper) neighbour and the partially occupied blocks are dilated
+  void dilate( PCCImage<T, 3>&              image,
+               const std::vector<uint32_t>& occupancyMap,
+               const size_t                 occupancyResolution,
+               const bool                   enhancedOccupancyMap,
+               const PCCImage<T, 3>*        reference = nullptr ) const;
+
+  // push-pull background filling
+  void pushPull( PCCImage<T, 3>& image, const std::vector<uint32_t>& occupancyMap ) const;
+  void pushPullMip( const PCCImage<T, 3>&        image,
+                    PCCImage<T, 3>&              mip,
+                    const std::vector<uint32_t>& occupancyMap,
+                    std::vector<uint32_t>&       mipOccupancyMap ) const;
+  void pushPullFill( PCCImage<T, 3>&              image,
+                     const PCCImage<T, 3>&        mip,
+                     const std::vector<uint32_t>& occupancyMap,
+                     const size_t                 numIters ) const;
+
+  // harmonic background filling: 5-point laplacian inpainting, solved from the coarsest layer
+  void harmonicBackgroundFill( PCCImage<T, 3>& image, const std::vector<uint32_t>& occupancyMap ) const;
+  void createCoarseLayer( const PCCImage<T, 3>&        image,
+                          PCCImage<T, 3>&              mip,
+                          const std::vector<uint32_t>& occupancyMap,
+                          std::vector<uint32_t>&       mipOccupancyMap ) const;
+  void regionFill( PCCImage<T, 3>&              image,
+                   const std::vector<uint32_t>& occupancyMap,
+                   const PCCImage<T, 3>&        imageLowRes ) const;
+
+ private:
+  size_t nbThread_;
+};
+
+};  // namespace pcc
+
+#endif /* PCCImagePadding_h */
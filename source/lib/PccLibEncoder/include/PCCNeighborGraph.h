@@ -0,0 +1,124 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PCCNeighborGraph_h
+#define PCCNeighborGraph_h
+
+#include "PCCCommon.h"
+
+namespace pcc {
+
+// Neighbourhood graph of a point cloud stored in compressed sparse rows: the neighbours of all the points are packed
+// in a single array of 32-bit indices, the neighbours of point i being in [offsets_[i], offsets_[i + 1]). The
+// distances to the neighbours can optionally be kept along.
+class PCCNeighborGraph {
+ public:
+  class Neighbors {
+   public:
+    Neighbors( const uint32_t* begin, const uint32_t* end ) : begin_( begin ), end_( end ) {}
+    const uint32_t* begin() const { return begin_; }
+    const uint32_t* end() const { return end_; }
+    size_t          size() const { return end_ - begin_; }
+    uint32_t        operator[]( const size_t index ) const { return begin_[index]; }
+
+   private:
+    const uint32_t* begin_;
+    const uint32_t* end_;
+  };
+
+  PCCNeighborGraph() = default;
+  ~PCCNeighborGraph() = default;
+
+  // reserves maxNeighborCount neighbours per point, the rows are filled with setNeighbors and packed with finalize
+  void init( const size_t pointCount, const size_t maxNeighborCount, const bool withDistances = false ) {
+    maxNeighborCount_ = maxNeighborCount;
+    offsets_.assign( pointCount + 1, 0 );
+    neighbors_.resize( pointCount * maxNeighborCount );
+    distances_.resize( withDistances ? pointCount * maxNeighborCount : 0 );
+  }
+  template <typename Result>
+  void setNeighbors( const size_t index, Result& result ) {
+    const size_t count = ( std::min )( result.count(), maxNeighborCount_ );
+    const size_t start = index * maxNeighborCount_;
+    for ( size_t j = 0; j < count; ++j ) { neighbors_[start + j] = static_cast<uint32_t>( result.indices( j ) ); }
+    if ( !distances_.empty() ) {
+      for ( size_t j = 0; j < count; ++j ) { distances_[start + j] = result.dist( j ); }
+    }
+    offsets_[index + 1] = count;
+  }
+  void finalize() {
+    const size_t pointCount = getPointCount();
+    size_t       offset     = 0;
+    for ( size_t i = 0; i < pointCount; ++i ) {
+      const size_t count = offsets_[i + 1];
+      const size_t start = i * maxNeighborCount_;
+      if ( offset != start ) {
+        std::copy( neighbors_.begin() + start, neighbors_.begin() + start + count, neighbors_.begin() + offset );
+        if ( !distances_.empty() ) {
+          std::copy( distances_.begin() + start, distances_.begin() + start + count, distances_.begin() + offset );
+        }
+      }
+      offsets_[i] = offset;
+      offset += count;
+    }
+    offsets_[pointCount] = offset;
+    neighbors_.resize( offset );
+    neighbors_.shrink_to_fit();
+    if ( !distances_.empty() ) {
+      distances_.resize( offset );
+      distances_.shrink_to_fit();
+    }
+  }
+  void clear() {
+    offsets_.clear();
+    neighbors_.clear();
+    distances_.clear();
+  }
+
+  size_t    getPointCount() const { return offsets_.empty() ? 0 : offsets_.size() - 1; }
+  Neighbors operator[]( const size_t index ) const {
+    return Neighbors( neighbors_.data() + offsets_[index], neighbors_.data() + offsets_[index + 1] );
+  }
+  double getDistance( const size_t index, const size_t neighbor ) const {
+    return distances_[offsets_[index] + neighbor];
+  }
+
+ private:
+  size_t                maxNeighborCount_ = 0;
+  std::vector<size_t>   offsets_;
+  std::vector<uint32_t> neighbors_;
+  std::vector<double>   distances_;
+};
+
+}  // namespace pcc
+
+#endif /* PCCNeighborGraph_h */
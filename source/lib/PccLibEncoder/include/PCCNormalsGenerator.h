@@ -41,7 +41,8 @@ enum PCCNormalsGeneratorOrientation {
   PCC_NORMALS_GENERATOR_ORIENTATION_NONE               = 0,
   PCC_NORMALS_GENERATOR_ORIENTATION_SPANNING_TREE      = 1,
   PCC_NORMALS_GENERATOR_ORIENTATION_VIEW_POINT         = 2,
-  PCC_NORMALS_GENERATOR_ORIENTATION_CUBEMAP_PROJECTION = 3
+  PCC_NORMALS_GENERATOR_ORIENTATION_CUBEMAP_PROJECTION = 3,
+  PCC_NORMALS_GENERATOR_ORIENTATION_SPANNING_FOREST    = 4
 };
 
 struct PCCNormalsGenerator3Parameters {
@@ -112,6 +113,9 @@ class PCCNormalsGenerator3 {
   void orientNormals( const PCCPointSet3&                   pointCloud,
                       const PCCKdTree&                      kdtree,
                       const PCCNormalsGenerator3Parameters& params );
+  void orientNormalsSpanningForest( const PCCPointSet3&                   pointCloud,
+                                    const PCCKdTree&                      kdtree,
+                                    const PCCNormalsGenerator3Parameters& params );
   void addNeighbors( const uint32_t      current,
                      const PCCPointSet3& pointCloud,
                      const PCCKdTree&    kdtree,
@@ -35,6 +35,7 @@
 #define PCCPatchSegmenter_h
 
 #include "PCCCommon.h"
+#include "PCCNeighborGraph.h"
 #include <set>
 
 namespace pcc {
@@ -100,11 +101,12 @@ struct PCCPatchSegmenter3Parameters {
 
 class PCCPatchSegmenter3 {
  public:
-  PCCPatchSegmenter3( void ) : nbThread_( 0 ) {}
+  PCCPatchSegmenter3( void ) : nbThread_( 0 ), nnSearchEngine_( NN_ENGINE_KDTREE ) {}
   PCCPatchSegmenter3( const PCCPatchSegmenter3& ) = delete;
   PCCPatchSegmenter3& operator=( const PCCPatchSegmenter3& ) = delete;
   ~PCCPatchSegmenter3()                                      = default;
   void setNbThread( size_t nbThread );
+  void setNNSearchEngine( PCCNNEngine engine ) { nnSearchEngine_ = engine; }
 
   void compute( const PCCPointSet3&                 geometry,
                 const size_t                        frameIndex,
@@ -138,16 +140,11 @@ class PCCPatchSegmenter3 {
                             const PCCVector3D*          orientations,
                             const size_t                orientationCount,
                             std::vector<size_t>&        partition );
-  void computeAdjacencyInfo( const PCCPointSet3&               pointCloud,
-                             const PCCKdTree&                  kdtree,
-                             std::vector<std::vector<size_t>>& adj,
-                             const size_t                      maxNNCount );
-
-  void computeAdjacencyInfoDist( const PCCPointSet3&               pointCloud,
-                                 const PCCKdTree&                  kdtree,
-                                 std::vector<std::vector<size_t>>& adj,
-                                 std::vector<std::vector<double>>& adjDist,
-                                 const size_t                      maxNNCount );
+  void computeAdjacencyInfo( const PCCPointSet3& pointCloud,
+                             const PCCKdTree&    kdtree,
+                             PCCNeighborGraph&   adj,
+                             const size_t        maxNNCount,
+                             const bool          withDistances = false );
 
   void computeAdjacencyInfoInRadius( const PCCPointSet3&                 pointCloud,
                                      const PCCKdTree&                    kdtree,
@@ -155,6 +152,14 @@ class PCCPatchSegmenter3 {
                                      const size_t                        maxNNCount,
                                      const size_t                        radius );
 
+  void extractConnectedComponents( const PCCNeighborGraph&           adj,
+                                   const std::vector<size_t>&        partition,
+                                   const std::vector<size_t>&        rawPoints,
+                                   const std::vector<double>&        rawPointsDistance,
+                                   const double                      maxAllowedDist2RawPointsDetection,
+                                   const size_t                      minPointCountPerCC,
+                                   std::vector<std::vector<size_t>>& connectedComponents );
+
   bool colorSimilarity( PCCColor3B& colorD1candidate, PCCColor3B& colorD0, uint8_t threshold ) {
     bool bSimilarity = ( std::abs( colorD0[0] - colorD1candidate[0] ) < threshold ) &&
                        ( std::abs( colorD0[1] - colorD1candidate[1] ) < threshold ) &&
@@ -232,6 +237,7 @@ class PCCPatchSegmenter3 {
 
  private:
   size_t                nbThread_;
+  PCCNNEngine           nnSearchEngine_;
   std::vector<PCCPatch> boxMinDepths_;  // box depth list
   std::vector<PCCPatch> boxMaxDepths_;  // box depth list
 
@@ -285,7 +291,7 @@ class PCCPatchSegmenter3 {
                                           const double                      minGradient,
                                           const size_t                      minNumHighGradientPoints,
                                           std::vector<size_t>&              partition,
-                                          std::vector<std::vector<size_t>>& adj,
+                                          const PCCNeighborGraph&           adj,
                                           std::vector<std::vector<size_t>>& connectedComponents );
   static void determinePatchOrientation( const size_t         additionalProjectionAxis,
                                          const bool           absoluteD1,
@@ -310,7 +316,7 @@ class PCCPatchSegmenter3 {
                                  const double                      minGradient,
                                  const size_t                      minNumHighGradientPoints,
                                  PCCPatch&                         patch,
-                                 std::vector<std::vector<size_t>>& adj,
+                                 const PCCNeighborGraph&           adj,
                                  std::vector<std::vector<size_t>>& highGradientConnectedComponents,
                                  std::vector<bool>&                isRemoved );
 
@@ -82,10 +82,28 @@ class PCCVideoEncoder {
                  const size_t       upsamplingFilter                  = 0,
                  const bool         patchColorSubsampling             = false );
 
+  // Application codecs run in their own processes and can be called concurrently, library codecs share global
+  // states and their compressions are serialized.
+  static bool isThreadSafe( PCCCodecId codecId, const std::string& colorSpaceConversionPath = "" );
+
   void setLogger( PCCLogger& logger ) { logger_ = &logger; }
+  void setUseNamedPipes( bool value ) { useNamedPipes_ = value; }
+
+  // When deferred, the reconstructed picture traces are stored instead of being written to the logger, so that
+  // concurrent compressions can be traced in the bitstream order.
+  void               setDeferPictureTrace( bool value ) { deferPictureTrace_ = value; }
+  const std::string& getPictureTrace() { return pictureTrace_; }
+
+  // Stream of the console messages, that concurrent compressions buffer to print them in the bitstream order.
+  void          setLog( std::ostream& log ) { log_ = &log; }
+  std::ostream& getLog() { return *log_; }
 
  private:
-  PCCLogger* logger_ = nullptr;
+  PCCLogger*    logger_            = nullptr;
+  std::ostream* log_               = &std::cout;
+  bool          useNamedPipes_     = false;
+  bool        deferPictureTrace_ = false;
+  std::string pictureTrace_;
 };
 
 };  // namespace pcc
@@ -0,0 +1,76 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef PCCVideoEncoderGraph_h
+#define PCCVideoEncoderGraph_h
+
+#include "PCCCommon.h"
+#include "PCCVideoEncoder.h"
+#include <functional>
+#include <sstream>
+
+namespace pcc {
+
+class PCCLogger;
+
+// Dependency graph of the video sub-bitstream compressions of a GOF. Each node compresses one video component and
+// starts as soon as the nodes it depends on are done; the number of concurrent nodes is bounded by nbThread. Nodes
+// must be added in the bitstream order: their dependencies are earlier nodes and their picture traces are written in
+// that order whatever the execution order was, as are the console messages that the nodes write to the log stream of
+// their encoder.
+class PCCVideoEncoderGraph {
+ public:
+  typedef std::function<void( PCCVideoEncoder& )> Task;
+
+  PCCVideoEncoderGraph( PCCLogger& logger, size_t nbThread, bool useNamedPipes );
+  ~PCCVideoEncoderGraph();
+
+  size_t addNode( const std::string& trace, const Task& task, const std::vector<size_t>& dependencies = {} );
+  void   run();
+
+ private:
+  struct Node {
+    std::string         trace_;
+    Task                task_;
+    std::vector<size_t> dependencies_;
+    PCCVideoEncoder     encoder_;
+    std::ostringstream  log_;
+  };
+  PCCLogger*        logger_;
+  size_t            nbThread_;
+  bool              useNamedPipes_;
+  std::vector<Node> nodes_;
+};
+
+};  // namespace pcc
+
+#endif /* PCCVideoEncoderGraph_h */
@@ -38,16 +38,23 @@
 #include "PCCPatch.h"
 #include "PCCPatchSegmenter.h"
 #include "PCCVideoEncoder.h"
+#include "PCCVideoEncoderGraph.h"
 #include "PCCGroupOfFrames.h"
 #include "PCCPointSet.h"
 #include "PCCEncoderParameters.h"
 #include "PCCKdTree.h"
 #include "PCCChrono.h"
+#include "PCCMemory.h"
 #include "PCCEncoder.h"
 #include "PCCEncoderConstant.h"
+#include "PCCImagePadding.h"
 #if defined( ENABLE_TBB )
 #include <tbb/tbb.h>
 #endif
+#if defined( __GLIBC__ )
+#include <malloc.h>
+#endif
+#include <atomic>
 
 using namespace std;
 using namespace pcc;
@@ -78,6 +85,8 @@ int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PC
 
   if ( sources.getFrameCount() == 0 ) { return 0; }
   assert( sources.getFrameCount() < 256 );
+  kdtreeCache_ = &sources.getKdTreeCache();
+  kdtreeCache_->setNNSearchEngine( params_.nnSearchEngine_ );
   if ( ( params_.rawPointsPatch_ || params_.lossyRawPointsPatch_ ) && params_.tileSegmentationType_ > 0 &&
        params_.numMaxTilePerFrame_ > 1 ) {
     params_.numMaxTilePerFrame_ += 1;
@@ -102,12 +111,14 @@ int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PC
 
   // Segmentation
   generateSegments( sources, context );
+  checkMemoryBudget( "segmentation" );
 
   // Init context and tiles
   params_.initializeContext( context );
 
   // Segment Placement
   placeSegments( sources, context );
+  checkMemoryBudget( "placement" );
 
   // updatePartitionInformation
   if ( params_.tileSegmentationType_ > 1 && params_.numMaxTilePerFrame_ > 1 ) {
@@ -117,6 +128,7 @@ int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PC
 
   PCCVideoEncoder videoEncoder;
   videoEncoder.setLogger( *logger_ );
+  videoEncoder.setUseNamedPipes( params_.useNamedPipes_ );
   size_t            atlasIndex = context.getAtlasIndex();
   const size_t      pointCount = sources[0].getPointCount();
   auto&             sps        = context.getVps();
@@ -157,13 +169,14 @@ int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PC
                          8,                                         // internalBitDepth
                          false,                                     // useConversion
                          params_.keepIntermediateFiles_ );          // keepIntermediateFiles
+  checkMemoryBudget( "occupancy map video" );
   if ( params_.offsetLossyOM_ > 0 ) { modifyOccupancyMap( sources, context ); }
   if ( !params_.useRawPointsSeparateVideo_ && ( params_.rawPointsPatch_ || params_.lossyRawPointsPatch_ ) ) {
     markRawPatchLocationOccupancyMapVideo( context );
   }
   if ( params_.tileSegmentationType_ > 0 ) {
-    generateAtlasBlockToPatchFromOccupancyMapVideo( context, params_.occupancyResolution_,
-                                                    params_.occupancyPrecision_ );
+    generateAtlasBlockToPatchFromOccupancyMapVideo( context, params_.occupancyResolution_, params_.occupancyPrecision_,
+                                                    params_.nbThread_ );
   } else {
     generateBlockToPatchFromOccupancyMapVideo( context, params_.occupancyResolution_, params_.occupancyPrecision_ );
   }
@@ -172,8 +185,6 @@ int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PC
   generateGeometryVideo( sources, context );
 
   // ENCODE GEOMETRY IMAGE
-  TRACE_PICTURE( "Geometry\n" );
-  TRACE_PICTURE( "MapIdx = 0, AuxiliaryVideoFlag = 0\n" );
   if ( params_.use3dmc_ || params_.usePccRDO_ ) { create3DMotionEstimationFiles( context, path.str() ); }
   auto&  gi                      = context.getVps().getGeometryInformation( atlasIndex );
   size_t geometryVideoBitDepth   = gi.getGeometry2dBitdepthMinus1() + 1;
@@ -182,111 +193,132 @@ int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PC
   size_t nbyteGeoMP              = ( geometryMPVideoBitDepth <= 8 ) ? 1 : 2;
   size_t internalBitDepth        = params_.videoEncoderInternalBitdepth_;
   if ( params_.rawPointsPatch_ ) { internalBitDepth = geometryVideoBitDepth; }
-  auto&       videoBitstreamD0 = params_.multipleStreams_ ? context.createVideoBitstream( VIDEO_GEOMETRY_D0 )
-                                                          : context.createVideoBitstream( VIDEO_GEOMETRY );
-  auto&       videoGeometry    = context.getVideoGeometryMultiple()[0];
-  std::string geometryConfigFile =
+  if ( params_.multipleStreams_ && params_.lossyRawPointsPatch_ ) {
+    std::cout << "Error: lossyRawPointsPatch has not been implemented for "
+                 "absoluteD1_ = 0 as "
+                 "yet. Exiting... "
+              << std::endl;
+    std::exit( -1 );
+  }
+  auto&                asps               = context.getAtlasSequenceParameterSet( atlasIndex );
+  PCCVideoBitstream    videoBitstreamD0( params_.multipleStreams_ ? VIDEO_GEOMETRY_D0 : VIDEO_GEOMETRY );
+  PCCVideoBitstream    videoBitstreamD1( VIDEO_GEOMETRY_D1 );
+  PCCVideoBitstream    videoRawPointsGeometryBitstream( VIDEO_GEOMETRY_RAW );
+  PCCVideoEncoderGraph geometryGraph( *logger_, params_.nbThread_, params_.useNamedPipes_ );
+  auto&                videoGeometry = context.getVideoGeometryMultiple()[0];
+  std::string          geometryConfigFile =
       params_.multipleStreams_
           ? params_.geometry0Config_
           : ( params_.mapCountMinus1_ == 0 ? getEncoderConfig1L( params_.geometryConfig_ ) : params_.geometryConfig_ );
-  videoEncoder.compress( videoGeometry,                             // video
-                         path.str(),                                // path
-                         params_.geometryQP_ + params_.deltaQPD0_,  // QP
-                         videoBitstreamD0,                          // bitstream
-                         geometryConfigFile,                        // config file
-                         params_.videoEncoderGeometryPath_,         // encoder path
-                         params_.videoEncoderGeometryCodecId_,      // Codec id
-                         params_.byteStreamVideoCoderGeometry_,     // byteStreamVideoCoder
-                         context,                                   // context
-                         nbyteGeo,                                  // nbyte
-                         false,                                     // use444CodecIo
-                         params_.use3dmc_,                          // use3dmv
-                         params_.usePccRDO_,                        // usePccRDO
-                         params_.shvcLayerIndex_,                   // SHVC layer index
-                         params_.shvcRateX_,                        // SHVC rate X
-                         params_.shvcRateY_,                        // SHVC rate Y
-                         internalBitDepth,                          // internalBitDepth
-                         false,                                     // useConversion
-                         params_.keepIntermediateFiles_ );          // keep intermediate
+  size_t geometryD0 = geometryGraph.addNode(
+      "Geometry\nMapIdx = 0, AuxiliaryVideoFlag = 0\n",
+      [&]( PCCVideoEncoder& videoEncoder ) {
+        videoEncoder.compress( videoGeometry,                             // video
+                               path.str(),                                // path
+                               params_.geometryQP_ + params_.deltaQPD0_,  // QP
+                               videoBitstreamD0,                          // bitstream
+                               geometryConfigFile,                        // config file
+                               params_.videoEncoderGeometryPath_,         // encoder path
+                               params_.videoEncoderGeometryCodecId_,      // Codec id
+                               params_.byteStreamVideoCoderGeometry_,     // byteStreamVideoCoder
+                               context,                                   // context
+                               nbyteGeo,                                  // nbyte
+                               false,                                     // use444CodecIo
+                               params_.use3dmc_,                          // use3dmv
+                               params_.usePccRDO_,                        // usePccRDO
+                               params_.shvcLayerIndex_,                   // SHVC layer index
+                               params_.shvcRateX_,                        // SHVC rate X
+                               params_.shvcRateY_,                        // SHVC rate Y
+                               internalBitDepth,                          // internalBitDepth
+                               false,                                     // useConversion
+                               params_.keepIntermediateFiles_ );          // keep intermediate
+      });
+  if ( params_.multipleStreams_ ) {
+    // the differential geometry1 is predicted from the reconstructed geometry0
+    geometryGraph.addNode(
+        "Geometry\nMapIdx = 1, AuxiliaryVideoFlag = 0\n",
+        [&]( PCCVideoEncoder& videoEncoder ) {
+          if ( !params_.absoluteD1_ ) {
+            // Form differential video geometry1
+            for ( size_t f = 0; f < frames.size(); ++f ) {
+              auto& frame1 = context.getVideoGeometryMultiple()[1].getFrame( f );
+              predictGeometryFrame( frames[f].getTitleFrameContext(), videoGeometry.getFrame( f ), frame1 );
+              dilate3DPadding( sources[f], frames[f], frames[f].getTitleFrameContext(), frame1,
+                               videoOccupancyMap.getFrame( f ) );
+            }
+          }
+          // Compress geometry1
+          videoEncoder.compress( context.getVideoGeometryMultiple()[1],     // video
+                                 path.str(),                                // path
+                                 params_.geometryQP_ + params_.deltaQPD1_,  // QP
+                                 videoBitstreamD1,                          // bitstream
+                                 params_.geometry1Config_,                  // config file
+                                 params_.videoEncoderGeometryPath_,         // encoder path
+                                 params_.videoEncoderGeometryCodecId_,      // Codec id
+                                 params_.byteStreamVideoCoderGeometry_,     // byteStreamVideoCoder
+                                 context,                                   // context
+                                 nbyteGeo,                                  // nbyte
+                                 false,                                     // use444CodecIo
+                                 params_.use3dmc_,                          // use3dmv
+                                 params_.usePccRDO_,                        // usePccRDO
+                                 params_.shvcLayerIndex_,                   // SHVC layer index
+                                 params_.shvcRateX_,                        // SHVC rate X
+                                 params_.shvcRateY_,                        // SHVC rate Y
+                                 internalBitDepth,                          // internalBitDepth
+                                 false,                                     // useConversion
+                                 params_.keepIntermediateFiles_ );          // keep intermediate
+        },
+        params_.absoluteD1_ ? std::vector<size_t>() : std::vector<size_t>( 1, geometryD0 ) );
+  }
+  if ( asps.getRawPatchEnabledFlag() && asps.getAuxiliaryVideoEnabledFlag() ) {
+    std::cout << "*******Video: Aux (Geometry) ********" << std::endl;
+    placeAuxiliaryPointsTiles( context );
+    generateRawPointsGeometryVideo( context );
+    geometryGraph.addNode(
+        "MapIdx = 0, AuxiliaryVideoFlag = 1\n",
+        [&]( PCCVideoEncoder& videoEncoder ) {
+          videoEncoder.compress( context.getVideoRawPointsGeometry(),    // video,
+                                 path.str(),                             // path,
+                                 params_.auxGeometryQP_,                 // qp,
+                                 videoRawPointsGeometryBitstream,        // bitstream,
+                                 params_.geometryAuxVideoConfig_,        // encoderConfig,
+                                 params_.videoEncoderGeometryPath_,      // encoderPath,
+                                 params_.videoEncoderGeometryCodecId_,   // codecId,
+                                 params_.byteStreamVideoCoderGeometry_,  // byteStreamVideoCoder,
+                                 context,                                // context
+                                 nbyteGeoMP,                             // nbyte
+                                 false,                                  // use444CodecIo
+                                 false,                                  // use3dmv
+                                 false,                                  // usePccRDO
+                                 params_.shvcLayerIndex_,                // SHVC layer index
+                                 params_.shvcRateX_,                     // SHVC rate X
+                                 params_.shvcRateY_,                     // SHVC rate Y
+                                 internalBitDepth,                       // internalBitDepth
+                                 false,                                  // useConversion
+                                 params_.keepIntermediateFiles_ );       // keepIntermediateFiles
+        });
+  }
+  // The geometry and the attribute videos are compressed by two graphs run one after the other, on purpose: the
+  // geometry reconstruction reads all the reconstructed geometry videos, raw points video included, and the attribute
+  // videos are generated from that reconstruction, so no attribute work could start before the last geometry node.
+  geometryGraph.run();
   size_t sizeGeometryVideo = videoBitstreamD0.size();
   std::cout << "sizeGeometryVideo: " << sizeGeometryVideo << std::endl;
+  context.createVideoBitstream( videoBitstreamD0.type() ).vector().swap( videoBitstreamD0.vector() );
   if ( params_.multipleStreams_ ) {
-    if ( params_.lossyRawPointsPatch_ ) {
-      std::cout << "Error: lossyRawPointsPatch has not been implemented for "
-                   "absoluteD1_ = 0 as "
-                   "yet. Exiting... "
-                << std::endl;
-      std::exit( -1 );
-    }
-    if ( !params_.absoluteD1_ ) {
-      // Form differential video geometry1
-      for ( size_t f = 0; f < frames.size(); ++f ) {
-        auto& frame1 = context.getVideoGeometryMultiple()[1].getFrame( f );
-        predictGeometryFrame( frames[f].getTitleFrameContext(), videoGeometry.getFrame( f ), frame1 );
-        dilate3DPadding( sources[f], frames[f], frames[f].getTitleFrameContext(), frame1,
-                         videoOccupancyMap.getFrame( f ) );
-      }
-    }
-
-    // Compress geometry1
-    TRACE_PICTURE( "Geometry\n" );
-    TRACE_PICTURE( "MapIdx = 1, AuxiliaryVideoFlag = 0\n" );
-    auto& videoGeometryD1  = context.getVideoGeometryMultiple()[1];
-    auto& videoBitstreamD1 = context.createVideoBitstream( VIDEO_GEOMETRY_D1 );
-    videoEncoder.compress( videoGeometryD1,                           // video
-                           path.str(),                                // path
-                           params_.geometryQP_ + params_.deltaQPD1_,  // QP
-                           videoBitstreamD1,                          // bitstream
-                           params_.geometry1Config_,                  // config file
-                           params_.videoEncoderGeometryPath_,         // encoder path
-                           params_.videoEncoderGeometryCodecId_,      // Codec id
-                           params_.byteStreamVideoCoderGeometry_,     // byteStreamVideoCoder
-                           context,                                   // context
-                           nbyteGeo,                                  // nbyte
-                           false,                                     // use444CodecIo
-                           params_.use3dmc_,                          // use3dmv
-                           params_.usePccRDO_,                        // usePccRDO
-                           params_.shvcLayerIndex_,                   // SHVC layer index
-                           params_.shvcRateX_,                        // SHVC rate X
-                           params_.shvcRateY_,                        // SHVC rate Y
-                           internalBitDepth,                          // internalBitDepth
-                           false,                                     // useConversion
-                           params_.keepIntermediateFiles_ );          // keep intermediate
     size_t sizeGeometryVideoD1 = videoBitstreamD1.size();
     std::cout << "sizeGeometryVideoD1: " << sizeGeometryVideoD1 << std::endl;
     std::cout << "geometryVideo ->" << ( sizeGeometryVideo + sizeGeometryVideoD1 ) << "=" << sizeGeometryVideo << "+"
               << sizeGeometryVideoD1 << " B ("
               << ( ( sizeGeometryVideo + sizeGeometryVideoD1 ) * 8.0 ) / ( 2 * frames.size() * pointCount ) << " bpp)"
               << std::endl;
+    context.createVideoBitstream( VIDEO_GEOMETRY_D1 ).vector().swap( videoBitstreamD1.vector() );
   }
-  auto& asps = context.getAtlasSequenceParameterSet( atlasIndex );
   if ( asps.getRawPatchEnabledFlag() && asps.getAuxiliaryVideoEnabledFlag() ) {
-    TRACE_PICTURE( "MapIdx = 0, AuxiliaryVideoFlag = 1\n" );
-    std::cout << "*******Video: Aux (Geometry) ********" << std::endl;
-    placeAuxiliaryPointsTiles( context );
-    auto& videoRawPointsGeometryBitstream = context.createVideoBitstream( VIDEO_GEOMETRY_RAW );
-    generateRawPointsGeometryVideo( context );
-    auto& videoRawPointsGeometry = context.getVideoRawPointsGeometry();
-    videoEncoder.compress( videoRawPointsGeometry,                 // video,
-                           path.str(),                             // path,
-                           params_.auxGeometryQP_,                 // qp,
-                           videoRawPointsGeometryBitstream,        // bitstream,
-                           params_.geometryAuxVideoConfig_,        // encoderConfig,
-                           params_.videoEncoderGeometryPath_,      // encoderPath,
-                           params_.videoEncoderGeometryCodecId_,   // codecId,
-                           params_.byteStreamVideoCoderGeometry_,  // byteStreamVideoCoder,
-                           context,                                // context
-                           nbyteGeoMP,                             // nbyte
-                           false,                                  // use444CodecIo
-                           false,                                  // use3dmv
-                           false,                                  // usePccRDO
-                           params_.shvcLayerIndex_,                // SHVC layer index
-                           params_.shvcRateX_,                     // SHVC rate X
-                           params_.shvcRateY_,                     // SHVC rate Y
-                           internalBitDepth,                       // internalBitDepth
-                           false,                                  // useConversion
-                           params_.keepIntermediateFiles_ );       // keepIntermediateFiles
+    context.createVideoBitstream( VIDEO_GEOMETRY_RAW ).vector().swap( videoRawPointsGeometryBitstream.vector() );
   }
+  checkMemoryBudget( "geometry video" );
+
   // Tile summary
   printf( "****TileInfo***Summary******************\n" );
   fflush( stdout );
@@ -331,7 +363,13 @@ int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PC
         frame.getTitleFrameContext().appendPointToPixel( tile.getPointToPixel() );
       }
     }
+    // the source points by patch are only used by the point local reconstruction search
+    frame.getTitleFrameContext().clearSrcPointCloudByPatch();
+    for ( size_t tileIdx = 0; tileIdx < frame.getNumTilesInAtlasFrame(); tileIdx++ ) {
+      frame.getTile( tileIdx ).clearSrcPointCloudByPatch();
+    }
   }
+  checkMemoryBudget( "geometry reconstruction" );
 
   auto& ai = sps.getAttributeInformation( atlasIndex );
   if ( ai.getAttributeCount() > 0 ) {
@@ -423,135 +461,147 @@ int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PC
 #endif
     }
     // ENCODE ATTRIBUTE IMAGE
-    TRACE_PICTURE( "Attribute\n" );
     std::cout << "attribute video " << std::endl;
-    auto&        videoBitstream = params_.multipleStreams_ ? context.createVideoBitstream( VIDEO_ATTRIBUTE_T0 )
-                                                           : context.createVideoBitstream( VIDEO_ATTRIBUTE );
-    const size_t nbyteAtt       = 1;
-    int attrPartitionIndex      = sps.getAttributeInformation( atlasIndex ).getAttributeDimensionPartitionsMinus1( 0 );
-    int attrTypeId              = sps.getAttributeInformation( atlasIndex ).getAttributeTypeId( 0 );
-    TRACE_PICTURE( "MapIdx = 0, AuxiliaryVideoFlag = 0, AttrIdx = 0, AttrPartIdx = %d, AttrTypeID = %d\n",
-                   attrPartitionIndex, attrTypeId );
-    auto encoderConfig0 = params_.multipleStreams_
+    const size_t nbyteAtt   = 1;
+    const size_t nByteAttMP = 1;
+    int attrPartitionIndex  = sps.getAttributeInformation( atlasIndex ).getAttributeDimensionPartitionsMinus1( 0 );
+    int attrTypeId          = sps.getAttributeInformation( atlasIndex ).getAttributeTypeId( 0 );
+    PCCVideoBitstream    videoBitstream( params_.multipleStreams_ ? VIDEO_ATTRIBUTE_T0 : VIDEO_ATTRIBUTE );
+    PCCVideoBitstream    videoBitstreamT1( VIDEO_ATTRIBUTE_T1 );
+    PCCVideoBitstream    videoBitstreamMP( VIDEO_ATTRIBUTE_RAW );
+    PCCVideoEncoderGraph attributeGraph( *logger_, params_.nbThread_, params_.useNamedPipes_ );
+    auto                 encoderConfig0 = params_.multipleStreams_
                               ? ( params_.mapCountMinus1_ == 0 ? getEncoderConfig1L( params_.attributeConfig_ )
                                                                : params_.attribute0Config_ )
                               : ( params_.mapCountMinus1_ == 0 ? getEncoderConfig1L( params_.attributeConfig_ )
                                                                : params_.attributeConfig_ );
-    videoEncoder.compress( context.getVideoAttributesMultiple()[0],         // video,
-                           path.str(),                                      // path
-                           params_.attributeQP_ + params_.deltaQPT0_,       // qp
-                           videoBitstream,                                  // bitstream
-                           encoderConfig0,                                  // encoderConfig
-                           params_.videoEncoderAttributePath_,              // encoderPath
-                           params_.videoEncoderAttributeCodecId_,           // codecId
-                           params_.byteStreamVideoCoderAttribute_,          // byteStreamVideoCoder
-                           context,                                         // context
-                           nbyteAtt,                                        // nbyte
-                           params_.attributeVideo444_,                      // use444CodecIo
-                           params_.use3dmc_,                                // use3dmv
-                           params_.usePccRDO_,                              // usePccRDO
-                           params_.shvcLayerIndex_,                         // SHVC layer index
-                           params_.shvcRateX_,                              // SHVC rate X
-                           params_.shvcRateY_,                              // SHVC rate Y
-                           params_.rawPointsPatch_ ? 8 : internalBitDepth,  // internalBitDepth
-                           !params_.rawPointsPatch_,                        // useConversion
-                           params_.keepIntermediateFiles_,                  // keepIntermediateFiles
-                           params_.colorSpaceConversionConfig_,             // colorSpaceConversionConfig
-                           params_.inverseColorSpaceConversionConfig_,      // inverseColorSpaceConversionConfig
-                           params_.colorSpaceConversionPath_ );             // colorSpaceConversionPath
-
+    size_t attributeT0 = attributeGraph.addNode(
+        stringFormat( "Attribute\nMapIdx = 0, AuxiliaryVideoFlag = 0, AttrIdx = 0, AttrPartIdx = %d, AttrTypeID = %d\n",
+                      attrPartitionIndex, attrTypeId ),
+        [&]( PCCVideoEncoder& videoEncoder ) {
+          videoEncoder.compress( context.getVideoAttributesMultiple()[0],         // video,
+                                 path.str(),                                      // path
+                                 params_.attributeQP_ + params_.deltaQPT0_,       // qp
+                                 videoBitstream,                                  // bitstream
+                                 encoderConfig0,                                  // encoderConfig
+                                 params_.videoEncoderAttributePath_,              // encoderPath
+                                 params_.videoEncoderAttributeCodecId_,           // codecId
+                                 params_.byteStreamVideoCoderAttribute_,          // byteStreamVideoCoder
+                                 context,                                         // context
+                                 nbyteAtt,                                        // nbyte
+                                 params_.attributeVideo444_,                      // use444CodecIo
+                                 params_.use3dmc_,                                // use3dmv
+                                 params_.usePccRDO_,                              // usePccRDO
+                                 params_.shvcLayerIndex_,                         // SHVC layer index
+                                 params_.shvcRateX_,                              // SHVC rate X
+                                 params_.shvcRateY_,                              // SHVC rate Y
+                                 params_.rawPointsPatch_ ? 8 : internalBitDepth,  // internalBitDepth
+                                 !params_.rawPointsPatch_,                        // useConversion
+                                 params_.keepIntermediateFiles_,                  // keepIntermediateFiles
+                                 params_.colorSpaceConversionConfig_,             // colorSpaceConversionConfig
+                                 params_.inverseColorSpaceConversionConfig_,      // inverseColorSpaceConversionConfig
+                                 params_.colorSpaceConversionPath_ );             // colorSpaceConversionPath
+        });
+    if ( params_.multipleStreams_ ) {
+      // the differential attribute1 is predicted from the reconstructed attribute0
+      auto encoderConfig1 =
+          params_.mapCountMinus1_ == 0 ? getEncoderConfig1L( params_.attributeConfig_ ) : params_.attribute1Config_;
+      attributeGraph.addNode(
+          stringFormat( "Attribute\nAttrIdx = 0, AttrPartIdx = %d, AttrTypeID = %d, MapIdx = 1, AuxiliaryVideoFlag = 0\n",
+                        attrPartitionIndex, attrTypeId ),
+          [&]( PCCVideoEncoder& videoEncoder ) {
+            // Form differential video attribute1
+            if ( !params_.absoluteT1_ ) {
+              for ( size_t f = 0; f < frames.size(); ++f ) {
+                auto& frame0 = context.getVideoAttributesMultiple()[0].getFrame( f );
+                auto& frame1 = context.getVideoAttributesMultiple()[1].getFrame( f );
+                predictAttributeFrame( frames[f].getTitleFrameContext(), frame0, frame1 );
+                switch ( params_.attributeBGFill_ ) {
+                  case 0: dilate( frames[f].getTitleFrameContext(), frame1 ); break;
+                  case 1: dilateSmoothedPushPull( frames[f].getTitleFrameContext(), frame1 ); break;
+                  case 2: dilateHarmonicBackgroundFill( frames[f].getTitleFrameContext(), frame1 ); break;
+                  default: videoEncoder.getLog() << "Warning: no attribute padding applied!" << std::endl;
+                }
+              }
+              videoEncoder.getLog() << "attribute prediction done " << std::endl;
+            }
+            // compress attribute1
+            videoEncoder.compress( context.getVideoAttributesMultiple()[1],         // video,
+                                   path.str(),                                      // path
+                                   params_.attributeQP_ + params_.deltaQPT1_,       // qp
+                                   videoBitstreamT1,                                // bitstream
+                                   encoderConfig1,                                  // encoderConfig
+                                   params_.videoEncoderAttributePath_,              // encoderPath
+                                   params_.videoEncoderAttributeCodecId_,           // codecId
+                                   params_.byteStreamVideoCoderAttribute_,          // byteStreamVideoCoder
+                                   context,                                         // context
+                                   nbyteAtt,                                        // nbyte
+                                   params_.attributeVideo444_,                      // use444CodecIo
+                                   params_.use3dmc_,                                // use3dmv
+                                   params_.usePccRDO_,                              // usePccRDO
+                                   params_.shvcLayerIndex_,                         // SHVC layer index
+                                   params_.shvcRateX_,                              // SHVC rate X
+                                   params_.shvcRateY_,                              // SHVC rate Y
+                                   params_.rawPointsPatch_ ? 8 : internalBitDepth,  // internalBitDepth
+                                   !params_.rawPointsPatch_,                        // useConversion
+                                   params_.keepIntermediateFiles_,                  // keepIntermediateFiles
+                                   params_.colorSpaceConversionConfig_,             // colorSpaceConversionConfig
+                                   params_.inverseColorSpaceConversionConfig_,  // inverseColorSpaceConversionConfig
+                                   params_.colorSpaceConversionPath_ );         // keepIntermediateFiles
+          },
+          params_.absoluteT1_ ? std::vector<size_t>() : std::vector<size_t>( 1, attributeT0 ) );
+    }
+    if ( asps.getRawPatchEnabledFlag() && asps.getAuxiliaryVideoEnabledFlag() ) {
+      std::cout << "*******Video: Aux (Attribute) ********" << std::endl;
+      generateRawPointsAttributeVideo( context );
+      attributeGraph.addNode(
+          stringFormat( "Attribute\nAttrIdx = 0, AttrPartIdx = %d, AttrTypeID = %d, MapIdx = 0, AuxiliaryVideoFlag = 1\n",
+                        attrPartitionIndex, attrTypeId ),
+          [&]( PCCVideoEncoder& videoEncoder ) {
+            videoEncoder.compress( context.getVideoRawPointsAttribute(),        // video,
+                                   path.str(),                                  // path
+                                   params_.auxAttributeQP_,                     // qp
+                                   videoBitstreamMP,                            // bitstream
+                                   params_.attributeAuxVideoConfig_,            // encoderConfig
+                                   params_.videoEncoderAttributePath_,          // encoderPath
+                                   params_.videoEncoderAttributeCodecId_,       // codecId
+                                   params_.byteStreamVideoCoderAttribute_,      // byteStreamVideoCoder
+                                   context,                                     // context
+                                   nByteAttMP,                                  // nbyte
+                                   params_.attributeVideo444_,                  // use444CodecIo
+                                   false,                                       // use3dmv
+                                   false,                                       // usePccRDO
+                                   params_.shvcLayerIndex_,                     // SHVC layer index
+                                   params_.shvcRateX_,                          // SHVC rate X
+                                   params_.shvcRateY_,                          // SHVC rate Y
+                                   10,                                          // internalBitDepth
+                                   !params_.rawPointsPatch_,                    // useConversion
+                                   params_.keepIntermediateFiles_,              // keepIntermediateFiles
+                                   params_.colorSpaceConversionConfig_,         // colorSpaceConversionConfig
+                                   params_.inverseColorSpaceConversionConfig_,  // inverseColorSpaceConversionConfig
+                                   params_.colorSpaceConversionPath_ );         // colorSpaceConversionPath
+          });
+    }
+    attributeGraph.run();
     auto sizeAttributeVideo = videoBitstream.size();
     std::cout << "attribute video ->" << sizeAttributeVideo << " B ("
               << ( sizeAttributeVideo * 8.0 ) / ( 2 * frames.size() * pointCount ) << " bpp)" << std::endl;
-
+    context.createVideoBitstream( videoBitstream.type() ).vector().swap( videoBitstream.vector() );
     if ( params_.multipleStreams_ ) {
-      // Form differential video attribute1
-      if ( !params_.absoluteT1_ ) {
-        for ( size_t f = 0; f < frames.size(); ++f ) {
-          auto& frame0 = context.getVideoAttributesMultiple()[0].getFrame( f );
-          auto& frame1 = context.getVideoAttributesMultiple()[1].getFrame( f );
-          predictAttributeFrame( frames[f].getTitleFrameContext(), frame0, frame1 );
-          switch ( params_.attributeBGFill_ ) {
-            case 0: dilate( frames[f].getTitleFrameContext(), frame1 ); break;
-            case 1: dilateSmoothedPushPull( frames[f].getTitleFrameContext(), frame1 ); break;
-            case 2: dilateHarmonicBackgroundFill( frames[f].getTitleFrameContext(), frame1 ); break;
-            default: std::cout << "Warning: no attribute padding applied!" << std::endl;
-          }
-        }
-        std::cout << "attribute prediction done " << std::endl;
-      }
-
-      // compress attribute1
-      TRACE_PICTURE( "Attribute\n" );
-      TRACE_PICTURE( "AttrIdx = 0, AttrPartIdx = %d, AttrTypeID = %d, MapIdx = 1, AuxiliaryVideoFlag = 0\n",
-                     attrPartitionIndex, attrTypeId );
-      auto& videoBitstreamT1 = context.createVideoBitstream( VIDEO_ATTRIBUTE_T1 );
-      auto  encoderConfig1 =
-          params_.mapCountMinus1_ == 0 ? getEncoderConfig1L( params_.attributeConfig_ ) : params_.attribute1Config_;
-      videoEncoder.compress( context.getVideoAttributesMultiple()[1],         // video,
-                             path.str(),                                      // path
-                             params_.attributeQP_ + params_.deltaQPT1_,       // qp
-                             videoBitstreamT1,                                // bitstream
-                             encoderConfig1,                                  // encoderConfig
-                             params_.videoEncoderAttributePath_,              // encoderPath
-                             params_.videoEncoderAttributeCodecId_,           // codecId
-                             params_.byteStreamVideoCoderAttribute_,          // byteStreamVideoCoder
-                             context,                                         // context
-                             nbyteAtt,                                        // nbyte
-                             params_.attributeVideo444_,                      // use444CodecIo
-                             params_.use3dmc_,                                // use3dmv
-                             params_.usePccRDO_,                              // usePccRDO
-                             params_.shvcLayerIndex_,                         // SHVC layer index
-                             params_.shvcRateX_,                              // SHVC rate X
-                             params_.shvcRateY_,                              // SHVC rate Y
-                             params_.rawPointsPatch_ ? 8 : internalBitDepth,  // internalBitDepth
-                             !params_.rawPointsPatch_,                        // useConversion
-                             params_.keepIntermediateFiles_,                  // keepIntermediateFiles
-                             params_.colorSpaceConversionConfig_,             // colorSpaceConversionConfig
-                             params_.inverseColorSpaceConversionConfig_,      // inverseColorSpaceConversionConfig
-                             params_.colorSpaceConversionPath_ );             // keepIntermediateFiles
       size_t sizeAttributeVideoT1 = videoBitstreamT1.size();
       std::cout << "attribute video ->" << ( sizeAttributeVideo + sizeAttributeVideoT1 ) << "=" << sizeAttributeVideo
                 << "+" << sizeAttributeVideoT1 << " B ("
                 << ( ( sizeAttributeVideo + sizeAttributeVideoT1 ) * 8.0 ) / ( 2 * frames.size() * pointCount )
                 << " bpp)" << std::endl;
+      context.createVideoBitstream( VIDEO_ATTRIBUTE_T1 ).vector().swap( videoBitstreamT1.vector() );
     }
-
     if ( asps.getRawPatchEnabledFlag() && asps.getAuxiliaryVideoEnabledFlag() ) {
-      TRACE_PICTURE( "Attribute\n" );
-      TRACE_PICTURE( "AttrIdx = 0, AttrPartIdx = %d, AttrTypeID = %d, MapIdx = 0, AuxiliaryVideoFlag = 1\n",
-                     attrPartitionIndex, attrTypeId );
-      std::cout << "*******Video: Aux (Attribute) ********" << std::endl;
-      auto& videoBitstreamMP = context.createVideoBitstream( VIDEO_ATTRIBUTE_RAW );
-      generateRawPointsAttributeVideo( context );
-      auto&        videoRawPointsAttribute = context.getVideoRawPointsAttribute();
-      const size_t nByteAttMP              = 1;
-      videoEncoder.compress( videoRawPointsAttribute,                     // video,
-                             path.str(),                                  // path
-                             params_.auxAttributeQP_,                     // qp
-                             videoBitstreamMP,                            // bitstream
-                             params_.attributeAuxVideoConfig_,            // encoderConfig
-                             params_.videoEncoderAttributePath_,          // encoderPath
-                             params_.videoEncoderAttributeCodecId_,       // codecId
-                             params_.byteStreamVideoCoderAttribute_,      // byteStreamVideoCoder
-                             context,                                     // context
-                             nByteAttMP,                                  // nbyte
-                             params_.attributeVideo444_,                  // use444CodecIo
-                             false,                                       // use3dmv
-                             false,                                       // usePccRDO
-                             params_.shvcLayerIndex_,                     // SHVC layer index
-                             params_.shvcRateX_,                          // SHVC rate X
-                             params_.shvcRateY_,                          // SHVC rate Y
-                             10,                                          // internalBitDepth
-                             !params_.rawPointsPatch_,                    // useConversion
-                             params_.keepIntermediateFiles_,              // keepIntermediateFiles
-                             params_.colorSpaceConversionConfig_,         // colorSpaceConversionConfig
-                             params_.inverseColorSpaceConversionConfig_,  // inverseColorSpaceConversionConfig
-                             params_.colorSpaceConversionPath_ );         // colorSpaceConversionPath
+      context.createVideoBitstream( VIDEO_ATTRIBUTE_RAW ).vector().swap( videoBitstreamMP.vector() );
       printf( "generateRawPointsAttributefromVideo \n" );
       for ( size_t fi = 0; fi < context.size(); fi++ ) { generateRawPointsAttributefromVideo( context, fi ); }
     }
   }  // attribute
+  checkMemoryBudget( "attribute video" );
 
   if ( params_.flagGeometrySmoothing_ ) {
     if ( params_.pbfEnableFlag_ ) {
@@ -570,6 +620,12 @@ int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PC
       }
     }
   }
+  // the geometry is reconstructed: the reconstructed geometry videos have no later consumer
+  for ( auto& videoGeometry : context.getVideoGeometryMultiple() ) {
+    videoGeometry.releaseFrames( videoGeometry.size() );
+  }
+  auto& videoRawPointsGeometry = context.getVideoRawPointsGeometry();
+  videoRawPointsGeometry.releaseFrames( videoRawPointsGeometry.size() );
 
   if ( ai.getAttributeCount() > 0 ) {
     // RECOLOR RECONSTRUCTED POINT CLOUD
@@ -595,7 +651,14 @@ int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PC
         }
       }  // tile
     }
+    // the reconstructed point clouds are coloured: the reconstructed attribute videos have no later consumer
+    for ( auto& videoAttribute : context.getVideoAttributesMultiple() ) {
+      videoAttribute.releaseFrames( videoAttribute.size() );
+    }
+    auto& videoRawPointsAttribute = context.getVideoRawPointsAttribute();
+    videoRawPointsAttribute.releaseFrames( videoRawPointsAttribute.size() );
   }  // if ( ai.getAttributeCount() > 0 )
+  checkMemoryBudget( "colour reconstruction" );
 
 #ifdef CONFORMANCE_TRACE
   for ( size_t frameIdx = 0; frameIdx < context.size(); frameIdx++ ) {
@@ -662,14 +725,17 @@ int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PC
                                                    1,                                // numNeighborsColorTransferBwd
                                                    true,                             // useDistWeightedAverageFwd
                                                    true,                             // useDistWeightedAverageBwd
-                                                   true,          // skipAvgIfIdenticalSourcePointPresentFwd
-                                                   false,         // skipAvgIfIdenticalSourcePointPresentBwd
-                                                   4,             // distOffsetFwd
-                                                   4,             // distOffsetBwd
-                                                   1000,          // maxGeometryDist2Fwd
-                                                   1000,          // maxGeometryDist2Bwd
-                                                   1000 * 256,    // maxColorDist2Fwd
-                                                   1000 * 256 );  // maxColorDist2Bwd
+                                                   true,                 // skipAvgIfIdenticalSourcePointPresentFwd
+                                                   false,                // skipAvgIfIdenticalSourcePointPresentBwd
+                                                   4,                    // distOffsetFwd
+                                                   4,                    // distOffsetBwd
+                                                   1000,                 // maxGeometryDist2Fwd
+                                                   1000,                 // maxGeometryDist2Bwd
+                                                   1000 * 256,           // maxColorDist2Fwd
+                                                   1000 * 256,           // maxColorDist2Bwd
+                                                   false,                // excludeColorOutlier
+                                                   10.0,                 // thresholdColorOutlierDist
+                                                   params_.nbThread_ );  // nbThread
           } else if ( params_.attrTransferFilterType_ == 2 ) {
             TRACE_PATCH( " transferColorWeight \n" );
             tempFrameBuffer.transferColorWeight( reconstruct, 0.1 );
@@ -686,14 +752,17 @@ int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PC
                                                            1,             //  numNeighborsColorTransferBwd
                                                            true,          //  useDistWeightedAverageFwd
                                                            true,          //  useDistWeightedAverageBwd
-                                                           true,          //  skipAvgIfIdenticalSourcePointPresentFwd
-                                                           false,         //  skipAvgIfIdenticalSourcePointPresentBwd
-                                                           4,             //  distOffsetFwd
-                                                           4,             //  distOffsetBwd
-                                                           1000,          //  maxGeometryDist2Fwd
-                                                           1000,          //  maxGeometryDist2Bwd
-                                                           1000 * 256,    //  maxColorDist2Fwd
-                                                           1000 * 256 );  //  maxColorDist2Bwd
+                                                           true,        //  skipAvgIfIdenticalSourcePointPresentFwd
+                                                           false,       //  skipAvgIfIdenticalSourcePointPresentBwd
+                                                           4,           //  distOffsetFwd
+                                                           4,           //  distOffsetBwd
+                                                           1000,        //  maxGeometryDist2Fwd
+                                                           1000,        //  maxGeometryDist2Bwd
+                                                           1000 * 256,  //  maxColorDist2Fwd
+                                                           1000 * 256,  //  maxColorDist2Bwd
+                                                           false,                //  excludeColorOutlier
+                                                           10.0,                 //  thresholdColorOutlierDist
+                                                           params_.nbThread_ );  //  nbThread
           }
         }
       }  // if ( ai.getAttributeCount() > 0 )
@@ -721,6 +790,7 @@ int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PC
     remove3DMotionEstimationFiles( path.str() );
   }
   createPatchFrameDataStructure( context );
+  checkMemoryBudget( "post processing" );
   params_.pointLocalReconstruction_   = ( pointLocalReconstructionOriginal != 0u );
   params_.mapCountMinus1_             = layerCountMinus1Original;
   params_.singleMapPixelInterleaving_ = ( singleMapPixelInterleavingOriginal != 0u );
@@ -729,33 +799,50 @@ int PCCEncoder::encode( const PCCGroupOfFrames& sources, PCCContext& context, PC
   return 0;
 }
 
-void PCCEncoder::printMap( std::vector<bool> img, const size_t sizeU, const size_t sizeV ) {
-  std::cout << std::endl;
-  std::cout << "PrintMap size = " << sizeU << " x " << sizeV << std::endl;
+void PCCEncoder::checkMemoryBudget( const std::string& stage ) {
+  if ( params_.memoryBudget_ == 0 ) { return; }
+  uint64_t residentMemory = getResidentMemory();
+  if ( residentMemory > params_.memoryBudget_ * 1024 ) {
+    // over budget: the KD-trees are rebuilt on demand by the next stages and the freed heap is returned to the system
+    if ( kdtreeCache_ != nullptr ) { kdtreeCache_->trim(); }
+#if defined( __GLIBC__ )
+    malloc_trim( 0 );
+#endif
+    residentMemory = getResidentMemory();
+  }
+  std::cout << "Memory after " << stage << ": " << residentMemory << " KB resident, peak " << getPeakMemory()
+            << " KB, budget " << params_.memoryBudget_ * 1024 << " KB" << std::endl;
+}
+
+template <typename T>
+void PCCEncoder::printMap( const T& img, const size_t sizeU, const size_t sizeV, std::ostream& log ) {
+  log << std::endl;
+  log << "PrintMap size = " << sizeU << " x " << sizeV << std::endl;
   for ( size_t v = 0; v < sizeV; ++v ) {
-    for ( size_t u = 0; u < sizeU; ++u ) { std::cout << ( img[v * sizeU + u] ? 'X' : '.' ); }
-    std::cout << std::endl;
+    for ( size_t u = 0; u < sizeU; ++u ) { log << ( img[v * sizeU + u] ? 'X' : '.' ); }
+    log << std::endl;
   }
-  std::cout << std::endl;
+  log << std::endl;
 }
 
-void PCCEncoder::printMapTetris( std::vector<bool> img,
-                                 const size_t      sizeU,
-                                 const size_t      sizeV,
-                                 std::vector<int>  horizon ) {
-  std::cout << std::endl;
-  std::cout << "PrintMap size = " << sizeU << " x " << sizeV << std::endl;
+void PCCEncoder::printMapTetris( const PCCPackingCanvas& img,
+                                 const size_t            sizeU,
+                                 const size_t            sizeV,
+                                 std::vector<int>        horizon,
+                                 std::ostream&           log ) {
+  log << std::endl;
+  log << "PrintMap size = " << sizeU << " x " << sizeV << std::endl;
   for ( int v = 0; v < sizeV; ++v ) {
     for ( int u = 0; u < sizeU; ++u ) {
       if ( v == horizon[u] ) {
-        std::cout << ( img[v * sizeU + u] ? 'U' : 'O' );
+        log << ( img[v * sizeU + u] ? 'U' : 'O' );
       } else {
-        std::cout << ( img[v * sizeU + u] ? 'X' : '.' );
+        log << ( img[v * sizeU + u] ? 'X' : '.' );
       }
     }
-    std::cout << std::endl;
+    log << std::endl;
   }
-  std::cout << std::endl;
+  log << std::endl;
 }
 
 template <typename T>
@@ -1210,7 +1297,8 @@ void PCCEncoder::spatialConsistencyPackFlexible( PCCFrameContext& tile,
                                                  size_t           presetWidth,
                                                  size_t           presetHeight,
                                                  int              safeguard,
-                                                 bool             enablePointCloudPartitioning ) {
+                                                 bool             enablePointCloudPartitioning,
+                                                 std::ostream&    log ) {
   auto& width       = tile.getWidth();
   auto& height      = tile.getHeight();
   auto& patches     = tile.getPatches();
@@ -1218,9 +1306,9 @@ void PCCEncoder::spatialConsistencyPackFlexible( PCCFrameContext& tile,
   if ( patches.empty() ) {
     if ( tile.getNumberOfRawPointsPatches() == 0 ) { return; }
     if ( tile.getUseRawPointsSeparateVideo() ) { return; }
-    std::vector<bool> occupancyMap;
-    size_t            occupancySizeU = presetWidth / params_.occupancyResolution_;
-    size_t            occupancySizeV = presetHeight / params_.occupancyResolution_;
+    PCCPackingCanvas occupancyMap;
+    size_t           occupancySizeU = presetWidth / params_.occupancyResolution_;
+    size_t           occupancySizeV = presetHeight / params_.occupancyResolution_;
     if ( presetWidth == 0 || presetHeight == 0 ) {
       auto& rawPointsPatch = tile.getRawPointsPatch( 0 );
       auto  rawPointsPatchBlocks =
@@ -1232,25 +1320,25 @@ void PCCEncoder::spatialConsistencyPackFlexible( PCCFrameContext& tile,
     }
     occupancyMap.resize( occupancySizeU * occupancySizeV );
     if ( tile.getNumberOfRawPointsPatches() > 0 && !tile.getUseRawPointsSeparateVideo() ) {
-      packRawPointsPatch( tile, occupancyMap, width, height, occupancySizeU, occupancySizeV, 0 );
+      packRawPointsPatch( tile, occupancyMap, width, height, occupancySizeU, occupancySizeV, 0, log );
     } else {
-      if ( g_printDetailedInfo ) { printMap( occupancyMap, occupancySizeU, occupancySizeV ); }
+      if ( g_printDetailedInfo ) { printMap( occupancyMap, occupancySizeU, occupancySizeV, log ); }
     }
     if ( params_.enhancedOccupancyMapCode_ && !tile.getUseRawPointsSeparateVideo() ) {
-      packEOMAttributePointsPatch( tile, occupancyMap, width, height, occupancySizeU, occupancySizeV, 0 );
+      packEOMAttributePointsPatch( tile, occupancyMap, width, height, occupancySizeU, occupancySizeV, 0, log );
     }
-    if ( g_printDetailedInfo ) { printMap( occupancyMap, occupancySizeU, occupancySizeV ); }
+    if ( g_printDetailedInfo ) { printMap( occupancyMap, occupancySizeU, occupancySizeV, log ); }
     bool emptyTile = false;
     if ( height == 0 ) {
       emptyTile = true;
       height    = 64;
     }
-    std::cout << "frame " << tile.getFrameIndex() << " tile " << tile.getTileIndex()
+    log << "frame " << tile.getFrameIndex() << " tile " << tile.getTileIndex()
               << " spatialConsistencyPackFlexible(patchEmpty): actualImageSize " << width << " x " << height;
     if ( emptyTile )
-      std::cout << " height adjusted" << std::endl;
+      log << " height adjusted" << std::endl;
     else
-      std::cout << std::endl;
+      log << std::endl;
     return;
   }
   if ( packingStrategy == 0 ) {
@@ -1310,14 +1398,14 @@ void PCCEncoder::spatialConsistencyPackFlexible( PCCFrameContext& tile,
 
   // remove the below logs when useless.
   if ( g_printDetailedInfo ) {
-    std::cout << "patches.size:" << patches.size() << ",reOrderedPatches.size:" << newOrderPatches.size()
+    log << "patches.size:" << patches.size() << ",reOrderedPatches.size:" << newOrderPatches.size()
               << ",matchedpatches.size:" << tile.getNumMatchedPatches() << std::endl;
   }
   patches = newOrderPatches;
   if ( g_printDetailedInfo ) {
-    std::cout << "Patch order:" << std::endl;
+    log << "Patch order:" << std::endl;
     for ( auto& patch : patches ) {
-      std::cout << "Patch[" << patch.getIndex() << "]=(" << patch.getSizeU0() << "," << patch.getSizeV0() << ")"
+      log << "Patch[" << patch.getIndex() << "]=(" << patch.getSizeU0() << "," << patch.getSizeV0() << ")"
                 << std::endl;
     }
   }
@@ -1326,20 +1414,30 @@ void PCCEncoder::spatialConsistencyPackFlexible( PCCFrameContext& tile,
   int tileWidth   = occupancySizeU / numTilesHor;
   int tileHeight  = int( tileWidth * params_.tileHeightToWidthRatio_ );
   if ( params_.enablePointCloudPartitioning_ ) {
-    std::cout << "frame " << tile.getFrameIndex() << " tilesize: " << tileWidth << "x" << tileHeight << std::endl;
-  }
-  occupancySizeV                    = ( occupancySizeV >= tileHeight ) ? occupancySizeV : tileHeight;
-  width                             = occupancySizeU * params_.occupancyResolution_;
-  height                            = occupancySizeV * params_.occupancyResolution_;
-  size_t            maxOccupancyRow = 0;
-  int               numOrientations = packingStrategy == 0 ? 1 : ( params_.useEightOrientations_ ? 8 : 2 );
-  std::vector<bool> occupancyMap;
+    log << "frame " << tile.getFrameIndex() << " tilesize: " << tileWidth << "x" << tileHeight << std::endl;
+  }
+  occupancySizeV                   = ( occupancySizeV >= tileHeight ) ? occupancySizeV : tileHeight;
+  width                            = occupancySizeU * params_.occupancyResolution_;
+  height                           = occupancySizeV * params_.occupancyResolution_;
+  size_t           maxOccupancyRow = 0;
+  int              numOrientations = packingStrategy == 0 ? 1 : ( params_.useEightOrientations_ ? 8 : 2 );
+  PCCPackingCanvas occupancyMap;
   occupancyMap.resize( occupancySizeU * occupancySizeV, false );
   for ( auto& patch : patches ) {
     assert( patch.getSizeU0() <= occupancySizeU );
     assert( patch.getSizeV0() <= occupancySizeV );
-    bool  locationFound = false;
-    auto& occupancy     = patch.getOccupancy();
+    bool                locationFound = false;
+    auto&               occupancy     = patch.getOccupancy();
+    std::vector<size_t> orientations;
+    for ( size_t orientationIdx = 0; orientationIdx < numOrientations; orientationIdx++ ) {
+      if ( packingStrategy == 0 ) {
+        orientations.push_back( PATCH_ORIENTATION_DEFAULT );
+      } else if ( patch.getSizeU0() > patch.getSizeV0() ) {
+        orientations.push_back( g_orientationHorizontal[orientationIdx] );
+      } else {
+        orientations.push_back( g_orientationVertical[orientationIdx] );
+      }
+    }
     while ( !locationFound ) {
       if ( patch.getBestMatchIdx() != g_invalidPatchIndex ) {
         patch.setPatchOrientation( prevPatches[patch.getBestMatchIdx()].getPatchOrientation() );
@@ -1349,52 +1447,27 @@ void PCCEncoder::spatialConsistencyPackFlexible( PCCFrameContext& tile,
         if ( patch.checkFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV, params_.lowDelayEncoding_ ) ) {
           locationFound = true;
           if ( g_printDetailedInfo ) {
-            std::cout << "Maintained orientation " << patch.getPatchOrientation() << " for matched patch "
+            log << "Maintained orientation " << patch.getPatchOrientation() << " for matched patch "
                       << patch.getIndex() << " in the same position (" << patch.getU0() << "," << patch.getV0() << ")"
                       << std::endl;
           }
         }
         // if the patch couldn't fit, try to fit the patch in the top left position
-        for ( int v = 0; v <= occupancySizeV && !locationFound; ++v ) {
-          for ( int u = 0; u <= occupancySizeU && !locationFound; ++u ) {
-            patch.setU0( u );
-            patch.setV0( v );
-            if ( patch.checkFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV, params_.lowDelayEncoding_,
-                                            safeguard ) ) {
-              locationFound = true;
-              if ( g_printDetailedInfo ) {
-                std::cout << "Maintained orientation " << patch.getPatchOrientation() << " for matched patch "
-                          << patch.getIndex() << " (" << u << "," << v << ")" << std::endl;
-              }
-            }
+        if ( !locationFound ) {
+          locationFound = findPatchLocation( patch, occupancyMap, { patch.getPatchOrientation() }, occupancySizeU + 1,
+                                             occupancySizeV + 1, occupancySizeU, occupancySizeV, safeguard );
+          if ( locationFound && g_printDetailedInfo ) {
+            log << "Maintained orientation " << patch.getPatchOrientation() << " for matched patch "
+                      << patch.getIndex() << " (" << patch.getU0() << "," << patch.getV0() << ")" << std::endl;
           }
         }
       } else {
         // best effort
-        for ( size_t v = 0; v < occupancySizeV && !locationFound; ++v ) {
-          for ( size_t u = 0; u < occupancySizeU && !locationFound; ++u ) {
-            patch.setU0( u );
-            patch.setV0( v );
-            for ( size_t orientationIdx = 0; orientationIdx < numOrientations && !locationFound; orientationIdx++ ) {
-              if ( packingStrategy == 0 )
-                patch.setPatchOrientation( PATCH_ORIENTATION_DEFAULT );
-              else {
-                if ( patch.getSizeU0() > patch.getSizeV0() ) {
-                  patch.setPatchOrientation( g_orientationHorizontal[orientationIdx] );
-                } else {
-                  patch.setPatchOrientation( g_orientationVertical[orientationIdx] );
-                }
-              }
-              if ( patch.checkFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV, params_.lowDelayEncoding_,
-                                              safeguard ) ) {
-                locationFound = true;
-                if ( g_printDetailedInfo ) {
-                  std::cout << "Orientation " << patch.getPatchOrientation() << " selected for unmatched patch "
-                            << patch.getIndex() << " (" << u << "," << v << ")" << std::endl;
-                }
-              }
-            }
-          }
+        locationFound = findPatchLocation( patch, occupancyMap, orientations, occupancySizeU, occupancySizeV,
+                                           occupancySizeU, occupancySizeV, safeguard );
+        if ( locationFound && g_printDetailedInfo ) {
+          log << "Orientation " << patch.getPatchOrientation() << " selected for unmatched patch "
+                    << patch.getIndex() << " (" << patch.getU0() << "," << patch.getV0() << ")" << std::endl;
         }
       }
       if ( !locationFound ) {
@@ -1423,15 +1496,16 @@ void PCCEncoder::spatialConsistencyPackFlexible( PCCFrameContext& tile,
     }
   }
   if ( tile.getNumberOfRawPointsPatches() > 0 && !tile.getUseRawPointsSeparateVideo() ) {
-    packRawPointsPatch( tile, occupancyMap, width, height, occupancySizeU, occupancySizeV, maxOccupancyRow );
+    packRawPointsPatch( tile, occupancyMap, width, height, occupancySizeU, occupancySizeV, maxOccupancyRow, log );
   } else {
-    if ( g_printDetailedInfo ) { printMap( occupancyMap, occupancySizeU, occupancySizeV ); }
+    if ( g_printDetailedInfo ) { printMap( occupancyMap, occupancySizeU, occupancySizeV, log ); }
   }
   if ( params_.enhancedOccupancyMapCode_ && !tile.getUseRawPointsSeparateVideo() ) {
-    packEOMAttributePointsPatch( tile, occupancyMap, width, height, occupancySizeU, occupancySizeV, maxOccupancyRow );
+    packEOMAttributePointsPatch( tile, occupancyMap, width, height, occupancySizeU, occupancySizeV, maxOccupancyRow,
+                                 log );
   }
-  if ( g_printDetailedInfo ) { printMap( occupancyMap, occupancySizeU, occupancySizeV ); }
-  std::cout << "frame " << tile.getFrameIndex() << " tile " << tile.getTileIndex()
+  if ( g_printDetailedInfo ) { printMap( occupancyMap, occupancySizeU, occupancySizeV, log ); }
+  log << "frame " << tile.getFrameIndex() << " tile " << tile.getTileIndex()
             << " spatialConsistencyPackFlexible: actualImageSize " << width << " x " << height << std::endl;
 }
 
@@ -1439,7 +1513,8 @@ void PCCEncoder::spatialConsistencyPackTetris( PCCFrameContext& frame,
                                                PCCFrameContext& prevFrame,
                                                size_t           presetWidth,
                                                size_t           presetHeight,
-                                               int              safeguard ) {
+                                               int              safeguard,
+                                             std::ostream&    log ) {
   auto& width       = frame.getWidth();
   auto& height      = frame.getHeight();
   auto& patches     = frame.getPatches();
@@ -1494,22 +1569,22 @@ void PCCEncoder::spatialConsistencyPackTetris( PCCFrameContext& frame,
 
   // remove the below logs when useless.
   if ( g_printDetailedInfo ) {
-    std::cout << "patches.size:" << patches.size() << ",reOrderedPatches.size:" << newOrderPatches.size()
+    log << "patches.size:" << patches.size() << ",reOrderedPatches.size:" << newOrderPatches.size()
               << ",matchedpatches.size:" << frame.getNumMatchedPatches() << std::endl;
   }
   patches = newOrderPatches;
   if ( g_printDetailedInfo ) {
-    std::cout << "Patch order:" << std::endl;
+    log << "Patch order:" << std::endl;
     for ( auto& patch : patches ) {
-      std::cout << "Patch[" << patch.getIndex() << "]=(" << patch.getSizeU0() << "," << patch.getSizeV0() << ")"
+      log << "Patch[" << patch.getIndex() << "]=(" << patch.getSizeU0() << "," << patch.getSizeV0() << ")"
                 << std::endl;
     }
   }
   for ( auto& patch : patches ) { occupancySizeU = (std::max)( occupancySizeU, patch.getSizeU0() + 1 ); }
-  width                             = occupancySizeU * params_.occupancyResolution_;
-  height                            = occupancySizeV * params_.occupancyResolution_;
-  size_t            maxOccupancyRow = 0;
-  std::vector<bool> occupancyMap;
+  width                            = occupancySizeU * params_.occupancyResolution_;
+  height                           = occupancySizeV * params_.occupancyResolution_;
+  size_t           maxOccupancyRow = 0;
+  PCCPackingCanvas occupancyMap;
   occupancyMap.resize( occupancySizeU * occupancySizeV, false );
   std::vector<int> horizon;
   horizon.resize( occupancySizeU, 0 );
@@ -1541,7 +1616,7 @@ void PCCEncoder::spatialConsistencyPackTetris( PCCFrameContext& frame,
           // Translate coordinates and mask them out.
           int xp = x + prevPatches[patch.getBestMatchIdx()].getU0();
           int yp = y + prevPatches[patch.getBestMatchIdx()].getV0();
-          if ( g_printDetailedInfo ) { std::cout << "Testing position (" << xp << ',' << yp << ')' << std::endl; }
+          if ( g_printDetailedInfo ) { log << "Testing position (" << xp << ',' << yp << ')' << std::endl; }
           if ( xp >= 0 && xp < occupancySizeU && yp >= 0 && yp < occupancySizeV ) {
             patch.setU0( xp );
             patch.setV0( yp );
@@ -1551,7 +1626,7 @@ void PCCEncoder::spatialConsistencyPackTetris( PCCFrameContext& frame,
               bestU         = xp;
               bestV         = yp;
               if ( g_printDetailedInfo ) {
-                std::cout << "Maintained orientation " << patch.getPatchOrientation() << " for matched patch "
+                log << "Maintained orientation " << patch.getPatchOrientation() << " for matched patch "
                           << patch.getIndex() << " in new position (" << xp << "," << yp << ")" << std::endl;
               }
             }
@@ -1578,7 +1653,7 @@ void PCCEncoder::spatialConsistencyPackTetris( PCCFrameContext& frame,
               if ( !patch.isPatchLocationAboveHorizon( horizon, topHorizon, bottomHorizon, rightHorizon,
                                                        leftHorizon ) ) {
                 if ( g_printDetailedInfo ) {
-                  std::cout << "(" << u << "," << v << "|" << patch.getPatchOrientation() << ") above horizon"
+                  log << "(" << u << "," << v << "|" << patch.getPatchOrientation() << ") above horizon"
                             << std::endl;
                 }
                 continue;
@@ -1609,16 +1684,16 @@ void PCCEncoder::spatialConsistencyPackTetris( PCCFrameContext& frame,
         patch.setV0( bestV );
         patch.setPatchOrientation( bestOrientation );
         if ( g_printDetailedInfo ) {
-          std::cout << "Selected position (" << bestU << "," << bestV << ") and orientation " << bestOrientation
+          log << "Selected position (" << bestU << "," << bestV << ") and orientation " << bestOrientation
                     << std::endl;
         }
         // update the horizon
         patch.updateHorizon( horizon, topHorizon, bottomHorizon, rightHorizon, leftHorizon );
         // debugging
         if ( g_printDetailedInfo ) {
-          std::cout << "New Horizon :[";
-          for ( int i = 0; i < occupancySizeU; i++ ) { std::cout << horizon[i] << ","; }
-          std::cout << "]" << std::endl;
+          log << "New Horizon :[";
+          for ( int i = 0; i < occupancySizeU; i++ ) { log << horizon[i] << ","; }
+          log << "]" << std::endl;
         }
       }
     }
@@ -1641,22 +1716,25 @@ void PCCEncoder::spatialConsistencyPackTetris( PCCFrameContext& frame,
       width           = (std::max)( width, ( patch.getU0() + patch.getSizeV0() ) * patch.getOccupancyResolution() );
       maxOccupancyRow = (std::max)( maxOccupancyRow, ( patch.getV0() + patch.getSizeU0() ) );
     }
-    if ( g_printDetailedInfo ) { printMapTetris( occupancyMap, occupancySizeU, occupancySizeV, horizon ); }
+    if ( g_printDetailedInfo ) { printMapTetris( occupancyMap, occupancySizeU, occupancySizeV, horizon, log ); }
   }
   if ( frame.getNumberOfRawPointsPatches() > 0 && !frame.getUseRawPointsSeparateVideo() ) {
-    packRawPointsPatch( frame, occupancyMap, width, height, occupancySizeU, occupancySizeV, maxOccupancyRow );
+    packRawPointsPatch( frame, occupancyMap, width, height, occupancySizeU, occupancySizeV, maxOccupancyRow, log );
   } else {
-    if ( g_printDetailedInfo ) { printMap( occupancyMap, occupancySizeU, occupancySizeV ); }
+    if ( g_printDetailedInfo ) { printMap( occupancyMap, occupancySizeU, occupancySizeV, log ); }
   }
   if ( params_.enhancedOccupancyMapCode_ && !frame.getUseRawPointsSeparateVideo() ) {
-    packEOMAttributePointsPatch( frame, occupancyMap, width, height, occupancySizeU, occupancySizeV, maxOccupancyRow );
+    packEOMAttributePointsPatch( frame, occupancyMap, width, height, occupancySizeU, occupancySizeV, maxOccupancyRow,
+                                 log );
   }
-  if ( g_printDetailedInfo ) { printMap( occupancyMap, occupancySizeU, occupancySizeV ); }
-  std::cout << "actualImageSize (spatialConsistencyPackTetris) " << width << " x " << height << std::endl;
+  if ( g_printDetailedInfo ) { printMap( occupancyMap, occupancySizeU, occupancySizeV, log ); }
+  log << "actualImageSize (spatialConsistencyPackTetris) " << width << " x " << height << std::endl;
 }
 
 // GTP - GLOBAL PATCH PACKING
-void PCCEncoder::findMatchesForGlobalTetrisPacking( PCCFrameContext& tile, PCCFrameContext& prevFrame ) {
+void PCCEncoder::findMatchesForGlobalTetrisPacking( PCCFrameContext& tile,
+                                                    PCCFrameContext& prevFrame,
+                                                    std::ostream&    log ) {
   auto& patches     = tile.getPatches();
   auto& prevPatches = prevFrame.getPatches();
   if ( patches.empty() ) { return; }
@@ -1666,7 +1744,7 @@ void PCCEncoder::findMatchesForGlobalTetrisPacking( PCCFrameContext& tile, PCCFr
     if ( g_printDetailedInfo ) {
       for ( int patchIdx = 0; patchIdx < patches.size(); patchIdx++ ) {
         auto& patch = patches[patchIdx];
-        std::cout << "Sorted Patch[" << patchIdx << "]->";
+        log << "Sorted Patch[" << patchIdx << "]->";
         patch.setU0( 0 );
         patch.setV0( 0 );
         patch.print();
@@ -1708,15 +1786,15 @@ void PCCEncoder::findMatchesForGlobalTetrisPacking( PCCFrameContext& tile, PCCFr
            ( ( area2 / area1 ) < params_.globalPackingStrategyThreshold_ ) ) {
         // this seems like an unlike mismatch, will break the chain here
         if ( g_printDetailedInfo ) {
-          std::cout << "Removing the match because areas are too different:" << std::endl;
-          std::cout << "elem.ID =" << curPatch.getIndex() << std::endl;
-          std::cout << "elem.sizeU0 =" << curPatch.getSizeU0() << std::endl;
-          std::cout << "elem.sizeV0 =" << curPatch.getSizeV0() << std::endl;
-          std::cout << "area =" << area1 << std::endl;
-          std::cout << "previous_elem.ID =" << patch.getIndex() << std::endl;
-          std::cout << "elem.sizeU0 =" << patch.getSizeU0() << std::endl;
-          std::cout << "elem.sizeV0 =" << patch.getSizeV0() << std::endl;
-          std::cout << "area =" << area2 << std::endl;
+          log << "Removing the match because areas are too different:" << std::endl;
+          log << "elem.ID =" << curPatch.getIndex() << std::endl;
+          log << "elem.sizeU0 =" << curPatch.getSizeU0() << std::endl;
+          log << "elem.sizeV0 =" << curPatch.getSizeV0() << std::endl;
+          log << "area =" << area1 << std::endl;
+          log << "previous_elem.ID =" << patch.getIndex() << std::endl;
+          log << "elem.sizeU0 =" << patch.getSizeU0() << std::endl;
+          log << "elem.sizeV0 =" << patch.getSizeV0() << std::endl;
+          log << "area =" << area2 << std::endl;
         }
       } else {
         // store the best match index
@@ -1736,11 +1814,11 @@ void PCCEncoder::findMatchesForGlobalTetrisPacking( PCCFrameContext& tile, PCCFr
     for ( int patchIdx = 0; patchIdx < patches.size(); patchIdx++ ) {
       auto& patch = patches[patchIdx];
       if ( patchIdx < tile.getNumMatchedPatches() ) {
-        std::cout << "Matched (refPatch[" << patches[patchIdx].getBestMatchIdx()
+        log << "Matched (refPatch[" << patches[patchIdx].getBestMatchIdx()
                   << "]=" << prevPatches[patches[patchIdx].getBestMatchIdx()].getIndex() << ") Patch[" << patchIdx
                   << "]->";
       } else {
-        std::cout << "Unmatched Patch[" << patchIdx << "]->";
+        log << "Unmatched Patch[" << patchIdx << "]->";
       }
       patch.setU0( 0 );
       patch.setV0( 0 );
@@ -2004,7 +2082,7 @@ void PCCEncoder::doGlobalTetrisPacking( PCCContext& context,
       }
       numOrientations = params_.packingStrategy_ == 0 ? 1 : ( params_.useEightOrientations_ ? 8 : 2 );
 
-      std::vector<bool> occupancyMap;
+      PCCPackingCanvas occupancyMap;
       occupancyMap.resize( occupancySizeU * occupancySizeV, false );
       int indNextMatchedPatch = 0;
       // patch loop
@@ -2327,12 +2405,72 @@ void PCCEncoder::doGlobalTetrisPacking( PCCContext& context,
   }
 }
 
+bool PCCEncoder::findPatchLocation( PCCPatch&                  patch,
+                                    const PCCPackingCanvas&    occupancyMap,
+                                    const std::vector<size_t>& orientations,
+                                    const size_t               sizeU,
+                                    const size_t               sizeV,
+                                    const size_t               occupancySizeU,
+                                    const size_t               occupancySizeV,
+                                    const int                  safeguard ) {
+  const bool precedence = params_.lowDelayEncoding_;
+  if ( precedence ) {
+    for ( const auto orientation : orientations ) { patch.updatePackingMask( orientation, safeguard ); }
+  }
+  occupancyMap.updateSummedArea( occupancySizeU );
+
+  // the candidates are ranked in the order of the raster scan: v, then u, then the orientation
+  const size_t        rowRankCount = sizeU * orientations.size();
+  const size_t        noRank       = (std::numeric_limits<size_t>::max)();
+  std::atomic<size_t> bestRank( noRank );
+  auto                searchRow = [&]( const size_t v ) {
+    for ( size_t u = 0; u < sizeU; ++u ) {
+      for ( size_t i = 0; i < orientations.size(); ++i ) {
+        if ( patch.checkFitPatchCanvas( occupancyMap, orientations[i], u, v, occupancySizeU, occupancySizeV, precedence,
+                                        safeguard ) ) {
+          const size_t rank    = v * rowRankCount + u * orientations.size() + i;
+          size_t       current = bestRank.load();
+          while ( rank < current && !bestRank.compare_exchange_weak( current, rank ) ) {}
+          return;
+        }
+      }
+    }
+  };
+#if defined( ENABLE_TBB )
+  const size_t threadCount =
+      params_.nbThread_ > 0 ? params_.nbThread_ : tbb::task_scheduler_init::default_num_threads();
+#else
+  const size_t threadCount = 1;
+#endif
+  if ( threadCount > 1 && sizeV > 1 ) {
+#if defined( ENABLE_TBB )
+    // the rows are handed out in increasing order, and the rows after the best candidate found so far are skipped
+    std::atomic<size_t> nextRow( 0 );
+    tbb::task_arena     limited( static_cast<int>( threadCount ) );
+    limited.execute( [&] {
+      tbb::parallel_for( size_t( 0 ), threadCount, [&]( const size_t ) {
+        for ( size_t v = nextRow++; v < sizeV && v * rowRankCount < bestRank.load(); v = nextRow++ ) { searchRow( v ); }
+      } );
+    } );
+#endif
+  } else {
+    for ( size_t v = 0; v < sizeV && bestRank.load() == noRank; ++v ) { searchRow( v ); }
+  }
+  const size_t rank = bestRank.load();
+  if ( rank == noRank ) { return false; }
+  patch.setPatchOrientation( orientations[rank % orientations.size()] );
+  patch.setU0( ( rank % rowRankCount ) / orientations.size() );
+  patch.setV0( rank / rowRankCount );
+  return true;
+}
+
 void PCCEncoder::packFlexible( PCCFrameContext& tile,
                                int              packingStrategy,
                                size_t           presetWidth,
                                size_t           presetHeight,
                                int              safeguard,
-                               bool             enablePointCloudPartitioning ) {
+                               bool             enablePointCloudPartitioning,
+                               std::ostream&    log ) {
   auto  width   = tile.getWidth();
   auto& height  = tile.getHeight();
   auto& patches = tile.getPatches();
@@ -2341,9 +2479,9 @@ void PCCEncoder::packFlexible( PCCFrameContext& tile,
   if ( patches.empty() ) {
     if ( tile.getNumberOfRawPointsPatches() == 0 ) { return; }
     if ( tile.getUseRawPointsSeparateVideo() ) { return; }
-    std::vector<bool> occupancyMap;
-    size_t            occupancySizeU = presetWidth / params_.occupancyResolution_;
-    size_t            occupancySizeV = presetHeight / params_.occupancyResolution_;
+    PCCPackingCanvas occupancyMap;
+    size_t           occupancySizeU = presetWidth / params_.occupancyResolution_;
+    size_t           occupancySizeV = presetHeight / params_.occupancyResolution_;
     if ( presetWidth == 0 || presetHeight == 0 ) {
       auto& rawPointsPatch = tile.getRawPointsPatch( 0 );
       auto  rawPointsPatchBlocks =
@@ -2355,25 +2493,25 @@ void PCCEncoder::packFlexible( PCCFrameContext& tile,
     }
     occupancyMap.resize( occupancySizeU * occupancySizeV );
     if ( tile.getNumberOfRawPointsPatches() > 0 && !tile.getUseRawPointsSeparateVideo() ) {
-      packRawPointsPatch( tile, occupancyMap, width, height, occupancySizeU, occupancySizeV, 0 );
+      packRawPointsPatch( tile, occupancyMap, width, height, occupancySizeU, occupancySizeV, 0, log );
     } else {
-      if ( g_printDetailedInfo ) { printMap( occupancyMap, occupancySizeU, occupancySizeV ); }
+      if ( g_printDetailedInfo ) { printMap( occupancyMap, occupancySizeU, occupancySizeV, log ); }
     }
     if ( params_.enhancedOccupancyMapCode_ && !tile.getUseRawPointsSeparateVideo() ) {
-      packEOMAttributePointsPatch( tile, occupancyMap, width, height, occupancySizeU, occupancySizeV, 0 );
+      packEOMAttributePointsPatch( tile, occupancyMap, width, height, occupancySizeU, occupancySizeV, 0, log );
     }
-    if ( g_printDetailedInfo ) { printMap( occupancyMap, occupancySizeU, occupancySizeV ); }
+    if ( g_printDetailedInfo ) { printMap( occupancyMap, occupancySizeU, occupancySizeV, log ); }
     bool emptyTile = false;
     if ( height == 0 ) {
       emptyTile = true;
       height    = 64;
     }
-    std::cout << "frame " << tile.getFrameIndex() << " tile " << tile.getTileIndex()
+    log << "frame " << tile.getFrameIndex() << " tile " << tile.getTileIndex()
               << " packFlexible(patchEmpty): actualImageSize " << width << " x " << height;
     if ( emptyTile )
-      std::cout << " height adjusted" << std::endl;
+      log << " height adjusted" << std::endl;
     else
-      std::cout << std::endl;
+      log << std::endl;
     return;
   }
   // sorting by patch largest dimension
@@ -2383,9 +2521,9 @@ void PCCEncoder::packFlexible( PCCFrameContext& tile,
     std::sort( patches.begin(), patches.end(), []( PCCPatch& a, PCCPatch& b ) { return a.gt( b ); } );
   }
   if ( g_printDetailedInfo ) {
-    std::cout << "Patch order:" << std::endl;
+    log << "Patch order:" << std::endl;
     for ( auto& patch : patches ) {
-      std::cout << "Patch[" << patch.getIndex() << "]=(" << patch.getSizeU0() << "," << patch.getSizeV0() << ")"
+      log << "Patch[" << patch.getIndex() << "]=(" << patch.getSizeU0() << "," << patch.getSizeV0() << ")"
                 << std::endl;
     }
   }
@@ -2398,43 +2536,34 @@ void PCCEncoder::packFlexible( PCCFrameContext& tile,
   int tileWidth   = occupancySizeU / numTilesHor;
   int tileHeight  = int( tileWidth * params_.tileHeightToWidthRatio_ );
   if ( params_.enablePointCloudPartitioning_ )
-    std::cout << "frame " << tile.getFrameIndex() << " tilesize: " << tileWidth << "x" << tileHeight << std::endl;
-  occupancySizeV                    = ( occupancySizeV >= tileHeight ) ? occupancySizeV : tileHeight;
-  height                            = occupancySizeV * params_.occupancyResolution_;
-  size_t            maxOccupancyRow = 0;
-  std::vector<bool> occupancyMap;
-  int               numOrientations = ( packingStrategy == 0 ) ? 1 : ( params_.useEightOrientations_ ? 8 : 2 );
+    log << "frame " << tile.getFrameIndex() << " tilesize: " << tileWidth << "x" << tileHeight << std::endl;
+  occupancySizeV                   = ( occupancySizeV >= tileHeight ) ? occupancySizeV : tileHeight;
+  height                           = occupancySizeV * params_.occupancyResolution_;
+  size_t           maxOccupancyRow = 0;
+  PCCPackingCanvas occupancyMap;
+  int              numOrientations = ( packingStrategy == 0 ) ? 1 : ( params_.useEightOrientations_ ? 8 : 2 );
   occupancyMap.resize( occupancySizeU * occupancySizeV, false );
   for ( auto& patch : patches ) {
     assert( patch.getSizeU0() <= occupancySizeU );
     assert( patch.getSizeV0() <= occupancySizeV );
-    bool  locationFound = false;
-    auto& occupancy     = patch.getOccupancy();
+    bool                locationFound = false;
+    auto&               occupancy     = patch.getOccupancy();
+    std::vector<size_t> orientations;
+    for ( size_t orientationIdx = 0; orientationIdx < numOrientations; orientationIdx++ ) {
+      if ( packingStrategy == 0 ) {
+        orientations.push_back( PATCH_ORIENTATION_DEFAULT );
+      } else if ( patch.getSizeU0() > patch.getSizeV0() ) {
+        orientations.push_back( g_orientationHorizontal[orientationIdx] );
+      } else {
+        orientations.push_back( g_orientationVertical[orientationIdx] );
+      }
+    }
     while ( !locationFound ) {
-      for ( size_t v = 0; v < occupancySizeV && !locationFound; ++v ) {
-        for ( size_t u = 0; u < occupancySizeU && !locationFound; ++u ) {
-          patch.setU0( u );
-          patch.setV0( v );
-          for ( size_t orientationIdx = 0; orientationIdx < numOrientations && !locationFound; orientationIdx++ ) {
-            if ( packingStrategy == 0 )
-              patch.setPatchOrientation( PATCH_ORIENTATION_DEFAULT );
-            else {
-              if ( patch.getSizeU0() > patch.getSizeV0() ) {
-                patch.setPatchOrientation( g_orientationHorizontal[orientationIdx] );
-              } else {
-                patch.setPatchOrientation( g_orientationVertical[orientationIdx] );
-              }
-            }
-            if ( patch.checkFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV, params_.lowDelayEncoding_,
-                                            safeguard ) ) {
-              locationFound = true;
-              if ( g_printDetailedInfo ) {
-                std::cout << "Orientation " << patch.getPatchOrientation() << " selected for patch " << patch.getIndex()
-                          << " (" << u << "," << v << ")" << std::endl;
-              }
-            }
-          }
-        }
+      locationFound = findPatchLocation( patch, occupancyMap, orientations, occupancySizeU, occupancySizeV,
+                                         occupancySizeU, occupancySizeV, safeguard );
+      if ( locationFound && g_printDetailedInfo ) {
+        log << "Orientation " << patch.getPatchOrientation() << " selected for patch " << patch.getIndex() << " ("
+                  << patch.getU0() << "," << patch.getV0() << ")" << std::endl;
       }
       if ( !locationFound ) {
         occupancySizeV *= 2;
@@ -2460,15 +2589,16 @@ void PCCEncoder::packFlexible( PCCFrameContext& tile,
     }
   }
   if ( tile.getNumberOfRawPointsPatches() > 0 && !tile.getUseRawPointsSeparateVideo() ) {
-    packRawPointsPatch( tile, occupancyMap, width, height, occupancySizeU, occupancySizeV, maxOccupancyRow );
+    packRawPointsPatch( tile, occupancyMap, width, height, occupancySizeU, occupancySizeV, maxOccupancyRow, log );
   } else {
-    if ( g_printDetailedInfo ) { printMap( occupancyMap, occupancySizeU, occupancySizeV ); }
+    if ( g_printDetailedInfo ) { printMap( occupancyMap, occupancySizeU, occupancySizeV, log ); }
   }
   if ( params_.enhancedOccupancyMapCode_ && !tile.getUseRawPointsSeparateVideo() ) {
-    packEOMAttributePointsPatch( tile, occupancyMap, width, height, occupancySizeU, occupancySizeV, maxOccupancyRow );
+    packEOMAttributePointsPatch( tile, occupancyMap, width, height, occupancySizeU, occupancySizeV, maxOccupancyRow,
+                                 log );
   }
-  if ( g_printDetailedInfo ) { printMap( occupancyMap, occupancySizeU, occupancySizeV ); }
-  std::cout << "frame " << tile.getFrameIndex() << " tile " << tile.getTileIndex() << " packFlexible: actualImageSize "
+  if ( g_printDetailedInfo ) { printMap( occupancyMap, occupancySizeU, occupancySizeV, log ); }
+  log << "frame " << tile.getFrameIndex() << " tile " << tile.getTileIndex() << " packFlexible: actualImageSize "
             << width << " x " << height << std::endl;
 }
 
@@ -2492,11 +2622,11 @@ void PCCEncoder::packMultipleTiles( PCCAtlasFrameContext& atlasFrame, int safegu
   int tileHeight = int( tileWidth * params_.tileHeightToWidthRatio_ );
   if ( params_.enablePointCloudPartitioning_ )
     std::cout << "frame " << frame.getFrameIndex() << " tilesize: " << tileWidth << "x" << tileHeight << std::endl;
-  occupancySizeV                    = ( occupancySizeV >= tileHeight ) ? occupancySizeV : tileHeight;
-  width                             = occupancySizeU * params_.occupancyResolution_;
-  height                            = occupancySizeV * params_.occupancyResolution_;
-  size_t            maxOccupancyRow = 0;
-  std::vector<bool> occupancyMap;
+  occupancySizeV                   = ( occupancySizeV >= tileHeight ) ? occupancySizeV : tileHeight;
+  width                            = occupancySizeU * params_.occupancyResolution_;
+  height                           = occupancySizeV * params_.occupancyResolution_;
+  size_t           maxOccupancyRow = 0;
+  PCCPackingCanvas occupancyMap;
   occupancyMap.resize( occupancySizeU * occupancySizeV, false );
   std::vector<Tile> tilesNotAvailable;  // set of all tiles occupied by prev ROIs of current ROI
   int               lastOccupiedTileIndex          = -1;
@@ -2617,11 +2747,11 @@ void PCCEncoder::packFlexibleMultipleTiles( PCCAtlasFrameContext& atlasFrame, in
 
   // initializating the tile map to -1 (not assigned)
   partitionToTileMap.resize( numTilesHor * numTilesVer, -1 );
-  width                             = occupancySizeU * params_.occupancyResolution_;
-  height                            = occupancySizeV * params_.occupancyResolution_;
-  size_t            maxOccupancyRow = 0;
-  std::vector<bool> occupancyMap;
-  int               numOrientations = params_.useEightOrientations_ ? 8 : 2;
+  width                            = occupancySizeU * params_.occupancyResolution_;
+  height                           = occupancySizeV * params_.occupancyResolution_;
+  size_t           maxOccupancyRow = 0;
+  PCCPackingCanvas occupancyMap;
+  int              numOrientations = params_.useEightOrientations_ ? 8 : 2;
   occupancyMap.resize( occupancySizeU * occupancySizeV, false );
   std::vector<Tile> tilesNotAvailable;
   int               lastOccupiedTileIndex          = -1;
@@ -2833,11 +2963,11 @@ void PCCEncoder::spatialConsistencyPackMultipleTiles( PCCAtlasFrameContext& atla
   int tileHeight  = int( tileWidth * params_.tileHeightToWidthRatio_ );
   if ( params_.enablePointCloudPartitioning_ )
     std::cout << "frame " << frame.getFrameIndex() << " tilesize: " << tileWidth << "x" << tileHeight << std::endl;
-  occupancySizeV                    = ( occupancySizeV >= tileHeight ) ? occupancySizeV : tileHeight;
-  width                             = occupancySizeU * params_.occupancyResolution_;
-  height                            = occupancySizeV * params_.occupancyResolution_;
-  size_t            maxOccupancyRow = 0;
-  std::vector<bool> occupancyMap;
+  occupancySizeV                   = ( occupancySizeV >= tileHeight ) ? occupancySizeV : tileHeight;
+  width                            = occupancySizeU * params_.occupancyResolution_;
+  height                           = occupancySizeV * params_.occupancyResolution_;
+  size_t           maxOccupancyRow = 0;
+  PCCPackingCanvas occupancyMap;
   occupancyMap.resize( occupancySizeU * occupancySizeV, false );
   std::vector<Tile> tilesNotAvailable;
   int               numROIs                        = params_.numROIs_;
@@ -3007,11 +3137,11 @@ void PCCEncoder::spatialConsistencyPackFlexibleMultipleTiles( PCCAtlasFrameConte
   int numTilesVer = occupancySizeV / tileHeight;
   // initializating the tile map to -1 (not assigned)
   partitionToTileMap.resize( numTilesHor * numTilesVer, -1 );
-  width                             = occupancySizeU * params_.occupancyResolution_;
-  height                            = occupancySizeV * params_.occupancyResolution_;
-  size_t            maxOccupancyRow = 0;
-  int               numOrientations = params_.useEightOrientations_ ? 8 : 2;
-  std::vector<bool> occupancyMap;
+  width                            = occupancySizeU * params_.occupancyResolution_;
+  height                           = occupancySizeV * params_.occupancyResolution_;
+  size_t           maxOccupancyRow = 0;
+  int              numOrientations = params_.useEightOrientations_ ? 8 : 2;
+  PCCPackingCanvas occupancyMap;
   occupancyMap.resize( occupancySizeU * occupancySizeV, false );
   // loop over ROIs
   for ( size_t roiIndex = 0; roiIndex < numROIs; ++roiIndex ) {
@@ -3227,7 +3357,11 @@ void PCCEncoder::spatialConsistencyPackFlexibleMultipleTiles( PCCAtlasFrameConte
             << std::endl;
 }
 
-void PCCEncoder::packTetris( PCCFrameContext& frame, size_t presetWidth, size_t presetHeight, int safeguard ) {
+void PCCEncoder::packTetris( PCCFrameContext& frame,
+                             size_t           presetWidth,
+                             size_t           presetHeight,
+                             int              safeguard,
+                             std::ostream&    log ) {
   auto& width   = frame.getWidth();
   auto& height  = frame.getHeight();
   auto& patches = frame.getPatches();
@@ -3237,26 +3371,26 @@ void PCCEncoder::packTetris( PCCFrameContext& frame, size_t presetWidth, size_t
   // sorting by patch largest dimension
   std::sort( patches.begin(), patches.end(), []( PCCPatch& a, PCCPatch& b ) { return a.gt( b ); } );
   if ( g_printDetailedInfo ) {
-    std::cout << "Patch order:" << std::endl;
+    log << "Patch order:" << std::endl;
     for ( auto& patch : patches ) {
-      std::cout << "Patch[" << patch.getIndex() << "]=(" << patch.getSizeU0() << "," << patch.getSizeV0() << ")"
+      log << "Patch[" << patch.getIndex() << "]=(" << patch.getSizeU0() << "," << patch.getSizeV0() << ")"
                 << std::endl;
     }
   }
   size_t occupancySizeU = presetWidth / params_.occupancyResolution_;
   size_t occupancySizeV = (std::max)( patches[0].getSizeV0(), patches[0].getSizeU0() );
   for ( auto& patch : patches ) { occupancySizeU = (std::max)( occupancySizeU, patch.getSizeU0() + 1 ); }
-  width                             = occupancySizeU * params_.occupancyResolution_;
-  height                            = occupancySizeV * params_.occupancyResolution_;
-  size_t            maxOccupancyRow = 0;
-  std::vector<bool> occupancyMap;
+  width                            = occupancySizeU * params_.occupancyResolution_;
+  height                           = occupancySizeV * params_.occupancyResolution_;
+  size_t           maxOccupancyRow = 0;
+  PCCPackingCanvas occupancyMap;
   occupancyMap.resize( occupancySizeU * occupancySizeV, false );
   std::vector<int> horizon;
   horizon.resize( occupancySizeU, 0 );
   if ( g_printDetailedInfo ) {
-    std::cout << "Horizon :[";
-    for ( int i = 0; i < occupancySizeU; i++ ) { std::cout << horizon[i] << ","; }
-    std::cout << "]" << std::endl;
+    log << "Horizon :[";
+    for ( int i = 0; i < occupancySizeU; i++ ) { log << horizon[i] << ","; }
+    log << "]" << std::endl;
   }
   for ( auto& patch : patches ) {
     assert( patch.getSizeU0() <= occupancySizeU );
@@ -3285,20 +3419,20 @@ void PCCEncoder::packTetris( PCCFrameContext& frame, size_t presetWidth, size_t
             patch.setPatchOrientation( g_orientationVertical[orientationIdx] );
             if ( !patch.isPatchLocationAboveHorizon( horizon, topHorizon, bottomHorizon, rightHorizon, leftHorizon ) ) {
               if ( g_printDetailedInfo ) {
-                std::cout << "(" << u << "," << v << "|" << patch.getPatchOrientation() << ") above horizon"
+                log << "(" << u << "," << v << "|" << patch.getPatchOrientation() << ") above horizon"
                           << std::endl;
               }
               continue;
             }
             if ( g_printDetailedInfo ) {
-              std::cout << "(" << u << "," << v << "|" << patch.getPatchOrientation() << ")" << std::endl;
+              log << "(" << u << "," << v << "|" << patch.getPatchOrientation() << ")" << std::endl;
             }
             if ( patch.checkFitPatchCanvas( occupancyMap, occupancySizeU, occupancySizeV, params_.lowDelayEncoding_,
                                             safeguard ) ) {
               // now calculate the wasted space
               int wasted_space =
                   patch.calculateWastedSpace( horizon, topHorizon, bottomHorizon, rightHorizon, leftHorizon );
-              if ( g_printDetailedInfo ) { std::cout << "(wasted space) = " << wasted_space << std::endl; }
+              if ( g_printDetailedInfo ) { log << "(wasted space) = " << wasted_space << std::endl; }
               if ( wasted_space < best_wasted_space ) {
                 best_wasted_space = wasted_space;
                 bestU             = u;
@@ -3314,7 +3448,7 @@ void PCCEncoder::packTetris( PCCFrameContext& frame, size_t presetWidth, size_t
         occupancySizeV *= 2;
         occupancyMap.resize( occupancySizeU * occupancySizeV );
         if ( g_printDetailedInfo ) {
-          std::cout << "Increasing frame size (" << occupancySizeU << "," << occupancySizeV << ")" << std::endl;
+          log << "Increasing frame size (" << occupancySizeU << "," << occupancySizeV << ")" << std::endl;
         }
       } else {
         // select the best position and orientation
@@ -3322,16 +3456,16 @@ void PCCEncoder::packTetris( PCCFrameContext& frame, size_t presetWidth, size_t
         patch.setV0( bestV );
         patch.setPatchOrientation( bestOrientation );
         if ( g_printDetailedInfo ) {
-          std::cout << "Selected position (" << bestU << "," << bestV << ") and orientation " << bestOrientation
+          log << "Selected position (" << bestU << "," << bestV << ") and orientation " << bestOrientation
                     << "(wasted space=" << best_wasted_space << ")" << std::endl;
         }
         // update the horizon
         patch.updateHorizon( horizon, topHorizon, bottomHorizon, rightHorizon, leftHorizon );
         // debugging
         if ( g_printDetailedInfo ) {
-          std::cout << "Horizon :[";
-          for ( int i = 0; i < occupancySizeU; i++ ) { std::cout << horizon[i] << ","; }
-          std::cout << "]" << std::endl;
+          log << "Horizon :[";
+          for ( int i = 0; i < occupancySizeU; i++ ) { log << horizon[i] << ","; }
+          log << "]" << std::endl;
         }
       }
     }
@@ -3354,27 +3488,29 @@ void PCCEncoder::packTetris( PCCFrameContext& frame, size_t presetWidth, size_t
       width           = (std::max)( width, ( patch.getU0() + patch.getSizeV0() ) * patch.getOccupancyResolution() );
       maxOccupancyRow = (std::max)( maxOccupancyRow, ( patch.getV0() + patch.getSizeU0() ) );
     }
-    if ( g_printDetailedInfo ) { printMapTetris( occupancyMap, occupancySizeU, occupancySizeV, horizon ); }
+    if ( g_printDetailedInfo ) { printMapTetris( occupancyMap, occupancySizeU, occupancySizeV, horizon, log ); }
   }
   if ( frame.getNumberOfRawPointsPatches() > 0 ) {
-    packRawPointsPatch( frame, occupancyMap, width, height, occupancySizeU, occupancySizeV, maxOccupancyRow );
+    packRawPointsPatch( frame, occupancyMap, width, height, occupancySizeU, occupancySizeV, maxOccupancyRow, log );
   } else {
-    if ( g_printDetailedInfo ) { printMap( occupancyMap, occupancySizeU, occupancySizeV ); }
+    if ( g_printDetailedInfo ) { printMap( occupancyMap, occupancySizeU, occupancySizeV, log ); }
   }
   if ( params_.enhancedOccupancyMapCode_ && !frame.getUseRawPointsSeparateVideo() ) {
-    packEOMAttributePointsPatch( frame, occupancyMap, width, height, occupancySizeU, occupancySizeV, maxOccupancyRow );
+    packEOMAttributePointsPatch( frame, occupancyMap, width, height, occupancySizeU, occupancySizeV, maxOccupancyRow,
+                                 log );
   }
-  if ( g_printDetailedInfo ) { printMap( occupancyMap, occupancySizeU, occupancySizeV ); }
-  std::cout << "actualImageSize(packTetris) " << width << " x " << height << std::endl;
+  if ( g_printDetailedInfo ) { printMap( occupancyMap, occupancySizeU, occupancySizeV, log ); }
+  log << "actualImageSize(packTetris) " << width << " x " << height << std::endl;
 }
 
-void PCCEncoder::packEOMAttributePointsPatch( PCCFrameContext&   frame,
-                                              std::vector<bool>& occupancyMap,
-                                              size_t             width,
-                                              size_t&            height,
-                                              size_t             occupancySizeU,
-                                              size_t             occupancySizeV,
-                                              size_t             maxOccupancyRow ) {
+void PCCEncoder::packEOMAttributePointsPatch( PCCFrameContext&  frame,
+                                              PCCPackingCanvas& occupancyMap,
+                                              size_t            width,
+                                              size_t&           height,
+                                              size_t            occupancySizeU,
+                                              size_t            occupancySizeV,
+                                              size_t            maxOccupancyRow,
+                                              std::ostream&     log ) {
   if ( !params_.useRawPointsSeparateVideo_ ) { assert( width == frame.getWidth() ); }
   auto&  eomPatches = frame.getEomPatches();
   size_t lastHeight = height;
@@ -3388,12 +3524,10 @@ void PCCEncoder::packEOMAttributePointsPatch( PCCFrameContext&   frame,
     eomPatches[i].v0_                = lastHeight / params_.occupancyResolution_;
     eomPatches[i].sizeU_             = occupancySizeU;
     eomPatches[i].sizeV_             = eomPointsPatchBlocksV;
-    printf(
-        "packEOMAttributePointsPatch %zu frame\t%zu tile\t [%zu/%zu] eompatch: pos %zu,%zu(block) "
-        "size(%zux%zu)(block), "
-        "#EOMBlock:%zu #EOM:%zu\n",
-        frame.getFrameIndex(), frame.getTileIndex(), i, eomPatches.size(), eomPatches[i].u0_, eomPatches[i].v0_,
-        eomPatches[i].sizeU_, eomPatches[i].sizeV_, eomPointsPatchBlocks, eomPatches[i].eomCount_ );
+    log << "packEOMAttributePointsPatch " << frame.getFrameIndex() << " frame\t" << frame.getTileIndex() << " tile\t ["
+        << i << "/" << eomPatches.size() << "] eompatch: pos " << eomPatches[i].u0_ << "," << eomPatches[i].v0_
+        << "(block) size(" << eomPatches[i].sizeU_ << "x" << eomPatches[i].sizeV_
+        << ")(block), #EOMBlock:" << eomPointsPatchBlocks << " #EOM:" << eomPatches[i].eomCount_ << std::endl;
     lastHeight += eomPatches[i].sizeV_ * params_.occupancyResolution_;
   }
   occupancyMap.resize( occupancySizeU * occupancySizeV );
@@ -3444,13 +3578,14 @@ size_t PCCEncoder::packRawPointsPatchSimple( PCCFrameContext& tile,
   return totalHeight;
 }
 
-size_t PCCEncoder::packRawPointsPatch( PCCFrameContext&   tile,
-                                       std::vector<bool>& occupancyMap,
-                                       size_t             width,
-                                       size_t&            height,
-                                       size_t             occupancySizeU,
-                                       size_t             occupancySizeV,
-                                       size_t             maxOccupancyRow ) {
+size_t PCCEncoder::packRawPointsPatch( PCCFrameContext&  tile,
+                                       PCCPackingCanvas& occupancyMap,
+                                       size_t            width,
+                                       size_t&           height,
+                                       size_t            occupancySizeU,
+                                       size_t            occupancySizeV,
+                                       size_t            maxOccupancyRow,
+                                       std::ostream&     log ) {
   size_t numberOfRawPointsPatches = tile.getNumberOfRawPointsPatches();
   size_t safeguard                = 0;
   for ( int i = 0; i < numberOfRawPointsPatches; i++ ) {
@@ -3524,9 +3659,9 @@ size_t PCCEncoder::packRawPointsPatch( PCCFrameContext&   tile,
       }
       height = (std::max)( height, ( patch.getV0() + patch.getSizeV0() ) * params_.occupancyResolution_ );
     }
-    printf( "packRawPointsPatch[%d/%zu]: posU0V0 %zu,%zu sizeU0V0(%zux%zu) #ofpixels %zu\n", i,
-            numberOfRawPointsPatches, rawPointsPatch.u0_, rawPointsPatch.v0_, rawPointsPatch.sizeU0_,
-            rawPointsPatch.sizeV0_, rawPointsPatch.getNumberOfRawPoints() * 3 );
+    log << "packRawPointsPatch[" << i << "/" << numberOfRawPointsPatches << "]: posU0V0 " << rawPointsPatch.u0_ << ","
+        << rawPointsPatch.v0_ << " sizeU0V0(" << rawPointsPatch.sizeU0_ << "x" << rawPointsPatch.sizeV0_
+        << ") #ofpixels " << rawPointsPatch.getNumberOfRawPoints() * 3 << std::endl;
   }
   return height;
 }
@@ -3664,6 +3799,7 @@ bool PCCEncoder::generateSegments( const PCCPointSet3&                 source,
     patches.reserve( 256 );
     PCCPatchSegmenter3 segmenter;
     segmenter.setNbThread( params_.nbThread_ );
+    segmenter.setNNSearchEngine( params_.nnSearchEngine_ );
     segmenter.compute( source, frame.getFrameIndex(), segmenterParams, patches, frame.getSrcPointCloudByPatch(),
                        distanceSrcRec );
   } else {
@@ -3682,6 +3818,8 @@ bool PCCEncoder::generateSegments( const PCCPointSet3&                 source,
   if ( params_.enhancedOccupancyMapCode_ ) { generateEomPatch( source, frame ); }
   if ( params_.pointLocalReconstruction_ ) {
     for ( auto& patch : frame.getPatches() ) { patch.setOriginalIndex( patch.getIndex() ); }
+  } else {
+    frame.clearSrcPointCloudByPatch();
   }
   return true;
 }
@@ -3715,20 +3853,32 @@ bool PCCEncoder::generateOccupancyMap( PCCContext& context, bool copyToFrame ) {
     entireFrame.getOccupancyMap().resize( entireFrame.getWidth() * entireFrame.getHeight(), 0 );
     printf( "generateOccupancyMap frame %zu: entireFrameSize:%zux%zu\n", entireFrame.getFrameIndex(),
             entireFrame.getWidth(), entireFrame.getHeight() );
+    // the tiles cover disjoint areas of the frame: their occupancy maps are generated concurrently
+#if defined( ENABLE_TBB )
+    tbb::task_arena limited( static_cast<int>( params_.nbThread_ ) );
+    limited.execute( [&] {
+      tbb::parallel_for( size_t( 0 ), frame.getNumTilesInAtlasFrame(), [&]( const size_t ti ) {
+#else
     for ( size_t ti = 0; ti < frame.getNumTilesInAtlasFrame(); ti++ ) {
-      auto& tile = frame.getTile( ti );
-      generateOccupancyMap( tile );
-      if ( params_.enhancedOccupancyMapCode_ ) { modifyOccupancyMapEOM( tile ); }
-      if ( copyToFrame ) {
-        for ( size_t y = 0; y < tile.getHeight(); y++ ) {
-          for ( size_t x = 0; x < tile.getWidth(); x++ ) {
-            entireFrame.getOccupancyMap()[( y + tile.getLeftTopYInFrame() ) * entireFrame.getWidth() +
-                                          ( x + tile.getLeftTopXInFrame() )] =
-                frame.getTile( ti ).getOccupancyMap()[y * tile.getWidth() + x];
+#endif
+        auto& tile = frame.getTile( ti );
+        generateOccupancyMap( tile );
+        if ( params_.enhancedOccupancyMapCode_ ) { modifyOccupancyMapEOM( tile ); }
+        if ( copyToFrame ) {
+          for ( size_t y = 0; y < tile.getHeight(); y++ ) {
+            for ( size_t x = 0; x < tile.getWidth(); x++ ) {
+              entireFrame.getOccupancyMap()[( y + tile.getLeftTopYInFrame() ) * entireFrame.getWidth() +
+                                            ( x + tile.getLeftTopXInFrame() )] =
+                  frame.getTile( ti ).getOccupancyMap()[y * tile.getWidth() + x];
+            }
           }
         }
-      }
+#if defined( ENABLE_TBB )
+      } );
+    } );
+#else
     }
+#endif
     if ( !params_.absoluteD1_ || !params_.absoluteT1_ ) {
       frame.getTitleFrameContext().getFullOccupancyMap() = frame.getTitleFrameContext().getOccupancyMap();
     }
@@ -3903,64 +4053,76 @@ void PCCEncoder::generateIntraImage( PCCAtlasFrameContext& atlasFrame,
                                      PCCImageGeometry&     image ) {
   image.resize( atlasFrame.getAtlasFrameWidth(), atlasFrame.getAtlasFrameHeight(), PCCCOLORFORMAT::YUV444 );
   image.set( 0 );
+  // the tiles cover disjoint areas of the image: they are written concurrently
+#if defined( ENABLE_TBB )
+  tbb::task_arena limited( static_cast<int>( params_.nbThread_ ) );
+  limited.execute( [&] {
+    tbb::parallel_for( size_t( 0 ), atlasFrame.getNumTilesInAtlasFrame(), [&]( const size_t ti ) {
+#else
   for ( size_t ti = 0; ti < atlasFrame.getNumTilesInAtlasFrame(); ti++ ) {
-    auto&  tile     = atlasFrame.getTile( ti );
-    auto   width    = tile.getWidth();
-    auto   height   = tile.getHeight();
-    size_t maxDepth = 0;
-    for ( auto& patch : tile.getPatches() ) {
-      for ( size_t v = 0; v < patch.getSizeV(); ++v ) {
-        for ( size_t u = 0; u < patch.getSizeU(); ++u ) {
-          const size_t  p = v * patch.getSizeU() + u;
-          const int16_t d = patch.getDepth( mapIndex, p );
-          if ( d < g_infiniteDepth ) {
-            size_t x;
-            size_t y;
-            patch.patch2Canvas( u, v, width, height, x, y );
-            assert( x < width && y < height );
-            image.setValue( 0, x + tile.getLeftTopXInFrame(), y + tile.getLeftTopYInFrame(), uint16_t( d ) );
-            maxDepth = (std::max)( maxDepth, (size_t)d );
+#endif
+      auto&  tile     = atlasFrame.getTile( ti );
+      auto   width    = tile.getWidth();
+      auto   height   = tile.getHeight();
+      size_t maxDepth = 0;
+      for ( auto& patch : tile.getPatches() ) {
+        for ( size_t v = 0; v < patch.getSizeV(); ++v ) {
+          for ( size_t u = 0; u < patch.getSizeU(); ++u ) {
+            const size_t  p = v * patch.getSizeU() + u;
+            const int16_t d = patch.getDepth( mapIndex, p );
+            if ( d < g_infiniteDepth ) {
+              size_t x;
+              size_t y;
+              patch.patch2Canvas( u, v, width, height, x, y );
+              assert( x < width && y < height );
+              image.setValue( 0, x + tile.getLeftTopXInFrame(), y + tile.getLeftTopYInFrame(), uint16_t( d ) );
+              maxDepth = (std::max)( maxDepth, (size_t)d );
+            }
           }
         }
       }
-    }
-    if ( maxDepth >= ( size_t( 1 ) << tile.getGeometry2dBitdepth() ) ) {
-      std::cout << "Error: maxDepth(" << maxDepth << ") >=" << ( 1 << tile.getGeometry2dBitdepth() ) << std::endl;
-      exit( -1 );
-    }
-    if ( !tile.getUseRawPointsSeparateVideo() ) {
-      size_t numberOfRawPointsPatches = tile.getNumberOfRawPointsPatches();
-      for ( int i = 0; i < numberOfRawPointsPatches; i++ ) {
-        auto&        rawPointsPatch = tile.getRawPointsPatch( i );
-        const size_t v0             = rawPointsPatch.v0_ * rawPointsPatch.occupancyResolution_;
-        const size_t u0             = rawPointsPatch.u0_ * rawPointsPatch.occupancyResolution_;
-        if ( rawPointsPatch.getNumberOfRawPoints() != 0u ) {
-          for ( size_t v = 0; v < rawPointsPatch.sizeV_; ++v ) {
-            for ( size_t u = 0; u < rawPointsPatch.sizeU_; ++u ) {
-              const size_t p = v * rawPointsPatch.sizeU_ + u;
-              if ( p < rawPointsPatch.getNumberOfRawPoints() * 3 ) {
-                assert( rawPointsPatch.x_[p] < g_infiniteDepth );
-                if ( rawPointsPatch.x_[p] >= g_infiniteDepth ) {
-                  printf( "(rawPointsPatch.x_[%zu] >=g_infiniteDepth)\n", p );
-                  exit( 126 );
+      if ( maxDepth >= ( size_t( 1 ) << tile.getGeometry2dBitdepth() ) ) {
+        std::cout << "Error: maxDepth(" << maxDepth << ") >=" << ( 1 << tile.getGeometry2dBitdepth() ) << std::endl;
+        exit( -1 );
+      }
+      if ( !tile.getUseRawPointsSeparateVideo() ) {
+        size_t numberOfRawPointsPatches = tile.getNumberOfRawPointsPatches();
+        for ( int i = 0; i < numberOfRawPointsPatches; i++ ) {
+          auto&        rawPointsPatch = tile.getRawPointsPatch( i );
+          const size_t v0             = rawPointsPatch.v0_ * rawPointsPatch.occupancyResolution_;
+          const size_t u0             = rawPointsPatch.u0_ * rawPointsPatch.occupancyResolution_;
+          if ( rawPointsPatch.getNumberOfRawPoints() != 0u ) {
+            for ( size_t v = 0; v < rawPointsPatch.sizeV_; ++v ) {
+              for ( size_t u = 0; u < rawPointsPatch.sizeU_; ++u ) {
+                const size_t p = v * rawPointsPatch.sizeU_ + u;
+                if ( p < rawPointsPatch.getNumberOfRawPoints() * 3 ) {
+                  assert( rawPointsPatch.x_[p] < g_infiniteDepth );
+                  if ( rawPointsPatch.x_[p] >= g_infiniteDepth ) {
+                    printf( "(rawPointsPatch.x_[%zu] >=g_infiniteDepth)\n", p );
+                    exit( 126 );
+                  }
+                  const size_t x = ( u0 + u );
+                  const size_t y = ( v0 + v );
+                  assert( x < width && y < height );
+                  image.setValue( 0, x + tile.getLeftTopXInFrame(), y + tile.getLeftTopYInFrame(),
+                                  uint16_t( rawPointsPatch.x_[p] ) );
+                } else {
+                  const size_t x = ( u0 + u );
+                  const size_t y = ( v0 + v );
+                  image.setValue( 0, x + tile.getLeftTopXInFrame(), y + tile.getLeftTopYInFrame(),
+                                  uint16_t( rawPointsPatch.x_[rawPointsPatch.getNumberOfRawPoints() * 3 - 1] ) );
                 }
-                const size_t x = ( u0 + u );
-                const size_t y = ( v0 + v );
-                assert( x < width && y < height );
-                image.setValue( 0, x + tile.getLeftTopXInFrame(), y + tile.getLeftTopYInFrame(),
-                                uint16_t( rawPointsPatch.x_[p] ) );
-              } else {
-                const size_t x = ( u0 + u );
-                const size_t y = ( v0 + v );
-                image.setValue( 0, x + tile.getLeftTopXInFrame(), y + tile.getLeftTopYInFrame(),
-                                uint16_t( rawPointsPatch.x_[rawPointsPatch.getNumberOfRawPoints() * 3 - 1] ) );
               }
             }
           }
         }
       }
-    }
+#if defined( ENABLE_TBB )
+    } );
+  } );
+#else
   }  // tile
+#endif
 }
 
 bool PCCEncoder::predictAttributeFrame( PCCFrameContext&         frame,
@@ -4217,8 +4379,8 @@ void PCCEncoder::generateRawPointsPatch( const PCCPointSet3& source,
     PCCPointSet3 rawPointsSet;
     rawPointsSet.resize( numRawPoints );
     // create raw points cloud
-    for ( size_t i = 0; i < numRawPoints; ++i ) { rawPointsSet[i] = source[rawPoints[i]]; }
-    PCCKdTree kdtreeRawPointsSet( rawPointsSet );
+    for ( size_t i = 0; i < numRawPoints; ++i ) { rawPointsSet.setPosition( i, source[rawPoints[i]] ); }
+    PCCKdTree kdtreeRawPointsSet( rawPointsSet, params_.nnSearchEngine_ );
     for ( size_t i = 0; i < numRawPoints; ++i ) {
       double      sumOfInverseDist = 0.0;
       PCCNNResult result;
@@ -4317,8 +4479,8 @@ void PCCEncoder::sortRawPointsPatchMorton( PCCFrameContext& frame, size_t index
     PCCPointSet3 rawPointsSet;
     rawPointsSet.resize( numRawPoints );
     for ( size_t i = 0; i < numRawPoints; i++ ) {
-      rawPointsSet[i] = PCCPoint3D( rawPointsPatch.x_[i], rawPointsPatch.x_[i + numRawPoints],
-                                    rawPointsPatch.x_[i + numRawPoints * 2] );
+      rawPointsSet.setPosition( i, PCCPoint3D( rawPointsPatch.x_[i], rawPointsPatch.x_[i + numRawPoints],
+                                               rawPointsPatch.x_[i + numRawPoints * 2] ) );
     }
     // calc Morton code of rawPointsSet
     std::vector<std::pair<uint64_t, PCCPoint3D>> mortonPoint;
@@ -4349,8 +4511,8 @@ void PCCEncoder::sortRawPointsPatch( PCCFrameContext& frame, size_t index ) {
     PCCPointSet3 rawPointsSet;
     rawPointsSet.resize( numRawPoints );
     for ( size_t i = 0; i < numRawPoints; i++ ) {
-      rawPointsSet[i] = PCCPoint3D( rawPointsPatch.x_[i], rawPointsPatch.x_[i + numRawPoints],
-                                    rawPointsPatch.x_[i + numRawPoints * 2] );
+      rawPointsSet.setPosition( i, PCCPoint3D( rawPointsPatch.x_[i], rawPointsPatch.x_[i + numRawPoints],
+                                               rawPointsPatch.x_[i + numRawPoints * 2] ) );
     }
     PCCKdTree           kdtreeRawPointsSet( rawPointsSet );
     PCCNNResult         result;
@@ -4401,12 +4563,12 @@ void PCCEncoder::placeAuxiliaryPointsTiles( PCCContext& context ) {
     // set height
     for ( size_t tileIdx = 0; tileIdx < numTilesInSeg; tileIdx++ ) {
       for ( size_t frameIdx = firstFrame; frameIdx < lastFrame; frameIdx++ ) {
-        auto&             tile = context[frameIdx].getTile( tileIdx );
-        std::vector<bool> auxPointsOccupancyMap;
-        size_t            auxPointsOccupancySizeU = maxWidth / params_.occupancyResolution_;
-        size_t            auxPointsOccupancySizeV = 1;
-        size_t            auxPointsTileHeight     = 0;
-        size_t            auxPointsTileWidth      = maxWidth;
+        auto&            tile = context[frameIdx].getTile( tileIdx );
+        PCCPackingCanvas auxPointsOccupancyMap;
+        size_t           auxPointsOccupancySizeU = maxWidth / params_.occupancyResolution_;
+        size_t           auxPointsOccupancySizeV = 1;
+        size_t           auxPointsTileHeight     = 0;
+        size_t           auxPointsTileWidth      = maxWidth;
         auxPointsOccupancyMap.resize( auxPointsOccupancySizeU * auxPointsOccupancySizeV, false );
         if ( tile.getRawPointsPatches().size() == 0 ) {
           printf( "packRawPointsPatch[0/0]: none\n" );
@@ -4738,44 +4900,69 @@ bool PCCEncoder::placeSegments( const PCCGroupOfFrames& sources, PCCContext& con
     generateTilesFromImage( context );
   } else {
     if ( params_.numMaxTilePerFrame_ > 1 ) { generateTilesFromSegments( context ); }
+    for ( size_t frameIndex = 0; frameIndex < context.size(); frameIndex++ ) {
+      if ( sources[frameIndex].getPointCount() == 0u ) { return false; }
+    }
+    std::vector<size_t> initTileWidths( params_.numMaxTilePerFrame_ );
+    std::vector<size_t> initTileHeights( params_.numMaxTilePerFrame_ );
+    // the tiles have their own canvases and patches: each tile packs its frames in order, the tiles concurrently,
+    // and the packing logs of each tile are printed in tile order once all the tiles are packed
+    std::vector<std::string> tileLogs( params_.numMaxTilePerFrame_ );
+#if defined( ENABLE_TBB )
+    tbb::task_arena limited( static_cast<int>( params_.nbThread_ ) );
+    limited.execute( [&] {
+      tbb::parallel_for( size_t( 0 ), params_.numMaxTilePerFrame_, [&]( const size_t tileIdx ) {
+#else
     for ( size_t tileIdx = 0; tileIdx < params_.numMaxTilePerFrame_; tileIdx++ ) {
-      size_t initTileWidth  = context.getFrame( 0 ).getTile( tileIdx ).getWidth();
-      size_t initTileHeight = context.getFrame( 0 ).getTile( tileIdx ).getHeight();
-      for ( size_t frameIndex = 0; frameIndex < context.size(); frameIndex++ ) {
-        if ( sources[frameIndex].getPointCount() == 0u ) { return false; }
-        auto&  tile       = context.getFrame( frameIndex ).getTile( tileIdx );
-        size_t tileWidth  = tile.getWidth();
-        size_t tileHeight = tile.getHeight();
-        size_t preIndex   = frameIndex > 0 ? ( frameIndex - 1 ) : 0;
-        auto&  prevTile   = context.getFrame( preIndex ).getTile( tileIdx );
-        if ( params_.levelOfDetailX_ > 1 || params_.levelOfDetailY_ > 1 ) { generateScaledGeometry( tile ); }
-        if ( params_.occupancyMapRefinement_ ) { refineOccupancyMap( tile ); }
-        if ( ( frameIndex == 0 ) || ( !params_.constrainedPack_ ) ) {
-          if ( params_.packingStrategy_ < 2 ) {
-            packFlexible( tile, params_.packingStrategy_, tileWidth, tileHeight, params_.safeGuardDistance_,
-                          params_.enablePointCloudPartitioning_ );
-          } else if ( params_.packingStrategy_ == 2 ) {
-            packTetris( tile, tileWidth, tileHeight, params_.safeGuardDistance_ );
-          }
-        } else {
-          if ( params_.packingStrategy_ < 2 ) {
-            if ( params_.globalPatchAllocation_ == 2 ) {
-              findMatchesForGlobalTetrisPacking( tile, prevTile );
-            } else {
-              spatialConsistencyPackFlexible( tile, prevTile, params_.packingStrategy_, tileWidth, tileHeight,
-                                              params_.safeGuardDistance_, params_.enablePointCloudPartitioning_ );
+#endif
+        initTileWidths[tileIdx]  = context.getFrame( 0 ).getTile( tileIdx ).getWidth();
+        initTileHeights[tileIdx] = context.getFrame( 0 ).getTile( tileIdx ).getHeight();
+        std::ostringstream log;
+        for ( size_t frameIndex = 0; frameIndex < context.size(); frameIndex++ ) {
+          auto&  tile       = context.getFrame( frameIndex ).getTile( tileIdx );
+          size_t tileWidth  = tile.getWidth();
+          size_t tileHeight = tile.getHeight();
+          size_t preIndex   = frameIndex > 0 ? ( frameIndex - 1 ) : 0;
+          auto&  prevTile   = context.getFrame( preIndex ).getTile( tileIdx );
+          if ( params_.levelOfDetailX_ > 1 || params_.levelOfDetailY_ > 1 ) { generateScaledGeometry( tile ); }
+          if ( params_.occupancyMapRefinement_ ) { refineOccupancyMap( tile ); }
+          if ( ( frameIndex == 0 ) || ( !params_.constrainedPack_ ) ) {
+            if ( params_.packingStrategy_ < 2 ) {
+              packFlexible( tile, params_.packingStrategy_, tileWidth, tileHeight, params_.safeGuardDistance_,
+                            params_.enablePointCloudPartitioning_, log );
+            } else if ( params_.packingStrategy_ == 2 ) {
+              packTetris( tile, tileWidth, tileHeight, params_.safeGuardDistance_, log );
             }
-          } else if ( params_.packingStrategy_ == 2 ) {
-            if ( params_.globalPatchAllocation_ == 2 ) {
-              findMatchesForGlobalTetrisPacking( tile, prevTile );  // this could also be a different prevFrame,
-              // it depends on the prediction structure
-            } else {
-              spatialConsistencyPackTetris( tile, prevTile, tileWidth, tileHeight, params_.safeGuardDistance_ );
+          } else {
+            if ( params_.packingStrategy_ < 2 ) {
+              if ( params_.globalPatchAllocation_ == 2 ) {
+                findMatchesForGlobalTetrisPacking( tile, prevTile, log );
+              } else {
+                spatialConsistencyPackFlexible( tile, prevTile, params_.packingStrategy_, tileWidth, tileHeight,
+                                                params_.safeGuardDistance_, params_.enablePointCloudPartitioning_,
+                                                log );
+              }
+            } else if ( params_.packingStrategy_ == 2 ) {
+              if ( params_.globalPatchAllocation_ == 2 ) {
+                findMatchesForGlobalTetrisPacking( tile, prevTile, log );  // this could also be a different prevFrame,
+                // it depends on the prediction structure
+              } else {
+                spatialConsistencyPackTetris( tile, prevTile, tileWidth, tileHeight, params_.safeGuardDistance_, log );
+              }
             }
           }
-        }
-      }  // frame
-
+        }  // frame
+        tileLogs[tileIdx] = log.str();
+#if defined( ENABLE_TBB )
+      } );
+    } );
+#else
+    }  // tile
+#endif
+    for ( auto& tileLog : tileLogs ) { std::cout << tileLog; }
+    for ( size_t tileIdx = 0; tileIdx < params_.numMaxTilePerFrame_; tileIdx++ ) {
+      const size_t initTileWidth  = initTileWidths[tileIdx];
+      const size_t initTileHeight = initTileHeights[tileIdx];
       // placing tiles in a frame
       resizeTileGeometryVideo( context, tileIdx, initTileWidth, initTileHeight );
       std::cout << "\t->tile " << tileIdx << " ImageSize " << context.getFrame( 0 ).getTile( tileIdx ).getWidth()
@@ -4926,9 +5113,9 @@ size_t PCCEncoder::generateTilesFromImage( PCCContext& context ) {
         tile.getEomPatches().push_back( eomPatch );
         // relocate eomPatches in the tile
         if ( !tile.getUseRawPointsSeparateVideo() ) {
-          std::vector<bool> occupancyMap;
-          size_t            occupancySizeU = tile.getWidth() / params_.occupancyResolution_;
-          size_t            occupancySizeV = tile.getHeight() / params_.occupancyResolution_;
+          PCCPackingCanvas occupancyMap;
+          size_t           occupancySizeU = tile.getWidth() / params_.occupancyResolution_;
+          size_t           occupancySizeV = tile.getHeight() / params_.occupancyResolution_;
           occupancyMap.resize( occupancySizeU * occupancySizeV );
           packEOMAttributePointsPatch( tile, occupancyMap, tile.getWidth(), tile.getHeight(), occupancySizeU,
                                        occupancySizeV, 0 );
@@ -4948,9 +5135,9 @@ size_t PCCEncoder::generateTilesFromImage( PCCContext& context ) {
       tile.getPatches().clear();
       tile.setWidth( frame.getWidth() );
       tile.setHeight( params_.tilePartitionHeight_ * 64 );
-      std::vector<bool> occupancyMap;
-      size_t            occupancySizeU = tile.getWidth() / params_.occupancyResolution_;
-      size_t            occupancySizeV = tile.getHeight() / params_.occupancyResolution_;
+      PCCPackingCanvas occupancyMap;
+      size_t           occupancySizeU = tile.getWidth() / params_.occupancyResolution_;
+      size_t           occupancySizeV = tile.getHeight() / params_.occupancyResolution_;
       occupancyMap.resize( occupancySizeU * occupancySizeV );
       if ( tile.getNumberOfRawPointsPatches() > 0 && !tile.getUseRawPointsSeparateVideo() ) {
         size_t height = tile.getHeight();
@@ -5709,123 +5896,9 @@ bool PCCEncoder::generateGeometryVideo( const PCCGroupOfFrames& sources, PCCCont
 
 template <typename T>
 void PCCEncoder::dilate( PCCFrameContext& frame, PCCImage<T, 3>& image, const PCCImage<T, 3>* reference ) {
-  auto          occupancyMapTemp         = frame.getOccupancyMap();
-  const size_t  pixelBlockCount          = params_.occupancyResolution_ * params_.occupancyResolution_;
-  const size_t  occupancyMapSizeU        = image.getWidth() / params_.occupancyResolution_;
-  const size_t  occupancyMapSizeV        = image.getHeight() / params_.occupancyResolution_;
-  const int64_t neighbors[4][2]          = { { 0, -1 }, { -1, 0 }, { 1, 0 }, { 0, 1 } };
-  const size_t  MAX_OCCUPANCY_RESOLUTION = 64;
-  assert( params_.occupancyResolution_ <= MAX_OCCUPANCY_RESOLUTION );
-  size_t              count[MAX_OCCUPANCY_RESOLUTION][MAX_OCCUPANCY_RESOLUTION];
-  PCCVector3<int32_t> values[MAX_OCCUPANCY_RESOLUTION][MAX_OCCUPANCY_RESOLUTION];
-  for ( size_t v1 = 0; v1 < occupancyMapSizeV; ++v1 ) {
-    const int64_t v0 = v1 * params_.occupancyResolution_;
-    for ( size_t u1 = 0; u1 < occupancyMapSizeU; ++u1 ) {
-      const int64_t u0                = u1 * params_.occupancyResolution_;
-      size_t        nonZeroPixelCount = 0;
-      for ( size_t v2 = 0; v2 < params_.occupancyResolution_; ++v2 ) {
-        for ( size_t u2 = 0; u2 < params_.occupancyResolution_; ++u2 ) {
-          const int64_t x0 = u0 + u2;
-          const int64_t y0 = v0 + v2;
-          assert( x0 < int64_t( image.getWidth() ) && y0 < int64_t( image.getHeight() ) );
-          const size_t location0 = y0 * image.getWidth() + x0;
-          if ( params_.enhancedOccupancyMapCode_ ) {
-            nonZeroPixelCount += ( occupancyMapTemp[location0] > 0 );
-          } else {
-            nonZeroPixelCount += ( occupancyMapTemp[location0] == 1 );
-          }
-        }
-      }
-      if ( !nonZeroPixelCount ) {
-        if ( reference ) {
-          for ( size_t v2 = 0; v2 < params_.occupancyResolution_; ++v2 ) {
-            for ( size_t u2 = 0; u2 < params_.occupancyResolution_; ++u2 ) {
-              const size_t x0 = u0 + u2;
-              const size_t y0 = v0 + v2;
-              image.setValue( 0, x0, y0, reference->getValue( 0, x0, y0 ) );
-              image.setValue( 1, x0, y0, reference->getValue( 1, x0, y0 ) );
-              image.setValue( 2, x0, y0, reference->getValue( 2, x0, y0 ) );
-            }
-          }
-        } else if ( u1 > 0 ) {
-          for ( size_t v2 = 0; v2 < params_.occupancyResolution_; ++v2 ) {
-            for ( size_t u2 = 0; u2 < params_.occupancyResolution_; ++u2 ) {
-              const size_t x0 = u0 + u2;
-              const size_t y0 = v0 + v2;
-              assert( x0 > 0 );
-              const size_t x1 = x0 - 1;
-              image.setValue( 0, x0, y0, image.getValue( 0, x1, y0 ) );
-              image.setValue( 1, x0, y0, image.getValue( 1, x1, y0 ) );
-              image.setValue( 2, x0, y0, image.getValue( 2, x1, y0 ) );
-            }
-          }
-        } else if ( v1 > 0 ) {
-          for ( size_t v2 = 0; v2 < params_.occupancyResolution_; ++v2 ) {
-            for ( size_t u2 = 0; u2 < params_.occupancyResolution_; ++u2 ) {
-              const size_t x0 = u0 + u2;
-              const size_t y0 = v0 + v2;
-              assert( y0 > 0 );
-              const size_t y1 = y0 - 1;
-              image.setValue( 0, x0, y0, image.getValue( 0, x0, y1 ) );
-              image.setValue( 1, x0, y0, image.getValue( 1, x0, y1 ) );
-              image.setValue( 2, x0, y0, image.getValue( 2, x0, y1 ) );
-            }
-          }
-        }
-        continue;
-      }
-      for ( size_t v2 = 0; v2 < params_.occupancyResolution_; ++v2 ) {
-        for ( size_t u2 = 0; u2 < params_.occupancyResolution_; ++u2 ) {
-          values[v2][u2] = 0;
-          count[v2][u2]  = 0UL;
-        }
-      }
-      uint32_t iteration = 1;
-      while ( nonZeroPixelCount < pixelBlockCount ) {
-        for ( size_t v2 = 0; v2 < params_.occupancyResolution_; ++v2 ) {
-          for ( size_t u2 = 0; u2 < params_.occupancyResolution_; ++u2 ) {
-            const int64_t x0 = u0 + u2;
-            const int64_t y0 = v0 + v2;
-            assert( x0 < int64_t( image.getWidth() ) && y0 < int64_t( image.getHeight() ) );
-            const size_t location0 = y0 * image.getWidth() + x0;
-            if ( occupancyMapTemp[location0] == iteration ) {
-              for ( auto neighbor : neighbors ) {
-                const int64_t x1        = x0 + neighbor[0];
-                const int64_t y1        = y0 + neighbor[1];
-                const size_t  location1 = y1 * image.getWidth() + x1;
-                if ( x1 >= u0 && x1 < int64_t( u0 + params_.occupancyResolution_ ) && y1 >= v0 &&
-                     y1 < int64_t( v0 + params_.occupancyResolution_ ) && occupancyMapTemp[location1] == 0 ) {
-                  const int64_t u3 = u2 + neighbor[0];
-                  const int64_t v3 = v2 + neighbor[1];
-                  assert( u3 >= 0 && u3 < int64_t( params_.occupancyResolution_ ) );
-                  assert( v3 >= 0 && v3 < int64_t( params_.occupancyResolution_ ) );
-                  for ( size_t k = 0; k < 3; ++k ) { values[v3][u3][k] += image.getValue( k, x0, y0 ); }
-                  ++count[v3][u3];
-                }
-              }
-            }
-          }
-        }
-        for ( size_t v2 = 0; v2 < params_.occupancyResolution_; ++v2 ) {
-          for ( size_t u2 = 0; u2 < params_.occupancyResolution_; ++u2 ) {
-            if ( count[v2][u2] ) {
-              ++nonZeroPixelCount;
-              const size_t x0             = u0 + u2;
-              const size_t y0             = v0 + v2;
-              const size_t location0      = y0 * image.getWidth() + x0;
-              const size_t c              = count[v2][u2];
-              const size_t c2             = c / 2;
-              occupancyMapTemp[location0] = iteration + 1;
-              for ( size_t k = 0; k < 3; ++k ) { image.setValue( k, x0, y0, T( ( values[v2][u2][k] + c2 ) / c ) ); }
-              values[v2][u2] = 0;
-              count[v2][u2]  = 0UL;
-            }
-          }
-        }
-        ++iteration;
-      }
-    }
-  }
+  PCCImagePadding<T>( params_.nbThread_ )
+      .dilate( image, frame.getOccupancyMap(), params_.occupancyResolution_, params_.enhancedOccupancyMapCode_,
+               reference );
 }
 
 // 3D geometry padding
@@ -5833,7 +5906,7 @@ size_t PCCEncoder::adjustDepth3DPadding( size_t            x,
                                          size_t            y,
                                          uint16_t          mean_val,
                                          PCCImageGeometry& image,
-                                         PCCKdTree&        kdtree,
+                                         const PCCKdTree&  kdtree,
                                          PCCFrameContext&  frame ) {
   auto&  blockToPatch = frame.getBlockToPatch();
   auto&  patches      = frame.getPatches();
@@ -5859,7 +5932,8 @@ size_t PCCEncoder::adjustDepth3DPadding( size_t            x,
     size_t deltadepth = 8;
     if ( mean_val < deltadepth ) { deltadepth = mean_val; }
     if ( mean_val + deltadepth > frame.getMaxDepth() ) { deltadepth = frame.getMaxDepth() - mean_val; }
-    for ( uint16_t depth = 1; depth < deltadepth; depth++ ) {
+    // a depth whose point belongs to the point cloud cannot be improved: the search stops there
+    for ( uint16_t depth = 1; depth < deltadepth && distance != 0; depth++ ) {
       PCCPoint3D point = patch.canvasTo3D( x, y, mean_val + depth );
       // now find the distance between the point and the original point cloud
       PCCNNResult result;
@@ -5871,6 +5945,7 @@ size_t PCCEncoder::adjustDepth3DPadding( size_t            x,
         image.setValue( 2, x, y, 0 );
         distance = dist2;
       }
+      if ( distance == 0 ) { break; }
       PCCPoint3D point_neg = patch.canvasTo3D( x, y, mean_val - depth );
       // now find the distance between the point and the original point cloud
       PCCNNResult result_neg;
@@ -5893,18 +5968,11 @@ void PCCEncoder::dilate3DPadding( const PCCPointSet3&     source,
                                   PCCImageGeometry&       image,
                                   PCCImageOccupancyMap&   occupancyMap,
                                   const PCCImageGeometry* reference ) {
-  const size_t  pixelBlockCount          = params_.occupancyResolution_ * params_.occupancyResolution_;
-  const size_t  occupancyMapSizeU        = image.getWidth() / params_.occupancyResolution_;
-  const size_t  occupancyMapSizeV        = image.getHeight() / params_.occupancyResolution_;
-  const int64_t neighbors[4][2]          = { { 0, -1 }, { -1, 0 }, { 1, 0 }, { 0, 1 } };
-  const size_t  MAX_OCCUPANCY_RESOLUTION = 64;
-  assert( params_.occupancyResolution_ <= MAX_OCCUPANCY_RESOLUTION );
-  size_t                count[MAX_OCCUPANCY_RESOLUTION][MAX_OCCUPANCY_RESOLUTION];
-  PCCVector3<int32_t>   values[MAX_OCCUPANCY_RESOLUTION][MAX_OCCUPANCY_RESOLUTION];
-  std::vector<uint32_t> occupancyMapTemp;
+  const size_t          width                = image.getWidth();
   auto&                 occupancyMapOriginal = frame.getOccupancyMap();
-  occupancyMapTemp.resize( image.getWidth() * image.getHeight(), 0 );
-  PCCKdTree kdtree( source );
+  std::vector<uint32_t> occupancyMapTemp( width * image.getHeight(), 0 );
+  // positions added by the occupancy map video coding and the mean depth of their occupancy block
+  std::vector<std::pair<size_t, uint16_t>> addedPositions;
   // fill in positions that are added to the sequence, because of occupancyMap video coding
   for ( size_t y_OM = 0; y_OM < occupancyMap.getHeight(); ++y_OM ) {
     for ( size_t x_OM = 0; x_OM < occupancyMap.getWidth(); ++x_OM ) {
@@ -5917,7 +5985,7 @@ void PCCEncoder::dilate3DPadding( const PCCPointSet3&     source,
           size_t y = y_OM * params_.occupancyPrecision_ + j;
           for ( size_t i = 0; i < params_.occupancyPrecision_; i++ ) {
             size_t x = x_OM * params_.occupancyPrecision_ + i;
-            if ( occupancyMapOriginal[y * image.getWidth() + x] != 0 ) {
+            if ( occupancyMapOriginal[y * width + x] != 0 ) {
               mean_val += image.getValue( 0, x, y );
               count++;
             }
@@ -5931,607 +5999,67 @@ void PCCEncoder::dilate3DPadding( const PCCPointSet3&     source,
         }
         assert( count > 0 );
         mean_val /= count;
-        // now fill in the missing positions with depth values searched in 3D space
+        // the missing positions get depth values searched in 3D space below
         for ( size_t j = 0; j < params_.occupancyPrecision_; j++ ) {
           size_t y = y_OM * params_.occupancyPrecision_ + j;
           for ( size_t i = 0; i < params_.occupancyPrecision_; i++ ) {
             size_t x = x_OM * params_.occupancyPrecision_ + i;
-            // if depth value is undefined, this position will be added, find the best value
-            if ( occupancyMapOriginal[y * image.getWidth() + x] == 0 ) {
-              // try to find the best value to approximate this new point to the original point cloud get the patch
-              // information
+            if ( occupancyMapOriginal[y * width + x] == 0 ) {
               if ( params_.geometryPadding_ == 1 ) {
-                occupancyMapTemp[y * image.getWidth() + x] =
-                    adjustDepth3DPadding( x, y, mean_val, image, kdtree, frame );
-              } else {
-                occupancyMapTemp[y * image.getWidth() + x] = 0;
+                addedPositions.emplace_back( y * width + x, mean_val );
+                occupancyMapTemp[y * width + x] = 1;
               }
             } else {
-              occupancyMapTemp[y * image.getWidth() + x] = 1;
+              occupancyMapTemp[y * width + x] = 1;
             }
           }
         }
       }
     }
   }
-
-  // now continue adding the pixels with the previous dilation approach
-  for ( size_t v1 = 0; v1 < occupancyMapSizeV; ++v1 ) {
-    const int64_t v0 = v1 * params_.occupancyResolution_;
-    for ( size_t u1 = 0; u1 < occupancyMapSizeU; ++u1 ) {
-      const int64_t u0                = u1 * params_.occupancyResolution_;
-      size_t        nonZeroPixelCount = 0;
-      for ( size_t v2 = 0; v2 < params_.occupancyResolution_; ++v2 ) {
-        for ( size_t u2 = 0; u2 < params_.occupancyResolution_; ++u2 ) {
-          const int64_t x0 = u0 + u2;
-          const int64_t y0 = v0 + v2;
-          assert( x0 < int64_t( image.getWidth() ) && y0 < int64_t( image.getHeight() ) );
-          const size_t location0 = y0 * image.getWidth() + x0;
-          if ( params_.enhancedOccupancyMapCode_ ) {
-            nonZeroPixelCount += static_cast<unsigned long long>( occupancyMapTemp[location0] > 0 );
-          } else {
-            nonZeroPixelCount += static_cast<unsigned long long>( occupancyMapTemp[location0] == 1 );
-          }
-        }
-      }
-      if ( nonZeroPixelCount == 0u ) {
-        if ( reference != nullptr ) {
-          for ( size_t v2 = 0; v2 < params_.occupancyResolution_; ++v2 ) {
-            for ( size_t u2 = 0; u2 < params_.occupancyResolution_; ++u2 ) {
-              const size_t x0 = u0 + u2;
-              const size_t y0 = v0 + v2;
-              image.setValue( 0, x0, y0, reference->getValue( 0, x0, y0 ) );
-              image.setValue( 1, x0, y0, reference->getValue( 1, x0, y0 ) );
-              image.setValue( 2, x0, y0, reference->getValue( 2, x0, y0 ) );
-            }
-          }
-        } else if ( u1 > 0 ) {
-          for ( size_t v2 = 0; v2 < params_.occupancyResolution_; ++v2 ) {
-            for ( size_t u2 = 0; u2 < params_.occupancyResolution_; ++u2 ) {
-              const size_t x0 = u0 + u2;
-              const size_t y0 = v0 + v2;
-              assert( x0 > 0 );
-              const size_t x1 = x0 - 1;
-              image.setValue( 0, x0, y0, image.getValue( 0, x1, y0 ) );
-              image.setValue( 1, x0, y0, image.getValue( 1, x1, y0 ) );
-              image.setValue( 2, x0, y0, image.getValue( 2, x1, y0 ) );
-            }
-          }
-        } else if ( v1 > 0 ) {
-          for ( size_t v2 = 0; v2 < params_.occupancyResolution_; ++v2 ) {
-            for ( size_t u2 = 0; u2 < params_.occupancyResolution_; ++u2 ) {
-              const size_t x0 = u0 + u2;
-              const size_t y0 = v0 + v2;
-              assert( y0 > 0 );
-              const size_t y1 = y0 - 1;
-              image.setValue( 0, x0, y0, image.getValue( 0, x0, y1 ) );
-              image.setValue( 1, x0, y0, image.getValue( 1, x0, y1 ) );
-              image.setValue( 2, x0, y0, image.getValue( 2, x0, y1 ) );
-            }
-          }
-        }
-        continue;
-      }
-      for ( size_t v2 = 0; v2 < params_.occupancyResolution_; ++v2 ) {
-        for ( size_t u2 = 0; u2 < params_.occupancyResolution_; ++u2 ) {
-          values[v2][u2] = 0;
-          count[v2][u2]  = 0UL;
-        }
-      }
-      uint32_t iteration = 1;
-      while ( nonZeroPixelCount < pixelBlockCount ) {
-        for ( size_t v2 = 0; v2 < params_.occupancyResolution_; ++v2 ) {
-          for ( size_t u2 = 0; u2 < params_.occupancyResolution_; ++u2 ) {
-            const int64_t x0 = u0 + u2;
-            const int64_t y0 = v0 + v2;
-            assert( x0 < int64_t( image.getWidth() ) && y0 < int64_t( image.getHeight() ) );
-            const size_t location0 = y0 * image.getWidth() + x0;
-            if ( occupancyMapTemp[location0] == iteration ) {
-              for ( auto neighbor : neighbors ) {
-                const int64_t x1        = x0 + neighbor[0];
-                const int64_t y1        = y0 + neighbor[1];
-                const size_t  location1 = y1 * image.getWidth() + x1;
-                if ( x1 >= u0 && x1 < int64_t( u0 + params_.occupancyResolution_ ) && y1 >= v0 &&
-                     y1 < int64_t( v0 + params_.occupancyResolution_ ) && occupancyMapTemp[location1] == 0 ) {
-                  const int64_t u3 = u2 + neighbor[0];
-                  const int64_t v3 = v2 + neighbor[1];
-                  assert( u3 >= 0 && u3 < int64_t( params_.occupancyResolution_ ) );
-                  assert( v3 >= 0 && v3 < int64_t( params_.occupancyResolution_ ) );
-                  for ( size_t k = 0; k < 3; ++k ) { values[v3][u3][k] += image.getValue( k, x0, y0 ); }
-                  ++count[v3][u3];
-                }
-              }
-            }
-          }
-        }
-        for ( size_t v2 = 0; v2 < params_.occupancyResolution_; ++v2 ) {
-          for ( size_t u2 = 0; u2 < params_.occupancyResolution_; ++u2 ) {
-            if ( count[v2][u2] != 0u ) {
-              ++nonZeroPixelCount;
-              const size_t x0             = u0 + u2;
-              const size_t y0             = v0 + v2;
-              const size_t location0      = y0 * image.getWidth() + x0;
-              const size_t c              = count[v2][u2];
-              const size_t c2             = c / 2;
-              occupancyMapTemp[location0] = iteration + 1;
-              for ( size_t k = 0; k < 3; ++k ) {
-                image.setValue( k, x0, y0, uint16_t( ( values[v2][u2][k] + c2 ) / c ) );
-              }
-              values[v2][u2] = 0;
-              count[v2][u2]  = 0UL;
-            }
-          }
-        }
-        ++iteration;
-      }
+  // try to find the best value to approximate each new point to the original point cloud: the means are computed
+  // from the original positions only and each search writes its own pixel, so the searches are independent
+  if ( !addedPositions.empty() ) {
+    auto kdtree = kdtreeCache_ != nullptr ? kdtreeCache_->get( source )
+                                          : std::make_shared<const PCCKdTree>( source, params_.nnSearchEngine_ );
+#if defined( ENABLE_TBB )
+    tbb::task_arena limited( static_cast<int>( params_.nbThread_ ) );
+    limited.execute( [&] {
+      tbb::parallel_for( size_t( 0 ), addedPositions.size(), [&]( const size_t i ) {
+#else
+    for ( size_t i = 0; i < addedPositions.size(); i++ ) {
+#endif
+        const size_t location = addedPositions[i].first;
+        adjustDepth3DPadding( location % width, location / width, addedPositions[i].second, image, *kdtree, frame );
+#if defined( ENABLE_TBB )
+      } );
+    } );
+#else
     }
+#endif
   }
+  // now continue adding the pixels with the previous dilation approach
+  PCCImagePadding<uint16_t>( params_.nbThread_ )
+      .dilate( image, occupancyMapTemp, params_.occupancyResolution_, params_.enhancedOccupancyMapCode_, reference );
 }
 
 /* harmonic background filling algorithm */
 // interpolate using 5-point laplacian inpainting
 template <typename T>
 void PCCEncoder::dilateHarmonicBackgroundFill( PCCFrameContext& frame, PCCImage<T, 3>& image ) {
-  auto                               occupancyMapTemp = frame.getOccupancyMap();
-  int                                i                = 0;
-  std::vector<PCCImage<T, 3>>        mipVec;
-  std::vector<std::vector<uint32_t>> mipOccupancyMapVec;
-  int                                miplev = 0;
-
-  // create coarse image by dyadic sampling
-  while ( true ) {
-    mipVec.resize( mipVec.size() + 1 );
-    mipOccupancyMapVec.resize( mipOccupancyMapVec.size() + 1 );
-    if ( miplev > 0 ) {
-      createCoarseLayer( mipVec[miplev - 1], mipVec[miplev], mipOccupancyMapVec[miplev - 1],
-                         mipOccupancyMapVec[miplev] );
-    } else {
-      createCoarseLayer( image, mipVec[miplev], occupancyMapTemp, mipOccupancyMapVec[miplev] );
-    }
-
-    if ( mipVec[miplev].getWidth() <= 4 || mipVec[miplev].getHeight() <= 4 ) { break; }
-    ++miplev;
-  }
-  miplev++;
-  // push phase: inpaint laplacian
-  regionFill( mipVec[miplev - 1], mipOccupancyMapVec[miplev - 1], mipVec[miplev - 1] );
-  for ( i = miplev - 1; i >= 0; --i ) {
-    if ( i > 0 ) {
-      regionFill( mipVec[i - 1], mipOccupancyMapVec[i - 1], mipVec[i] );
-    } else {
-      regionFill( image, occupancyMapTemp, mipVec[i] );
-    }
-  }
-}
-
-template <typename T>
-void PCCEncoder::createCoarseLayer( PCCImage<T, 3>&        image,
-                                    PCCImage<T, 3>&        mip,
-                                    std::vector<uint32_t>& occupancyMap,
-                                    std::vector<uint32_t>& mipOccupancyMap ) {
-  int dyadicWidth = 1;
-  while ( dyadicWidth < image.getWidth() ) { dyadicWidth *= 2; }
-  int dyadicHeight = 1;
-  while ( dyadicHeight < image.getHeight() ) { dyadicHeight *= 2; }
-  // allocate the mipmap with half the resolution
-  mip.resize( ( dyadicWidth / 2 ), ( dyadicHeight / 2 ), PCCCOLORFORMAT::YUV444 );
-  mipOccupancyMap.resize( ( dyadicWidth / 2 ) * ( dyadicHeight / 2 ), 0 );
-  int stride    = image.getWidth();
-  int newStride = ( dyadicWidth / 2 );
-  for ( size_t y = 0; y < mip.getHeight(); y++ ) {
-    for ( size_t x = 0; x < mip.getWidth(); x++ ) {
-      double num[3] = { 0.0, 0.0, 0.0 };
-      double den    = 0;
-      for ( size_t i = 0; i < 2; i++ ) {
-        for ( size_t j = 0; j < 2; j++ ) {
-          int row = ( 2 * y + i ) < 0 ? 0 : ( 2 * y + i ) >= image.getHeight() ? image.getHeight() - 1 : ( 2 * y + i );
-          int column = ( 2 * x + j ) < 0 ? 0 : ( 2 * x + j ) >= image.getWidth() ? image.getWidth() - 1 : ( 2 * x + j );
-          if ( occupancyMap[column + stride * row] == 1 ) {
-            den++;
-            for ( int cc = 0; cc < 3; cc++ ) { num[cc] += image.getValue( cc, column, row ); }
-          }
-        }
-      }
-      if ( den > 0 ) {
-        mipOccupancyMap[x + newStride * y] = 1;
-        for ( int cc = 0; cc < 3; cc++ ) { mip.setValue( cc, x, y, std::round( num[cc] / den ) ); }
-      }
-    }
-  }
-}
-
-template <typename T>
-void PCCEncoder::regionFill( PCCImage<T, 3>& image, std::vector<uint32_t>& occupancyMap, PCCImage<T, 3>& imageLowRes ) {
-  int                   stride        = image.getWidth();
-  int                   numElem       = 0;
-  int                   numSparseElem = 0;
-  std::vector<uint32_t> indexing;
-  indexing.resize( occupancyMap.size() );
-  for ( int i = 0; i < occupancyMap.size(); i++ ) {
-    if ( occupancyMap[i] == 0 ) {
-      indexing[i] = numElem;
-      numElem++;
-    }
-  }
-  // create a sparse matrix with the coefficients
-  std::vector<uint32_t> iSparse;
-  std::vector<uint32_t> jSparse;
-  std::vector<double>   valSparse;
-  iSparse.resize( numElem * 5 );
-  jSparse.resize( numElem * 5 );
-  valSparse.resize( numElem * 5 );
-  // create an initial solution using the low-resolution
-  std::vector<double> b[3];
-  b[0].resize( numElem );
-  b[1].resize( numElem );
-  b[2].resize( numElem );
-  // fill in the system
-  int idx       = 0;
-  int idxSparse = 0;
-  for ( int row = 0; row < image.getHeight(); row++ ) {
-    for ( int column = 0; column < image.getWidth(); column++ ) {
-      if ( occupancyMap[column + stride * row] == 0 ) {
-        int count = 0;
-        b[0][idx] = 0;
-        b[1][idx] = 0;
-        b[2][idx] = 0;
-        for ( int i = -1; i < 2; i++ ) {
-          for ( int j = -1; j < 2; j++ ) {
-            if ( ( i == j ) || ( i == -j ) ) { continue; }
-            if ( ( column + j < 0 ) || ( column + j > image.getWidth() - 1 ) ) { continue; }
-            if ( ( row + i < 0 ) || ( row + i > image.getHeight() - 1 ) ) { continue; }
-            count++;
-            if ( occupancyMap[column + j + stride * ( row + i )] == 1 ) {
-              b[0][idx] += image.getValue( 0, column + j, row + i );
-              b[1][idx] += image.getValue( 1, column + j, row + i );
-              b[2][idx] += image.getValue( 2, column + j, row + i );
-            } else {
-              iSparse[idxSparse]   = idx;
-              jSparse[idxSparse]   = indexing[column + j + stride * ( row + i )];
-              valSparse[idxSparse] = -1;
-              idxSparse++;
-            }
-          }
-        }
-        // now insert the weight of the center pixel
-        iSparse[idxSparse]   = idx;
-        jSparse[idxSparse]   = idx;
-        valSparse[idxSparse] = count;
-        idx++;
-        idxSparse++;
-      }
-    }
-  }
-  numSparseElem = idxSparse;
-  // now solve the linear system Ax=b using Gauss-Siedel relaxation, with initial guess coming from the lower resolution
-  std::vector<double> x[3];
-  x[0].resize( numElem );
-  x[1].resize( numElem );
-  x[2].resize( numElem );
-  if ( imageLowRes.getWidth() == image.getWidth() ) {
-    // low resolution image not provided, let's use for the initialization the mean value of the active pixels
-    double mean[3] = { 0.0, 0.0, 0.0 };
-    idx            = 0;
-    for ( int row = 0; row < image.getHeight(); row++ ) {
-      for ( int column = 0; column < image.getWidth(); column++ ) {
-        if ( occupancyMap[column + stride * row] == 1 ) {
-          mean[0] += double( image.getValue( 0, column, row ) );
-          mean[1] += double( image.getValue( 1, column, row ) );
-          mean[2] += double( image.getValue( 2, column, row ) );
-          idx++;
-        }
-      }
-    }
-    mean[0] /= idx;
-    mean[1] /= idx;
-    mean[2] /= idx;
-    idx = 0;
-    for ( int row = 0; row < image.getHeight(); row++ ) {
-      for ( int column = 0; column < image.getWidth(); column++ ) {
-        if ( occupancyMap[column + stride * row] == 0 ) {
-          x[0][idx] = mean[0];
-          x[1][idx] = mean[1];
-          x[2][idx] = mean[2];
-          idx++;
-        }
-      }
-    }
-  } else {
-    idx = 0;
-    for ( int row = 0; row < image.getHeight(); row++ ) {
-      for ( int column = 0; column < image.getWidth(); column++ ) {
-        if ( occupancyMap[column + stride * row] == 0 ) {
-          x[0][idx] = imageLowRes.getValue( 0, column / 2, row / 2 );
-          x[1][idx] = imageLowRes.getValue( 1, column / 2, row / 2 );
-          x[2][idx] = imageLowRes.getValue( 2, column / 2, row / 2 );
-          idx++;
-        }
-      }
-    }
-  }
-  int    maxIteration = 1024;
-  double maxError     = 0.00001;
-  for ( int cc = 0; cc < 3; cc++ ) {
-    int it = 0;
-    for ( ; it < maxIteration; it++ ) {
-      int    idxSparse = 0;
-      double error     = 0;
-      for ( int centerIdx = 0; centerIdx < numElem; centerIdx++ ) {
-        // add the b result
-        double val = b[cc][centerIdx];
-        while ( ( idxSparse < numSparseElem ) && ( iSparse[idxSparse] == centerIdx ) ) {
-          if ( valSparse[idxSparse] < 0 ) {
-            val += x[cc][jSparse[idxSparse]];
-            idxSparse++;
-          } else {
-            // final value
-            val /= valSparse[idxSparse];
-            // accumulate the error
-            error += ( val - x[cc][centerIdx] ) * ( val - x[cc][centerIdx] );
-            // update the value
-            x[cc][centerIdx] = val;
-            idxSparse++;
-          }
-        }
-      }
-      error = error / numElem;
-      if ( error < maxError ) { break; }
-    }
-  }
-  // put the value back in the image
-  idx = 0;
-  for ( int row = 0; row < image.getHeight(); row++ ) {
-    for ( int column = 0; column < image.getWidth(); column++ ) {
-      if ( occupancyMap[column + stride * row] == 0 ) {
-        image.setValue( 0, column, row, x[0][idx] );
-        image.setValue( 1, column, row, x[1][idx] );
-        image.setValue( 2, column, row, x[2][idx] );
-        idx++;
-      }
-    }
-  }
-}
-
-/* pull push filling algorithm */
-template <typename T>
-int PCCEncoder::mean4w( T             p1,
-                        unsigned char w1,
-                        T             p2,
-                        unsigned char w2,
-                        T             p3,
-                        unsigned char w3,
-                        T             p4,
-                        unsigned char w4 ) {
-  int result = ( p1 * int( w1 ) + p2 * int( w2 ) + p3 * int( w3 ) + p4 * int( w4 ) ) /
-               ( int( w1 ) + int( w2 ) + int( w3 ) + int( w4 ) );
-  return result;
-}
-
-// Generates a weighted mipmap
-template <typename T>
-void PCCEncoder::pushPullMip( const PCCImage<T, 3>&        image,
-                              PCCImage<T, 3>&              mip,
-                              const std::vector<uint32_t>& occupancyMap,
-                              std::vector<uint32_t>&       mipOccupancyMap ) {
-  unsigned char w1;
-  unsigned char w2;
-  unsigned char w3;
-  unsigned char w4;
-  unsigned char val1;
-  unsigned char val2;
-  unsigned char val3;
-  unsigned char val4;
-  const size_t  width     = image.getWidth();
-  const size_t  height    = image.getHeight();
-  const size_t  newWidth  = ( ( width + 1 ) >> 1 );
-  const size_t  newHeight = ( ( height + 1 ) >> 1 );
-  // allocate the mipmap with half the resolution
-  mip.resize( newWidth, newHeight, PCCCOLORFORMAT::YUV444 );
-  mipOccupancyMap.resize( newWidth * newHeight, 0 );
-  for ( size_t y = 0; y < newHeight; ++y ) {
-    const size_t yUp = y << 1;
-    for ( size_t x = 0; x < newWidth; ++x ) {
-      const size_t xUp = x << 1;
-      if ( occupancyMap[xUp + width * yUp] == 0 ) {
-        w1 = 0;
-      } else {
-        w1 = 255;
-      }
-      if ( ( xUp + 1 >= width ) || ( occupancyMap[xUp + 1 + width * yUp] == 0 ) ) {
-        w2 = 0;
-      } else {
-        w2 = 255;
-      }
-      if ( ( yUp + 1 >= height ) || ( occupancyMap[xUp + width * ( yUp + 1 )] == 0 ) ) {
-        w3 = 0;
-      } else {
-        w3 = 255;
-      }
-      if ( ( xUp + 1 >= width ) || ( yUp + 1 >= height ) || ( occupancyMap[xUp + 1 + width * ( yUp + 1 )] == 0 ) ) {
-        w4 = 0;
-      } else {
-        w4 = 255;
-      }
-      if ( w1 + w2 + w3 + w4 > 0 ) {
-        for ( int cc = 0; cc < 3; cc++ ) {
-          val1 = image.getValue( cc, xUp, yUp );
-          if ( xUp + 1 >= width ) {
-            val2 = 0;
-          } else {
-            val2 = image.getValue( cc, xUp + 1, yUp );
-          }
-          if ( yUp + 1 >= height ) {
-            val3 = 0;
-          } else {
-            val3 = image.getValue( cc, xUp, yUp + 1 );
-          }
-          if ( ( xUp + 1 >= width ) || ( yUp + 1 >= height ) ) {
-            val4 = 0;
-          } else {
-            val4 = image.getValue( cc, xUp + 1, yUp + 1 );
-          }
-          T newVal = mean4w( val1, w1, val2, w2, val3, w3, val4, w4 );
-          mip.setValue( cc, x, y, newVal );
-        }
-        mipOccupancyMap[x + newWidth * y] = 1;
-      }
-    }
-  }
-}
-
-// interpolate using mipmap
-template <typename T>
-void PCCEncoder::pushPullFill( PCCImage<T, 3>&              image,
-                               const PCCImage<T, 3>&        mip,
-                               const std::vector<uint32_t>& occupancyMap,
-                               int                          numIters ) {
-  const size_t width    = mip.getWidth();
-  const size_t height   = mip.getHeight();
-  const size_t widthUp  = image.getWidth();
-  const size_t heightUp = image.getHeight();
-  assert( ( ( widthUp + 1 ) >> 1 ) == width );
-  assert( ( ( heightUp + 1 ) >> 1 ) == height );
-  unsigned char w1;
-  unsigned char w2;
-  unsigned char w3;
-  unsigned char w4;
-  for ( int yUp = 0; yUp < heightUp; ++yUp ) {
-    int y = yUp >> 1;
-    for ( int xUp = 0; xUp < widthUp; ++xUp ) {
-      int x = xUp >> 1;
-      if ( occupancyMap[xUp + widthUp * yUp] == 0 ) {
-        if ( ( xUp % 2 == 0 ) && ( yUp % 2 == 0 ) ) {
-          w1 = 144;
-          w2 = ( x > 0 ? static_cast<unsigned char>( 48 ) : 0 );
-          w3 = ( y > 0 ? static_cast<unsigned char>( 48 ) : 0 );
-          w4 = ( ( ( x > 0 ) && ( y > 0 ) ) ? static_cast<unsigned char>( 16 ) : 0 );
-          for ( int cc = 0; cc < 3; cc++ ) {
-            T val       = mip.getValue( cc, x, y );
-            T valLeft   = ( x > 0 ? mip.getValue( cc, x - 1, y ) : 0 );
-            T valUp     = ( y > 0 ? mip.getValue( cc, x, y - 1 ) : 0 );
-            T valUpLeft = ( ( x > 0 && y > 0 ) ? mip.getValue( cc, x - 1, y - 1 ) : 0 );
-            T newVal    = mean4w( val, w1, valLeft, w2, valUp, w3, valUpLeft, w4 );
-            image.setValue( cc, xUp, yUp, newVal );
-          }
-        } else if ( ( xUp % 2 == 1 ) && ( yUp % 2 == 0 ) ) {
-          w1 = 144;
-          w2 = ( x < width - 1 ? static_cast<unsigned char>( 48 ) : 0 );
-          w3 = ( y > 0 ? static_cast<unsigned char>( 48 ) : 0 );
-          w4 = ( ( ( x < width - 1 ) && ( y > 0 ) ) ? static_cast<unsigned char>( 16 ) : 0 );
-          for ( int cc = 0; cc < 3; cc++ ) {
-            T val        = mip.getValue( cc, x, y );
-            T valRight   = ( x < width - 1 ? mip.getValue( cc, x + 1, y ) : 0 );
-            T valUp      = ( y > 0 ? mip.getValue( cc, x, y - 1 ) : 0 );
-            T valUpRight = ( ( ( x < width - 1 ) && ( y > 0 ) ) ? mip.getValue( cc, x + 1, y - 1 ) : 0 );
-            T newVal     = mean4w( val, w1, valRight, w2, valUp, w3, valUpRight, w4 );
-            image.setValue( cc, xUp, yUp, newVal );
-          }
-        } else if ( ( xUp % 2 == 0 ) && ( yUp % 2 == 1 ) ) {
-          w1 = 144;
-          w2 = ( x > 0 ? static_cast<unsigned char>( 48 ) : 0 );
-          w3 = ( y < height - 1 ? static_cast<unsigned char>( 48 ) : 0 );
-          w4 = ( ( ( x > 0 ) && ( y < height - 1 ) ) ? static_cast<unsigned char>( 16 ) : 0 );
-          for ( int cc = 0; cc < 3; cc++ ) {
-            T val         = mip.getValue( cc, x, y );
-            T valLeft     = ( x > 0 ? mip.getValue( cc, x - 1, y ) : 0 );
-            T valDown     = ( ( y < height - 1 ) ? mip.getValue( cc, x, y + 1 ) : 0 );
-            T valDownLeft = ( ( x > 0 && ( y < height - 1 ) ) ? mip.getValue( cc, x - 1, y + 1 ) : 0 );
-            T newVal      = mean4w( val, w1, valLeft, w2, valDown, w3, valDownLeft, w4 );
-            image.setValue( cc, xUp, yUp, newVal );
-          }
-        } else {
-          w1 = 144;
-          w2 = ( x < width - 1 ? static_cast<unsigned char>( 48 ) : 0 );
-          w3 = ( y < height - 1 ? static_cast<unsigned char>( 48 ) : 0 );
-          w4 = ( ( ( x < width - 1 ) && ( y < height - 1 ) ) ? static_cast<unsigned char>( 16 ) : 0 );
-          for ( int cc = 0; cc < 3; cc++ ) {
-            T val          = mip.getValue( cc, x, y );
-            T valRight     = ( x < width - 1 ? mip.getValue( cc, x + 1, y ) : 0 );
-            T valDown      = ( ( y < height - 1 ) ? mip.getValue( cc, x, y + 1 ) : 0 );
-            T valDownRight = ( ( ( x < width - 1 ) && ( y < height - 1 ) ) ? mip.getValue( cc, x + 1, y + 1 ) : 0 );
-            T newVal       = mean4w( val, w1, valRight, w2, valDown, w3, valDownRight, w4 );
-            image.setValue( cc, xUp, yUp, newVal );
-          }
-        }
-      }
-    }
-  }
-  auto tmpImage( image );
-  for ( size_t n = 0; n < numIters; n++ ) {
-    for ( int y = 0; y < heightUp; y++ ) {
-      for ( int x = 0; x < widthUp; x++ ) {
-        if ( occupancyMap[x + widthUp * y] == 0 ) {
-          int x1 = ( x > 0 ) ? x - 1 : x;
-          int y1 = ( y > 0 ) ? y - 1 : y;
-          int x2 = ( x < widthUp - 1 ) ? x + 1 : x;
-          int y2 = ( y < heightUp - 1 ) ? y + 1 : y;
-          for ( size_t c = 0; c < 3; c++ ) {
-            int val = image.getValue( c, x1, y1 ) + image.getValue( c, x2, y1 ) + image.getValue( c, x1, y2 ) +
-                      image.getValue( c, x2, y2 ) + image.getValue( c, x1, y ) + image.getValue( c, x2, y ) +
-                      image.getValue( c, x, y1 ) + image.getValue( c, x, y2 );
-            tmpImage.setValue( c, x, y, ( val + 4 ) >> 3 );
-          }
-        }
-      }
-    }
-    swap( image, tmpImage );
-  }
+  PCCImagePadding<T>( params_.nbThread_ ).harmonicBackgroundFill( image, frame.getOccupancyMap() );
 }
 
 template <typename T>
 void PCCEncoder::dilateSmoothedPushPull( PCCFrameContext& frame, PCCImage<T, 3>& image, int mapIdx ) {
-  auto                               occupancyMapTemp = frame.getOccupancyMap();
-  int                                i                = 0;
-  std::vector<PCCImage<T, 3>>        mipVec;
-  std::vector<std::vector<uint32_t>> mipOccupancyMapVec;
-  int                                div    = 2;
-  int                                miplev = 0;
-
-  // pull phase create the mipmap
-  while ( true ) {
-    mipVec.resize( mipVec.size() + 1 );
-    mipOccupancyMapVec.resize( mipOccupancyMapVec.size() + 1 );
-    div *= 2;
-    if ( miplev > 0 ) {
-      pushPullMip( mipVec[miplev - 1], mipVec[miplev], mipOccupancyMapVec[miplev - 1], mipOccupancyMapVec[miplev] );
-    } else {
-      pushPullMip( image, mipVec[miplev], occupancyMapTemp, mipOccupancyMapVec[miplev] );
-    }
-    if ( mipVec[miplev].getWidth() <= 4 || mipVec[miplev].getHeight() <= 4 ) { break; }
-    ++miplev;
-  }
-  miplev++;
-#if DEBUG_PATCH
-  for ( int k = 0; k < miplev; k++ ) {
-    char buf[100];
-    sprintf( buf, "mip%02i", k );
-    std::string filename = addVideoFormat( buf, mipVec[k].getWidth(), mipVec[k].getHeight(), false, false );
-    mipVec[k].write( filename, 1 );
-  }
-#endif
-  // push phase: refill
-  int numIters = 4;
-  for ( i = miplev - 1; i >= 0; --i ) {
-    if ( i > 0 ) {
-      pushPullFill( mipVec[i - 1], mipVec[i], mipOccupancyMapVec[i - 1], numIters );
-    } else {
-      pushPullFill( image, mipVec[i], occupancyMapTemp, numIters );
-    }
-    numIters = (std::min)( numIters + 1, 16 );
-  }
-#if DEBUG_PATCH
-  for ( int k = 0; k < miplev; k++ ) {
-    char buf[100];
-    sprintf( buf, "mipfill%02i", k );
-    std::string filename = addVideoFormat( buf, mipVec[k].getWidth(), mipVec[k].getHeight(), false, false );
-    mipVec[k].write( filename, 1 );
-  }
-#endif
+  PCCImagePadding<T>( params_.nbThread_ ).pushPull( image, frame.getOccupancyMap() );
 }
 
 void PCCEncoder::presmoothPointCloudColor( PCCPointSet3& reconstruct, const PCCEncoderParameters params ) {
   const size_t            pointCount = reconstruct.getPointCount();
-  PCCKdTree               kdtree( reconstruct );
+  auto                    kdtree =
+      kdtreeCache_ != nullptr ? kdtreeCache_->get( reconstruct )
+                              : std::make_shared<const PCCKdTree>( reconstruct, params_.nnSearchEngine_ );
   PCCNNResult             result;
   std::vector<PCCColor3B> temp;
   temp.resize( pointCount );
@@ -6545,8 +6073,8 @@ void PCCEncoder::presmoothPointCloudColor( PCCPointSet3& reconstruct, const PCCE
 #endif
       PCCNNResult result;
       if ( reconstruct.getBoundaryPointType( i ) == 2 ) {
-        kdtree.searchRadius( reconstruct[i], params.neighborCountColorPreSmoothing_, params.radius2ColorPreSmoothing_,
-                             result );
+        kdtree->searchRadius( reconstruct[i], params.neighborCountColorPreSmoothing_, params.radius2ColorPreSmoothing_,
+                              result );
         PCCVector3D          centroid( 0.0 );
         size_t               neighborCount = 0;
         std::vector<uint8_t> Lum;
@@ -6632,7 +6160,9 @@ bool PCCEncoder::generateAttributeVideo( const PCCGroupOfFrames&     sources,
           params_.maxColorDist2Fwd_,                         // maxColorDist2Fwd
           params_.maxColorDist2Bwd_,                         // maxColorDist2Bwd
           params_.excludeColorOutlier_,                      // excludeColorOutlier
-          params_.thresholdColorOutlierDist_                 // thresholdColorOutlierDist
+          params_.thresholdColorOutlierDist_,                // thresholdColorOutlierDist
+          kdtreeCache_,                                      // kdtreeCache
+          params_.nbThread_                                  // nbThread
       );
       // color pre-smoothing
       if ( params_.flagColorPreSmoothing_ ) { presmoothPointCloudColor( reconstructs[i], params ); }
@@ -7072,11 +6602,11 @@ size_t PCCEncoder::unionPatchGenerationAndPacking( const GlobalPatches& globalPa
     occupancySizeU            = std::max<size_t>( occupancySizeU, curPatchUnion.getSizeU0() + 1 );
     occupancySizeV            = std::max<size_t>( occupancySizeV, curPatchUnion.getSizeV0() + 1 );
   }
-  size_t            width           = occupancySizeU * params_.occupancyResolution_;
-  size_t            height          = occupancySizeV * params_.occupancyResolution_;
-  size_t            maxOccupancyRow = 0;
-  std::vector<bool> occupancyMap;
-  int               numOrientations = params_.packingStrategy_ == 0 ? 1 : ( params_.useEightOrientations_ ? 8 : 2 );
+  size_t           width           = occupancySizeU * params_.occupancyResolution_;
+  size_t           height          = occupancySizeV * params_.occupancyResolution_;
+  size_t           maxOccupancyRow = 0;
+  PCCPackingCanvas occupancyMap;
+  int              numOrientations = params_.packingStrategy_ == 0 ? 1 : ( params_.useEightOrientations_ ? 8 : 2 );
   occupancyMap.resize( occupancySizeU * occupancySizeV, false );
   for ( auto& iter : unionPatchTemp ) {
     auto& curPatchUnion = iter.second;  // [u0, v0] may be modified;
@@ -7175,13 +6705,13 @@ void PCCEncoder::packingFirstFrame( PCCContext& context,
   size_t           occupancySizeV = 0;
   for ( auto& p : patches ) { occupancySizeV = std::max( occupancySizeV, std::max( p.getSizeU0(), p.getSizeV0() ) ); }
   for ( auto& patch : patches ) { occupancySizeU = (std::max)( occupancySizeU, patch.getSizeU0() + 1 ); }
-  auto& widthGPA                    = tile.getCurPCCGPAFrameSize().widthGPA_;
-  auto& heithGPA                    = tile.getCurPCCGPAFrameSize().heightGPA_;
-  widthGPA                          = occupancySizeU * params_.occupancyResolution_;
-  heithGPA                          = occupancySizeV * params_.occupancyResolution_;
-  size_t            maxOccupancyRow = 0;
-  int               numOrientations = ( params_.packingStrategy_ == 0 ) ? 1 : ( params_.useEightOrientations_ ? 8 : 2 );
-  std::vector<bool> occupancyMap;
+  auto& widthGPA                   = tile.getCurPCCGPAFrameSize().widthGPA_;
+  auto& heithGPA                   = tile.getCurPCCGPAFrameSize().heightGPA_;
+  widthGPA                         = occupancySizeU * params_.occupancyResolution_;
+  heithGPA                         = occupancySizeV * params_.occupancyResolution_;
+  size_t           maxOccupancyRow = 0;
+  int              numOrientations = ( params_.packingStrategy_ == 0 ) ? 1 : ( params_.useEightOrientations_ ? 8 : 2 );
+  PCCPackingCanvas occupancyMap;
   occupancyMap.resize( occupancySizeU * occupancySizeV, false );
   for ( auto& patch : patches ) {
     assert( patch.getSizeU0() <= occupancySizeU );
@@ -7489,10 +7019,10 @@ void PCCEncoder::performGPAPacking( const SubContext& subContext,
     for ( auto& patch : patches ) {
       occupancySizeU = (std::max)( occupancySizeU, patch.getCurGPAPatchData().sizeU0_ + 1 );
     }
-    widthGPA                          = occupancySizeU * params_.occupancyResolution_;
-    heightGPA                         = occupancySizeV * params_.occupancyResolution_;
-    size_t            maxOccupancyRow = 0;
-    std::vector<bool> occupancyMap;
+    widthGPA                         = occupancySizeU * params_.occupancyResolution_;
+    heightGPA                        = occupancySizeV * params_.occupancyResolution_;
+    size_t           maxOccupancyRow = 0;
+    PCCPackingCanvas occupancyMap;
     occupancyMap.resize( occupancySizeU * occupancySizeV, false );
     // !!!packing global matched patch;
     for ( auto& patch : patches ) {
@@ -7585,16 +7115,16 @@ void PCCEncoder::performGPAPacking( const SubContext& subContext,
   if ( exceedMinimumImageHeight || badCondition > BAD_CONDITION_THRESHOLD ) { badGPAPacking = true; }
 }
 
-void PCCEncoder::packingWithoutRefForFirstFrameNoglobalPatch( PCCPatch&          patch,
-                                                              size_t             ii,
-                                                              size_t             icount,
-                                                              size_t&            occupancySizeU,
-                                                              size_t&            occupancySizeV,
-                                                              const size_t       safeguard,
-                                                              std::vector<bool>& occupancyMap,
-                                                              size_t&            heightGPA,
-                                                              size_t&            widthGPA,
-                                                              size_t&            maxOccupancyRow ) {
+void PCCEncoder::packingWithoutRefForFirstFrameNoglobalPatch( PCCPatch&         patch,
+                                                              size_t            ii,
+                                                              size_t            icount,
+                                                              size_t&           occupancySizeU,
+                                                              size_t&           occupancySizeV,
+                                                              const size_t      safeguard,
+                                                              PCCPackingCanvas& occupancyMap,
+                                                              size_t&           heightGPA,
+                                                              size_t&           widthGPA,
+                                                              size_t&           maxOccupancyRow ) {
   int           numOrientations = ( params_.packingStrategy_ == 0 ) ? 1 : ( params_.useEightOrientations_ ? 8 : 2 );
   GPAPatchData& curGPAPatchData = patch.getCurGPAPatchData();
   assert( curGPAPatchData.sizeU0_ <= occupancySizeU );
@@ -7679,7 +7209,7 @@ void PCCEncoder::packingWithRefForFirstFrameNoglobalPatch( PCCPatch&
                                                            size_t&                      occupancySizeU,
                                                            size_t&                      occupancySizeV,
                                                            const size_t                 safeguard,
-                                                           std::vector<bool>&           occupancyMap,
+                                                           PCCPackingCanvas&            occupancyMap,
                                                            size_t&                      heightGPA,
                                                            size_t&                      widthGPA,
                                                            size_t&                      maxOccupancyRow ) {
@@ -8828,6 +8358,7 @@ void PCCEncoder::segmentationPartiallyAddtinalProjectionPlane( const PCCPointSet
     Orthogonal.reserve( 256 );
     float distanceSrcRecA;
     segmenter.setNbThread( params_.nbThread_ );
+    segmenter.setNNSearchEngine( params_.nnSearchEngine_ );
     segmenter.compute( source, frame.getFrameIndex(), local, Orthogonal, frame.getSrcPointCloudByPatch(),
                        distanceSrcRecA );
     distanceSrcRec                  = distanceSrcRecA;
@@ -8845,6 +8376,7 @@ void PCCEncoder::segmentationPartiallyAddtinalProjectionPlane( const PCCPointSet
     Additional.reserve( 256 );
     float distanceSrcRecA;
     segmenter.setNbThread( params_.nbThread_ );
+    segmenter.setNNSearchEngine( params_.nnSearchEngine_ );
     segmenter.compute( partial, frame.getFrameIndex(), local, Additional, frame.getSrcPointCloudByPatch(),
                        distanceSrcRecA );
     distanceSrcRec                  = distanceSrcRecA;
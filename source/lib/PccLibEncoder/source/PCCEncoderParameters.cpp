@@ -46,6 +46,7 @@ PCCEncoderParameters::PCCEncoderParameters() {
   gridBasedSegmentation_               = false;
   voxelDimensionGridBasedSegmentation_ = 2;
   uncompressedDataPath_                = {};
+  uncompressedDataCachePath_           = {};
   compressedStreamPath_                = {};
   reconstructedDataPath_               = {};
   configurationFolder_                 = {};
@@ -135,7 +136,12 @@ PCCEncoderParameters::PCCEncoderParameters() {
   geometryAuxVideoConfig_                  = {};
   attributeAuxVideoConfig_                 = {};
   nbThread_                                = 1;
+  maxGroupOfFramesInFlight_                = 1;
+  parallelGroupOfFrames_                   = false;
+  memoryBudget_                            = 0;
+  nnSearchEngine_                          = NN_ENGINE_KDTREE;
   keepIntermediateFiles_                   = false;
+  useNamedPipes_                           = false;
   absoluteD1_                              = false;
   absoluteT1_                              = false;
   multipleStreams_                         = false;
@@ -327,6 +333,7 @@ void PCCEncoderParameters::print() {
   if ( useRawPointsSeparateVideo_ )
     std::cout << "\t attributeRawSeparateVideoWidth             " << attributeRawSeparateVideoWidth_ << std::endl;
   std::cout << "\t uncompressedDataPath                       " << uncompressedDataPath_ << std::endl;
+  std::cout << "\t uncompressedDataCachePath                  " << uncompressedDataCachePath_ << std::endl;
   std::cout << "\t compressedStreamPath                       " << compressedStreamPath_ << std::endl;
   std::cout << "\t reconstructedDataPath                      " << reconstructedDataPath_ << std::endl;
   std::cout << "\t frameCount                                 " << frameCount_ << std::endl;
@@ -335,7 +342,12 @@ void PCCEncoderParameters::print() {
   std::cout << "\t groupOfFramesSize                          " << groupOfFramesSize_ << std::endl;
   std::cout << "\t colorTransform                             " << colorTransform_ << std::endl;
   std::cout << "\t nbThread                                   " << nbThread_ << std::endl;
+  std::cout << "\t maxGroupOfFramesInFlight                   " << maxGroupOfFramesInFlight_ << std::endl;
+  std::cout << "\t parallelGroupOfFrames                      " << parallelGroupOfFrames_ << std::endl;
+  std::cout << "\t memoryBudget                               " << memoryBudget_ << std::endl;
+  std::cout << "\t nnSearchEngine                             " << nnSearchEngine_ << std::endl;
   std::cout << "\t keepIntermediateFiles                      " << keepIntermediateFiles_ << std::endl;
+  std::cout << "\t useNamedPipes                              " << useNamedPipes_ << std::endl;
   std::cout << "\t multipleStreams                            " << multipleStreams_ << std::endl;
   std::cout << "\t multipleStreams                            " << multipleStreams_ << std::endl;
   std::cout << "\t videoEncoderInternalBitdepth               " << videoEncoderInternalBitdepth_ << std::endl;  
@@ -918,8 +930,8 @@ bool PCCEncoderParameters::check() {
     std::cerr << "absoluteD1_ should be true when multipleStreams_ is false\n";
     absoluteD1_ = true;
   }
-  if ( normalOrientation_ > 3 ) {
-    std::cerr << "WARNING: the normal orientation is out of the possible range [0;3]\n";
+  if ( normalOrientation_ > 4 ) {
+    std::cerr << "WARNING: the normal orientation is out of the possible range [0;4]\n";
     normalOrientation_ = 1;
   }
   if ( !absoluteT1_ && absoluteD1_ ) {
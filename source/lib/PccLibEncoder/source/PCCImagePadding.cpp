@@ -0,0 +1,512 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "PCCCommon.h"
+#include "PCCMath.h"
+#include "PCCImage.h"
+#include "PCCImagePadding.h"
+#include "PCCParallel.h"
+
+using namespace pcc;
+
+// Fills the empty pixels of a row of the push-pull filling from the mip: a pixel is the weighted mean of the sample
+// of its 2x2 block (9/16) and of the samples next to it on the side of the pixel (3/16 each and 1/16 diagonally).
+// mipRowV is the mip row above or below the pixels, or nullptr outside of the mip, and the samples outside of the mip
+// have no weight.
+template <typename T>
+static void interpolateRow( const T*        mipRow,
+                            const T*        mipRowV,
+                            const size_t    mipWidth,
+                            const uint32_t* occupancy,
+                            T*              dst,
+                            const size_t    width ) {
+  const int w3 = mipRowV != nullptr ? 48 : 0;
+  for ( size_t xUp = 0; xUp < width; ++xUp ) {
+    if ( occupancy[xUp] != 0 ) { continue; }
+    const size_t x      = xUp >> 1;
+    const bool   right  = ( xUp & 1 ) != 0;
+    const bool   hasH   = right ? x + 1 < mipWidth : x > 0;
+    const size_t xH     = right ? x + 1 : x - 1;
+    const int    w2     = hasH ? 48 : 0;
+    const int    w4     = hasH && w3 != 0 ? 16 : 0;
+    const int    weight = 144 + w2 + w3 + w4;
+    const int    valH   = hasH ? mipRow[xH] : 0;
+    const int    valV   = w3 != 0 ? mipRowV[x] : 0;
+    const int    valHV  = w4 != 0 ? mipRowV[xH] : 0;
+    const int    sum    = mipRow[x] * 144 + valH * w2 + valV * w3 + valHV * w4;
+    // the weight of the pixels inside the mip is 256
+    dst[xUp] = T( weight == 256 ? sum >> 8 : sum / weight );
+  }
+}
+
+// Smooths a row of the push-pull filling: the empty pixels become the mean of their 8 neighbours, read in the row and
+// in the rows above and below, the occupied pixels keep their value.
+template <typename T>
+static void smoothRow( const T*        row,
+                       const T*        rowAbove,
+                       const T*        rowBelow,
+                       const uint32_t* occupancy,
+                       T*              dst,
+                       const size_t    width ) {
+  auto mean = [&]( const size_t x, const size_t x1, const size_t x2 ) {
+    const int val =
+        rowAbove[x1] + rowAbove[x2] + rowBelow[x1] + rowBelow[x2] + row[x1] + row[x2] + rowAbove[x] + rowBelow[x];
+    return occupancy[x] != 0 ? row[x] : T( ( val + 4 ) >> 3 );
+  };
+  // the borders are handled apart so that the inner loop has no branch and can be vectorized
+  dst[0] = mean( 0, 0, ( std::min )( size_t( 1 ), width - 1 ) );
+  for ( size_t x = 1; x + 1 < width; x++ ) {
+    const int val = rowAbove[x - 1] + rowAbove[x + 1] + rowBelow[x - 1] + rowBelow[x + 1] + row[x - 1] + row[x + 1] +
+                    rowAbove[x] + rowBelow[x];
+    const T value    = row[x];
+    const T smoothed = T( ( val + 4 ) >> 3 );
+    dst[x]           = occupancy[x] != 0 ? value : smoothed;
+  }
+  if ( width > 1 ) { dst[width - 1] = mean( width - 1, width - 2, width - 1 ); }
+}
+
+template <typename T>
+void PCCImagePadding<T>::dilate( PCCImage<T, 3>&              image,
+                                 const std::vector<uint32_t>& occupancyMap,
+                                 const size_t                 occupancyResolution,
+                                 const bool                   enhancedOccupancyMap,
+                                 const PCCImage<T, 3>*        reference ) const {
+  assert( image.getColorFormat() != PCCCOLORFORMAT::YUV420 );
+  auto          occupancyMapTemp  = occupancyMap;
+  const size_t  width             = image.getWidth();
+  const size_t  pixelBlockCount   = occupancyResolution * occupancyResolution;
+  const size_t  occupancyMapSizeU = image.getWidth() / occupancyResolution;
+  const size_t  occupancyMapSizeV = image.getHeight() / occupancyResolution;
+  const int64_t neighbors[4][2]   = { { 0, -1 }, { -1, 0 }, { 1, 0 }, { 0, 1 } };
+  T*            planes[3]         = { image.getChannel( 0 ).data(), image.getChannel( 1 ).data(),
+                       image.getChannel( 2 ).data() };
+  std::vector<uint8_t> emptyBlocks( occupancyMapSizeU * occupancyMapSizeV, 0 );
+
+  // the partially occupied blocks only read and write their own pixels: they are dilated independently
+  forEachRange( nbThread_, occupancyMapSizeV, [&]( const size_t begin, const size_t end ) {
+    std::vector<size_t>              count( pixelBlockCount );
+    std::vector<PCCVector3<int32_t>> values( pixelBlockCount );
+    for ( size_t v1 = begin; v1 < end; ++v1 ) {
+      const int64_t v0 = v1 * occupancyResolution;
+      for ( size_t u1 = 0; u1 < occupancyMapSizeU; ++u1 ) {
+        const int64_t u0                = u1 * occupancyResolution;
+        size_t        nonZeroPixelCount = 0;
+        for ( size_t v2 = 0; v2 < occupancyResolution; ++v2 ) {
+          const uint32_t* occupancy = occupancyMapTemp.data() + ( v0 + v2 ) * width + u0;
+          for ( size_t u2 = 0; u2 < occupancyResolution; ++u2 ) {
+            nonZeroPixelCount += enhancedOccupancyMap ? ( occupancy[u2] > 0 ) : ( occupancy[u2] == 1 );
+          }
+        }
+        if ( nonZeroPixelCount == 0 ) {
+          emptyBlocks[v1 * occupancyMapSizeU + u1] = 1;
+          continue;
+        }
+        std::fill( values.begin(), values.end(), PCCVector3<int32_t>( 0 ) );
+        std::fill( count.begin(), count.end(), 0 );
+        uint32_t iteration = 1;
+        while ( nonZeroPixelCount < pixelBlockCount ) {
+          for ( size_t v2 = 0; v2 < occupancyResolution; ++v2 ) {
+            for ( size_t u2 = 0; u2 < occupancyResolution; ++u2 ) {
+              const int64_t x0        = u0 + u2;
+              const int64_t y0        = v0 + v2;
+              const size_t  location0 = y0 * width + x0;
+              if ( occupancyMapTemp[location0] != iteration ) { continue; }
+              for ( auto neighbor : neighbors ) {
+                const int64_t x1 = x0 + neighbor[0];
+                const int64_t y1 = y0 + neighbor[1];
+                if ( x1 >= u0 && x1 < int64_t( u0 + occupancyResolution ) && y1 >= v0 &&
+                     y1 < int64_t( v0 + occupancyResolution ) && occupancyMapTemp[y1 * width + x1] == 0 ) {
+                  const size_t block = ( v2 + neighbor[1] ) * occupancyResolution + u2 + neighbor[0];
+                  for ( size_t k = 0; k < 3; ++k ) { values[block][k] += planes[k][location0]; }
+                  ++count[block];
+                }
+              }
+            }
+          }
+          for ( size_t v2 = 0; v2 < occupancyResolution; ++v2 ) {
+            for ( size_t u2 = 0; u2 < occupancyResolution; ++u2 ) {
+              const size_t block = v2 * occupancyResolution + u2;
+              if ( count[block] ) {
+                ++nonZeroPixelCount;
+                const size_t location0      = ( v0 + v2 ) * width + u0 + u2;
+                const size_t c              = count[block];
+                const size_t c2             = c / 2;
+                occupancyMapTemp[location0] = iteration + 1;
+                for ( size_t k = 0; k < 3; ++k ) { planes[k][location0] = T( ( values[block][k] + c2 ) / c ); }
+                values[block] = 0;
+                count[block]  = 0UL;
+              }
+            }
+          }
+          ++iteration;
+        }
+      }
+    }
+  } );
+
+  // an empty block repeats the last column of the block on its left, or in the first column the last row of the
+  // block above, or copies the reference
+  auto fillEmptyBlock = [&]( const size_t u1, const size_t v1 ) {
+    const size_t u0 = u1 * occupancyResolution;
+    const size_t v0 = v1 * occupancyResolution;
+    for ( size_t k = 0; k < 3; ++k ) {
+      T* plane = planes[k];
+      for ( size_t y = v0; y < v0 + occupancyResolution; ++y ) {
+        T* row = plane + y * width;
+        if ( reference ) {
+          const T* src = reference->getChannel( k ).data() + y * width;
+          std::copy( src + u0, src + u0 + occupancyResolution, row + u0 );
+        } else if ( u1 > 0 ) {
+          std::fill( row + u0, row + u0 + occupancyResolution, row[u0 - 1] );
+        } else if ( v1 > 0 ) {
+          const T* src = plane + ( v0 - 1 ) * width;
+          std::copy( src + u0, src + u0 + occupancyResolution, row + u0 );
+        }
+      }
+    }
+  };
+  // the first column of blocks is filled from the top, then the rows of blocks are filled from the left
+  for ( size_t v1 = 0; v1 < occupancyMapSizeV; ++v1 ) {
+    if ( emptyBlocks[v1 * occupancyMapSizeU] ) { fillEmptyBlock( 0, v1 ); }
+  }
+  forEachRange( nbThread_, occupancyMapSizeV, [&]( const size_t begin, const size_t end ) {
+    for ( size_t v1 = begin; v1 < end; ++v1 ) {
+      for ( size_t u1 = 1; u1 < occupancyMapSizeU; ++u1 ) {
+        if ( emptyBlocks[v1 * occupancyMapSizeU + u1] ) { fillEmptyBlock( u1, v1 ); }
+      }
+    }
+  } );
+}
+
+template <typename T>
+void PCCImagePadding<T>::pushPull( PCCImage<T, 3>& image, const std::vector<uint32_t>& occupancyMap ) const {
+  std::vector<PCCImage<T, 3>>        mipVec;
+  std::vector<std::vector<uint32_t>> mipOccupancyMapVec;
+  size_t                             miplev = 0;
+
+  // pull phase create the mipmap
+  while ( true ) {
+    mipVec.resize( mipVec.size() + 1 );
+    mipOccupancyMapVec.resize( mipOccupancyMapVec.size() + 1 );
+    if ( miplev > 0 ) {
+      pushPullMip( mipVec[miplev - 1], mipVec[miplev], mipOccupancyMapVec[miplev - 1], mipOccupancyMapVec[miplev] );
+    } else {
+      pushPullMip( image, mipVec[miplev], occupancyMap, mipOccupancyMapVec[miplev] );
+    }
+    if ( mipVec[miplev].getWidth() <= 4 || mipVec[miplev].getHeight() <= 4 ) { break; }
+    ++miplev;
+  }
+  miplev++;
+  // push phase: refill
+  size_t numIters = 4;
+  for ( size_t i = miplev; i-- > 0; ) {
+    if ( i > 0 ) {
+      pushPullFill( mipVec[i - 1], mipVec[i], mipOccupancyMapVec[i - 1], numIters );
+    } else {
+      pushPullFill( image, mipVec[i], occupancyMap, numIters );
+    }
+    numIters = ( std::min )( numIters + 1, size_t( 16 ) );
+  }
+}
+
+// Generates a weighted mipmap: a sample is the mean of the occupied pixels of its 2x2 block, read as 8-bit values
+template <typename T>
+void PCCImagePadding<T>::pushPullMip( const PCCImage<T, 3>&        image,
+                                      PCCImage<T, 3>&              mip,
+                                      const std::vector<uint32_t>& occupancyMap,
+                                      std::vector<uint32_t>&       mipOccupancyMap ) const {
+  assert( image.getColorFormat() != PCCCOLORFORMAT::YUV420 );
+  const size_t width     = image.getWidth();
+  const size_t height    = image.getHeight();
+  const size_t newWidth  = ( ( width + 1 ) >> 1 );
+  const size_t newHeight = ( ( height + 1 ) >> 1 );
+  // allocate the mipmap with half the resolution
+  mip.resize( newWidth, newHeight, PCCCOLORFORMAT::YUV444 );
+  mipOccupancyMap.resize( newWidth * newHeight, 0 );
+  forEachRange( nbThread_, newHeight, [&]( const size_t begin, const size_t end ) {
+    for ( size_t y = begin; y < end; ++y ) {
+      const size_t    yUp        = y << 1;
+      const bool      hasDown    = yUp + 1 < height;
+      const uint32_t* occupancy0 = occupancyMap.data() + width * yUp;
+      const uint32_t* occupancy1 = hasDown ? occupancy0 + width : occupancy0;
+      uint32_t*       mipOccupancy = mipOccupancyMap.data() + newWidth * y;
+      for ( size_t x = 0; x < newWidth; ++x ) {
+        const size_t xUp      = x << 1;
+        const bool   hasRight = xUp + 1 < width;
+        const int    w1       = occupancy0[xUp] != 0 ? 255 : 0;
+        const int    w2       = hasRight && occupancy0[xUp + 1] != 0 ? 255 : 0;
+        const int    w3       = hasDown && occupancy1[xUp] != 0 ? 255 : 0;
+        const int    w4       = hasRight && hasDown && occupancy1[xUp + 1] != 0 ? 255 : 0;
+        const int    weight   = w1 + w2 + w3 + w4;
+        if ( weight == 0 ) { continue; }
+        for ( size_t cc = 0; cc < 3; cc++ ) {
+          const T*  row0 = image.getChannel( cc ).data() + width * yUp;
+          const T*  row1 = row0 + width;
+          const int val1 = static_cast<uint8_t>( row0[xUp] );
+          const int val2 = hasRight ? static_cast<uint8_t>( row0[xUp + 1] ) : 0;
+          const int val3 = hasDown ? static_cast<uint8_t>( row1[xUp] ) : 0;
+          const int val4 = hasRight && hasDown ? static_cast<uint8_t>( row1[xUp + 1] ) : 0;
+          mip.getChannel( cc )[newWidth * y + x] = T( ( val1 * w1 + val2 * w2 + val3 * w3 + val4 * w4 ) / weight );
+        }
+        mipOccupancy[x] = 1;
+      }
+    }
+  } );
+}
+
+// interpolate using mipmap
+template <typename T>
+void PCCImagePadding<T>::pushPullFill( PCCImage<T, 3>&              image,
+                                       const PCCImage<T, 3>&        mip,
+                                       const std::vector<uint32_t>& occupancyMap,
+                                       const size_t                 numIters ) const {
+  assert( image.getColorFormat() != PCCCOLORFORMAT::YUV420 );
+  const size_t width    = mip.getWidth();
+  const size_t height   = mip.getHeight();
+  const size_t widthUp  = image.getWidth();
+  const size_t heightUp = image.getHeight();
+  assert( ( ( widthUp + 1 ) >> 1 ) == width );
+  assert( ( ( heightUp + 1 ) >> 1 ) == height );
+  forEachRange( nbThread_, heightUp, [&]( const size_t begin, const size_t end ) {
+    for ( size_t yUp = begin; yUp < end; ++yUp ) {
+      const size_t y    = yUp >> 1;
+      const bool   down = ( yUp & 1 ) != 0;
+      const bool   hasV = down ? y + 1 < height : y > 0;
+      const size_t yV   = down ? y + 1 : y - 1;
+      for ( size_t cc = 0; cc < 3; cc++ ) {
+        const T* src = mip.getChannel( cc ).data();
+        interpolateRow( src + y * width, hasV ? src + yV * width : nullptr, width, occupancyMap.data() + widthUp * yUp,
+                        image.getChannel( cc ).data() + widthUp * yUp, widthUp );
+      }
+    }
+  } );
+  // smoothing passes: an empty pixel becomes the mean of its 8 neighbours, replicated at the borders
+  auto tmpImage( image );
+  for ( size_t n = 0; n < numIters; n++ ) {
+    forEachRange( nbThread_, heightUp, [&]( const size_t begin, const size_t end ) {
+      for ( size_t y = begin; y < end; y++ ) {
+        const size_t    y1        = ( y > 0 ) ? y - 1 : y;
+        const size_t    y2        = ( y < heightUp - 1 ) ? y + 1 : y;
+        const uint32_t* occupancy = occupancyMap.data() + widthUp * y;
+        for ( size_t c = 0; c < 3; c++ ) {
+          const T* plane = image.getChannel( c ).data();
+          smoothRow( plane + widthUp * y, plane + widthUp * y1, plane + widthUp * y2, occupancy,
+                     tmpImage.getChannel( c ).data() + widthUp * y, widthUp );
+        }
+      }
+    } );
+    image.swap( tmpImage );
+  }
+}
+
+// interpolate using 5-point laplacian inpainting
+template <typename T>
+void PCCImagePadding<T>::harmonicBackgroundFill( PCCImage<T, 3>&              image,
+                                                 const std::vector<uint32_t>& occupancyMap ) const {
+  std::vector<PCCImage<T, 3>>        mipVec;
+  std::vector<std::vector<uint32_t>> mipOccupancyMapVec;
+  size_t                             miplev = 0;
+
+  // create coarse image by dyadic sampling
+  while ( true ) {
+    mipVec.resize( mipVec.size() + 1 );
+    mipOccupancyMapVec.resize( mipOccupancyMapVec.size() + 1 );
+    if ( miplev > 0 ) {
+      createCoarseLayer( mipVec[miplev - 1], mipVec[miplev], mipOccupancyMapVec[miplev - 1],
+                         mipOccupancyMapVec[miplev] );
+    } else {
+      createCoarseLayer( image, mipVec[miplev], occupancyMap, mipOccupancyMapVec[miplev] );
+    }
+    if ( mipVec[miplev].getWidth() <= 4 || mipVec[miplev].getHeight() <= 4 ) { break; }
+    ++miplev;
+  }
+  miplev++;
+  // push phase: inpaint laplacian
+  regionFill( mipVec[miplev - 1], mipOccupancyMapVec[miplev - 1], mipVec[miplev - 1] );
+  for ( size_t i = miplev; i-- > 0; ) {
+    if ( i > 0 ) {
+      regionFill( mipVec[i - 1], mipOccupancyMapVec[i - 1], mipVec[i] );
+    } else {
+      regionFill( image, occupancyMap, mipVec[i] );
+    }
+  }
+}
+
+template <typename T>
+void PCCImagePadding<T>::createCoarseLayer( const PCCImage<T, 3>&        image,
+                                            PCCImage<T, 3>&              mip,
+                                            const std::vector<uint32_t>& occupancyMap,
+                                            std::vector<uint32_t>&       mipOccupancyMap ) const {
+  assert( image.getColorFormat() != PCCCOLORFORMAT::YUV420 );
+  size_t dyadicWidth = 1;
+  while ( dyadicWidth < image.getWidth() ) { dyadicWidth *= 2; }
+  size_t dyadicHeight = 1;
+  while ( dyadicHeight < image.getHeight() ) { dyadicHeight *= 2; }
+  // allocate the mipmap with half the resolution
+  mip.resize( ( dyadicWidth / 2 ), ( dyadicHeight / 2 ), PCCCOLORFORMAT::YUV444 );
+  mipOccupancyMap.resize( ( dyadicWidth / 2 ) * ( dyadicHeight / 2 ), 0 );
+  const size_t stride    = image.getWidth();
+  const size_t newStride = ( dyadicWidth / 2 );
+  forEachRange( nbThread_, mip.getHeight(), [&]( const size_t begin, const size_t end ) {
+    for ( size_t y = begin; y < end; y++ ) {
+      // the samples outside of the image repeat its last row and column
+      const size_t rows[2] = { ( std::min )( 2 * y, image.getHeight() - 1 ),
+                               ( std::min )( 2 * y + 1, image.getHeight() - 1 ) };
+      for ( size_t x = 0; x < mip.getWidth(); x++ ) {
+        const size_t columns[2] = { ( std::min )( 2 * x, stride - 1 ), ( std::min )( 2 * x + 1, stride - 1 ) };
+        double       num[3]     = { 0.0, 0.0, 0.0 };
+        double       den        = 0;
+        for ( size_t i = 0; i < 2; i++ ) {
+          for ( size_t j = 0; j < 2; j++ ) {
+            const size_t location = columns[j] + stride * rows[i];
+            if ( occupancyMap[location] == 1 ) {
+              den++;
+              for ( size_t cc = 0; cc < 3; cc++ ) { num[cc] += image.getChannel( cc )[location]; }
+            }
+          }
+        }
+        if ( den > 0 ) {
+          mipOccupancyMap[x + newStride * y] = 1;
+          for ( size_t cc = 0; cc < 3; cc++ ) { mip.getChannel( cc )[x + newStride * y] = std::round( num[cc] / den ); }
+        }
+      }
+    }
+  } );
+}
+
+template <typename T>
+void PCCImagePadding<T>::regionFill( PCCImage<T, 3>&              image,
+                                     const std::vector<uint32_t>& occupancyMap,
+                                     const PCCImage<T, 3>&        imageLowRes ) const {
+  assert( image.getColorFormat() != PCCCOLORFORMAT::YUV420 );
+  const size_t          width   = image.getWidth();
+  const size_t          height  = image.getHeight();
+  size_t                numElem = 0;
+  std::vector<uint32_t> indexing;
+  indexing.resize( occupancyMap.size() );
+  for ( size_t i = 0; i < occupancyMap.size(); i++ ) {
+    if ( occupancyMap[i] == 0 ) { indexing[i] = numElem++; }
+  }
+  // the system has a row per empty pixel: the unknown neighbours (up, left, right, down) are stored in compressed
+  // sparse rows, and the occupied neighbours are summed in b
+  std::vector<uint32_t> offsets( numElem + 1, 0 );
+  std::vector<uint32_t> neighbors;
+  std::vector<double>   weights( numElem );
+  std::vector<double>   b[3];
+  std::vector<double>   x[3];
+  neighbors.reserve( numElem * 4 );
+  for ( size_t cc = 0; cc < 3; cc++ ) {
+    b[cc].resize( numElem, 0 );
+    x[cc].resize( numElem );
+  }
+  const int64_t offsetsI[4] = { -1, 0, 0, 1 };
+  const int64_t offsetsJ[4] = { 0, -1, 1, 0 };
+  size_t        idx         = 0;
+  for ( size_t row = 0; row < height; row++ ) {
+    for ( size_t column = 0; column < width; column++ ) {
+      if ( occupancyMap[column + width * row] != 0 ) { continue; }
+      int count = 0;
+      for ( size_t n = 0; n < 4; n++ ) {
+        const int64_t r = int64_t( row ) + offsetsI[n];
+        const int64_t c = int64_t( column ) + offsetsJ[n];
+        if ( c < 0 || c > int64_t( width ) - 1 || r < 0 || r > int64_t( height ) - 1 ) { continue; }
+        count++;
+        const size_t location = c + width * r;
+        if ( occupancyMap[location] == 1 ) {
+          for ( size_t cc = 0; cc < 3; cc++ ) { b[cc][idx] += image.getChannel( cc )[location]; }
+        } else {
+          neighbors.push_back( indexing[location] );
+        }
+      }
+      weights[idx] = count;
+      offsets[++idx] = neighbors.size();
+    }
+  }
+  // initial solution: the low resolution image or, if not provided, the mean value of the occupied pixels
+  if ( imageLowRes.getWidth() == width ) {
+    double mean[3] = { 0.0, 0.0, 0.0 };
+    size_t count   = 0;
+    for ( size_t i = 0; i < width * height; i++ ) {
+      if ( occupancyMap[i] == 1 ) {
+        for ( size_t cc = 0; cc < 3; cc++ ) { mean[cc] += double( image.getChannel( cc )[i] ); }
+        count++;
+      }
+    }
+    for ( size_t cc = 0; cc < 3; cc++ ) {
+      mean[cc] /= count;
+      std::fill( x[cc].begin(), x[cc].end(), mean[cc] );
+    }
+  } else {
+    const size_t lowResWidth = imageLowRes.getWidth();
+    idx                      = 0;
+    for ( size_t row = 0; row < height; row++ ) {
+      for ( size_t column = 0; column < width; column++ ) {
+        if ( occupancyMap[column + width * row] != 0 ) { continue; }
+        const size_t location = column / 2 + lowResWidth * ( row / 2 );
+        for ( size_t cc = 0; cc < 3; cc++ ) { x[cc][idx] = imageLowRes.getChannel( cc )[location]; }
+        idx++;
+      }
+    }
+  }
+  // solve the linear system Ax=b using Gauss-Siedel relaxation, the channels being solved concurrently
+  const int    maxIteration = 1024;
+  const double maxError     = 0.00001;
+  forEachRange( nbThread_, 3, [&]( const size_t begin, const size_t end ) {
+    for ( size_t cc = begin; cc < end; cc++ ) {
+      auto& xc = x[cc];
+      auto& bc = b[cc];
+      for ( int it = 0; it < maxIteration && numElem > 0; it++ ) {
+        double error = 0;
+        for ( size_t centerIdx = 0; centerIdx < numElem; centerIdx++ ) {
+          double val = bc[centerIdx];
+          for ( size_t n = offsets[centerIdx]; n < offsets[centerIdx + 1]; n++ ) { val += xc[neighbors[n]]; }
+          val /= weights[centerIdx];
+          error += ( val - xc[centerIdx] ) * ( val - xc[centerIdx] );
+          xc[centerIdx] = val;
+        }
+        error = error / numElem;
+        if ( error < maxError ) { break; }
+      }
+    }
+  } );
+  // put the value back in the image
+  for ( size_t cc = 0; cc < 3; cc++ ) {
+    T* plane = image.getChannel( cc ).data();
+    idx      = 0;
+    for ( size_t i = 0; i < width * height; i++ ) {
+      if ( occupancyMap[i] == 0 ) { plane[i] = T( x[cc][idx++] ); }
+    }
+  }
+}
+
+template class pcc::PCCImagePadding<uint8_t>;
+template class pcc::PCCImagePadding<uint16_t>;
@@ -34,10 +34,13 @@
 #include "PCCKdTree.h"
 #include "PCCNormalsGenerator.h"
 #include "PCCImage.h"
+#include "PCCParallel.h"
 #if defined( ENABLE_TBB )
 #include <tbb/tbb.h>
 #endif
 
+#include <atomic>
+
 using namespace pcc;
 
 void PCCNormalsGenerator3::init( const size_t pointCount, const PCCNormalsGenerator3Parameters& params ) {
@@ -195,39 +198,44 @@ void PCCNormalsGenerator3::orientNormals( const PCCPointSet3&
   }
   saveNormal.write( "normal_no_orientation.ply" );
 #endif
-  if ( params.orientationStrategy_ == PCC_NORMALS_GENERATOR_ORIENTATION_SPANNING_TREE ) {
+  if ( params.orientationStrategy_ == PCC_NORMALS_GENERATOR_ORIENTATION_SPANNING_TREE ||
+       params.orientationStrategy_ == PCC_NORMALS_GENERATOR_ORIENTATION_SPANNING_FOREST ) {
     const size_t pointCount = pointCloud.getPointCount();
-    PCCNNResult  nNResult;
-    visited_.resize( pointCount );
-    std::fill( visited_.begin(), visited_.end(), 0 );
-    PCCNNQuery3 nNQuery  = {PCCPoint3D( 0.0 ),
-                           static_cast<float>( params.radiusNormalOrientation_ ) * params.radiusNormalOrientation_,
-                           params.numberOfNearestNeighborsInNormalOrientation_};
-    PCCNNQuery3 nNQuery2 = {PCCPoint3D( 0.0 ), ( std::numeric_limits<float>::max )(),
-                            params.numberOfNearestNeighborsInNormalOrientation_};
-    for ( size_t ptIndex = 0; ptIndex < pointCount; ++ptIndex ) {
-      if ( visited_[ptIndex] == 0u ) {
-        visited_[ptIndex] = 1;
-        size_t      numberOfNormals;
-        PCCVector3D accumulatedNormals;
-        addNeighbors( uint32_t( ptIndex ), pointCloud, kdtree, nNQuery2, nNResult, accumulatedNormals,
-                      numberOfNormals );
-        if ( numberOfNormals == 0u ) {
-          if ( ptIndex != 0u ) {
-            accumulatedNormals = normals_[ptIndex - 1];
-          } else {
-            accumulatedNormals = ( params.viewPoint_ - pointCloud[ptIndex] );
+    if ( params.orientationStrategy_ == PCC_NORMALS_GENERATOR_ORIENTATION_SPANNING_FOREST ) {
+      orientNormalsSpanningForest( pointCloud, kdtree, params );
+    } else {
+      PCCNNResult nNResult;
+      visited_.resize( pointCount );
+      std::fill( visited_.begin(), visited_.end(), 0 );
+      PCCNNQuery3 nNQuery  = {PCCPoint3D( 0.0 ),
+                             static_cast<float>( params.radiusNormalOrientation_ ) * params.radiusNormalOrientation_,
+                             params.numberOfNearestNeighborsInNormalOrientation_};
+      PCCNNQuery3 nNQuery2 = {PCCPoint3D( 0.0 ), ( std::numeric_limits<float>::max )(),
+                              params.numberOfNearestNeighborsInNormalOrientation_};
+      for ( size_t ptIndex = 0; ptIndex < pointCount; ++ptIndex ) {
+        if ( visited_[ptIndex] == 0u ) {
+          visited_[ptIndex] = 1;
+          size_t      numberOfNormals;
+          PCCVector3D accumulatedNormals;
+          addNeighbors( uint32_t( ptIndex ), pointCloud, kdtree, nNQuery2, nNResult, accumulatedNormals,
+                        numberOfNormals );
+          if ( numberOfNormals == 0u ) {
+            if ( ptIndex != 0u ) {
+              accumulatedNormals = normals_[ptIndex - 1];
+            } else {
+              accumulatedNormals = ( params.viewPoint_ - pointCloud[ptIndex] );
+            }
           }
-        }
-        if ( normals_[ptIndex] * accumulatedNormals < 0.0 ) { normals_[ptIndex] = -normals_[ptIndex]; }
-        while ( !edges_.empty() ) {
-          PCCWeightedEdge edge = edges_.top();
-          edges_.pop();
-          uint32_t current = edge.end_;
-          if ( visited_[current] == 0u ) {
-            visited_[current] = 1;
-            if ( normals_[edge.start_] * normals_[current] < 0.0 ) { normals_[current] = -normals_[current]; }
-            addNeighbors( current, pointCloud, kdtree, nNQuery, nNResult, accumulatedNormals, numberOfNormals );
+          if ( normals_[ptIndex] * accumulatedNormals < 0.0 ) { normals_[ptIndex] = -normals_[ptIndex]; }
+          while ( !edges_.empty() ) {
+            PCCWeightedEdge edge = edges_.top();
+            edges_.pop();
+            uint32_t current = edge.end_;
+            if ( visited_[current] == 0u ) {
+              visited_[current] = 1;
+              if ( normals_[edge.start_] * normals_[current] < 0.0 ) { normals_[current] = -normals_[current]; }
+              addNeighbors( current, pointCloud, kdtree, nNQuery, nNResult, accumulatedNormals, numberOfNormals );
+            }
           }
         }
       }
@@ -518,6 +526,224 @@ void PCCNormalsGenerator3::orientNormals( const PCCPointSet3&
 #endif
   }
 }
+void PCCNormalsGenerator3::orientNormalsSpanningForest( const PCCPointSet3&                   pointCloud,
+                                                        const PCCKdTree&                      kdtree,
+                                                        const PCCNormalsGenerator3Parameters& params ) {
+  // The normals are propagated along the maximum spanning forest of the neighbourhood graph weighted by |ni.nj|, that
+  // the serial traversal grew from one point at a time with a priority queue. The forest is built here with Boruvka's
+  // algorithm: at each round, every tree selects its heaviest outgoing edge, the ties being broken by the end points
+  // so that the forest is unique, and the selected edges merge the trees in a lock-free union-find. The normals are
+  // then propagated in each tree from its smallest index, the trees concurrently, and as in the serial traversal each
+  // tree is flipped to agree with the trees of smaller indices around its first point.
+  const size_t   pointCount    = pointCloud.getPointCount();
+  const size_t   neighborCount = params.numberOfNearestNeighborsInNormalOrientation_;
+  const uint64_t noEdge        = ( std::numeric_limits<uint64_t>::max )();
+
+  std::vector<uint32_t> neighbors( pointCount * neighborCount );
+  std::vector<uint32_t> degrees( pointCount );
+
+  const double radius = static_cast<float>( params.radiusNormalOrientation_ ) * params.radiusNormalOrientation_;
+  forEachRange( nbThread_, pointCount, [&]( const size_t begin, const size_t end ) {
+    PCCNNResult result;
+    for ( size_t i = begin; i < end; ++i ) {
+      if ( radius > 32768.0 ) {
+        kdtree.search( pointCloud[i], neighborCount, result );
+      } else {
+        kdtree.searchRadius( pointCloud[i], neighborCount, radius, result );
+      }
+      uint32_t degree = 0;
+      for ( size_t j = 0; j < result.count() && j < neighborCount; ++j ) {
+        if ( result.indices( j ) != i ) { neighbors[i * neighborCount + degree++] = uint32_t( result.indices( j ) ); }
+      }
+      degrees[i] = degree;
+    }
+  } );
+  // the graph is made symmetric so that every point sees all its edges
+  std::vector<std::atomic<uint32_t>> counts( pointCount );
+  std::vector<size_t>                offsets( pointCount + 1, 0 );
+  forEachRange( nbThread_, pointCount, [&]( const size_t begin, const size_t end ) {
+    for ( size_t i = begin; i < end; ++i ) {
+      for ( uint32_t j = 0; j < degrees[i]; ++j ) { ++counts[neighbors[i * neighborCount + j]]; }
+    }
+  } );
+  for ( size_t i = 0; i < pointCount; ++i ) { offsets[i + 1] = offsets[i] + degrees[i] + counts[i]; }
+  std::vector<uint32_t> graph( offsets[pointCount] );
+  forEachRange( nbThread_, pointCount, [&]( const size_t begin, const size_t end ) {
+    for ( size_t i = begin; i < end; ++i ) {
+      std::copy( neighbors.begin() + i * neighborCount, neighbors.begin() + i * neighborCount + degrees[i],
+                 graph.begin() + offsets[i] );
+      counts[i].store( degrees[i] );
+    }
+  } );
+  forEachRange( nbThread_, pointCount, [&]( const size_t begin, const size_t end ) {
+    for ( size_t i = begin; i < end; ++i ) {
+      for ( uint32_t j = 0; j < degrees[i]; ++j ) {
+        const uint32_t n              = neighbors[i * neighborCount + j];
+        graph[offsets[n] + counts[n]++] = uint32_t( i );
+      }
+    }
+  } );
+  for ( size_t i = 0; i < pointCount; ++i ) { degrees[i] = uint32_t( offsets[i + 1] - offsets[i] ); }
+  std::vector<uint32_t>().swap( neighbors );
+
+  // an edge is packed as ( start << 32 | end ), the heavier of two edges having the larger weight, then the smaller
+  // end points
+  auto heavier = [&]( const uint64_t lhs, const uint64_t rhs ) {
+    const uint32_t lhs0 = uint32_t( lhs >> 32 );
+    const uint32_t lhs1 = uint32_t( lhs );
+    const uint32_t rhs0 = uint32_t( rhs >> 32 );
+    const uint32_t rhs1 = uint32_t( rhs );
+    const double   lhsW = fabs( normals_[lhs0] * normals_[lhs1] );
+    const double   rhsW = fabs( normals_[rhs0] * normals_[rhs1] );
+    if ( lhsW != rhsW ) { return lhsW > rhsW; }
+    if ( ( std::min )( lhs0, lhs1 ) != ( std::min )( rhs0, rhs1 ) ) {
+      return ( std::min )( lhs0, lhs1 ) < ( std::min )( rhs0, rhs1 );
+    }
+    return ( std::max )( lhs0, lhs1 ) < ( std::max )( rhs0, rhs1 );
+  };
+  std::vector<std::atomic<uint32_t>> parents( pointCount );
+  std::vector<std::atomic<uint64_t>> bestEdges( pointCount );
+  std::vector<uint64_t>              treeEdges( pointCount, noEdge );
+  std::vector<uint32_t>              roots( pointCount );
+  for ( size_t i = 0; i < pointCount; ++i ) { parents[i].store( uint32_t( i ) ); }
+  auto find = [&parents]( uint32_t i ) {
+    uint32_t parent = parents[i].load();
+    while ( parent != i ) {
+      const uint32_t grandParent = parents[parent].load();
+      if ( grandParent != parent ) { parents[i].compare_exchange_weak( parent, grandParent ); }
+      i      = grandParent;
+      parent = parents[i].load();
+    }
+    return i;
+  };
+  // links the trees of the end points of edge under the smallest root, the edge being kept by the other root
+  auto unite = [&]( const uint64_t edge ) {
+    uint32_t lhs = uint32_t( edge >> 32 );
+    uint32_t rhs = uint32_t( edge );
+    while ( true ) {
+      lhs = find( lhs );
+      rhs = find( rhs );
+      if ( lhs == rhs ) { return false; }
+      if ( lhs < rhs ) { std::swap( lhs, rhs ); }
+      uint32_t root = lhs;
+      if ( parents[lhs].compare_exchange_strong( root, rhs ) ) {
+        treeEdges[lhs] = edge;
+        return true;
+      }
+    }
+  };
+  auto select = [&]( const uint32_t root, const uint64_t edge ) {
+    uint64_t current = bestEdges[root].load();
+    while ( ( current == noEdge || heavier( edge, current ) ) &&
+            !bestEdges[root].compare_exchange_weak( current, edge ) ) {}
+  };
+  std::atomic<bool> merged( true );
+  while ( merged ) {
+    merged = false;
+    forEachRange( nbThread_, pointCount, [&]( const size_t begin, const size_t end ) {
+      for ( size_t i = begin; i < end; ++i ) {
+        roots[i] = find( uint32_t( i ) );
+        bestEdges[i].store( noEdge );
+      }
+    } );
+    // the edges inside the trees are dropped from the graph as they go
+    forEachRange( nbThread_, pointCount, [&]( const size_t begin, const size_t end ) {
+      for ( size_t i = begin; i < end; ++i ) {
+        uint32_t* row        = graph.data() + offsets[i];
+        uint32_t  degree     = 0;
+        uint64_t  best       = noEdge;
+        double    bestWeight = 0.0;
+        for ( uint32_t j = 0; j < degrees[i]; ++j ) {
+          const uint32_t n = row[j];
+          if ( roots[n] == roots[i] ) { continue; }
+          row[degree++]         = n;
+          const uint64_t edge   = uint64_t( i ) << 32 | n;
+          const double   weight = fabs( normals_[i] * normals_[n] );
+          if ( best == noEdge || weight > bestWeight || ( weight == bestWeight && heavier( edge, best ) ) ) {
+            best       = edge;
+            bestWeight = weight;
+          }
+        }
+        degrees[i] = degree;
+        if ( best != noEdge ) { select( roots[i], best ); }
+      }
+    } );
+    forEachRange( nbThread_, pointCount, [&]( const size_t begin, const size_t end ) {
+      for ( size_t i = begin; i < end; ++i ) {
+        const uint64_t edge = bestEdges[i].load();
+        if ( roots[i] == i && edge != noEdge && unite( edge ) ) { merged = true; }
+      }
+    } );
+  }
+
+  // propagation in the trees, rooted at their smallest index
+  std::vector<uint32_t> treeOffsets( pointCount + 1, 0 );
+  std::vector<uint32_t> treeNeighbors( pointCount > 0 ? 2 * ( pointCount - 1 ) : 0 );
+  for ( size_t i = 0; i < pointCount; ++i ) {
+    roots[i] = find( uint32_t( i ) );
+    if ( treeEdges[i] != noEdge ) {
+      ++treeOffsets[( treeEdges[i] >> 32 ) + 1];
+      ++treeOffsets[uint32_t( treeEdges[i] ) + 1];
+    }
+  }
+  for ( size_t i = 0; i < pointCount; ++i ) { treeOffsets[i + 1] += treeOffsets[i]; }
+  std::vector<uint32_t> treeDegrees( pointCount, 0 );
+  std::vector<uint32_t> treeRoots;
+  for ( size_t i = 0; i < pointCount; ++i ) {
+    if ( treeEdges[i] != noEdge ) {
+      const uint32_t start = uint32_t( treeEdges[i] >> 32 );
+      const uint32_t end   = uint32_t( treeEdges[i] );
+      treeNeighbors[treeOffsets[start] + treeDegrees[start]++] = end;
+      treeNeighbors[treeOffsets[end] + treeDegrees[end]++]     = start;
+    }
+    if ( roots[i] == i ) { treeRoots.push_back( uint32_t( i ) ); }
+  }
+  forEachRange( nbThread_, treeRoots.size(), [&]( const size_t begin, const size_t end ) {
+    std::vector<std::pair<uint32_t, uint32_t>> stack;
+    for ( size_t t = begin; t < end; ++t ) {
+      stack.emplace_back( treeRoots[t], treeRoots[t] );
+      while ( !stack.empty() ) {
+        const uint32_t current = stack.back().first;
+        const uint32_t parent  = stack.back().second;
+        stack.pop_back();
+        for ( uint32_t j = treeOffsets[current]; j < treeOffsets[current + 1]; ++j ) {
+          const uint32_t n = treeNeighbors[j];
+          if ( n == parent ) { continue; }
+          if ( normals_[current] * normals_[n] < 0.0 ) { normals_[n] = -normals_[n]; }
+          stack.emplace_back( n, current );
+        }
+      }
+    }
+  } );
+  std::vector<uint8_t> flipped( pointCount, 0 );
+  auto orientedNormal = [&]( const size_t i ) { return flipped[roots[i]] != 0u ? -normals_[i] : normals_[i]; };
+  PCCNNResult result;
+  for ( const auto root : treeRoots ) {
+    kdtree.search( pointCloud[root], neighborCount, result );
+    PCCVector3D accumulatedNormals( 0.0 );
+    size_t      numberOfNormals = 0;
+    for ( size_t j = 0; j < result.count(); ++j ) {
+      const size_t n = result.indices( j );
+      if ( roots[n] < root ) {
+        accumulatedNormals += orientedNormal( n );
+        ++numberOfNormals;
+      }
+    }
+    if ( numberOfNormals == 0u ) {
+      if ( root != 0u ) {
+        accumulatedNormals = orientedNormal( root - 1 );
+      } else {
+        accumulatedNormals = ( params.viewPoint_ - pointCloud[root] );
+      }
+    }
+    if ( normals_[root] * accumulatedNormals < 0.0 ) { flipped[root] = 1; }
+  }
+  forEachRange( nbThread_, pointCount, [&]( const size_t begin, const size_t end ) {
+    for ( size_t i = begin; i < end; ++i ) {
+      if ( flipped[roots[i]] != 0u ) { normals_[i] = -normals_[i]; }
+    }
+  } );
+}
 void PCCNormalsGenerator3::addNeighbors( const uint32_t      current,
                                          const PCCPointSet3& pointCloud,
                                          const PCCKdTree&    kdtree,
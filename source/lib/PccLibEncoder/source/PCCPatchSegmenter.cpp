@@ -41,6 +41,8 @@
 #include <tbb/tbb.h>
 #endif
 
+#include <atomic>
+
 using namespace pcc;
 
 void PCCPatchSegmenter3::setNbThread( size_t nbThread ) {
@@ -86,7 +88,7 @@ void PCCPatchSegmenter3::compute( const PCCPointSet3&                 geometry,
     geometryVox = geometry;
   }
   std::cout << "  Computing normals for original point cloud... ";
-  PCCKdTree            kdtree( geometryVox );
+  PCCKdTree            kdtree( geometryVox, nnSearchEngine_ );
   PCCNNResult          result;
   PCCNormalsGenerator3 normalsGen;
   auto                 normalsOrientation = static_cast<PCCNormalsGeneratorOrientation>( params.normalOrientation_ );
@@ -136,7 +138,7 @@ void PCCPatchSegmenter3::compute( const PCCPointSet3&                 geometry,
     applyVoxelsDataToPoints( geometry.getPointCount(), params.geometryBitDepth3D_,
                              params.voxelDimensionGridBasedSegmentation_, voxels, geometryVox, normalsGen, partition );
     std::cout << "[done]" << std::endl;
-    kdtree.init( geometry );
+    kdtree.init( geometry, nnSearchEngine_ );
   }
   std::cout << "  Patch segmentation... ";
   PCCPointSet3        resampled;
@@ -264,30 +266,37 @@ void PCCPatchSegmenter3::initialSegmentation( const PCCPointSet3&         geomet
 #endif
 }
 
-void PCCPatchSegmenter3::computeAdjacencyInfo( const PCCPointSet3&               pointCloud,
-                                               const PCCKdTree&                  kdtree,
-                                               std::vector<std::vector<size_t>>& adj,
-                                               const size_t                      maxNNCount ) {
+void PCCPatchSegmenter3::computeAdjacencyInfo( const PCCPointSet3& pointCloud,
+                                               const PCCKdTree&    kdtree,
+                                               PCCNeighborGraph&   adj,
+                                               const size_t        maxNNCount,
+                                               const bool          withDistances ) {
   const size_t pointCount = pointCloud.getPointCount();
-  adj.resize( pointCount );
+  adj.init( pointCount, maxNNCount, withDistances );
+  // one result per range of points: the results of more than PCCNNResult::inlineCapacity neighbours are reused
 #if defined( ENABLE_TBB )
   tbb::task_arena limited( static_cast<int>( nbThread_ ) );
   limited.execute( [&] {
-    tbb::parallel_for( size_t( 0 ), pointCount, [&]( const size_t i ) {
+    tbb::parallel_for( tbb::blocked_range<size_t>( 0, pointCount ), [&]( const tbb::blocked_range<size_t>& range ) {
+      const size_t begin = range.begin();
+      const size_t end   = range.end();
 #else
-  for ( size_t i = 0; i < pointCount; i++ ) {
+  {
+    const size_t begin = 0;
+    const size_t end   = pointCount;
 #endif
       PCCNNResult result;
-      kdtree.search( pointCloud[i], maxNNCount, result );
-      std::vector<size_t>& neighbors = adj[i];
-      neighbors.resize( result.count() );
-      for ( size_t j = 0; j < result.count(); ++j ) { neighbors[j] = result.indices( j ); }
+      for ( size_t i = begin; i < end; ++i ) {
+        kdtree.search( pointCloud[i], maxNNCount, result );
+        adj.setNeighbors( i, result );
+      }
 #if defined( ENABLE_TBB )
-      } );
     } );
+  } );
 #else
   }
 #endif
+  adj.finalize();
 }
 
 void PCCPatchSegmenter3::computeAdjacencyInfoInRadius( const PCCPointSet3&                 pointCloud,
@@ -300,47 +309,133 @@ void PCCPatchSegmenter3::computeAdjacencyInfoInRadius( const PCCPointSet3&
 #if defined( ENABLE_TBB )
   tbb::task_arena limited( static_cast<int>( nbThread_ ) );
   limited.execute( [&] {
-    tbb::parallel_for( size_t( 0 ), pointCount, [&]( const size_t i ) {
+    tbb::parallel_for( tbb::blocked_range<size_t>( 0, pointCount ), [&]( const tbb::blocked_range<size_t>& range ) {
+      const size_t begin = range.begin();
+      const size_t end   = range.end();
 #else
-  for ( size_t i = 0; i < pointCount; i++ ) {
+  {
+    const size_t begin = 0;
+    const size_t end   = pointCount;
 #endif
       PCCNNResult result;
-      kdtree.searchRadius( pointCloud[i], maxNNCount, radius, result );
-      std::vector<uint32_t>& neighbors = adj[i];
-      neighbors.resize( result.count() );
-      for ( size_t j = 0; j < result.count(); ++j ) { neighbors[j] = result.indices( j ); }
+      for ( size_t i = begin; i < end; ++i ) {
+        kdtree.searchRadius( pointCloud[i], maxNNCount, radius, result );
+        std::vector<uint32_t>& neighbors = adj[i];
+        neighbors.resize( result.count() );
+        for ( size_t j = 0; j < result.count(); ++j ) { neighbors[j] = result.indices( j ); }
+      }
 #if defined( ENABLE_TBB )
-      } );
     } );
+  } );
 #else
   }
 #endif
 }
 
-void PCCPatchSegmenter3::computeAdjacencyInfoDist( const PCCPointSet3&               pointCloud,
-                                                   const PCCKdTree&                  kdtree,
-                                                   std::vector<std::vector<size_t>>& adj,
-                                                   std::vector<std::vector<double>>& adjDist,
-                                                   const size_t                      maxNNCount ) {
-  const size_t pointCount = pointCloud.getPointCount();
-  adj.resize( pointCount );
-  adjDist.resize( pointCount );
+void PCCPatchSegmenter3::extractConnectedComponents( const PCCNeighborGraph&           adj,
+                                                     const std::vector<size_t>&        partition,
+                                                     const std::vector<size_t>&        rawPoints,
+                                                     const std::vector<double>&        rawPointsDistance,
+                                                     const double                      maxAllowedDist2RawPointsDetection,
+                                                     const size_t                      minPointCountPerCC,
+                                                     std::vector<std::vector<size_t>>& connectedComponents ) {
+  // The components are grown from the seeds, in the order of rawPoints, along the edges between raw points of the
+  // same partition, each seed taking the points not reached by the previous ones. Since the neighbourhood graph is
+  // directed, a component is not a connected component of the graph but always lies in the undirected one of its
+  // seed: these are labelled first with a lock-free union-find linking every root under the smallest index, then the
+  // seeds of the different labels are grown independently and the components are put back in the order of the seeds.
+  // With a single thread, all the seeds are grown in one label as the labelling would only cost time.
+#if defined( ENABLE_TBB )
+  const size_t threadCount = nbThread_ > 0 ? nbThread_ : tbb::task_scheduler_init::default_num_threads();
+#else
+  const size_t threadCount = 1;
+#endif
+  const size_t                       pointCount = adj.getPointCount();
+  std::vector<uint8_t>               flags( pointCount, 0 );
+  std::vector<std::atomic<uint32_t>> parents( threadCount > 1 ? pointCount : 0 );
+  for ( const auto i : rawPoints ) { flags[i] = 1; }
+  for ( size_t i = 0; i < parents.size(); ++i ) { parents[i].store( static_cast<uint32_t>( i ) ); }
+  auto find = [&parents]( uint32_t i ) {
+    uint32_t parent = parents[i].load();
+    while ( parent != i ) {
+      const uint32_t grandParent = parents[parent].load();
+      if ( grandParent != parent ) { parents[i].compare_exchange_weak( parent, grandParent ); }
+      i      = grandParent;
+      parent = parents[i].load();
+    }
+    return i;
+  };
 #if defined( ENABLE_TBB )
   tbb::task_arena limited( static_cast<int>( nbThread_ ) );
+  if ( threadCount > 1 ) {
+    auto unite = [&parents, &find]( uint32_t a, uint32_t b ) {
+      while ( true ) {
+        a = find( a );
+        b = find( b );
+        if ( a == b ) { return; }
+        if ( a < b ) { std::swap( a, b ); }
+        uint32_t root = a;
+        if ( parents[a].compare_exchange_strong( root, b ) ) { return; }
+      }
+    };
+    limited.execute( [&] {
+      tbb::parallel_for( size_t( 0 ), rawPoints.size(), [&]( const size_t k ) {
+        const size_t i    = rawPoints[k];
+        uint32_t     root = find( static_cast<uint32_t>( i ) );
+        for ( const auto n : adj[i] ) {
+          if ( flags[n] && partition[n] == partition[i] && find( n ) != root ) {
+            unite( root, n );
+            root = find( root );
+          }
+        }
+      } );
+    } );
+  }
+#endif
+
+  // seeds of each label, as positions in rawPoints
+  std::vector<uint32_t>            labels( pointCount, ( std::numeric_limits<uint32_t>::max )() );
+  std::vector<std::vector<size_t>> seeds;
+  for ( size_t k = 0; k < rawPoints.size(); ++k ) {
+    const size_t i = rawPoints[k];
+    if ( rawPointsDistance[i] > maxAllowedDist2RawPointsDetection ) {
+      const uint32_t root = threadCount > 1 ? find( static_cast<uint32_t>( i ) ) : 0;
+      if ( labels[root] == ( std::numeric_limits<uint32_t>::max )() ) {
+        labels[root] = static_cast<uint32_t>( seeds.size() );
+        seeds.emplace_back();
+      }
+      seeds[labels[root]].push_back( k );
+    }
+  }
+  std::vector<std::vector<std::pair<size_t, std::vector<size_t>>>> componentsPerLabel( seeds.size() );
+#if defined( ENABLE_TBB )
   limited.execute( [&] {
-    tbb::parallel_for( size_t( 0 ), pointCount, [&]( const size_t i ) {
+    tbb::parallel_for( size_t( 0 ), seeds.size(), [&]( const size_t label ) {
 #else
-  for ( size_t i = 0; i < pointCount; i++ ) {
+  for ( size_t label = 0; label < seeds.size(); ++label ) {
 #endif
-      PCCNNResult result;
-      kdtree.search( pointCloud[i], maxNNCount, result );
-      std::vector<size_t>& neighbors     = adj[i];
-      std::vector<double>& neighborsDist = adjDist[i];
-      neighbors.resize( result.count() );
-      neighborsDist.resize( result.count() );
-      for ( size_t j = 0; j < result.count(); ++j ) {
-        neighbors[j]     = result.indices( j );
-        neighborsDist[j] = result.dist( j );
+      std::vector<size_t> fifo;
+      for ( const auto k : seeds[label] ) {
+        const size_t i = rawPoints[k];
+        if ( !flags[i] ) { continue; }
+        flags[i] = 0;
+        const size_t        clusterIndex = partition[i];
+        std::vector<size_t> connectedComponent( 1, i );
+        fifo.push_back( i );
+        while ( !fifo.empty() ) {
+          const size_t current = fifo.back();
+          fifo.pop_back();
+          for ( const auto n : adj[current] ) {
+            if ( clusterIndex == partition[n] && flags[n] ) {
+              flags[n] = 0;
+              fifo.push_back( n );
+              connectedComponent.push_back( n );
+            }
+          }
+        }
+        if ( connectedComponent.size() >= minPointCountPerCC ) {
+          componentsPerLabel[label].emplace_back( k, std::move( connectedComponent ) );
+        }
       }
 #if defined( ENABLE_TBB )
     } );
@@ -348,6 +443,21 @@ void PCCPatchSegmenter3::computeAdjacencyInfoDist( const PCCPointSet3&
 #else
   }
 #endif
+
+  std::vector<std::pair<size_t, std::vector<size_t>>> components;
+  for ( auto& labelComponents : componentsPerLabel ) {
+    for ( auto& component : labelComponents ) { components.push_back( std::move( component ) ); }
+  }
+  std::sort( components.begin(), components.end(),
+             []( const std::pair<size_t, std::vector<size_t>>& a, const std::pair<size_t, std::vector<size_t>>& b ) {
+               return a.first < b.first;
+             } );
+  connectedComponents.clear();
+  connectedComponents.reserve( components.size() );
+  for ( auto& component : components ) {
+    std::cout << "\t\t CC " << connectedComponents.size() << " -> " << component.second.size() << std::endl;
+    connectedComponents.push_back( std::move( component.second ) );
+  }
 }
 
 void printChunk( const std::vector<std::pair<int, int>>& chunk ) {
@@ -590,7 +700,6 @@ void PCCPatchSegmenter3::segmentPatches( const PCCPointSet3&                 poi
   const size_t pointCount             = points.getPointCount();
   patchPartition.resize( pointCount, 0 );
   resampledPatchPartition.reserve( pointCount );
-  PCCNNResult             result;
   std::vector<PCCColor3B> frame_pcc_color;
   frame_pcc_color.reserve( pointCount );
   for ( size_t i = 0; i < pointCount; i++ ) { frame_pcc_color.push_back( points.getColor( i ) ); }
@@ -600,19 +709,18 @@ void PCCPatchSegmenter3::segmentPatches( const PCCPointSet3&                 poi
   size_t numD1Points      = 0;
   size_t numEOMOnlyPoints = 0;
   std::cout << "\n\t Computing adjacency info... ";
-  std::vector<std::vector<size_t>>              adj;
-  std::vector<std::vector<double>>              adjDist;
-  std::vector<bool>                             flagExp;
-  int                                           numROIs;
-  int                                           numChunks;
-  std::vector<PCCPointSet3>                     pointsChunks;
-  std::vector<std::vector<size_t>>              pointsIndexChunks;
-  std::vector<size_t>                           pointCountChunks;
-  std::vector<PCCKdTree>                        kdtreeChunks;
-  std::vector<PCCBox3D>                         boundingBoxChunks;
-  std::vector<std::vector<std::vector<size_t>>> adjChunks;
+  PCCNeighborGraph                 adj;
+  std::vector<bool>                flagExp;
+  int                              numROIs;
+  int                              numChunks;
+  std::vector<PCCPointSet3>        pointsChunks;
+  std::vector<std::vector<size_t>> pointsIndexChunks;
+  std::vector<size_t>              pointCountChunks;
+  std::vector<PCCKdTree>           kdtreeChunks;
+  std::vector<PCCBox3D>            boundingBoxChunks;
+  std::vector<PCCNeighborGraph>    adjChunks;
   if ( patchExpansionEnabled ) {
-    computeAdjacencyInfoDist( points, kdtree, adj, adjDist, maxNNCount );
+    computeAdjacencyInfo( points, kdtree, adj, maxNNCount, true );
     flagExp.resize( pointCount, false );
   } else {
     if ( !enablePointCloudPartitioning ) {
@@ -751,7 +859,7 @@ void PCCPatchSegmenter3::segmentPatches( const PCCPointSet3&                 poi
       }
 
       for ( size_t chunkIndex = 0; chunkIndex < numChunks; ++chunkIndex ) {
-        kdtreeChunks[chunkIndex].init( pointsChunks[chunkIndex] );
+        kdtreeChunks[chunkIndex].init( pointsChunks[chunkIndex], nnSearchEngine_ );
       }
 
       adjChunks.resize( numChunks );
@@ -790,92 +898,35 @@ void PCCPatchSegmenter3::segmentPatches( const PCCPointSet3&                 poi
     }
   }
   subPointCloud.clear();
-  double meanPAB     = 0.0;
-  double meanYAB     = 0.0;
-  double meanUAB     = 0.0;
-  double meanVAB     = 0.0;
-  double meanPBA     = 0.0;
-  double meanYBA     = 0.0;
-  double meanUBA     = 0.0;
-  double meanVBA     = 0.0;
-  size_t testSrcNum  = 0;
-  size_t testRecNum  = 0;
-  size_t numberOfEOM = 0;
+  double meanPAB               = 0.0;
+  double meanYAB               = 0.0;
+  double meanUAB               = 0.0;
+  double meanVAB               = 0.0;
+  double meanPBA               = 0.0;
+  double meanYBA               = 0.0;
+  double meanUBA               = 0.0;
+  double meanVBA               = 0.0;
+  size_t testSrcNum            = 0;
+  size_t testRecNum            = 0;
+  size_t numberOfEOM           = 0;
+  size_t resampledIndexedCount = 0;
   while ( !rawPoints.empty() ) {
     std::vector<std::vector<size_t>> connectedComponents;
     if ( !enablePointCloudPartitioning ) {
-      std::vector<size_t> fifo;
-      fifo.reserve( pointCount );
-      std::vector<bool> flags;
-      flags.resize( pointCount, false );
-      for ( const auto i : rawPoints ) { flags[i] = true; }
-      connectedComponents.reserve( 256 );
-      for ( const auto i : rawPoints ) {
-        if ( flags[i] && rawPointsDistance[i] > maxAllowedDist2RawPointsDetection ) {
-          flags[i]                  = false;
-          const size_t indexCC      = connectedComponents.size();
-          const size_t clusterIndex = partition[i];
-          connectedComponents.resize( indexCC + 1 );
-          std::vector<size_t>& connectedComponent = connectedComponents[indexCC];
-          fifo.push_back( i );
-          connectedComponent.push_back( i );
-          while ( !fifo.empty() ) {
-            const size_t current = fifo.back();
-            fifo.pop_back();
-            for ( const auto n : adj[current] ) {
-              if ( clusterIndex == partition[n] && flags[n] ) {
-                flags[n] = false;
-                fifo.push_back( n );
-                connectedComponent.push_back( n );
-              }
-            }
-          }
-          if ( connectedComponent.size() < minPointCountPerCC ) {
-            connectedComponents.resize( indexCC );
-          } else {
-            std::cout << "\t\t CC " << indexCC << " -> " << connectedComponent.size() << std::endl;
-          }
-        }
-      }
-
+      extractConnectedComponents( adj, partition, rawPoints, rawPointsDistance, maxAllowedDist2RawPointsDetection,
+                                  minPointCountPerCC, connectedComponents );
       std::cout << " # CC " << connectedComponents.size() << std::endl;
     } else {
       std::vector<std::vector<std::vector<size_t>>> connectedComponentsChunks( numChunks );
       for ( size_t chunkIndex = 0; chunkIndex < numChunks; ++chunkIndex ) {
         std::cout << "\n\t Extracting connected components of chunk " << chunkIndex << "... ";
-        std::vector<size_t> fifo;
-        fifo.reserve( pointCountChunks[chunkIndex] );
-        std::vector<bool> flags;
-        flags.resize( pointCountChunks[chunkIndex], false );
-        for ( const auto i : rawPointsChunks[chunkIndex] ) { flags[i] = true; }
-        connectedComponentsChunks[chunkIndex].reserve( 256 );
-        for ( const auto i : rawPointsChunks[chunkIndex] ) {
-          if ( flags[i] && rawPointsDistanceChunks[chunkIndex][i] > maxAllowedDist2RawPointsDetection ) {
-            flags[i]                  = false;
-            const size_t indexCC      = connectedComponentsChunks[chunkIndex].size();
-            const size_t clusterIndex = partition[pointsIndexChunks[chunkIndex][i]];
-            connectedComponentsChunks[chunkIndex].resize( indexCC + 1 );
-            std::vector<size_t>& connectedComponentChunk = connectedComponentsChunks[chunkIndex][indexCC];
-            fifo.push_back( i );
-            connectedComponentChunk.push_back( i );
-            while ( !fifo.empty() ) {
-              const size_t current = fifo.back();
-              fifo.pop_back();
-              for ( const auto n : adjChunks[chunkIndex][current] ) {
-                if ( clusterIndex == partition[pointsIndexChunks[chunkIndex][n]] && flags[n] ) {
-                  flags[n] = false;
-                  fifo.push_back( n );
-                  connectedComponentChunk.push_back( n );
-                }
-              }
-            }
-            if ( connectedComponentChunk.size() < minPointCountPerCC ) {
-              connectedComponentsChunks[chunkIndex].resize( indexCC );
-            } else {
-              std::cout << "\t\t CC " << indexCC << " -> " << connectedComponentChunk.size() << std::endl;
-            }
-          }
+        std::vector<size_t> partitionChunk( pointCountChunks[chunkIndex] );
+        for ( size_t i = 0; i < pointCountChunks[chunkIndex]; ++i ) {
+          partitionChunk[i] = partition[pointsIndexChunks[chunkIndex][i]];
         }
+        extractConnectedComponents( adjChunks[chunkIndex], partitionChunk, rawPointsChunks[chunkIndex],
+                                    rawPointsDistanceChunks[chunkIndex], maxAllowedDist2RawPointsDetection,
+                                    minPointCountPerCC, connectedComponentsChunks[chunkIndex] );
         std::cout << "[done]" << std::endl;
       }
 
@@ -907,10 +958,36 @@ void PCCPatchSegmenter3::segmentPatches( const PCCPointSet3&                 poi
       std::sort( connectedComponents.begin(), connectedComponents.end(),
                  []( const std::vector<size_t>& a, const std::vector<size_t>& b ) { return a.size() >= b.size(); } );
     }
-    for ( auto& connectedComponent : connectedComponents ) {
-      const size_t patchIndex = patches.size();
-      patches.resize( patchIndex + 1 );
-      if ( createSubPointCloud ) { subPointCloud.resize( patchIndex + 1 ); }
+    // the patches of the components are built independently in their own slots, and what they add to the shared
+    // resampled point cloud and statistics is gathered afterwards in the order of the components
+    struct PatchContribution {
+      bool                built = false;
+      PCCPointSet3        resampled;
+      std::vector<size_t> resampledPatchPartition;
+      size_t              d0Count      = 0;
+      size_t              d1Count      = 0;
+      size_t              eomCount     = 0;
+      size_t              testSrcCount = 0;
+      size_t              testRecCount = 0;
+      float               distPAB      = 0.F;
+      float               distPBA      = 0.F;
+      float               distYAB      = 0.F;
+      float               distYBA      = 0.F;
+      float               distUAB      = 0.F;
+      float               distUBA      = 0.F;
+      float               distVAB      = 0.F;
+      float               distVBA      = 0.F;
+    };
+    const size_t                   patchBaseIndex = patches.size();
+    const size_t                   componentCount = connectedComponents.size();
+    std::vector<PatchContribution> contributions( componentCount );
+    patches.resize( patchBaseIndex + componentCount );
+    if ( createSubPointCloud ) { subPointCloud.resize( patchBaseIndex + componentCount ); }
+    auto buildPatch = [&]( const size_t componentIndex ) {
+      auto&        connectedComponent = connectedComponents[componentIndex];
+      auto&        contribution       = contributions[componentIndex];
+      const size_t patchIndex         = patchBaseIndex + componentIndex;
+
       PCCPatch& patch            = patches[patchIndex];
       size_t    d0CountPerPatch  = 0;
       size_t    d1CountPerPatch  = 0;
@@ -953,7 +1030,7 @@ void PCCPatchSegmenter3::segmentPatches( const PCCPointSet3&                 poi
           if ( u - minU < params.maxPatchSize_ && v - minV < params.maxPatchSize_ ) { tempCC.push_back( i ); }
         }
         connectedComponent = tempCC;
-        if ( connectedComponent.empty() ) { continue; }
+        if ( connectedComponent.empty() ) { return; }
       }
 
       const int16_t projectionDirectionType = -2 * patch.getProjectionMode() + 1;
@@ -970,8 +1047,8 @@ void PCCPatchSegmenter3::segmentPatches( const PCCPointSet3&                 poi
                  ( clusterIndex + 3 == partition[n] ) || ( clusterIndex == partition[n] + 3 ) ) {
               continue;
             }
-            const double dist2 = adjDist[i][ac];  // sum of square
-            if ( dist2 <= 2 ) {                   // <-- expansion distance
+            const double dist2 = adj.getDistance( i, ac );  // sum of square
+            if ( dist2 <= 2 ) {                             // <-- expansion distance
               fifoa.push_back( n );
               flagExp[n] = true;  // add point
             }
@@ -1196,7 +1273,7 @@ void PCCPatchSegmenter3::segmentPatches( const PCCPointSet3&                 poi
       rec.resize( 0 );
       std::vector<size_t> pointCount;
       pointCount.resize( 3 );
-      resampledPointcloud( pointCount, resampled, resampledPatchPartition, patch, patchIndex,
+      resampledPointcloud( pointCount, contribution.resampled, contribution.resampledPatchPartition, patch, patchIndex,
                            params.mapCountMinus1_ > 0, surfaceThickness, EOMFixBitCount, bIsAdditionalProjectionPlane,
                            useEnhancedOccupancyMapCode, geometryBitDepth3D, createSubPointCloud, rec );
 
@@ -1233,30 +1310,17 @@ void PCCPatchSegmenter3::segmentPatches( const PCCPointSet3&                 poi
         }
         for ( const auto& p : rec.getPositions() ) { testRec.addPoint( p ); }
         testSrc.transferColorSimple( testRec );
-        float distPAB;
-        float distPBA;
-        float distYAB;
-        float distYBA;
-        float distUAB;
-        float distUBA;
-        float distVAB;
-        float distVBA;
         testRec.removeDuplicate();
-        testSrc.distanceGeoColor( testRec, distPAB, distPBA, distYAB, distYBA, distUAB, distUBA, distVAB, distVBA );
-        meanPAB += distPAB * testSrc.getPointCount();
-        meanPBA += distPBA * testRec.getPointCount();
-        meanYAB += distYAB * testSrc.getPointCount();
-        meanYBA += distYBA * testRec.getPointCount();
-        meanUAB += distUAB * testSrc.getPointCount();
-        meanUBA += distUBA * testRec.getPointCount();
-        meanVAB += distVAB * testSrc.getPointCount();
-        meanVBA += distVBA * testRec.getPointCount();
-        testSrcNum += testSrc.getPointCount();
-        testRecNum += testRec.getPointCount();
-
-        auto& sub = subPointCloud[subPointCloud.size() - 1];
+        testSrc.distanceGeoColor( testRec, contribution.distPAB, contribution.distPBA, contribution.distYAB,
+                                  contribution.distYBA, contribution.distUAB, contribution.distUBA,
+                                  contribution.distVAB, contribution.distVBA );
+        contribution.testSrcCount = testSrc.getPointCount();
+        contribution.testRecCount = testRec.getPointCount();
+
+        auto& sub = subPointCloud[patchIndex];
         sub.resize( 0 );
-        PCCKdTree kdtreeRec( rec );
+        PCCKdTree   kdtreeRec( rec, nnSearchEngine_ );
+        PCCNNResult result;
         for ( const auto i : connectedComponent ) {
           kdtreeRec.search( points[i], 1, result );
           const double dist2 = result.dist( 0 );
@@ -1279,23 +1343,93 @@ void PCCPatchSegmenter3::segmentPatches( const PCCPointSet3&                 poi
       patch.setEOMandD1Count( eomCountPerPatch );
       if ( useEnhancedOccupancyMapCode ) { patch.setEOMCount( eomCountPerPatch - d1CountPerPatch ); }
       patch.setD0Count( d0CountPerPatch );
-      numberOfEOM += ( eomCountPerPatch - d1CountPerPatch );
-      numD0Points += d0CountPerPatch;
-      numD1Points += d1CountPerPatch;
-      if ( useEnhancedOccupancyMapCode ) { numEOMOnlyPoints += ( eomCountPerPatch - d1CountPerPatch ); }
+      contribution.d0Count  = d0CountPerPatch;
+      contribution.d1Count  = d1CountPerPatch;
+      contribution.eomCount = eomCountPerPatch;
+      contribution.built    = true;
+    };
+    if ( patchExpansionEnabled || enablePointCloudPartitioning ) {
+      // the expansion of a patch depends on the previous ones and the components of overlapping chunks share points
+      for ( size_t componentIndex = 0; componentIndex < componentCount; ++componentIndex ) {
+        buildPatch( componentIndex );
+      }
+    } else {
+#if defined( ENABLE_TBB )
+      tbb::task_arena limited( static_cast<int>( nbThread_ ) );
+      limited.execute( [&] { tbb::parallel_for( size_t( 0 ), componentCount, buildPatch ); } );
+#else
+      for ( size_t componentIndex = 0; componentIndex < componentCount; ++componentIndex ) {
+        buildPatch( componentIndex );
+      }
+#endif
+    }
+    for ( size_t componentIndex = 0; componentIndex < componentCount; ++componentIndex ) {
+      auto& contribution = contributions[componentIndex];
+      if ( !contribution.built ) { continue; }
+      const size_t patchIndex      = patchBaseIndex + componentIndex;
+      const auto&  patch           = patches[patchIndex];
+      const size_t resampledOffset = resampled.getPointCount();
+      resampled.resize( resampledOffset + contribution.resampled.getPointCount() );
+      for ( size_t i = 0; i < contribution.resampled.getPointCount(); ++i ) {
+        resampled.setPosition( resampledOffset + i, contribution.resampled[i] );
+      }
+      resampledPatchPartition.insert( resampledPatchPartition.end(), contribution.resampledPatchPartition.begin(),
+                                      contribution.resampledPatchPartition.end() );
+      contribution.resampled.clear();
+      if ( createSubPointCloud ) {
+        meanPAB += contribution.distPAB * contribution.testSrcCount;
+        meanPBA += contribution.distPBA * contribution.testRecCount;
+        meanYAB += contribution.distYAB * contribution.testSrcCount;
+        meanYBA += contribution.distYBA * contribution.testRecCount;
+        meanUAB += contribution.distUAB * contribution.testSrcCount;
+        meanUBA += contribution.distUBA * contribution.testRecCount;
+        meanVAB += contribution.distVAB * contribution.testSrcCount;
+        meanVBA += contribution.distVBA * contribution.testRecCount;
+        testSrcNum += contribution.testSrcCount;
+        testRecNum += contribution.testRecCount;
+      }
+      numberOfEOM += ( contribution.eomCount - contribution.d1Count );
+      numD0Points += contribution.d0Count;
+      numD1Points += contribution.d1Count;
+      if ( useEnhancedOccupancyMapCode ) { numEOMOnlyPoints += ( contribution.eomCount - contribution.d1Count ); }
       std::cout << "\t\t Patch " << patchIndex << " ->(d1,u1,v1)=( " << patch.getD1() << " , " << patch.getU1() << " , "
                 << patch.getV1() << " )(dd,du,dv)=( " << patch.getSizeD() << " , " << patch.getSizeU() << " , "
                 << patch.getSizeV() << " ),Normal: " << size_t( patch.getNormalAxis() )
                 << " Direction: " << patch.getProjectionMode() << " EOM: " << patch.getEOMCount() << std::endl;
     }
-    PCCKdTree kdtreeResampled( resampled );
-    rawPoints.resize( 0 );
-    for ( size_t i = 0; i < pointCount; ++i ) {
-      kdtreeResampled.search( points[i], 1, result );
-      const double dist2   = result.dist( 0 );
-      rawPointsDistance[i] = dist2;
-      if ( dist2 > maxAllowedDist2RawPointsSelection ) { rawPoints.push_back( i ); }
+    // the resampled points only grow: the points that are no longer raw stay so, and the distances of the
+    // remaining raw points are only updated with the points resampled by the patches of this iteration
+    PCCPointSet3 resampledNew;
+    resampledNew.resize( resampled.getPointCount() - resampledIndexedCount );
+    for ( size_t i = 0; i < resampledNew.getPointCount(); ++i ) {
+      resampledNew.setPosition( i, resampled[resampledIndexedCount + i] );
+    }
+    resampledIndexedCount = resampled.getPointCount();
+    if ( resampledNew.getPointCount() > 0 ) {
+      PCCKdTree kdtreeResampled( resampledNew, nnSearchEngine_ );
+#if defined( ENABLE_TBB )
+      tbb::task_arena limited( static_cast<int>( nbThread_ ) );
+      limited.execute( [&] {
+        tbb::parallel_for( size_t( 0 ), rawPoints.size(), [&]( const size_t k ) {
+#else
+      for ( size_t k = 0; k < rawPoints.size(); ++k ) {
+#endif
+          PCCNNResult  result;
+          const size_t i = rawPoints[k];
+          kdtreeResampled.search( points[i], 1, result );
+          rawPointsDistance[i] = ( std::min )( rawPointsDistance[i], double( result.dist( 0 ) ) );
+#if defined( ENABLE_TBB )
+        } );
+      } );
+#else
+      }
+#endif
+    }
+    size_t rawPointCount = 0;
+    for ( const auto i : rawPoints ) {
+      if ( rawPointsDistance[i] > maxAllowedDist2RawPointsSelection ) { rawPoints[rawPointCount++] = i; }
     }
+    rawPoints.resize( rawPointCount );
     if ( enablePointCloudPartitioning ) {
       // update rawPointsChunks using rawPoints
       std::set<size_t>                 rawPointsSet( rawPoints.begin(), rawPoints.end() );
@@ -1329,12 +1463,12 @@ void PCCPatchSegmenter3::refineSegmentation( const PCCPointSet3&         pointCl
                                              const size_t                iterationCount,
                                              std::vector<size_t>&        partition ) {
   assert( orientations );
-  std::vector<std::vector<size_t>> adj;
+  PCCNeighborGraph adj;
   computeAdjacencyInfo( pointCloud, kdtree, adj, maxNNCount );
-  const size_t                     pointCount = pointCloud.getPointCount();
-  const double                     weight     = lambda / maxNNCount;
-  std::vector<size_t>              tempPartition( pointCount );
-  std::vector<std::vector<size_t>> scoresSmooth( pointCount, std::vector<size_t>( orientationCount ) );
+  const size_t          pointCount = pointCloud.getPointCount();
+  const double          weight     = lambda / maxNNCount;
+  std::vector<size_t>   tempPartition( pointCount );
+  std::vector<uint32_t> scoresSmooth( pointCount * orientationCount );
   for ( size_t k = 0; k < iterationCount; ++k ) {
 #if defined( ENABLE_TBB )
     tbb::task_arena limited( static_cast<int>( nbThread_ ) );
@@ -1343,9 +1477,9 @@ void PCCPatchSegmenter3::refineSegmentation( const PCCPointSet3&         pointCl
 #else
     for ( size_t i = 0; i < pointCount; i++ ) {
 #endif
-        auto& scoreSmooth = scoresSmooth[i];
-        std::fill( scoreSmooth.begin(), scoreSmooth.end(), 0 );
-        for ( auto& neighbor : adj[i] ) { ++scoreSmooth[partition[neighbor]]; }
+        uint32_t* scoreSmooth = scoresSmooth.data() + i * orientationCount;
+        std::fill( scoreSmooth, scoreSmooth + orientationCount, 0 );
+        for ( const auto neighbor : adj[i] ) { ++scoreSmooth[partition[neighbor]]; }
 #if defined( ENABLE_TBB )
       } );
     } );
@@ -1361,7 +1495,7 @@ void PCCPatchSegmenter3::refineSegmentation( const PCCPointSet3&         pointCl
         const PCCVector3D normal       = normalsGen.getNormal( i );
         size_t            clusterIndex = partition[i];
         double            bestScore    = 0.0;
-        const auto&       scoreSmooth  = scoresSmooth[i];
+        const uint32_t*   scoreSmooth  = scoresSmooth.data() + i * orientationCount;
         for ( size_t j = 0; j < orientationCount; ++j ) {
           const double scoreNormal = normal * orientations[j];
           const double score       = scoreNormal + weight * scoreSmooth[j];
@@ -1379,7 +1513,6 @@ void PCCPatchSegmenter3::refineSegmentation( const PCCPointSet3&         pointCl
 #endif
     swap( tempPartition, partition );
   }
-  for ( auto& vector : scoresSmooth ) { vector.clear(); }
   scoresSmooth.clear();
 }
 
@@ -1458,7 +1591,7 @@ void PCCPatchSegmenter3::refineSegmentationGridBased( const PCCPointSet3&
   }
 
   // a step for searching adjacents voxels of each voxel within the voxSearchRadius
-  PCCKdTree                          kdtree( gridCenters );
+  PCCKdTree                          kdtree( gridCenters, nnSearchEngine_ );
   const size_t                       voxSearchRadius  = searchRadius >> voxDimShift;
   const size_t                       maxNeighborCount = ( std::numeric_limits<int16_t>::max )();
   std::vector<std::vector<uint32_t>> adj( gridCenters.getPointCount() );
@@ -1580,7 +1713,7 @@ void PCCPatchSegmenter3::separateHighGradientPoints( const PCCPointSet3&
                                                      const double                      minGradient,
                                                      const size_t                      minNumHighGradientPoints,
                                                      std::vector<size_t>&              partition,
-                                                     std::vector<std::vector<size_t>>& adj,
+                                                     const PCCNeighborGraph&           adj,
                                                      std::vector<std::vector<size_t>>& connectedComponents ) {
   // detect and remove high gradient points
   std::vector<std::vector<size_t>> highGradientConnectedComponents;
@@ -1767,7 +1900,7 @@ void PCCPatchSegmenter3::calculateGradient( const PCCPointSet3&               po
                                             const double                      minGradient,
                                             const size_t                      minNumHighGradientPoints,
                                             PCCPatch&                         patch,
-                                            std::vector<std::vector<size_t>>& adj,
+                                            const PCCNeighborGraph&           adj,
                                             std::vector<std::vector<size_t>>& highGradientConnectedComponents,
                                             std::vector<bool>&                isRemoved ) {
   /* for the case that the xyz components of a normal are the same:
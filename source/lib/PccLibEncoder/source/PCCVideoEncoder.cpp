@@ -44,13 +44,38 @@
 #else
 #include "PCCHDRToolsAppColorConverter.h"
 #endif
+#include <mutex>
 
 using namespace pcc;
 
+// serializes the compressions that can't run concurrently in the same process
+static std::mutex g_videoEncoderMutex;
+
 PCCVideoEncoder::PCCVideoEncoder() = default;
 
 PCCVideoEncoder::~PCCVideoEncoder() = default;
 
+bool PCCVideoEncoder::isThreadSafe( PCCCodecId codecId, const std::string& colorSpaceConversionPath ) {
+#ifdef USE_HDRTOOLS
+  // the HDRTools library converter is not reentrant
+  if ( !colorSpaceConversionPath.empty() ) { return false; }
+#else
+  (void)colorSpaceConversionPath;
+#endif
+  switch ( codecId ) {
+#ifdef USE_HMAPP_VIDEO_CODEC
+    case HMAPP: return true;
+#endif
+#ifdef USE_SHMAPP_VIDEO_CODEC
+    case SHMAPP: return true;
+#endif
+#ifdef USE_JMAPP_VIDEO_CODEC
+    case JMAPP: return true;
+#endif
+    default: return false;
+  }
+}
+
 template <typename T>
 void PCCVideoEncoder::patchColorSubsmple( PCCVideo<T, 3>&    video,
                                           PCCContext&        contexts,
@@ -59,7 +84,7 @@ void PCCVideoEncoder::patchColorSubsmple( PCCVideo<T, 3>&    video,
                                           const std::string& configColorSpace,
                                           const std::string& colorSpaceConversionPath,
                                           const std::string& fileName ) {
-  printf( "Encoder convert : patchColorSubsampling\n" );
+  *log_ << "Encoder convert : patchColorSubsampling" << std::endl;
 
   std::shared_ptr<PCCVirtualColorConverter<T>> converter;
   if ( colorSpaceConversionPath.empty() ) {
@@ -248,7 +273,7 @@ void PCCVideoEncoder::patchColorSubsmple( PCCVideo<T, 3>&    video,
                 }
               }
             } else {
-              printf( "This condition should never occur, report an error" );
+              *log_ << "This condition should never occur, report an error";
               return;
             }
           }
@@ -306,6 +331,8 @@ bool PCCVideoEncoder::compress( PCCVideo<T, 3>&    video,
                                 const bool         patchColorSubsampling ) {
   auto& frames = video.getFrames();
   if ( frames.empty() || frames[0].getChannelCount() != 3 ) { return false; }
+  std::unique_lock<std::mutex> lock( g_videoEncoderMutex, std::defer_lock );
+  if ( !isThreadSafe( codecId, colorSpaceConversionPath ) ) { lock.lock(); }
   const size_t      width                = frames[0].getWidth();
   const size_t      height               = frames[0].getHeight();
   const size_t      depth                = nbyte == 1 ? 8 : 10;
@@ -342,7 +369,7 @@ bool PCCVideoEncoder::compress( PCCVideo<T, 3>&    video,
   // Convert src video
   if ( yuvVideo ) {
     if ( !use444CodecIo ) {
-      printf( "Encoder convert : write420 without conversion: %s \n", srcYuvFileName.c_str() );
+      *log_ << "Encoder convert : write420 without conversion: " << srcYuvFileName << " " << std::endl;
       if ( video.getColorFormat() == PCCCOLORFORMAT::YUV444 ) { video.convertYUV444ToYUV420(); }
     }
   } else {
@@ -379,21 +406,29 @@ bool PCCVideoEncoder::compress( PCCVideo<T, 3>&    video,
   params.shvcLayerIndex_              = shvcLayerIndex;
   params.shvcRateX_                   = shvcRateX;
   params.shvcRateY_                   = shvcRateY;
-  printf( "Encode: video size = %zu x %zu num frames = %zu \n", video.getWidth(), video.getHeight(),
-          video.getFrameCount() );
-  fflush( stdout );
+  params.useNamedPipes_               = useNamedPipes_;
+  *log_ << "Encode: video size = " << video.getWidth() << " x " << video.getHeight()
+         << " num frames = " << video.getFrameCount() << " " << std::endl;
   PCCVideo<T, 3> videoRec;
   auto           encoder = PCCVirtualVideoEncoder<T>::create( codecId );
   encoder->encode( video, params, bitstream, videoRec );
 
-  size_t frameIndex = 0;
+#ifdef CONFORMANCE_TRACE
+  std::string trace;
+  size_t      frameIndex = 0;
   for ( auto& image : videoRec ) {
-    TRACE_PICTURE( " IdxOutOrderCntVal = %d, ", frameIndex++ );
-    TRACE_PICTURE( " MD5checksumChan0 = %s, ", image.computeMD5( 0 ).c_str() );
-    TRACE_PICTURE( " MD5checksumChan1 = %s, ", image.computeMD5( 1 ).c_str() );
-    TRACE_PICTURE( " MD5checksumChan2 = %s \n", image.computeMD5( 2 ).c_str() );
+    trace += stringFormat( " IdxOutOrderCntVal = %d, ", (int)frameIndex++ );
+    trace += stringFormat( " MD5checksumChan0 = %s, ", image.computeMD5( 0 ).c_str() );
+    trace += stringFormat( " MD5checksumChan1 = %s, ", image.computeMD5( 1 ).c_str() );
+    trace += stringFormat( " MD5checksumChan2 = %s \n", image.computeMD5( 2 ).c_str() );
   }
-  TRACE_PICTURE( "Width =  %d, Height = %d \n", videoRec.getWidth(), videoRec.getHeight() );
+  trace += stringFormat( "Width =  %d, Height = %d \n", (int)videoRec.getWidth(), (int)videoRec.getHeight() );
+  if ( deferPictureTrace_ ) {
+    pictureTrace_ += trace;
+  } else {
+    TRACE_PICTURE( "%s", trace.c_str() );
+  }
+#endif
 
   if ( keepIntermediateFiles ) {
     bitstream.write( binFileName );
@@ -0,0 +1,101 @@
+/* The copyright in this software is being made available under the BSD
+ * License, included below. This software may be subject to other third party
+ * and contributor rights, including patent rights, and no such rights are
+ * granted under this license.
+ *
+ * Copyright (c) 2010-2017, ISO/IEC
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *  * Neither the name of the ISO/IEC nor the names of its contributors may
+ *    be used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF
+ * THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "PCCVideoEncoderGraph.h"
+#include "PCCLogger.h"
+#if defined( ENABLE_TBB )
+#include <tbb/tbb.h>
+#include <tbb/flow_graph.h>
+#endif
+
+using namespace pcc;
+
+PCCVideoEncoderGraph::PCCVideoEncoderGraph( PCCLogger& logger, size_t nbThread, bool useNamedPipes ) :
+    logger_( &logger ), nbThread_( nbThread ), useNamedPipes_( useNamedPipes ) {}
+
+PCCVideoEncoderGraph::~PCCVideoEncoderGraph() = default;
+
+size_t PCCVideoEncoderGraph::addNode( const std::string&         trace,
+                                      const Task&                task,
+                                      const std::vector<size_t>& dependencies ) {
+#ifndef NDEBUG
+  for ( auto& index : dependencies ) { assert( index < nodes_.size() ); }
+#endif
+  nodes_.resize( nodes_.size() + 1 );
+  auto& node         = nodes_.back();
+  node.trace_        = trace;
+  node.task_         = task;
+  node.dependencies_ = dependencies;
+  node.encoder_.setLogger( *logger_ );
+  node.encoder_.setUseNamedPipes( useNamedPipes_ );
+  return nodes_.size() - 1;
+}
+
+void PCCVideoEncoderGraph::run() {
+#if defined( ENABLE_TBB )
+  if ( nbThread_ != 1 && nodes_.size() > 1 ) {
+    typedef tbb::flow::continue_node<tbb::flow::continue_msg> FlowNode;
+    for ( auto& node : nodes_ ) {
+      node.encoder_.setDeferPictureTrace( true );
+      node.encoder_.setLog( node.log_ );
+    }
+    tbb::task_arena limited( nbThread_ > 0 ? static_cast<int>( nbThread_ ) : tbb::task_arena::automatic );
+    limited.execute( [&] {
+      tbb::flow::graph                       graph;
+      std::vector<std::unique_ptr<FlowNode>> flowNodes;
+      for ( auto& node : nodes_ ) {
+        flowNodes.emplace_back(
+            new FlowNode( graph, [&node]( const tbb::flow::continue_msg& ) { node.task_( node.encoder_ ); } ) );
+        for ( auto& index : node.dependencies_ ) { tbb::flow::make_edge( *flowNodes[index], *flowNodes.back() ); }
+      }
+      for ( size_t i = 0; i < nodes_.size(); i++ ) {
+        if ( nodes_[i].dependencies_.empty() ) { flowNodes[i]->try_put( tbb::flow::continue_msg() ); }
+      }
+      graph.wait_for_all();
+    } );
+    for ( auto& node : nodes_ ) {
+      std::cout << node.log_.str() << std::flush;
+      if ( !node.trace_.empty() ) { TRACE_PICTURE( "%s", node.trace_.c_str() ); }
+      if ( !node.encoder_.getPictureTrace().empty() ) {
+        TRACE_PICTURE( "%s", node.encoder_.getPictureTrace().c_str() );
+      }
+    }
+    nodes_.clear();
+    return;
+  }
+#endif
+  for ( auto& node : nodes_ ) {
+    if ( !node.trace_.empty() ) { TRACE_PICTURE( "%s", node.trace_.c_str() ); }
+    node.task_( node.encoder_ );
+  }
+  nodes_.clear();
+}
@@ -41,6 +41,7 @@
 namespace pcc {
 
 class PCCGroupOfFrames;
+class PCCPointSet3;
 
 class PCCChecksum {
  public:
@@ -55,6 +56,7 @@ class PCCChecksum {
   void computeReordered( PCCGroupOfFrames& groupOfFrames );
   void computeReconstructed( PCCGroupOfFrames& groupOfFrames );
   void computeDecoded( PCCGroupOfFrames& groupOfFrames );
+  void computeDecoded( PCCPointSet3& frame );
 
   bool compareSrcRec();
   bool compareRecDec();
@@ -36,6 +36,7 @@
 #include "PCCCommon.h"
 
 #include "PCCPointSet.h"
+#include "PCCKdTreeCache.h"
 #include "PCCMetricsParameters.h"
 
 namespace pcc {
@@ -56,7 +57,7 @@ class QualityMetrics {
 
   void setParameters( const PCCMetricsParameters& params );
 
-  void compute( const PCCPointSet3& cloudA, const PCCPointSet3& cloudB );
+  void compute( const PCCPointSet3& cloudA, const PCCPointSet3& cloudB, PCCKdTreeCache* kdtreeCache = nullptr );
 
   QualityMetrics operator+( const QualityMetrics& metric ) const;
 
@@ -101,6 +102,10 @@ class PCCMetrics {
   void display();
 
  private:
+  void computeQuality( const PCCPointSet3& source,
+                       const PCCPointSet3& reconstruct,
+                       PCCKdTreeCache*     kdtreeCache = nullptr );
+
   std::vector<size_t>         sourcePoints_;
   std::vector<size_t>         sourceDuplicates_;
   std::vector<size_t>         reconstructPoints_;
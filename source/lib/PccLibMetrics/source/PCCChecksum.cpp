@@ -78,13 +78,15 @@ void PCCChecksum::computeReconstructed( PCCGroupOfFrames& groupOfFrames ) {
 }
 
 void PCCChecksum::computeDecoded( PCCGroupOfFrames& groupOfFrames ) {
-  for ( auto& frame : groupOfFrames ) {
-    checksumsDec_.push_back( frame.computeChecksum() );
-    printf( "ChecksumDec: " );
-    for ( auto& c : checksumsDec_.back() ) { printf( "%02x", c ); }
-    printf( "\n" );
-    fflush( stdout );
-  }
+  for ( auto& frame : groupOfFrames ) { computeDecoded( frame ); }
+}
+
+void PCCChecksum::computeDecoded( PCCPointSet3& frame ) {
+  checksumsDec_.push_back( frame.computeChecksum() );
+  printf( "ChecksumDec: " );
+  for ( auto& c : checksumsDec_.back() ) { printf( "%02x", c ); }
+  printf( "\n" );
+  fflush( stdout );
 }
 
 void PCCChecksum::read( const std::string& compressedStreamPath ) {
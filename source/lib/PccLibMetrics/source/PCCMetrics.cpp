@@ -34,6 +34,7 @@
 #include "PCCGroupOfFrames.h"
 #include "PCCPointSet.h"
 #include "PCCKdTree.h"
+#include "PCCKdTreeCache.h"
 #include "PCCMetrics.h"
 
 using namespace std;
@@ -70,7 +71,9 @@ QualityMetrics::QualityMetrics() :
 
 void QualityMetrics::setParameters( const PCCMetricsParameters& params ) { params_ = params; }
 
-void QualityMetrics::compute( const PCCPointSet3& pointcloudA, const PCCPointSet3& pointcloudB ) {
+void QualityMetrics::compute( const PCCPointSet3& pointcloudA,
+                              const PCCPointSet3& pointcloudB,
+                              PCCKdTreeCache*     kdtreeCache ) {
   double maxC2c         = ( std::numeric_limits<double>::min )();
   double maxC2p         = ( std::numeric_limits<double>::min )();
   double sseC2p         = 0;
@@ -81,7 +84,8 @@ void QualityMetrics::compute( const PCCPointSet3& pointcloudA, const PCCPointSet
 
   psnr_ = params_.resolution_;
 
-  PCCKdTree    kdtree( pointcloudB );
+  auto kdtree =
+      kdtreeCache != nullptr ? kdtreeCache->get( pointcloudB ) : std::make_shared<const PCCKdTree>( pointcloudB );
   PCCNNResult  result;
   const size_t num_results_max  = 30;
   const size_t num_results_incr = 5;
@@ -92,7 +96,7 @@ void QualityMetrics::compute( const PCCPointSet3& pointcloudA, const PCCPointSet
     size_t num_results = 0;
     do {
       num_results += num_results_incr;
-      kdtree.search( pointcloudA[indexA], num_results, result );
+      kdtree->search( pointcloudA[indexA], num_results, result );
     } while ( result.dist( 0 ) == result.dist( num_results - 1 ) && num_results + num_results_incr <= num_results_max );
 
     // Compute point-to-point, which should be equal to sqrt( dist[0] )
@@ -348,12 +352,17 @@ void PCCMetrics::compute( const PCCGroupOfFrames& sources,
       sourceDuplicates_.push_back( source.getPointCount() );
       reconstructDuplicates_.push_back( reconstruct.getPointCount() );
       compute( source, reconstruct, normals.getFrameCount() == 0 ? normalEmpty : normals[i] );
+    } else if ( normals.getFrameCount() == 0 ) {
+      // the clouds are not modified: measure them in place and share the KD-trees built by the encoder
+      sourceDuplicates_.push_back( 0 );
+      reconstructDuplicates_.push_back( 0 );
+      computeQuality( sourceOrg, reconstructOrg, &sources.getKdTreeCache() );
     } else {
       source      = sourceOrg;
       reconstruct = reconstructOrg;
       sourceDuplicates_.push_back( 0 );
       reconstructDuplicates_.push_back( 0 );
-      compute( source, reconstruct, normals.getFrameCount() == 0 ? normalEmpty : normals[i] );
+      compute( source, reconstruct, normals[i] );
     }
   }
 }
@@ -363,12 +372,18 @@ void PCCMetrics::compute( PCCPointSet3& source, PCCPointSet3& reconstruct, const
     source.copyNormals( normalSource );
     reconstruct.scaleNormals( normalSource );
   }
+  computeQuality( source, reconstruct );
+}
+
+void PCCMetrics::computeQuality( const PCCPointSet3& source,
+                                 const PCCPointSet3& reconstruct,
+                                 PCCKdTreeCache*     kdtreeCache ) {
   QualityMetrics q1;
   QualityMetrics q2;
   q1.setParameters( params_ );
-  q1.compute( source, reconstruct );
+  q1.compute( source, reconstruct, kdtreeCache );
   q2.setParameters( params_ );
-  q2.compute( reconstruct, source );
+  q2.compute( reconstruct, source, kdtreeCache );
   quality1_.push_back( q1 );
   quality2_.push_back( q2 );
   qualityF_.push_back( q1 + q2 );
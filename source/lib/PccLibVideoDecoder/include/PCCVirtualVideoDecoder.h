@@ -53,7 +53,10 @@ class PCCVirtualVideoDecoder {
                        const std::string& decoderPath    = "",
                        const std::string& parameters     = "" ) = 0;
 
- public:
+  void setUseNamedPipes( bool value ) { useNamedPipes_ = value; }
+
+ protected:
+  bool useNamedPipes_ = false;
 };
 
 };  // namespace pcc
@@ -56,13 +56,23 @@ void PCCSHMAppVideoDecoder<T>::decode( PCCVideoBitstream& bitstream,
     }
   }
   std::cout << cmd.str() << '\n';
-  if ( pcc::system( cmd.str().c_str() ) ) {
-    std::cout << "Error: can't run system command!" << std::endl;
-    exit( -1 );
-  }
   PCCCOLORFORMAT format = isRGB[layerIndex_] ? PCCCOLORFORMAT::RGB444 : PCCCOLORFORMAT::YUV420;
   video.clear();
-  video.read( reconFile, width[layerIndex_], height[layerIndex_], format, outputBitDepth == 8 ? 1 : 2 );
+  if ( this->useNamedPipes_ && namedPipesSupported() && createNamedPipe( reconFile ) ) {
+    // stream the reconstructed video through a named pipe instead of an intermediate file
+    if ( systemWithNamedPipes( cmd.str().c_str(), "", nullptr, reconFile, [&]( std::istream& stream ) {
+           return video.read( stream, width[layerIndex_], height[layerIndex_], format, outputBitDepth == 8 ? 1 : 2 );
+         } ) ) {
+      std::cout << "Error: can't run system command with named pipes!" << std::endl;
+      exit( -1 );
+    }
+  } else {
+    if ( pcc::system( cmd.str().c_str() ) ) {
+      std::cout << "Error: can't run system command!" << std::endl;
+      exit( -1 );
+    }
+    video.read( reconFile, width[layerIndex_], height[layerIndex_], format, outputBitDepth == 8 ? 1 : 2 );
+  }
   printf( "File read size = %zu x %zu frame count = %zu \n", video.getWidth(), video.getHeight(),
           video.getFrameCount() );
 
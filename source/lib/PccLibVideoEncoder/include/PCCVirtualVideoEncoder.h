@@ -61,6 +61,7 @@ struct PCCVideoEncoderParameters {
   int32_t     shvcLayerIndex_              = 8;
   int32_t     shvcRateX_                   = 0;
   int32_t     shvcRateY_                   = 0;
+  bool        useNamedPipes_               = false;
 };
 
 template <class T>
@@ -90,14 +90,29 @@ void PCCHMAppVideoEncoder<T>::encode( PCCVideo<T, 3>&            videoSrc,
 
   std::cout << cmd.str() << std::endl;
 
-  videoSrc.write( srcYuvFileName, params.inputBitDepth_ == 8 ? 1 : 2 );
-  if ( pcc::system( cmd.str().c_str() ) ) {
-    std::cout << "Error: can't run system command!" << std::endl;
-    exit( -1 );
-  }
   PCCCOLORFORMAT format = getColorFormat( params.recYuvFileName_ );
   videoRec.clear();
-  videoRec.read( recYuvFileName, width, height, format, params.outputBitDepth_ == 8 ? 1 : 2 );
+  if ( params.useNamedPipes_ && namedPipesSupported() && createNamedPipe( srcYuvFileName ) &&
+       createNamedPipe( recYuvFileName ) ) {
+    // stream src and rec videos through named pipes instead of intermediate files
+    if ( systemWithNamedPipes(
+             cmd.str().c_str(), srcYuvFileName,
+             [&]( std::ostream& stream ) { return videoSrc.write( stream, params.inputBitDepth_ == 8 ? 1 : 2 ); },
+             recYuvFileName,
+             [&]( std::istream& stream ) {
+               return videoRec.read( stream, width, height, format, params.outputBitDepth_ == 8 ? 1 : 2 );
+             } ) ) {
+      std::cout << "Error: can't run system command with named pipes!" << std::endl;
+      exit( -1 );
+    }
+  } else {
+    videoSrc.write( srcYuvFileName, params.inputBitDepth_ == 8 ? 1 : 2 );
+    if ( pcc::system( cmd.str().c_str() ) ) {
+      std::cout << "Error: can't run system command!" << std::endl;
+      exit( -1 );
+    }
+    videoRec.read( recYuvFileName, width, height, format, params.outputBitDepth_ == 8 ? 1 : 2 );
+  }
   bitstream.read( binFileName );
   removeFile( srcYuvFileName );
   removeFile( recYuvFileName );
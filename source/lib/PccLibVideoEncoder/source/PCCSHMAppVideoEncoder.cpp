@@ -181,14 +181,29 @@ void PCCSHMAppVideoEncoder<T>::encode( PCCVideo<T, 3>&            videoSrc,
     if ( params.inputColourSpaceConvert_ ) { cmd << " --InputColourSpaceConvert=RGBtoGBR"; }
 
     std::cout << cmd.str() << std::endl;
-    videoSrc.write( srcYuvName, params.inputBitDepth_ == 8 ? 1 : 2 );
-    if ( pcc::system( cmd.str().c_str() ) ) {
-      std::cout << "Error: can't run system command!" << std::endl;
-      exit( -1 );
-    }
     PCCCOLORFORMAT format = getColorFormat( params.recYuvFileName_ );
     videoRec.clear();
-    videoRec.read( recYuvName, width, height, format, params.outputBitDepth_ == 8 ? 1 : 2 );
+    if ( params.useNamedPipes_ && namedPipesSupported() && createNamedPipe( srcYuvName ) &&
+         createNamedPipe( recYuvName ) ) {
+      // stream src and rec videos through named pipes instead of intermediate files
+      if ( systemWithNamedPipes(
+               cmd.str().c_str(), srcYuvName,
+               [&]( std::ostream& stream ) { return videoSrc.write( stream, params.inputBitDepth_ == 8 ? 1 : 2 ); },
+               recYuvName,
+               [&]( std::istream& stream ) {
+                 return videoRec.read( stream, width, height, format, params.outputBitDepth_ == 8 ? 1 : 2 );
+               } ) ) {
+        std::cout << "Error: can't run system command with named pipes!" << std::endl;
+        exit( -1 );
+      }
+    } else {
+      videoSrc.write( srcYuvName, params.inputBitDepth_ == 8 ? 1 : 2 );
+      if ( pcc::system( cmd.str().c_str() ) ) {
+        std::cout << "Error: can't run system command!" << std::endl;
+        exit( -1 );
+      }
+      videoRec.read( recYuvName, width, height, format, params.outputBitDepth_ == 8 ? 1 : 2 );
+    }
     bitstream.read( binName );
     removeFile( srcYuvName );
     removeFile( recYuvName );